@@ -59,6 +59,13 @@ enum aom_com_control_id {
    * AOM_DECODER_CTRL_ID_START range next time we're ready to break the ABI.
    */
   AV1_GET_REFERENCE = 128, /**< get a pointer to a reference frame */
+
+  /*!\brief Run the workers of the codec on a shared thread pool
+   *
+   * Must be set before the first frame is encoded or decoded. The number of
+   * threads used by the codec is then limited by the size of the pool.
+   */
+  AOM_SET_THREAD_POOL = 129,
   AOM_COMMON_CTRL_ID_MAX,
 
   AV1_GET_NEW_FRAME_IMAGE = 192, /**< get a pointer to the new frame */
@@ -147,6 +154,8 @@ AOM_CTRL_USE_TYPE(AOM_SET_DBG_DISPLAY_MV, int)
 #define AOM_CTRL_AOM_SET_DBG_DISPLAY_MV
 AOM_CTRL_USE_TYPE(AV1_GET_REFERENCE, av1_ref_frame_t *)
 #define AOM_CTRL_AV1_GET_REFERENCE
+AOM_CTRL_USE_TYPE(AOM_SET_THREAD_POOL, aom_thread_pool_t *)
+#define AOM_CTRL_AOM_SET_THREAD_POOL
 AOM_CTRL_USE_TYPE(AV1_GET_NEW_FRAME_IMAGE, aom_image_t *)
 #define AOM_CTRL_AV1_GET_NEW_FRAME_IMAGE
 
@@ -376,6 +376,31 @@ aom_codec_err_t aom_codec_destroy(aom_codec_ctx_t *ctx);
  */
 aom_codec_caps_t aom_codec_get_caps(aom_codec_iface_t *iface);
 
+/*!\brief Thread pool shared by codec instances
+ *
+ * Opaque handle to a fixed set of threads. Encoder and decoder instances
+ * attached to the pool with the #AOM_SET_THREAD_POOL control run their
+ * workers on its threads instead of creating threads of their own.
+ */
+typedef struct aom_thread_pool aom_thread_pool_t;
+
+/*!\brief Create a thread pool
+ *
+ * \param[in] num_threads   Number of threads of the pool, 1 to 256
+ *
+ * \return A pool, or NULL if the threads could not be created or the
+ *     library was built without multi-threading.
+ */
+aom_thread_pool_t *aom_thread_pool_create(unsigned int num_threads);
+
+/*!\brief Destroy a thread pool
+ *
+ * All codec instances attached to the pool must be destroyed first.
+ *
+ * \param[in] pool   Pool returned by aom_thread_pool_create(), or NULL
+ */
+void aom_thread_pool_destroy(aom_thread_pool_t *pool);
+
 /*!\brief Control algorithm
  *
  * This function is used to exchange algorithm specific data with the codec
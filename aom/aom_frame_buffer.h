@@ -22,10 +22,9 @@ extern "C" {
 
 #include "./aom_integer.h"
 
-/*!\brief The maximum number of work buffers used by libaom.
- *  Support maximum 4 threads to decode video in parallel.
- *  Each thread will use one work buffer.
- * TODO(hkuang): Add support to set number of worker threads dynamically.
+/*!\brief The number of work buffers used by libaom.
+ *  Enough for 4 threads to decode video in parallel. Each additional
+ *  thread decoding frames in parallel uses one more work buffer.
  */
 #define AOM_MAXIMUM_WORK_BUFFERS 8
 
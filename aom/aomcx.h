@@ -502,6 +502,45 @@ enum aome_enc_control_id {
    * Experiment: LOOPFILTERING_ACROSS_TILES
    */
   AV1E_SET_TILE_LOOPFILTER,
+
+  /*!\brief Codec control function to enable row based multi-threading within
+   * a tile.
+   *
+   * The superblock rows of a tile are encoded in parallel by the encoder
+   * threads, each row one superblock behind the row above. The mode search
+   * state of each row is taken from the row above, so the output does not
+   * depend on the number of threads. It differs from the output with row
+   * based multi-threading disabled.
+   *
+   * By default, the value is 0, i.e. row based multi-threading is disabled.
+   */
+  AV1E_SET_ROW_MT,
+
+  /*!\brief Codec control function to encode the frames asynchronously.
+   *
+   * aom_codec_encode() copies the frame to a queue and returns. The frames
+   * of the queue are encoded in order by a thread of the encoder instance.
+   * aom_codec_encode() only waits for that thread if the queue is full, or
+   * when it is called with a NULL image, which flushes the encoder and
+   * returns once all the queued frames are encoded. An error of the encoding
+   * thread is returned by the next call to aom_codec_encode(), which also
+   * makes its detail the one of aom_codec_error_detail().
+   *
+   * Unlike in synchronous mode, each frame is copied twice: to the queue, and
+   * from the queue to the lookahead of the encoder by the encoding thread.
+   *
+   * If aom_async_output_t::cb is set, it is called by the encoding thread
+   * with each packet as soon as it is available. The packet and its data
+   * are only valid during the call. Otherwise, the packets are kept until
+   * they are retrieved with aom_codec_get_cx_data(), which returns the
+   * packets made since its previous call with a NULL iterator.
+   *
+   * Other controls and aom_codec_enc_config_set() wait until the queued
+   * frames are encoded. The mode cannot be turned off once it is set.
+   *
+   * \note Only available in builds with multi-threading.
+   */
+  AV1E_SET_ASYNC_OUTPUT,
 };
 
 /*!\brief aom 1-D scaling mode
@@ -558,6 +597,27 @@ typedef struct aom_scaling_mode {
   AOM_SCALING_MODE v_scaling_mode; /**< vertical scaling mode   */
 } aom_scaling_mode_t;
 
+/*!\brief Output callback of the asynchronous encoding mode
+ *
+ * Called by the encoding thread with each packet made by the encoder.
+ *
+ * \param[in] priv  The priv member of aom_async_output_t
+ * \param[in] pkt   The packet, only valid during the call
+ */
+typedef void (*aom_async_output_cb_fn_t)(void *priv,
+                                         const aom_codec_cx_pkt_t *pkt);
+
+/*!\brief Asynchronous encoding mode
+ *
+ * Parameter of AV1E_SET_ASYNC_OUTPUT.
+ */
+typedef struct aom_async_output {
+  /*! Called with each packet, or NULL to retrieve the packets with
+   * aom_codec_get_cx_data(). */
+  aom_async_output_cb_fn_t cb;
+  void *priv; /**< Passed to cb */
+} aom_async_output_t;
+
 /*!brief AV1 encoder content type */
 typedef enum {
   AOM_CONTENT_DEFAULT,
@@ -658,6 +718,12 @@ AOM_CTRL_USE_TYPE(AV1E_SET_DISABLE_TEMPMV, unsigned int)
 AOM_CTRL_USE_TYPE(AV1E_SET_FRAME_PARALLEL_DECODING, unsigned int)
 #define AOM_CTRL_AV1E_SET_FRAME_PARALLEL_DECODING
 
+AOM_CTRL_USE_TYPE(AV1E_SET_ROW_MT, unsigned int)
+#define AOM_CTRL_AV1E_SET_ROW_MT
+
+AOM_CTRL_USE_TYPE(AV1E_SET_ASYNC_OUTPUT, aom_async_output_t *)
+#define AOM_CTRL_AV1E_SET_ASYNC_OUTPUT
+
 AOM_CTRL_USE_TYPE(AV1E_SET_AQ_MODE, unsigned int)
 #define AOM_CTRL_AV1E_SET_AQ_MODE
 
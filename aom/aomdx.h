@@ -152,6 +152,26 @@ enum aom_dec_control_id {
    */
   AV1_SET_INSPECTION_CALLBACK,
 
+  /** control function to enable row-based multi-threading within a tile. The
+   * superblock rows of a tile are reconstructed in parallel by the decoder
+   * threads once the tile has been parsed. The output is identical to single
+   * threaded decoding. The default value is 0 (disabled).
+   */
+  AV1D_SET_ROW_MT,
+
+  /** control function to enable the collection of per-stage decoding times.
+   * The times are read with AV1D_GET_FRAME_TIMING. Timing adds two clock
+   * reads per stage and per tile. The default value is 0 (disabled).
+   */
+  AV1D_SET_FRAME_TIMING,
+
+  /** control function to get the decoding time of each stage of the frames
+   * decoded by the last call to aom_codec_decode(). Takes an
+   * aom_frame_timing_t. Returns AOM_CODEC_ERROR when the timing is not enabled
+   * with AV1D_SET_FRAME_TIMING. Only supported in serial decode.
+   */
+  AV1D_GET_FRAME_TIMING,
+
   AOM_DECODER_CTRL_ID_MAX,
 };
 
@@ -173,6 +193,48 @@ typedef struct aom_decrypt_init {
   void *decrypt_state;
 } aom_decrypt_init;
 
+/*!\brief Structure to hold the decoding time of each stage
+ *
+ * Filled by AV1D_GET_FRAME_TIMING. The times are in microseconds and are
+ * summed over all the frames decoded by the last call to aom_codec_decode(),
+ * including the frames that are not shown.
+ */
+typedef struct aom_frame_timing {
+  /*! Number of frames decoded. */
+  int num_frames;
+
+  /*! Reading the uncompressed and compressed frame headers. */
+  int64_t header_us;
+
+  /*! Decoding the tile data. The loop filter is included when it runs
+   * interleaved with the tile decoding. */
+  int64_t tile_decode_us;
+
+  /*! Loop filtering after the tiles are decoded. This includes CDEF and loop
+   * restoration when they are pipelined with the loop filter. */
+  int64_t loop_filter_us;
+
+  /*! Constrained directional enhancement filter. */
+  int64_t cdef_us;
+
+  /*! Loop restoration. */
+  int64_t loop_restoration_us;
+
+  /*! Backward adaptation of the probabilities and CDFs. */
+  int64_t adaptation_us;
+
+  /*! Whole frame decode, from the frame header to the border extension. */
+  int64_t total_us;
+
+  /*! Number of entries in tile_us. */
+  int num_tiles;
+
+  /*! Decoding time of each tile, in raster order. Tiles decoded by different
+   * threads overlap in time. Valid until the next call to aom_codec_decode().
+   */
+  const int64_t *tile_us;
+} aom_frame_timing_t;
+
 /*!\cond */
 /*!\brief AOM decoder control function parameter type
  *
@@ -209,6 +271,12 @@ AOM_CTRL_USE_TYPE(AV1_SET_DECODE_TILE_COL, int)
 #define AOM_CTRL_AV1_SET_DECODE_TILE_COL
 AOM_CTRL_USE_TYPE(AV1_SET_INSPECTION_CALLBACK, aom_inspect_init *)
 #define AOM_CTRL_AV1_SET_INSPECTION_CALLBACK
+AOM_CTRL_USE_TYPE(AV1D_SET_ROW_MT, int)
+#define AOM_CTRL_AV1D_SET_ROW_MT
+AOM_CTRL_USE_TYPE(AV1D_SET_FRAME_TIMING, int)
+#define AOM_CTRL_AV1D_SET_FRAME_TIMING
+AOM_CTRL_USE_TYPE(AV1D_GET_FRAME_TIMING, aom_frame_timing_t *)
+#define AOM_CTRL_AV1D_GET_FRAME_TIMING
 /*!\endcond */
 /*! @} - end defgroup aom_decoder */
 
@@ -17,6 +17,7 @@
 #include <stdlib.h>
 #include "aom/aom_integer.h"
 #include "aom/internal/aom_codec_internal.h"
+#include "aom_util/aom_thread_pool.h"
 #include "aom_version.h"
 
 #define SAVE_STATUS(ctx, var) (ctx ? (ctx->err = var) : var)
@@ -86,6 +87,15 @@ aom_codec_caps_t aom_codec_get_caps(aom_codec_iface_t *iface) {
   return (iface) ? iface->caps : 0;
 }
 
+aom_thread_pool_t *aom_thread_pool_create(unsigned int num_threads) {
+  if (num_threads == 0 || num_threads > 256) return NULL;
+  return (aom_thread_pool_t *)aom_thread_pool_alloc((int)num_threads);
+}
+
+void aom_thread_pool_destroy(aom_thread_pool_t *pool) {
+  aom_thread_pool_free((AVxThreadPool *)pool);
+}
+
 aom_codec_err_t aom_codec_control_(aom_codec_ctx_t *ctx, int ctrl_id, ...) {
   aom_codec_err_t res;
 
@@ -20,6 +20,9 @@ DSP_SRCS-$(ARCH_X86)$(ARCH_X86_64)   += x86/synonyms.h
 # bit reader
 DSP_SRCS-yes += prob.h
 DSP_SRCS-yes += prob.c
+DSP_SRCS-yes += cdf_simd.h
+DSP_SRCS-$(HAVE_SSE2) += x86/cdf_sse2.c
+DSP_SRCS-$(HAVE_NEON) += arm/cdf_neon.c
 DSP_SRCS-$(CONFIG_ANS) += ans.h
 
 ifeq ($(CONFIG_ENCODERS),yes)
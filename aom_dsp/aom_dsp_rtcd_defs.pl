@@ -316,6 +316,19 @@ if (aom_config("CONFIG_AOM_HIGHBITDEPTH") eq "yes") {
   specialize qw/aom_highbd_lpf_horizontal_4_dual sse2/;
 }  # CONFIG_AOM_HIGHBITDEPTH
 
+#
+# Entropy coding
+#
+if (aom_config("CONFIG_DAALA_EC") eq "yes") {
+  add_proto qw/int od_ec_find_symbol/, "const uint16_t *cdf, int nsyms, unsigned q";
+  specialize qw/od_ec_find_symbol sse2 neon/;
+}
+
+if (aom_config("CONFIG_EC_ADAPT") eq "yes") {
+  add_proto qw/void aom_update_cdf/, "uint16_t *cdf, int val, int nsymbs";
+  specialize qw/aom_update_cdf sse2 neon/;
+}
+
 #
 # Encoder functions.
 #
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2017, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include "./aom_dsp_rtcd.h"
+#include "aom_dsp/prob.h"
+#include "aom_ports/bitops.h"
+
+#if CONFIG_DAALA_EC
+// Vector version of od_ec_find_symbol_c(), comparing 8 entries at a time.
+// Only the nsyms entries of the CDF are read.
+int SIMD_FUNC(od_ec_find_symbol)(const uint16_t *cdf, int nsyms, unsigned q) {
+  const v128 qv = v128_dup_16(q);
+  int ret;
+  for (ret = 0; ret + 8 <= nsyms; ret += 8) {
+    // cdf[s] <= q exactly when the saturated difference is zero, and as the
+    // CDF is monotonic, the number of such entries is the index of the first
+    // entry above q.
+    const v128 le = v128_cmpeq_16(
+        v128_ssub_u16(v128_load_unaligned(cdf + ret), qv), v128_zero());
+    const int n = (int)v128_hadd_u8(v128_shr_u16(le, 15));
+    if (n < 8) return ret + n;
+  }
+  while (cdf[ret] <= q) ret++;
+  return ret;
+}
+#endif
+
+#if CONFIG_EC_ADAPT
+// Vector version of update_cdf_c(), adapting 8 entries at a time. The last
+// entry and the counter that follow the adapted entries are read and written
+// back unchanged, so a vector never reaches past the counter. The entries
+// left over are adapted one at a time.
+void SIMD_FUNC(aom_update_cdf)(uint16_t *cdf, int val, int nsymbs) {
+  const int rate = 4 + (cdf[nsymbs] > 31) + get_msb(nsymbs);
+  const int rate2 = 5;
+  const int diff = ((CDF_PROB_TOP - (nsymbs << rate2)) >> rate) << rate;
+  const v128 lane = v128_from_64(0x0007000600050004LL, 0x0003000200010000LL);
+  int i;
+
+  if (nsymbs + 1 < 8) {
+    update_cdf_c(cdf, val, nsymbs);
+    return;
+  }
+  for (i = 0; i + 8 <= nsymbs + 1; i += 8) {
+    // In lane j, tmp is (i + j + 1) << rate2, plus diff from symbol val on.
+    const v128 idx = v128_add_16(lane, v128_dup_16(i));
+    const v128 tmp =
+        v128_add_16(v128_shl_16(v128_add_16(idx, v128_dup_16(1)), rate2),
+                    v128_andn(v128_dup_16(diff),
+                              v128_cmplt_s16(idx, v128_dup_16(val))));
+    const v128 keep = v128_cmplt_s16(idx, v128_dup_16(nsymbs - 1));
+    const v128 c = v128_load_unaligned(cdf + i);
+    // The differences and the results fit in 16 bits, so the wrapping
+    // arithmetic matches the int arithmetic of update_cdf_c().
+    const v128 r = v128_sub_16(c, v128_shr_s16(v128_sub_16(c, tmp), rate));
+    v128_store_unaligned(cdf + i,
+                         v128_or(v128_and(r, keep), v128_andn(c, keep)));
+  }
+  for (; i < nsymbs - 1; ++i) {
+    const int tmp = ((i + 1) << rate2) + (i >= val ? diff : 0);
+    cdf[i] -= ((cdf[i] - tmp) >> rate);
+  }
+  cdf[nsymbs] += (cdf[nsymbs] < 32);
+}
+#endif
@@ -13,6 +13,7 @@
 #include "./config.h"
 #endif
 
+#include "./aom_dsp_rtcd.h"
 #include "aom_dsp/entcode.h"
 
 /*Given the current total integer number of bits used and the current value of
@@ -51,3 +52,15 @@ uint32_t od_ec_tell_frac(uint32_t nbits_total, uint32_t rng) {
   }
   return nbits - l;
 }
+
+/*Finds the symbol whose range of the CDF holds q.
+  cdf: The CDF, whose values must be monotonically non-decreasing.
+  nsyms: The number of symbols in the alphabet, with q < cdf[nsyms - 1].
+  Return: The first symbol s such that q < cdf[s].*/
+int od_ec_find_symbol_c(const uint16_t *cdf, int nsyms, unsigned q) {
+  int ret;
+  (void)nsyms;
+  for (ret = 0; cdf[ret] <= q; ret++) {
+  }
+  return ret;
+}
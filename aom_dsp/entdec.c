@@ -13,7 +13,9 @@
 #include "./config.h"
 #endif
 
+#include "./aom_dsp_rtcd.h"
 #include "aom_dsp/entdec.h"
+#include "aom_ports/mem_ops.h"
 
 /*A range decoder.
   This is an entropy decoder based upon \cite{Mar79}, which is itself a
@@ -86,6 +88,17 @@ static void od_ec_dec_refill(od_ec_dec *dec) {
   bptr = dec->bptr;
   end = dec->end;
   s = OD_EC_WINDOW_SIZE - 9 - (cnt + 15);
+  /*Away from the end of the buffer, the bytes that fit in the window are read
+     with a single big-endian load instead of one at a time.*/
+  if (s >= 0 && end - bptr >= 4) {
+    int n;
+    n = OD_MINI((s >> 3) + 1, 4);
+    dif |= ((od_ec_window)mem_get_be32(bptr) >> (32 - 8 * n))
+           << (s - 8 * (n - 1));
+    bptr += n;
+    cnt += 8 * n;
+    s -= 8 * n;
+  }
   for (; s >= 0 && bptr < end; s -= 8, bptr++) {
     OD_ASSERT(s <= OD_EC_WINDOW_SIZE - 8);
     dif |= (od_ec_window)bptr[0] << s;
@@ -214,6 +227,12 @@ int od_ec_decode_bool_q15(od_ec_dec *dec, unsigned fz) {
   return od_ec_dec_normalize(dec, dif, r_new, ret);
 }
 
+/*Up to 8 symbols, the vector versions are no faster than the scalar loop.*/
+static int od_ec_find_cdf_symbol(const uint16_t *cdf, int nsyms, unsigned q) {
+  return nsyms > 8 ? od_ec_find_symbol(cdf, nsyms, q)
+                   : od_ec_find_symbol_c(cdf, nsyms, q);
+}
+
 /*Decodes a symbol given a cumulative distribution function (CDF) table.
   cdf: The CDF, such that symbol s falls in the range
         [s > 0 ? cdf[s - 1] : 0, cdf[s]).
@@ -265,9 +284,9 @@ int od_ec_decode_cdf(od_ec_dec *dec, const uint16_t *cdf, int nsyms) {
 #endif
   q >>= s;
   OD_ASSERT(q<ft>> s);
-  fl = 0;
-  ret = 0;
-  for (fh = cdf[ret]; fh <= q; fh = cdf[++ret]) fl = fh;
+  ret = od_ec_find_cdf_symbol(cdf, nsyms, q);
+  fl = ret > 0 ? cdf[ret - 1] : 0;
+  fh = cdf[ret];
   OD_ASSERT(fh <= ft >> s);
   fl <<= s;
   fh <<= s;
@@ -332,9 +351,9 @@ int od_ec_decode_cdf_unscaled(od_ec_dec *dec, const uint16_t *cdf, int nsyms) {
 #endif
   q >>= s;
   OD_ASSERT(q<ft>> s);
-  fl = 0;
-  ret = 0;
-  for (fh = cdf[ret]; fh <= q; fh = cdf[++ret]) fl = fh;
+  ret = od_ec_find_cdf_symbol(cdf, nsyms, q);
+  fl = ret > 0 ? cdf[ret - 1] : 0;
+  fh = cdf[ret];
   OD_ASSERT(fh <= ft >> s);
   fl <<= s;
   fh <<= s;
@@ -15,6 +15,7 @@
 #include <string.h>
 #endif
 
+#include "./aom_dsp_rtcd.h"
 #include "aom_dsp/prob.h"
 
 #if CONFIG_DAALA_EC
@@ -237,3 +238,13 @@ void av1_indices_from_tree(int *ind, int *inv, const aom_tree_index *tree) {
   tree_to_index(&stack_index, ind, inv, tree, 0, 0);
 }
 #endif
+
+#if CONFIG_EC_ADAPT
+void aom_update_cdf_c(uint16_t *cdf, int val, int nsymbs) {
+  update_cdf_c(cdf, val, nsymbs);
+}
+
+void aom_update_large_cdf(aom_cdf_prob *cdf, int val, int nsymbs) {
+  aom_update_cdf(cdf, val, nsymbs);
+}
+#endif
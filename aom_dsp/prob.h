@@ -145,7 +145,8 @@ void av1_indices_from_tree(int *ind, int *inv, const aom_tree_index *tree);
 DECLARE_ALIGNED(16, extern const uint8_t, aom_norm[256]);
 
 #if CONFIG_EC_ADAPT
-static INLINE void update_cdf(aom_cdf_prob *cdf, int val, int nsymbs) {
+// Reference implementation of update_cdf().
+static INLINE void update_cdf_c(aom_cdf_prob *cdf, int val, int nsymbs) {
   const int rate = 4 + (cdf[nsymbs] > 31) + get_msb(nsymbs);
   const int rate2 = 5;
   int i, tmp;
@@ -172,6 +173,17 @@ static INLINE void update_cdf(aom_cdf_prob *cdf, int val, int nsymbs) {
 #endif
   cdf[nsymbs] += (cdf[nsymbs] < 32);
 }
+
+// Adapts the CDF with the version of aom_update_cdf() selected at run time.
+void aom_update_large_cdf(aom_cdf_prob *cdf, int val, int nsymbs);
+
+static INLINE void update_cdf(aom_cdf_prob *cdf, int val, int nsymbs) {
+  // Up to 8 symbols, the vector versions are no faster than the scalar loop.
+  if (nsymbs > 8)
+    aom_update_large_cdf(cdf, val, nsymbs);
+  else
+    update_cdf_c(cdf, val, nsymbs);
+}
 #endif
 
 #ifdef __cplusplus
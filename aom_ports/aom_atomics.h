@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2017, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#ifndef AOM_PORTS_AOM_ATOMICS_H_
+#define AOM_PORTS_AOM_ATOMICS_H_
+
+#include "./aom_config.h"
+
+/* Sequentially consistent loads and stores of an int shared between threads.
+ *
+ * A thread publishing progress stores it with aom_atomic_store_int() and a
+ * thread waiting for it polls aom_atomic_load_int(), so the waiting thread
+ * only takes a lock once it has to block. Since the operations are
+ * sequentially consistent, a waiter that sets a flag and then loads the
+ * progress, and a publisher that stores the progress and then loads the flag,
+ * cannot both miss the other's store.
+ *
+ * aom_atomic_fetch_add_int() adds to an int and returns its previous value,
+ * e.g. to hand out the jobs of a queue to several threads without a lock.
+ */
+
+#if !CONFIG_MULTITHREAD
+
+static INLINE int aom_atomic_load_int(const int *p) { return *p; }
+
+static INLINE void aom_atomic_store_int(int *p, int value) { *p = value; }
+
+static INLINE int aom_atomic_fetch_add_int(int *p, int value) {
+  const int old = *p;
+  *p += value;
+  return old;
+}
+
+#elif defined(__clang__) || \
+    (defined(__GNUC__) &&   \
+     (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7)))
+
+static INLINE int aom_atomic_load_int(const int *p) {
+  return __atomic_load_n(p, __ATOMIC_SEQ_CST);
+}
+
+static INLINE void aom_atomic_store_int(int *p, int value) {
+  __atomic_store_n(p, value, __ATOMIC_SEQ_CST);
+}
+
+static INLINE int aom_atomic_fetch_add_int(int *p, int value) {
+  return __atomic_fetch_add(p, value, __ATOMIC_SEQ_CST);
+}
+
+#elif defined(__GNUC__)
+
+static INLINE int aom_atomic_load_int(const int *p) {
+  return __sync_fetch_and_add((int *)p, 0);
+}
+
+static INLINE void aom_atomic_store_int(int *p, int value) {
+  __sync_synchronize();
+  *(volatile int *)p = value;
+  __sync_synchronize();
+}
+
+static INLINE int aom_atomic_fetch_add_int(int *p, int value) {
+  return __sync_fetch_and_add(p, value);
+}
+
+#elif defined(_MSC_VER)
+
+#include <intrin.h>
+
+static INLINE int aom_atomic_load_int(const int *p) {
+  return (int)_InterlockedOr((volatile long *)p, 0);
+}
+
+static INLINE void aom_atomic_store_int(int *p, int value) {
+  _InterlockedExchange((volatile long *)p, (long)value);
+}
+
+static INLINE int aom_atomic_fetch_add_int(int *p, int value) {
+  return (int)_InterlockedExchangeAdd((volatile long *)p, (long)value);
+}
+
+#else
+#error "aom_atomics.h: no atomic operations for this compiler."
+#endif
+
+/* Number of polls of a progress value before a waiting thread blocks. */
+#define AOM_ATOMIC_SPIN_COUNT 1000
+
+#endif  // AOM_PORTS_AOM_ATOMICS_H_
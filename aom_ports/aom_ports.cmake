@@ -9,6 +9,7 @@
 ## PATENTS file, you can obtain it at www.aomedia.org/license/patent.
 ##
 set(AOM_PORTS_INCLUDES
+    "${AOM_ROOT}/aom_ports/aom_atomics.h"
     "${AOM_ROOT}/aom_ports/aom_once.h"
     "${AOM_ROOT}/aom_ports/aom_timer.h"
     "${AOM_ROOT}/aom_ports/bitops.h"
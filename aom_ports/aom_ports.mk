@@ -13,6 +13,7 @@
 
 PORTS_SRCS-yes += aom_ports.mk
 
+PORTS_SRCS-yes += aom_atomics.h
 PORTS_SRCS-yes += bitops.h
 PORTS_SRCS-yes += mem.h
 PORTS_SRCS-yes += msvc.h
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2017, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <assert.h>
+
+#include "aom/aom_integer.h"
+#include "aom_mem/aom_mem.h"
+#include "aom_ports/aom_atomics.h"
+#include "aom_util/aom_job_queue.h"
+
+// The queues of the workers are kept on separate cache lines.
+#define JOB_DEQUE_ALIGN 64
+
+struct AVxJobDeque {
+  // The queue holds the jobs with index worker + k * num_workers for k in
+  // [next, end). next is incremented atomically and may pass end.
+  int next;
+  int end;
+};
+
+static size_t deque_stride(void) {
+  return (sizeof(AVxJobDeque) + JOB_DEQUE_ALIGN - 1) & ~(JOB_DEQUE_ALIGN - 1);
+}
+
+static AVxJobDeque *get_deque(const AVxJobQueue *const queue, int worker) {
+  return (AVxJobDeque *)((uint8_t *)queue->deques + worker * deque_stride());
+}
+
+int aom_job_queue_alloc(AVxJobQueue *const queue, int max_workers) {
+  int i;
+
+  if (queue->max_workers >= max_workers) return 1;
+  aom_job_queue_free(queue);
+
+  queue->deques = (AVxJobDeque *)aom_memalign(JOB_DEQUE_ALIGN,
+                                              max_workers * deque_stride());
+  if (queue->deques == NULL) return 0;
+
+  for (i = 0; i < max_workers; ++i) {
+    AVxJobDeque *const deque = get_deque(queue, i);
+    deque->next = 0;
+    deque->end = 0;
+  }
+  queue->max_workers = max_workers;
+  queue->num_workers = 0;
+  return 1;
+}
+
+void aom_job_queue_free(AVxJobQueue *const queue) {
+  aom_free(queue->deques);
+  queue->deques = NULL;
+  queue->max_workers = 0;
+  queue->num_workers = 0;
+}
+
+void aom_job_queue_reset(AVxJobQueue *const queue, int num_jobs,
+                         int num_workers) {
+  int i;
+
+  assert(num_workers > 0 && num_workers <= queue->max_workers);
+  queue->num_workers = num_workers;
+  for (i = 0; i < num_workers; ++i) {
+    AVxJobDeque *const deque = get_deque(queue, i);
+    deque->next = 0;
+    deque->end = (num_jobs - i + num_workers - 1) / num_workers;
+  }
+}
+
+// Takes the first job left in the queue of worker 'owner'.
+static int take_job(AVxJobQueue *const queue, int owner) {
+  AVxJobDeque *const deque = get_deque(queue, owner);
+  int k;
+
+  if (aom_atomic_load_int(&deque->next) >= deque->end) return -1;
+  k = aom_atomic_fetch_add_int(&deque->next, 1);
+  return k < deque->end ? owner + k * queue->num_workers : -1;
+}
+
+int aom_job_queue_next(AVxJobQueue *const queue, int worker) {
+  const int num_workers = queue->num_workers;
+  int job = -1;
+  int i;
+
+  assert(worker >= 0 && worker < num_workers);
+  for (i = 0; i < num_workers && job < 0; ++i)
+    job = take_job(queue, (worker + i) % num_workers);
+  return job;
+}
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2017, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+//
+// Work-stealing job queue shared by the workers of a parallel stage.
+//
+// The jobs of a stage are numbered 0 to num_jobs - 1 and dealt round-robin to
+// one queue per worker, so that worker w owns the jobs w, w + n, w + 2n, ...
+// A worker takes the jobs of its own queue in order. Once its queue is empty,
+// it takes the first job left in the queue of another worker. Jobs are taken
+// with an atomic increment of the position in the queue, so the workers never
+// wait for each other.
+//
+// Jobs are taken in increasing order from every queue and a worker only steals
+// once its own queue is empty, so the lowest job not finished is always
+// running. Jobs may therefore wait for lower jobs, e.g. a superblock row for
+// the row above, without a deadlock.
+
+#ifndef AOM_JOB_QUEUE_H_
+#define AOM_JOB_QUEUE_H_
+
+#include "./aom_config.h"
+#include "aom_util/aom_thread.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct AVxJobDeque AVxJobDeque;
+
+typedef struct {
+  AVxJobDeque *deques;
+  // Number of allocated queues, the most workers the queue can serve.
+  int max_workers;
+  // Number of workers taking part in the current stage.
+  int num_workers;
+} AVxJobQueue;
+
+// Allocates the queues of up to max_workers workers. Returns false in case of
+// error. Re-allocating an allocated queue keeps it if it is large enough.
+int aom_job_queue_alloc(AVxJobQueue *const queue, int max_workers);
+
+// Frees the queues. The queue may then be allocated again.
+void aom_job_queue_free(AVxJobQueue *const queue);
+
+// Deals num_jobs jobs to the queues of the first num_workers workers. Each of
+// them must then take jobs until none are left, or the jobs dealt to an idle
+// worker may only run once the others run out of work. Must not be called
+// while any worker is taking jobs.
+void aom_job_queue_reset(AVxJobQueue *const queue, int num_jobs,
+                         int num_workers);
+
+// Returns the next job for worker 'worker', or -1 once all the jobs have been
+// taken.
+int aom_job_queue_next(AVxJobQueue *const queue, int worker);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // AOM_JOB_QUEUE_H_
@@ -18,6 +18,7 @@
 #include <string.h>  // for memset()
 #include "./aom_thread.h"
 #include "aom_mem/aom_mem.h"
+#include "aom_util/aom_thread_pool.h"
 
 #if CONFIG_MULTITHREAD
 
@@ -85,6 +86,7 @@ static void init(AVxWorker *const worker) {
 
 static int sync(AVxWorker *const worker) {
 #if CONFIG_MULTITHREAD
+  if (worker->pool != NULL) return aom_thread_pool_sync(worker);
   change_state(worker, OK);
 #endif
   assert(worker->status_ <= OK);
@@ -96,6 +98,10 @@ static int reset(AVxWorker *const worker) {
   worker->had_error = 0;
   if (worker->status_ < OK) {
 #if CONFIG_MULTITHREAD
+    if (worker->pool != NULL) {
+      worker->status_ = OK;
+      return 1;
+    }
     worker->impl_ = (AVxWorkerImpl *)aom_calloc(1, sizeof(*worker->impl_));
     if (worker->impl_ == NULL) {
       return 0;
@@ -137,6 +143,10 @@ static void execute(AVxWorker *const worker) {
 
 static void launch(AVxWorker *const worker) {
 #if CONFIG_MULTITHREAD
+  if (worker->pool != NULL) {
+    aom_thread_pool_launch(worker);
+    return;
+  }
   change_state(worker, WORK);
 #else
   execute(worker);
@@ -145,7 +155,10 @@ static void launch(AVxWorker *const worker) {
 
 static void end(AVxWorker *const worker) {
 #if CONFIG_MULTITHREAD
-  if (worker->impl_ != NULL) {
+  if (worker->pool != NULL) {
+    aom_thread_pool_sync(worker);
+    worker->status_ = NOT_OK;
+  } else if (worker->impl_ != NULL) {
     change_state(worker, NOT_OK);
     pthread_join(worker->impl_->thread_, NULL);
     pthread_mutex_destroy(&worker->impl_->mutex_);
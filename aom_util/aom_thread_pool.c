@@ -0,0 +1,233 @@
+/*
+ * Copyright (c) 2017, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <assert.h>
+#include <string.h>
+
+#include "aom_mem/aom_mem.h"
+#include "aom_util/aom_thread_pool.h"
+
+#if CONFIG_MULTITHREAD
+
+struct AVxThreadPool {
+  pthread_mutex_t mutex;
+  // Signaled when a worker is ready to run, or when the pool is freed.
+  pthread_cond_t work_cond;
+  // Signaled when threads are released by a client, or a client is served.
+  pthread_cond_t reserve_cond;
+  pthread_t *threads;
+  int num_threads;
+  // The workers ready to run, in launch order. At most num_threads of them
+  // wait at a time, since each of them holds a reserved thread.
+  AVxWorker **ready;
+  int ready_start;
+  int num_ready;
+  // Number of threads neither running a worker nor reserved by a client.
+  int num_idle;
+  // The clients are served in the order of their tickets.
+  unsigned int next_ticket;
+  unsigned int now_serving;
+  int quit;
+};
+
+static THREADFN thread_loop(void *ptr) {
+  AVxThreadPool *const pool = (AVxThreadPool *)ptr;
+
+  pthread_mutex_lock(&pool->mutex);
+  for (;;) {
+    AVxWorker *worker;
+    AVxThreadPoolClient *client;
+
+    while (pool->num_ready == 0 && !pool->quit)
+      pthread_cond_wait(&pool->work_cond, &pool->mutex);
+    if (pool->num_ready == 0) break;
+    worker = pool->ready[pool->ready_start];
+    pool->ready_start = (pool->ready_start + 1) % pool->num_threads;
+    --pool->num_ready;
+    pthread_mutex_unlock(&pool->mutex);
+
+    if (worker->hook != NULL)
+      worker->had_error |= !worker->hook(worker->data1, worker->data2);
+
+    pthread_mutex_lock(&pool->mutex);
+    client = worker->pool;
+    worker->status_ = OK;
+    if (--client->num_running == 0) {
+      // The client gives its threads back until it launches workers again.
+      pool->num_idle += client->max_workers;
+      client->reserved = 0;
+      pthread_cond_broadcast(&pool->reserve_cond);
+    }
+    pthread_cond_broadcast(&client->cond);
+  }
+  pthread_mutex_unlock(&pool->mutex);
+  return THREAD_RETURN(NULL);
+}
+
+AVxThreadPool *aom_thread_pool_alloc(int num_threads) {
+  AVxThreadPool *pool;
+
+  if (num_threads <= 0) return NULL;
+  pool = (AVxThreadPool *)aom_calloc(1, sizeof(*pool));
+  if (pool == NULL) return NULL;
+  pool->threads = (pthread_t *)aom_malloc(num_threads * sizeof(*pool->threads));
+  pool->ready = (AVxWorker **)aom_malloc(num_threads * sizeof(*pool->ready));
+  if (pool->threads == NULL || pool->ready == NULL) goto Error;
+  if (pthread_mutex_init(&pool->mutex, NULL)) goto Error;
+  if (pthread_cond_init(&pool->work_cond, NULL)) {
+    pthread_mutex_destroy(&pool->mutex);
+    goto Error;
+  }
+  if (pthread_cond_init(&pool->reserve_cond, NULL)) {
+    pthread_cond_destroy(&pool->work_cond);
+    pthread_mutex_destroy(&pool->mutex);
+    goto Error;
+  }
+  for (; pool->num_threads < num_threads; ++pool->num_threads) {
+    if (pthread_create(&pool->threads[pool->num_threads], NULL, thread_loop,
+                       pool)) {
+      aom_thread_pool_free(pool);
+      return NULL;
+    }
+  }
+  pool->num_idle = num_threads;
+  return pool;
+
+Error:
+  aom_free(pool->threads);
+  aom_free(pool->ready);
+  aom_free(pool);
+  return NULL;
+}
+
+void aom_thread_pool_free(AVxThreadPool *pool) {
+  int i;
+
+  if (pool == NULL) return;
+  pthread_mutex_lock(&pool->mutex);
+  pool->quit = 1;
+  pthread_cond_broadcast(&pool->work_cond);
+  pthread_mutex_unlock(&pool->mutex);
+  for (i = 0; i < pool->num_threads; ++i) pthread_join(pool->threads[i], NULL);
+  pthread_cond_destroy(&pool->reserve_cond);
+  pthread_cond_destroy(&pool->work_cond);
+  pthread_mutex_destroy(&pool->mutex);
+  aom_free(pool->threads);
+  aom_free(pool->ready);
+  aom_free(pool);
+}
+
+int aom_thread_pool_num_threads(const AVxThreadPool *pool) {
+  return pool->num_threads;
+}
+
+int aom_thread_pool_client_init(AVxThreadPoolClient *client,
+                                AVxThreadPool *pool, int max_workers) {
+  memset(client, 0, sizeof(*client));
+  if (max_workers <= 0 || max_workers > pool->num_threads) return 0;
+  if (pthread_cond_init(&client->cond, NULL)) return 0;
+  client->pool = pool;
+  client->max_workers = max_workers;
+  return 1;
+}
+
+void aom_thread_pool_client_free(AVxThreadPoolClient *client) {
+  if (client->pool == NULL) return;
+  assert(client->num_running == 0);
+  pthread_cond_destroy(&client->cond);
+  client->pool = NULL;
+}
+
+void aom_thread_pool_yield(AVxThreadPoolClient *client) {
+  AVxThreadPool *const pool = client->pool;
+
+  pthread_mutex_lock(&pool->mutex);
+  // The reservation ends with the last running worker of the client.
+  if (client->reserved && pool->now_serving != pool->next_ticket) {
+    while (client->num_running > 0)
+      pthread_cond_wait(&client->cond, &pool->mutex);
+  }
+  pthread_mutex_unlock(&pool->mutex);
+}
+
+void aom_thread_pool_launch(AVxWorker *const worker) {
+  AVxThreadPoolClient *const client = worker->pool;
+  AVxThreadPool *const pool = client->pool;
+
+  pthread_mutex_lock(&pool->mutex);
+  while (worker->status_ == WORK)
+    pthread_cond_wait(&client->cond, &pool->mutex);
+  if (!client->reserved) {
+    const unsigned int ticket = pool->next_ticket++;
+    while (ticket != pool->now_serving || pool->num_idle < client->max_workers)
+      pthread_cond_wait(&pool->reserve_cond, &pool->mutex);
+    pool->num_idle -= client->max_workers;
+    client->reserved = 1;
+    ++pool->now_serving;
+    pthread_cond_broadcast(&pool->reserve_cond);
+  }
+  assert(client->num_running < client->max_workers);
+  ++client->num_running;
+  worker->status_ = WORK;
+  pool->ready[(pool->ready_start + pool->num_ready) % pool->num_threads] =
+      worker;
+  ++pool->num_ready;
+  pthread_cond_signal(&pool->work_cond);
+  pthread_mutex_unlock(&pool->mutex);
+}
+
+int aom_thread_pool_sync(AVxWorker *const worker) {
+  AVxThreadPoolClient *const client = worker->pool;
+  AVxThreadPool *const pool = client->pool;
+
+  pthread_mutex_lock(&pool->mutex);
+  while (worker->status_ == WORK)
+    pthread_cond_wait(&client->cond, &pool->mutex);
+  pthread_mutex_unlock(&pool->mutex);
+  return !worker->had_error;
+}
+
+#else
+
+AVxThreadPool *aom_thread_pool_alloc(int num_threads) {
+  (void)num_threads;
+  return NULL;
+}
+
+void aom_thread_pool_free(AVxThreadPool *pool) { (void)pool; }
+
+int aom_thread_pool_num_threads(const AVxThreadPool *pool) {
+  (void)pool;
+  return 0;
+}
+
+int aom_thread_pool_client_init(AVxThreadPoolClient *client,
+                                AVxThreadPool *pool, int max_workers) {
+  (void)pool;
+  (void)max_workers;
+  memset(client, 0, sizeof(*client));
+  return 0;
+}
+
+void aom_thread_pool_client_free(AVxThreadPoolClient *client) {
+  (void)client;
+}
+
+void aom_thread_pool_yield(AVxThreadPoolClient *client) { (void)client; }
+
+void aom_thread_pool_launch(AVxWorker *const worker) {
+  if (worker->hook != NULL)
+    worker->had_error |= !worker->hook(worker->data1, worker->data2);
+}
+
+int aom_thread_pool_sync(AVxWorker *const worker) { return !worker->had_error; }
+
+#endif  // CONFIG_MULTITHREAD
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2017, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+//
+// Thread pool shared by the workers of several codec instances.
+//
+// A worker attached to a client of the pool has no thread of its own. When it
+// is launched, one of the threads of the pool runs its hook.
+//
+// The workers launched together may wait for each other, e.g. a superblock row
+// for the row above. They must therefore run at the same time. Before a client
+// launches its first worker, it reserves max_workers threads of the pool. It
+// keeps them until none of its workers is running. Clients reserve threads in
+// the order they ask for them, so a client never waits on the clients that
+// came after it. A client that keeps some worker running all the time, like
+// the frame workers of the decoder, calls aom_thread_pool_yield() between its
+// launches so that it does not hold its threads forever.
+
+#ifndef AOM_THREAD_POOL_H_
+#define AOM_THREAD_POOL_H_
+
+#include "./aom_config.h"
+#include "aom_util/aom_thread.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct AVxThreadPool AVxThreadPool;
+
+struct AVxThreadPoolClient {
+  AVxThreadPool *pool;
+#if CONFIG_MULTITHREAD
+  // Signaled when a worker of the client finishes.
+  pthread_cond_t cond;
+#endif
+  // Most workers of the client running at the same time.
+  int max_workers;
+  // Number of workers launched and not finished.
+  int num_running;
+  // Whether max_workers threads of the pool are reserved for the client.
+  int reserved;
+};
+
+// Creates a pool of num_threads threads. Returns NULL in case of error, or if
+// the library is built without multi-threading.
+AVxThreadPool *aom_thread_pool_alloc(int num_threads);
+
+// Joins the threads and frees the pool. The clients must be freed first.
+void aom_thread_pool_free(AVxThreadPool *pool);
+
+int aom_thread_pool_num_threads(const AVxThreadPool *pool);
+
+// Initializes a client that runs up to max_workers workers at the same time on
+// the pool. max_workers may not exceed the number of threads of the pool.
+// Returns false in case of error.
+int aom_thread_pool_client_init(AVxThreadPoolClient *client,
+                                AVxThreadPool *pool, int max_workers);
+
+// Frees the client. None of its workers may be running.
+void aom_thread_pool_client_free(AVxThreadPoolClient *client);
+
+// If other clients wait for threads, waits for the workers of the client to
+// finish, so that its threads go to these clients first. Only call it between
+// the launches of workers that do not wait for the ones launched after them.
+void aom_thread_pool_yield(AVxThreadPoolClient *client);
+
+// Implementation of launch() and sync() of the workers attached to a client.
+void aom_thread_pool_launch(AVxWorker *const worker);
+int aom_thread_pool_sync(AVxWorker *const worker);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // AOM_THREAD_POOL_H_
@@ -9,8 +9,12 @@
 ## PATENTS file, you can obtain it at www.aomedia.org/license/patent.
 ##
 set(AOM_UTIL_SOURCES
+    "${AOM_ROOT}/aom_util/aom_job_queue.c"
+    "${AOM_ROOT}/aom_util/aom_job_queue.h"
     "${AOM_ROOT}/aom_util/aom_thread.c"
     "${AOM_ROOT}/aom_util/aom_thread.h"
+    "${AOM_ROOT}/aom_util/aom_thread_pool.c"
+    "${AOM_ROOT}/aom_util/aom_thread_pool.h"
     "${AOM_ROOT}/aom_util/endian_inl.h")
 
 if (CONFIG_BITSTREAM_DEBUG)
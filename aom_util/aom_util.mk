@@ -13,6 +13,10 @@
 UTIL_SRCS-yes += aom_util.mk
 UTIL_SRCS-yes += aom_thread.c
 UTIL_SRCS-yes += aom_thread.h
+UTIL_SRCS-yes += aom_thread_pool.c
+UTIL_SRCS-yes += aom_thread_pool.h
+UTIL_SRCS-yes += aom_job_queue.c
+UTIL_SRCS-yes += aom_job_queue.h
 UTIL_SRCS-$(CONFIG_BITSTREAM_DEBUG) += debug_util.c
 UTIL_SRCS-$(CONFIG_BITSTREAM_DEBUG) += debug_util.h
 UTIL_SRCS-yes += endian_inl.h
@@ -85,6 +85,10 @@ static const arg_def_t threadsarg =
     ARG_DEF("t", "threads", 1, "Max threads to use");
 static const arg_def_t frameparallelarg =
     ARG_DEF(NULL, "frame-parallel", 0, "Frame parallel decode");
+static const arg_def_t rowmtarg =
+    ARG_DEF(NULL, "row-mt", 0, "Row based multi-threaded decode within tiles");
+static const arg_def_t frametimingarg =
+    ARG_DEF(NULL, "frame-timing", 0, "Show the decoding time of each stage");
 static const arg_def_t verbosearg =
     ARG_DEF("v", "verbose", 0, "Show version string");
 static const arg_def_t error_concealment =
@@ -126,6 +130,8 @@ static const arg_def_t *all_args[] = { &codecarg,
                                        &outputfile,
                                        &threadsarg,
                                        &frameparallelarg,
+                                       &rowmtarg,
+                                       &frametimingarg,
                                        &verbosearg,
                                        &scalearg,
                                        &fb_arg,
@@ -338,6 +344,39 @@ static int file_is_raw(struct AvxInputContext *input) {
   return is_raw;
 }
 
+#if CONFIG_AV1_DECODER
+static void show_frame_timing(const char *label,
+                              const aom_frame_timing_t *timing) {
+  int i;
+  fprintf(stderr,
+          "%s: %d frame(s), header %" PRId64 ", tiles %" PRId64 ", lf %" PRId64
+          ", cdef %" PRId64 ", lr %" PRId64 ", adapt %" PRId64
+          ", total %" PRId64 " us",
+          label, timing->num_frames, timing->header_us, timing->tile_decode_us,
+          timing->loop_filter_us, timing->cdef_us,
+          timing->loop_restoration_us, timing->adaptation_us,
+          timing->total_us);
+  if (timing->num_tiles > 1 && timing->tile_us != NULL) {
+    fprintf(stderr, ", tile us:");
+    for (i = 0; i < timing->num_tiles; ++i)
+      fprintf(stderr, " %" PRId64, timing->tile_us[i]);
+  }
+  fprintf(stderr, "\n");
+}
+
+static void add_frame_timing(aom_frame_timing_t *sum,
+                             const aom_frame_timing_t *timing) {
+  sum->num_frames += timing->num_frames;
+  sum->header_us += timing->header_us;
+  sum->tile_decode_us += timing->tile_decode_us;
+  sum->loop_filter_us += timing->loop_filter_us;
+  sum->cdef_us += timing->cdef_us;
+  sum->loop_restoration_us += timing->loop_restoration_us;
+  sum->adaptation_us += timing->adaptation_us;
+  sum->total_us += timing->total_us;
+}
+#endif  // CONFIG_AV1_DECODER
+
 static void show_progress(int frame_in, int frame_out, uint64_t dx_time) {
   fprintf(stderr,
           "%d decoded frames/%d showed frames in %" PRId64 " us (%.2f fps)\r",
@@ -506,7 +545,8 @@ static int main_loop(int argc, const char **argv_) {
   size_t bytes_in_buffer = 0, buffer_size = 0;
   FILE *infile;
   int frame_in = 0, frame_out = 0, flipuv = 0, noblit = 0;
-  int do_md5 = 0, progress = 0, frame_parallel = 0;
+  int do_md5 = 0, progress = 0, frame_parallel = 0, row_mt = 0;
+  int frame_timing = 0;
   int stop_after = 0, postproc = 0, summary = 0, quiet = 1;
   int arg_skip = 0;
   int ec_enabled = 0;
@@ -522,6 +562,9 @@ static int main_loop(int argc, const char **argv_) {
   int opt_yv12 = 0;
   int opt_i420 = 0;
   aom_codec_dec_cfg_t cfg = { 0, 0, 0 };
+#if CONFIG_AV1_DECODER
+  aom_frame_timing_t timing_sum;
+#endif
 #if CONFIG_AOM_HIGHBITDEPTH
   unsigned int output_bit_depth = 0;
 #endif
@@ -612,6 +655,10 @@ static int main_loop(int argc, const char **argv_) {
 #if CONFIG_AV1_DECODER
     else if (arg_match(&arg, &frameparallelarg, argi))
       frame_parallel = 1;
+    else if (arg_match(&arg, &rowmtarg, argi))
+      row_mt = 1;
+    else if (arg_match(&arg, &frametimingarg, argi))
+      frame_timing = 1;
 #endif
     else if (arg_match(&arg, &verbosearg, argi))
       quiet = 0;
@@ -732,6 +779,25 @@ static int main_loop(int argc, const char **argv_) {
 
   if (!quiet) fprintf(stderr, "%s\n", decoder.name);
 
+#if CONFIG_AV1_DECODER
+  if (row_mt && aom_codec_control(&decoder, AV1D_SET_ROW_MT, row_mt)) {
+    fprintf(stderr, "Failed to set row_mt: %s\n", aom_codec_error(&decoder));
+    goto fail;
+  }
+
+  if (frame_timing && frame_parallel) {
+    warn("--frame-timing is not supported in frame parallel decode");
+    frame_timing = 0;
+  }
+  if (frame_timing &&
+      aom_codec_control(&decoder, AV1D_SET_FRAME_TIMING, frame_timing)) {
+    fprintf(stderr, "Failed to set frame_timing: %s\n",
+            aom_codec_error(&decoder));
+    goto fail;
+  }
+  memset(&timing_sum, 0, sizeof(timing_sum));
+#endif
+
 #if CONFIG_AV1_DECODER && CONFIG_EXT_TILE
   if (aom_codec_control(&decoder, AV1_SET_DECODE_TILE_ROW, tile_row)) {
     fprintf(stderr, "Failed to set decode_tile_row: %s\n",
@@ -807,6 +873,22 @@ static int main_loop(int argc, const char **argv_) {
 
         aom_usec_timer_mark(&timer);
         dx_time += aom_usec_timer_elapsed(&timer);
+
+#if CONFIG_AV1_DECODER
+        if (frame_timing) {
+          aom_frame_timing_t timing;
+          char label[32];
+          if (aom_codec_control(&decoder, AV1D_GET_FRAME_TIMING, &timing)) {
+            warn("Failed AV1D_GET_FRAME_TIMING: %s",
+                 aom_codec_error(&decoder));
+            if (!keep_going) goto fail;
+          } else {
+            snprintf(label, sizeof(label), "Frame %d", frame_in);
+            show_frame_timing(label, &timing);
+            add_frame_timing(&timing_sum, &timing);
+          }
+        }
+#endif
       } else {
         flush_decoder = 1;
       }
@@ -998,6 +1080,9 @@ static int main_loop(int argc, const char **argv_) {
     show_progress(frame_in, frame_out, dx_time);
     fprintf(stderr, "\n");
   }
+#if CONFIG_AV1_DECODER
+  if (frame_timing) show_frame_timing("Total", &timing_sum);
+#endif
 
   if (frames_corrupted) {
     fprintf(stderr, "WARNING: %d frames corrupted.\n", frames_corrupted);
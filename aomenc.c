@@ -408,6 +408,10 @@ static const arg_def_t frame_parallel_decoding =
     ARG_DEF(NULL, "frame-parallel", 1,
             "Enable frame parallel decodability features "
             "(0: false (default), 1: true)");
+static const arg_def_t row_mt =
+    ARG_DEF(NULL, "row-mt", 1,
+            "Enable row based multi-threading within tiles "
+            "(0: false (default), 1: true)");
 #if CONFIG_DELTA_Q
 static const arg_def_t aq_mode = ARG_DEF(
     NULL, "aq-mode", 1,
@@ -497,6 +501,7 @@ static const arg_def_t *av1_args[] = { &cpu_used_av1,
                                        &qm_max,
 #endif
                                        &frame_parallel_decoding,
+                                       &row_mt,
                                        &aq_mode,
                                        &frame_periodic_boost,
                                        &noise_sens,
@@ -545,6 +550,7 @@ static const int av1_arg_ctrl_map[] = { AOME_SET_CPUUSED,
                                         AV1E_SET_QM_MAX,
 #endif
                                         AV1E_SET_FRAME_PARALLEL_DECODING,
+                                        AV1E_SET_ROW_MT,
                                         AV1E_SET_AQ_MODE,
                                         AV1E_SET_FRAME_PERIODIC_BOOST,
                                         AV1E_SET_NOISE_SENSITIVITY,
@@ -63,6 +63,7 @@ struct av1_extracfg {
   unsigned int disable_tempmv;
 #endif
   unsigned int frame_parallel_decoding_mode;
+  unsigned int row_mt;
   AQ_MODE aq_mode;
   unsigned int frame_periodic_boost;
   aom_bit_depth_t bit_depth;
@@ -75,6 +76,7 @@ struct av1_extracfg {
 #if CONFIG_ANS && ANS_MAX_SYMBOLS
   int ans_window_size_log2;
 #endif
+  aom_thread_pool_t *thread_pool;
 };
 
 static struct av1_extracfg default_extra_cfg = {
@@ -122,6 +124,7 @@ static struct av1_extracfg default_extra_cfg = {
   0,  // disable temporal mv prediction
 #endif
   1,                            // frame_parallel_decoding_mode
+  0,                            // row_mt
   NO_AQ,                        // aq_mode
   CONFIG_XIPHRC,                // frame_periodic_delta_q
   AOM_BITS_8,                   // Bit depth
@@ -134,8 +137,30 @@ static struct av1_extracfg default_extra_cfg = {
 #if CONFIG_ANS && ANS_MAX_SYMBOLS
   23,  // ans_window_size_log2
 #endif
+  NULL,  // thread_pool
 };
 
+// Most frames queued by aom_codec_encode() in asynchronous mode.
+#define ASYNC_QUEUE_SIZE 4
+
+// A frame queued in asynchronous mode. The image is a copy of the one of the
+// caller, which av1_receive_raw_frame() copies again to the lookahead, since
+// the lookahead is only filled by the encoding thread.
+typedef struct {
+  aom_image_t img;
+  int has_img;
+  aom_codec_pts_t pts;
+  unsigned long duration;
+  aom_enc_frame_flags_t flags;
+  unsigned long deadline;
+} AsyncFrame;
+
+// A packet made in asynchronous mode, followed by a copy of its data.
+typedef struct AsyncPacket {
+  aom_codec_cx_pkt_t pkt;
+  struct AsyncPacket *next;
+} AsyncPacket;
+
 struct aom_codec_alg_priv {
   aom_codec_priv_t base;
   aom_codec_enc_cfg_t cfg;
@@ -155,18 +180,58 @@ struct aom_codec_alg_priv {
   unsigned int fixed_kf_cntr;
   // BufferPool that holds all reference frames.
   BufferPool *buffer_pool;
+  // Asynchronous mode, see AV1E_SET_ASYNC_OUTPUT.
+  int async;
+  aom_async_output_t async_output;
+  AVxWorker async_worker;
+#if CONFIG_MULTITHREAD
+  pthread_mutex_t async_mutex;
+  // Signaled when the encoding thread is done with a frame of the queue.
+  pthread_cond_t async_cond;
+#endif
+  AsyncFrame async_frames[ASYNC_QUEUE_SIZE];
+  int async_start;
+  int async_count;
+  // Whether the encoding thread is launched. It returns once the queue is
+  // empty.
+  int async_busy;
+  // First error of the encoding thread not returned yet, and its detail,
+  // empty if it has none.
+  aom_codec_err_t async_err;
+  char async_err_detail[80];
+  // The detail of the last error of the encoding thread returned to the
+  // caller, which base.err_detail points to.
+  char returned_err_detail[80];
+  // The packets not retrieved yet, and the packets returned by the last call
+  // to aom_codec_get_cx_data() with a NULL iterator.
+  AsyncPacket *async_pkts;
+  AsyncPacket **async_pkts_tail;
+  AsyncPacket *async_got_pkts;
 };
 
 static aom_codec_err_t update_error_state(
-    aom_codec_alg_priv_t *ctx, const struct aom_internal_error_info *error) {
+    const char **err_detail, const struct aom_internal_error_info *error) {
   const aom_codec_err_t res = error->error_code;
 
   if (res != AOM_CODEC_OK)
-    ctx->base.err_detail = error->has_detail ? error->detail : NULL;
+    *err_detail = error->has_detail ? error->detail : NULL;
 
   return res;
 }
 
+// Waits until the frames queued in asynchronous mode are encoded.
+static void finish_async_frames(aom_codec_alg_priv_t *ctx) {
+#if CONFIG_MULTITHREAD
+  if (!ctx->async) return;
+  pthread_mutex_lock(&ctx->async_mutex);
+  while (ctx->async_busy)
+    pthread_cond_wait(&ctx->async_cond, &ctx->async_mutex);
+  pthread_mutex_unlock(&ctx->async_mutex);
+#else
+  (void)ctx;
+#endif
+}
+
 #undef ERROR
 #define ERROR(str)                  \
   do {                              \
@@ -209,6 +274,7 @@ static aom_codec_err_t validate_config(aom_codec_alg_priv_t *ctx,
   RANGE_CHECK_BOOL(extra_cfg, lossless);
   RANGE_CHECK(extra_cfg, aq_mode, 0, AQ_MODE_COUNT - 1);
   RANGE_CHECK_HI(extra_cfg, frame_periodic_boost, 1);
+  RANGE_CHECK_HI(extra_cfg, row_mt, 1);
   RANGE_CHECK_HI(cfg, g_threads, 64);
   RANGE_CHECK_HI(cfg, g_lag_in_frames, MAX_LAG_BUFFERS);
   RANGE_CHECK(cfg, rc_end_usage, AOM_VBR, AOM_Q);
@@ -401,6 +467,11 @@ static aom_codec_err_t set_encoder_config(
   const int is_vbr = cfg->rc_end_usage == AOM_VBR;
   oxcf->profile = cfg->g_profile;
   oxcf->max_threads = (int)cfg->g_threads;
+  oxcf->thread_pool = (AVxThreadPool *)extra_cfg->thread_pool;
+  // One worker runs on the thread calling the encoder.
+  if (oxcf->thread_pool != NULL)
+    oxcf->max_threads = AOMMIN(
+        oxcf->max_threads, aom_thread_pool_num_threads(oxcf->thread_pool) + 1);
   oxcf->width = cfg->g_w;
   oxcf->height = cfg->g_h;
   oxcf->bit_depth = cfg->g_bit_depth;
@@ -534,6 +605,7 @@ static aom_codec_err_t set_encoder_config(
 #endif  // CONFIG_LOOPFILTERING_ACROSS_TILES
   oxcf->error_resilient_mode = cfg->g_error_resilient;
   oxcf->frame_parallel_decoding_mode = extra_cfg->frame_parallel_decoding_mode;
+  oxcf->row_mt = extra_cfg->row_mt;
 
   oxcf->aq_mode = extra_cfg->aq_mode;
 
@@ -578,6 +650,7 @@ static aom_codec_err_t encoder_set_config(aom_codec_alg_priv_t *ctx,
   aom_codec_err_t res;
   int force_key = 0;
 
+  finish_async_frames(ctx);
   if (cfg->g_w != ctx->cfg.g_w || cfg->g_h != ctx->cfg.g_h) {
     if (cfg->g_lag_in_frames > 1 || cfg->g_pass != AOM_RC_ONE_PASS)
       ERROR("Cannot change width or height after initialization");
@@ -613,6 +686,7 @@ static aom_codec_err_t ctrl_get_quantizer(aom_codec_alg_priv_t *ctx,
                                           va_list args) {
   int *const arg = va_arg(args, int *);
   if (arg == NULL) return AOM_CODEC_INVALID_PARAM;
+  finish_async_frames(ctx);
   *arg = av1_get_quantizer(ctx->cpi);
   return AOM_CODEC_OK;
 }
@@ -621,13 +695,16 @@ static aom_codec_err_t ctrl_get_quantizer64(aom_codec_alg_priv_t *ctx,
                                             va_list args) {
   int *const arg = va_arg(args, int *);
   if (arg == NULL) return AOM_CODEC_INVALID_PARAM;
+  finish_async_frames(ctx);
   *arg = av1_qindex_to_quantizer(av1_get_quantizer(ctx->cpi));
   return AOM_CODEC_OK;
 }
 
 static aom_codec_err_t update_extra_cfg(aom_codec_alg_priv_t *ctx,
                                         const struct av1_extracfg *extra_cfg) {
-  const aom_codec_err_t res = validate_config(ctx, &ctx->cfg, extra_cfg);
+  aom_codec_err_t res;
+  finish_async_frames(ctx);
+  res = validate_config(ctx, &ctx->cfg, extra_cfg);
   if (res == AOM_CODEC_OK) {
     ctx->extra_cfg = *extra_cfg;
     set_encoder_config(&ctx->oxcf, &ctx->cfg, &ctx->extra_cfg);
@@ -822,6 +899,23 @@ static aom_codec_err_t ctrl_set_frame_parallel_decoding_mode(
   return update_extra_cfg(ctx, &extra_cfg);
 }
 
+static aom_codec_err_t ctrl_set_row_mt(aom_codec_alg_priv_t *ctx,
+                                       va_list args) {
+  struct av1_extracfg extra_cfg = ctx->extra_cfg;
+  extra_cfg.row_mt = CAST(AV1E_SET_ROW_MT, args);
+  return update_extra_cfg(ctx, &extra_cfg);
+}
+
+static aom_codec_err_t ctrl_set_thread_pool(aom_codec_alg_priv_t *ctx,
+                                           va_list args) {
+  struct av1_extracfg extra_cfg = ctx->extra_cfg;
+  finish_async_frames(ctx);
+  // The workers are attached to the pool when they are created.
+  if (ctx->cpi->num_workers > 0) return AOM_CODEC_ERROR;
+  extra_cfg.thread_pool = CAST(AOM_SET_THREAD_POOL, args);
+  return update_extra_cfg(ctx, &extra_cfg);
+}
+
 static aom_codec_err_t ctrl_set_aq_mode(aom_codec_alg_priv_t *ctx,
                                         va_list args) {
   struct av1_extracfg extra_cfg = ctx->extra_cfg;
@@ -864,6 +958,8 @@ static aom_codec_err_t encoder_init(aom_codec_ctx_t *ctx,
     ctx->priv->enc.total_encoders = 1;
     priv->buffer_pool = (BufferPool *)aom_calloc(1, sizeof(BufferPool));
     if (priv->buffer_pool == NULL) return AOM_CODEC_MEM_ERROR;
+    if (av1_alloc_frame_bufs(priv->buffer_pool, FRAME_BUFFERS))
+      return AOM_CODEC_MEM_ERROR;
 
 #if CONFIG_MULTITHREAD
     if (pthread_mutex_init(&priv->buffer_pool->pool_mutex, NULL)) {
@@ -899,12 +995,35 @@ static aom_codec_err_t encoder_init(aom_codec_ctx_t *ctx,
   return res;
 }
 
+#if CONFIG_MULTITHREAD
+static void free_async_packets(AsyncPacket *pkt) {
+  while (pkt != NULL) {
+    AsyncPacket *const next = pkt->next;
+    aom_free(pkt);
+    pkt = next;
+  }
+}
+#endif
+
 static aom_codec_err_t encoder_destroy(aom_codec_alg_priv_t *ctx) {
+#if CONFIG_MULTITHREAD
+  if (ctx->async) {
+    int i;
+    aom_get_worker_interface()->end(&ctx->async_worker);
+    for (i = 0; i < ASYNC_QUEUE_SIZE; ++i)
+      aom_img_free(&ctx->async_frames[i].img);
+    free_async_packets(ctx->async_pkts);
+    free_async_packets(ctx->async_got_pkts);
+    pthread_cond_destroy(&ctx->async_cond);
+    pthread_mutex_destroy(&ctx->async_mutex);
+  }
+#endif
   free(ctx->cx_data);
   av1_remove_compressor(ctx->cpi);
 #if CONFIG_MULTITHREAD
   pthread_mutex_destroy(&ctx->buffer_pool->pool_mutex);
 #endif
+  av1_free_frame_bufs(ctx->buffer_pool);
   aom_free(ctx->buffer_pool);
   aom_free(ctx);
   return AOM_CODEC_OK;
@@ -1024,12 +1143,14 @@ static aom_codec_frame_flags_t get_frame_pkt_flags(const AV1_COMP *cpi,
 }
 
 const size_t kMinCompressedSize = 8192;
-static aom_codec_err_t encoder_encode(aom_codec_alg_priv_t *ctx,
-                                      const aom_image_t *img,
-                                      aom_codec_pts_t pts,
-                                      unsigned long duration,
-                                      aom_enc_frame_flags_t enc_flags,
-                                      unsigned long deadline) {
+// Encodes img, which has been validated. The detail of an error is stored in
+// *err_detail.
+static aom_codec_err_t encode_frame(aom_codec_alg_priv_t *ctx,
+                                    const aom_image_t *img, aom_codec_pts_t pts,
+                                    unsigned long duration,
+                                    aom_enc_frame_flags_t enc_flags,
+                                    unsigned long deadline,
+                                    const char **err_detail) {
   volatile aom_codec_err_t res = AOM_CODEC_OK;
   volatile aom_enc_frame_flags_t flags = enc_flags;
   AV1_COMP *const cpi = ctx->cpi;
@@ -1039,28 +1160,23 @@ static aom_codec_err_t encoder_encode(aom_codec_alg_priv_t *ctx,
   if (cpi == NULL) return AOM_CODEC_INVALID_PARAM;
 
   if (img != NULL) {
-    res = validate_img(ctx, img);
-    // TODO(jzern) the checks related to cpi's validity should be treated as a
-    // failure condition, encoder setup is done fully in init() currently.
-    if (res == AOM_CODEC_OK) {
 #if CONFIG_EXT_REFS
-      data_sz = ALIGN_POWER_OF_TWO(ctx->cfg.g_w, 5) *
-                ALIGN_POWER_OF_TWO(ctx->cfg.g_h, 5) * get_image_bps(img);
+    data_sz = ALIGN_POWER_OF_TWO(ctx->cfg.g_w, 5) *
+              ALIGN_POWER_OF_TWO(ctx->cfg.g_h, 5) * get_image_bps(img);
 #else
-      // There's no codec control for multiple alt-refs so check the encoder
-      // instance for its status to determine the compressed data size.
-      data_sz = ALIGN_POWER_OF_TWO(ctx->cfg.g_w, 5) *
-                ALIGN_POWER_OF_TWO(ctx->cfg.g_h, 5) * get_image_bps(img) / 8 *
-                (cpi->multi_arf_allowed ? 8 : 2);
+    // There's no codec control for multiple alt-refs so check the encoder
+    // instance for its status to determine the compressed data size.
+    data_sz = ALIGN_POWER_OF_TWO(ctx->cfg.g_w, 5) *
+              ALIGN_POWER_OF_TWO(ctx->cfg.g_h, 5) * get_image_bps(img) / 8 *
+              (cpi->multi_arf_allowed ? 8 : 2);
 #endif  // CONFIG_EXT_REFS
-      if (data_sz < kMinCompressedSize) data_sz = kMinCompressedSize;
-      if (ctx->cx_data == NULL || ctx->cx_data_sz < data_sz) {
-        ctx->cx_data_sz = data_sz;
-        free(ctx->cx_data);
-        ctx->cx_data = (unsigned char *)malloc(ctx->cx_data_sz);
-        if (ctx->cx_data == NULL) {
-          return AOM_CODEC_MEM_ERROR;
-        }
+    if (data_sz < kMinCompressedSize) data_sz = kMinCompressedSize;
+    if (ctx->cx_data == NULL || ctx->cx_data_sz < data_sz) {
+      ctx->cx_data_sz = data_sz;
+      free(ctx->cx_data);
+      ctx->cx_data = (unsigned char *)malloc(ctx->cx_data_sz);
+      if (ctx->cx_data == NULL) {
+        return AOM_CODEC_MEM_ERROR;
       }
     }
   }
@@ -1071,13 +1187,13 @@ static aom_codec_err_t encoder_encode(aom_codec_alg_priv_t *ctx,
   // Handle Flags
   if (((flags & AOM_EFLAG_NO_UPD_GF) && (flags & AOM_EFLAG_FORCE_GF)) ||
       ((flags & AOM_EFLAG_NO_UPD_ARF) && (flags & AOM_EFLAG_FORCE_ARF))) {
-    ctx->base.err_detail = "Conflicting flags.";
+    *err_detail = "Conflicting flags.";
     return AOM_CODEC_INVALID_PARAM;
   }
 
   if (setjmp(cpi->common.error.jmp)) {
     cpi->common.error.setjmp = 0;
-    res = update_error_state(ctx, &cpi->common.error);
+    res = update_error_state(err_detail, &cpi->common.error);
     aom_clear_system_state();
     return res;
   }
@@ -1113,7 +1229,7 @@ static aom_codec_err_t encoder_encode(aom_codec_alg_priv_t *ctx,
       // key frame flag when we actually encode this frame.
       if (av1_receive_raw_frame(cpi, flags | ctx->next_frame_flags, &sd,
                                 dst_time_stamp, dst_end_time_stamp)) {
-        res = update_error_state(ctx, &cpi->common.error);
+        res = update_error_state(err_detail, &cpi->common.error);
       }
       ctx->next_frame_flags = 0;
     }
@@ -1144,7 +1260,7 @@ static aom_codec_err_t encoder_encode(aom_codec_alg_priv_t *ctx,
                                          !img)) {
 #if CONFIG_REFERENCE_BUFFER
       if (cpi->common.invalid_delta_frame_id_minus1) {
-        ctx->base.err_detail = "Invalid delta_frame_id_minus1";
+        *err_detail = "Invalid delta_frame_id_minus1";
         return AOM_CODEC_ERROR;
       }
 #endif
@@ -1196,8 +1312,231 @@ static aom_codec_err_t encoder_encode(aom_codec_alg_priv_t *ctx,
   return res;
 }
 
+#if CONFIG_MULTITHREAD
+static aom_codec_err_t copy_async_image(aom_image_t *dst,
+                                        const aom_image_t *src) {
+  const int bytes_per_sample = (src->fmt & AOM_IMG_FMT_HIGHBITDEPTH) ? 2 : 1;
+  int plane;
+
+  if (dst->fmt != src->fmt || dst->d_w != src->d_w || dst->d_h != src->d_h) {
+    aom_img_free(dst);
+    if (aom_img_alloc(dst, src->fmt, src->d_w, src->d_h, 32) == NULL) {
+      memset(dst, 0, sizeof(*dst));
+      return AOM_CODEC_MEM_ERROR;
+    }
+  }
+  for (plane = 0; plane < 3; ++plane) {
+    const int x_shift = plane ? src->x_chroma_shift : 0;
+    const int y_shift = plane ? src->y_chroma_shift : 0;
+    const size_t width =
+        ((src->d_w + x_shift) >> x_shift) * (size_t)bytes_per_sample;
+    const unsigned int height = (src->d_h + y_shift) >> y_shift;
+    const unsigned char *src_row = src->planes[plane];
+    unsigned char *dst_row = dst->planes[plane];
+    unsigned int y;
+
+    for (y = 0; y < height; ++y) {
+      memcpy(dst_row, src_row, width);
+      src_row += src->stride[plane];
+      dst_row += dst->stride[plane];
+    }
+  }
+  dst->cs = src->cs;
+  dst->range = src->range;
+  dst->bit_depth = src->bit_depth;
+  dst->r_w = src->r_w;
+  dst->r_h = src->r_h;
+  dst->user_priv = src->user_priv;
+  return AOM_CODEC_OK;
+}
+
+static AsyncPacket *copy_async_packet(const aom_codec_cx_pkt_t *pkt) {
+  // Except for PSNR packets, data.raw describes the data of the packet.
+  const size_t sz = pkt->kind == AOM_CODEC_PSNR_PKT ? 0 : pkt->data.raw.sz;
+  AsyncPacket *const copy = (AsyncPacket *)aom_malloc(sizeof(*copy) + sz);
+
+  if (copy == NULL) return NULL;
+  copy->pkt = *pkt;
+  copy->next = NULL;
+  if (sz > 0) {
+    copy->pkt.data.raw.buf = copy + 1;
+    memcpy(copy + 1, pkt->data.raw.buf, sz);
+  }
+  return copy;
+}
+
+// Encodes the queued frames until the queue is empty.
+static int async_encode_hook(void *arg1, void *arg2) {
+  aom_codec_alg_priv_t *const ctx = (aom_codec_alg_priv_t *)arg1;
+  (void)arg2;
+
+  pthread_mutex_lock(&ctx->async_mutex);
+  while (ctx->async_count > 0) {
+    const AsyncFrame *const frame = &ctx->async_frames[ctx->async_start];
+    AsyncPacket *pkts = NULL;
+    AsyncPacket **tail = &pkts;
+    const aom_codec_cx_pkt_t *pkt;
+    aom_codec_iter_t iter = NULL;
+    const char *err_detail = NULL;
+    aom_codec_err_t res;
+    pthread_mutex_unlock(&ctx->async_mutex);
+
+    // Do not return the packets of the previous frame if this one fails early.
+    aom_codec_pkt_list_init(&ctx->pkt_list);
+    // The caller may read base.err_detail at any time, so the error detail is
+    // kept aside until the error is returned.
+    res = encode_frame(ctx, frame->has_img ? &frame->img : NULL, frame->pts,
+                       frame->duration, frame->flags, frame->deadline,
+                       &err_detail);
+    while ((pkt = aom_codec_pkt_list_get(&ctx->pkt_list.head, &iter)) != NULL) {
+      if (ctx->async_output.cb != NULL) {
+        ctx->async_output.cb(ctx->async_output.priv, pkt);
+      } else if ((*tail = copy_async_packet(pkt)) != NULL) {
+        tail = &(*tail)->next;
+      } else if (res == AOM_CODEC_OK) {
+        res = AOM_CODEC_MEM_ERROR;
+      }
+    }
+
+    pthread_mutex_lock(&ctx->async_mutex);
+    if (pkts != NULL) {
+      *ctx->async_pkts_tail = pkts;
+      ctx->async_pkts_tail = tail;
+    }
+    if (ctx->async_err == AOM_CODEC_OK && res != AOM_CODEC_OK) {
+      ctx->async_err = res;
+      ctx->async_err_detail[0] = '\0';
+      if (err_detail != NULL) {
+        strncpy(ctx->async_err_detail, err_detail,
+                sizeof(ctx->async_err_detail) - 1);
+        ctx->async_err_detail[sizeof(ctx->async_err_detail) - 1] = '\0';
+      }
+    }
+    ctx->async_start = (ctx->async_start + 1) % ASYNC_QUEUE_SIZE;
+    --ctx->async_count;
+    pthread_cond_broadcast(&ctx->async_cond);
+  }
+  ctx->async_busy = 0;
+  pthread_cond_broadcast(&ctx->async_cond);
+  pthread_mutex_unlock(&ctx->async_mutex);
+  return 1;
+}
+
+// Returns the first error of the encoding thread not returned yet, and makes
+// its detail the one of the encoder. Called with async_mutex held.
+static aom_codec_err_t take_async_error(aom_codec_alg_priv_t *ctx) {
+  const aom_codec_err_t res = ctx->async_err;
+
+  if (res != AOM_CODEC_OK) {
+    memcpy(ctx->returned_err_detail, ctx->async_err_detail,
+           sizeof(ctx->returned_err_detail));
+    ctx->base.err_detail =
+        ctx->returned_err_detail[0] != '\0' ? ctx->returned_err_detail : NULL;
+    ctx->async_err = AOM_CODEC_OK;
+  }
+  return res;
+}
+
+static aom_codec_err_t queue_async_frame(aom_codec_alg_priv_t *ctx,
+                                         const aom_image_t *img,
+                                         aom_codec_pts_t pts,
+                                         unsigned long duration,
+                                         aom_enc_frame_flags_t flags,
+                                         unsigned long deadline) {
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+  AsyncFrame *frame;
+  aom_codec_err_t res;
+  int launch = 0;
+
+  pthread_mutex_lock(&ctx->async_mutex);
+  while (ctx->async_count == ASYNC_QUEUE_SIZE)
+    pthread_cond_wait(&ctx->async_cond, &ctx->async_mutex);
+  res = take_async_error(ctx);
+  frame = &ctx->async_frames[(ctx->async_start + ctx->async_count) %
+                             ASYNC_QUEUE_SIZE];
+  pthread_mutex_unlock(&ctx->async_mutex);
+  if (res != AOM_CODEC_OK) return res;
+
+  // The slot is not used by the encoding thread until it is counted.
+  frame->has_img = img != NULL;
+  if (img != NULL) {
+    res = copy_async_image(&frame->img, img);
+    if (res != AOM_CODEC_OK) return res;
+  }
+  frame->pts = pts;
+  frame->duration = duration;
+  frame->flags = flags;
+  frame->deadline = deadline;
+
+  pthread_mutex_lock(&ctx->async_mutex);
+  ++ctx->async_count;
+  if (!ctx->async_busy) {
+    ctx->async_busy = 1;
+    launch = 1;
+  }
+  pthread_mutex_unlock(&ctx->async_mutex);
+  if (launch) {
+    // Let the previous run of the hook return before launching it again.
+    winterface->sync(&ctx->async_worker);
+    winterface->launch(&ctx->async_worker);
+  }
+
+  if (img == NULL) {
+    // Flushing returns once all the frames are encoded.
+    finish_async_frames(ctx);
+    pthread_mutex_lock(&ctx->async_mutex);
+    res = take_async_error(ctx);
+    pthread_mutex_unlock(&ctx->async_mutex);
+  }
+  return res;
+}
+
+static const aom_codec_cx_pkt_t *get_async_packet(aom_codec_alg_priv_t *ctx,
+                                                  aom_codec_iter_t *iter) {
+  const AsyncPacket *pkt;
+
+  if (*iter == NULL) {
+    free_async_packets(ctx->async_got_pkts);
+    pthread_mutex_lock(&ctx->async_mutex);
+    ctx->async_got_pkts = ctx->async_pkts;
+    ctx->async_pkts = NULL;
+    ctx->async_pkts_tail = &ctx->async_pkts;
+    pthread_mutex_unlock(&ctx->async_mutex);
+    pkt = ctx->async_got_pkts;
+  } else {
+    pkt = ((const AsyncPacket *)*iter)->next;
+  }
+  if (pkt == NULL) return NULL;
+  *iter = pkt;
+  return &pkt->pkt;
+}
+#endif  // CONFIG_MULTITHREAD
+
+static aom_codec_err_t encoder_encode(aom_codec_alg_priv_t *ctx,
+                                      const aom_image_t *img,
+                                      aom_codec_pts_t pts,
+                                      unsigned long duration,
+                                      aom_enc_frame_flags_t flags,
+                                      unsigned long deadline) {
+  if (img != NULL) {
+    // TODO(jzern) the checks related to cpi's validity should be treated as a
+    // failure condition, encoder setup is done fully in init() currently.
+    const aom_codec_err_t res = validate_img(ctx, img);
+    if (res != AOM_CODEC_OK) return res;
+  }
+#if CONFIG_MULTITHREAD
+  if (ctx->async)
+    return queue_async_frame(ctx, img, pts, duration, flags, deadline);
+#endif
+  return encode_frame(ctx, img, pts, duration, flags, deadline,
+                      &ctx->base.err_detail);
+}
+
 static const aom_codec_cx_pkt_t *encoder_get_cxdata(aom_codec_alg_priv_t *ctx,
                                                     aom_codec_iter_t *iter) {
+#if CONFIG_MULTITHREAD
+  if (ctx->async) return get_async_packet(ctx, iter);
+#endif
   return aom_codec_pkt_list_get(&ctx->pkt_list.head, iter);
 }
 
@@ -1205,6 +1544,7 @@ static aom_codec_err_t ctrl_set_reference(aom_codec_alg_priv_t *ctx,
                                           va_list args) {
   aom_ref_frame_t *const frame = va_arg(args, aom_ref_frame_t *);
 
+  finish_async_frames(ctx);
   if (frame != NULL) {
     YV12_BUFFER_CONFIG sd;
 
@@ -1221,6 +1561,7 @@ static aom_codec_err_t ctrl_copy_reference(aom_codec_alg_priv_t *ctx,
                                            va_list args) {
   aom_ref_frame_t *const frame = va_arg(args, aom_ref_frame_t *);
 
+  finish_async_frames(ctx);
   if (frame != NULL) {
     YV12_BUFFER_CONFIG sd;
 
@@ -1237,6 +1578,7 @@ static aom_codec_err_t ctrl_get_reference(aom_codec_alg_priv_t *ctx,
                                           va_list args) {
   av1_ref_frame_t *const frame = va_arg(args, av1_ref_frame_t *);
 
+  finish_async_frames(ctx);
   if (frame != NULL) {
     YV12_BUFFER_CONFIG *fb = get_ref_frame(&ctx->cpi->common, frame->idx);
     if (fb == NULL) return AOM_CODEC_ERROR;
@@ -1252,6 +1594,7 @@ static aom_codec_err_t ctrl_get_new_frame_image(aom_codec_alg_priv_t *ctx,
                                                 va_list args) {
   aom_image_t *const new_img = va_arg(args, aom_image_t *);
 
+  finish_async_frames(ctx);
   if (new_img != NULL) {
     YV12_BUFFER_CONFIG new_frame;
 
@@ -1276,6 +1619,7 @@ static aom_codec_err_t ctrl_set_previewpp(aom_codec_alg_priv_t *ctx,
 static aom_image_t *encoder_get_preview(aom_codec_alg_priv_t *ctx) {
   YV12_BUFFER_CONFIG sd;
 
+  finish_async_frames(ctx);
   if (av1_get_preview_raw_frame(ctx->cpi, &sd) == 0) {
     yuvconfig2image(&ctx->preview_img, &sd, NULL);
     return &ctx->preview_img;
@@ -1288,6 +1632,7 @@ static aom_codec_err_t ctrl_use_reference(aom_codec_alg_priv_t *ctx,
                                           va_list args) {
   const int reference_flag = va_arg(args, int);
 
+  finish_async_frames(ctx);
   av1_use_as_reference(ctx->cpi, reference_flag);
   return AOM_CODEC_OK;
 }
@@ -1305,6 +1650,7 @@ static aom_codec_err_t ctrl_set_active_map(aom_codec_alg_priv_t *ctx,
                                            va_list args) {
   aom_active_map_t *const map = va_arg(args, aom_active_map_t *);
 
+  finish_async_frames(ctx);
   if (map) {
     if (!av1_set_active_map(ctx->cpi, map->active_map, (int)map->rows,
                             (int)map->cols))
@@ -1320,6 +1666,7 @@ static aom_codec_err_t ctrl_get_active_map(aom_codec_alg_priv_t *ctx,
                                            va_list args) {
   aom_active_map_t *const map = va_arg(args, aom_active_map_t *);
 
+  finish_async_frames(ctx);
   if (map) {
     if (!av1_get_active_map(ctx->cpi, map->active_map, (int)map->rows,
                             (int)map->cols))
@@ -1335,6 +1682,7 @@ static aom_codec_err_t ctrl_set_scale_mode(aom_codec_alg_priv_t *ctx,
                                            va_list args) {
   aom_scaling_mode_t *const mode = va_arg(args, aom_scaling_mode_t *);
 
+  finish_async_frames(ctx);
   if (mode) {
     const int res =
         av1_set_internal_size(ctx->cpi, (AOM_SCALING)mode->h_scaling_mode,
@@ -1345,6 +1693,44 @@ static aom_codec_err_t ctrl_set_scale_mode(aom_codec_alg_priv_t *ctx,
   }
 }
 
+static aom_codec_err_t ctrl_set_async_output(aom_codec_alg_priv_t *ctx,
+                                             va_list args) {
+#if CONFIG_MULTITHREAD
+  const aom_async_output_t *const output =
+      va_arg(args, const aom_async_output_t *);
+
+  if (output == NULL) return AOM_CODEC_INVALID_PARAM;
+  if (!ctx->async) {
+    const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+    AVxWorker *const worker = &ctx->async_worker;
+
+    if (pthread_mutex_init(&ctx->async_mutex, NULL)) return AOM_CODEC_MEM_ERROR;
+    if (pthread_cond_init(&ctx->async_cond, NULL)) {
+      pthread_mutex_destroy(&ctx->async_mutex);
+      return AOM_CODEC_MEM_ERROR;
+    }
+    winterface->init(worker);
+    if (!winterface->reset(worker)) {
+      pthread_cond_destroy(&ctx->async_cond);
+      pthread_mutex_destroy(&ctx->async_mutex);
+      return AOM_CODEC_MEM_ERROR;
+    }
+    worker->hook = async_encode_hook;
+    worker->data1 = ctx;
+    worker->data2 = NULL;
+    ctx->async_pkts_tail = &ctx->async_pkts;
+    ctx->async = 1;
+  }
+  finish_async_frames(ctx);
+  ctx->async_output = *output;
+  return AOM_CODEC_OK;
+#else
+  (void)ctx;
+  (void)args;
+  return AOM_CODEC_INCAPABLE;
+#endif  // CONFIG_MULTITHREAD
+}
+
 static aom_codec_err_t ctrl_set_tune_content(aom_codec_alg_priv_t *ctx,
                                              va_list args) {
   struct av1_extracfg extra_cfg = ctx->extra_cfg;
@@ -1437,6 +1823,9 @@ static aom_codec_ctrl_fn_map_t encoder_ctrl_maps[] = {
   { AV1E_SET_DISABLE_TEMPMV, ctrl_set_disable_tempmv },
 #endif
   { AV1E_SET_FRAME_PARALLEL_DECODING, ctrl_set_frame_parallel_decoding_mode },
+  { AV1E_SET_ROW_MT, ctrl_set_row_mt },
+  { AV1E_SET_ASYNC_OUTPUT, ctrl_set_async_output },
+  { AOM_SET_THREAD_POOL, ctrl_set_thread_pool },
   { AV1E_SET_AQ_MODE, ctrl_set_aq_mode },
   { AV1E_SET_FRAME_PERIODIC_BOOST, ctrl_set_frame_periodic_boost },
   { AV1E_SET_TUNE_CONTENT, ctrl_set_tune_content },
@@ -21,6 +21,7 @@
 #include "aom_dsp/bitreader_buffer.h"
 #include "aom_dsp/aom_dsp_common.h"
 #include "aom_util/aom_thread.h"
+#include "aom_util/aom_thread_pool.h"
 
 #include "av1/common/alloccommon.h"
 #include "av1/common/frame_buffers.h"
@@ -57,6 +58,8 @@ struct aom_codec_alg_priv {
   int last_show_frame;  // Index of last output frame.
   int byte_alignment;
   int skip_loop_filter;
+  int row_mt;
+  int frame_timing;
   int decode_tile_row;
   int decode_tile_col;
 
@@ -75,6 +78,12 @@ struct aom_codec_alg_priv {
   int need_resync;  // wait for key/intra-only frame
   // BufferPool that holds all reference frames. Shared by all the FrameWorkers.
   BufferPool *buffer_pool;
+  // Tile workers shared by all the FrameWorkers.
+  AV1DecWorkerPool worker_pool;
+  // Threads shared with other codec instances, or NULL.
+  AVxThreadPool *thread_pool;
+  // Runs the frame workers on thread_pool, when set.
+  AVxThreadPoolClient pool_client;
 
   // External frame buffer info to save for AV1 common.
   void *ext_priv;  // Private data associated with the external frame buffers.
@@ -142,9 +151,12 @@ static aom_codec_err_t decoder_destroy(aom_codec_alg_priv_t *ctx) {
     pthread_mutex_destroy(&ctx->buffer_pool->pool_mutex);
 #endif
   }
+  aom_thread_pool_client_free(&ctx->pool_client);
+  av1_dec_worker_pool_end(&ctx->worker_pool);
 
   if (ctx->buffer_pool) {
     av1_free_ref_frame_buffers(ctx->buffer_pool);
+    av1_free_frame_bufs(ctx->buffer_pool);
     av1_free_internal_frame_buffers(&ctx->buffer_pool->int_frame_buffers);
   }
 
@@ -306,7 +318,8 @@ static void init_buffer_callbacks(aom_codec_alg_priv_t *ctx) {
       pool->get_fb_cb = av1_get_frame_buffer;
       pool->release_fb_cb = av1_release_frame_buffer;
 
-      if (av1_alloc_internal_frame_buffers(&pool->int_frame_buffers))
+      if (av1_alloc_internal_frame_buffers(&pool->int_frame_buffers,
+                                           pool->num_frame_bufs))
         aom_internal_error(&cm->error, AOM_CODEC_MEM_ERROR,
                            "Failed to initialize internal frame buffers");
 
@@ -358,6 +371,8 @@ static int frame_worker_hook(void *arg1, void *arg2) {
 
 static aom_codec_err_t init_decoder(aom_codec_alg_priv_t *ctx) {
   int i;
+  int num_frame_bufs;
+  int num_threads = ctx->cfg.threads;
   const AVxWorkerInterface *const winterface = aom_get_worker_interface();
 
   ctx->last_show_frame = -1;
@@ -368,16 +383,29 @@ static aom_codec_err_t init_decoder(aom_codec_alg_priv_t *ctx) {
   ctx->frame_cache_write = 0;
   ctx->num_cache_frames = 0;
   ctx->need_resync = 1;
-  ctx->num_frame_workers =
-      (ctx->frame_parallel_decode == 1) ? ctx->cfg.threads : 1;
-  if (ctx->num_frame_workers > MAX_DECODE_THREADS)
-    ctx->num_frame_workers = MAX_DECODE_THREADS;
+  // On a shared pool, each worker running at the same time takes a thread.
+  if (ctx->thread_pool != NULL) {
+    num_threads =
+        AOMMIN(num_threads, aom_thread_pool_num_threads(ctx->thread_pool));
+    if (num_threads <= 1) ctx->frame_parallel_decode = 0;
+  }
+  ctx->num_frame_workers = (ctx->frame_parallel_decode == 1) ? num_threads : 1;
   ctx->available_threads = ctx->num_frame_workers;
   ctx->flushed = 0;
 
   ctx->buffer_pool = (BufferPool *)aom_calloc(1, sizeof(BufferPool));
   if (ctx->buffer_pool == NULL) return AOM_CODEC_MEM_ERROR;
 
+  // In frame parallel mode, each frame worker decodes into its own buffer and
+  // the frames waiting in the output cache keep theirs.
+  num_frame_bufs = FRAME_BUFFERS;
+  if (ctx->frame_parallel_decode)
+    num_frame_bufs += ctx->num_frame_workers + FRAME_CACHE_SIZE;
+  if (av1_alloc_frame_bufs(ctx->buffer_pool, num_frame_bufs)) {
+    set_error_detail(ctx, "Failed to allocate frame buffers");
+    return AOM_CODEC_MEM_ERROR;
+  }
+
 #if CONFIG_MULTITHREAD
   if (pthread_mutex_init(&ctx->buffer_pool->pool_mutex, NULL)) {
     set_error_detail(ctx, "Failed to allocate buffer pool mutex");
@@ -385,6 +413,23 @@ static aom_codec_err_t init_decoder(aom_codec_alg_priv_t *ctx) {
   }
 #endif
 
+  // In frame parallel mode, the frames that wait for their references or
+  // context leave threads idle. Tile and row workers shared by the frames keep
+  // them busy. On a shared pool, the other instances use these threads.
+  if (ctx->frame_parallel_decode && num_threads > 1 &&
+      ctx->thread_pool == NULL &&
+      av1_dec_worker_pool_init(&ctx->worker_pool, num_threads)) {
+    set_error_detail(ctx, "Tile worker thread creation failed");
+    return AOM_CODEC_MEM_ERROR;
+  }
+
+  if (ctx->thread_pool != NULL &&
+      !aom_thread_pool_client_init(&ctx->pool_client, ctx->thread_pool,
+                                   ctx->num_frame_workers)) {
+    set_error_detail(ctx, "Failed to attach the thread pool");
+    return AOM_CODEC_ERROR;
+  }
+
   ctx->frame_workers = (AVxWorker *)aom_malloc(ctx->num_frame_workers *
                                                sizeof(*ctx->frame_workers));
   if (ctx->frame_workers == NULL) {
@@ -396,6 +441,7 @@ static aom_codec_err_t init_decoder(aom_codec_alg_priv_t *ctx) {
     AVxWorker *const worker = &ctx->frame_workers[i];
     FrameWorkerData *frame_worker_data = NULL;
     winterface->init(worker);
+    if (ctx->pool_client.pool != NULL) worker->pool = &ctx->pool_client;
     worker->data1 = aom_memalign(32, sizeof(FrameWorkerData));
     if (worker->data1 == NULL) {
       set_error_detail(ctx, "Failed to allocate frame_worker_data");
@@ -425,9 +471,25 @@ static aom_codec_err_t init_decoder(aom_codec_alg_priv_t *ctx) {
     }
 #endif
     // If decoding in serial mode, FrameWorker thread could create tile worker
-    // thread or loopfilter thread.
-    frame_worker_data->pbi->max_threads =
-        (ctx->frame_parallel_decode == 0) ? ctx->cfg.threads : 0;
+    // thread or loopfilter thread. In frame parallel mode, it borrows them
+    // from the worker pool.
+    frame_worker_data->pbi->max_threads = num_threads;
+    if (ctx->worker_pool.num_workers > 0) {
+      frame_worker_data->pbi->worker_pool = &ctx->worker_pool;
+    } else if (ctx->frame_parallel_decode) {
+      frame_worker_data->pbi->max_threads = 0;
+    } else if (ctx->thread_pool != NULL && num_threads > 1) {
+      // The tile and loop filter workers run on the shared pool.
+      AV1Decoder *const pbi = frame_worker_data->pbi;
+      if (!aom_thread_pool_client_init(&pbi->pool_client, ctx->thread_pool,
+                                       num_threads)) {
+        set_error_detail(ctx, "Failed to attach the thread pool");
+        return AOM_CODEC_ERROR;
+      }
+      pbi->lf_worker.pool = &pbi->pool_client;
+    }
+    frame_worker_data->pbi->row_mt = ctx->row_mt;
+    frame_worker_data->pbi->frame_timing = ctx->frame_timing;
 
     frame_worker_data->pbi->inv_tile_order = ctx->invert_tile_order;
     frame_worker_data->pbi->common.frame_parallel_decode =
@@ -548,6 +610,10 @@ static aom_codec_err_t decode_one(aom_codec_alg_priv_t *ctx,
         (ctx->next_submit_worker_id + 1) % ctx->num_frame_workers;
     --ctx->available_threads;
     worker->had_error = 0;
+    // A frame is launched before the previous ones are decoded, so the frame
+    // workers would keep their threads of the pool as long as frames come in.
+    if (ctx->pool_client.pool != NULL)
+      aom_thread_pool_yield(&ctx->pool_client);
     winterface->launch(worker);
   }
 
@@ -660,6 +726,11 @@ static aom_codec_err_t decoder_decode(aom_codec_alg_priv_t *ctx,
     }
   } else {
     // Decode in serial mode.
+    FrameWorkerData *const frame_worker_data =
+        (FrameWorkerData *)ctx->frame_workers->data1;
+    if (frame_worker_data->pbi->frame_timing)
+      av1_reset_frame_timing(frame_worker_data->pbi);
+
     if (frame_count > 0) {
       int i;
 
@@ -1112,6 +1183,69 @@ static aom_codec_err_t ctrl_set_skip_loop_filter(aom_codec_alg_priv_t *ctx,
   return AOM_CODEC_OK;
 }
 
+static aom_codec_err_t ctrl_set_row_mt(aom_codec_alg_priv_t *ctx,
+                                       va_list args) {
+  ctx->row_mt = va_arg(args, int);
+
+  if (ctx->frame_workers) {
+    AVxWorker *const worker = ctx->frame_workers;
+    FrameWorkerData *const frame_worker_data = (FrameWorkerData *)worker->data1;
+    frame_worker_data->pbi->row_mt = ctx->row_mt;
+  }
+
+  return AOM_CODEC_OK;
+}
+
+static aom_codec_err_t ctrl_set_thread_pool(aom_codec_alg_priv_t *ctx,
+                                           va_list args) {
+  // The workers are attached to the pool when they are created.
+  if (ctx->frame_workers != NULL) return AOM_CODEC_ERROR;
+  ctx->thread_pool = (AVxThreadPool *)va_arg(args, aom_thread_pool_t *);
+  return AOM_CODEC_OK;
+}
+
+static aom_codec_err_t ctrl_set_frame_timing(aom_codec_alg_priv_t *ctx,
+                                             va_list args) {
+  ctx->frame_timing = va_arg(args, int);
+
+  if (ctx->frame_workers) {
+    AVxWorker *const worker = ctx->frame_workers;
+    FrameWorkerData *const frame_worker_data = (FrameWorkerData *)worker->data1;
+    frame_worker_data->pbi->frame_timing = ctx->frame_timing;
+  }
+
+  return AOM_CODEC_OK;
+}
+
+static aom_codec_err_t ctrl_get_frame_timing(aom_codec_alg_priv_t *ctx,
+                                             va_list args) {
+  aom_frame_timing_t *const timing = va_arg(args, aom_frame_timing_t *);
+
+  // Only support this function in serial decode.
+  if (ctx->frame_parallel_decode) {
+    set_error_detail(ctx, "Not supported in frame parallel decode");
+    return AOM_CODEC_INCAPABLE;
+  }
+
+  if (timing) {
+    if (ctx->frame_workers) {
+      AVxWorker *const worker = ctx->frame_workers;
+      FrameWorkerData *const frame_worker_data =
+          (FrameWorkerData *)worker->data1;
+      if (!frame_worker_data->pbi->frame_timing) {
+        set_error_detail(ctx, "Frame timing is not enabled");
+        return AOM_CODEC_ERROR;
+      }
+      *timing = frame_worker_data->pbi->timing;
+      return AOM_CODEC_OK;
+    } else {
+      return AOM_CODEC_ERROR;
+    }
+  }
+
+  return AOM_CODEC_INVALID_PARAM;
+}
+
 static aom_codec_err_t ctrl_get_accounting(aom_codec_alg_priv_t *ctx,
                                            va_list args) {
 #if !CONFIG_ACCOUNTING
@@ -1173,6 +1307,9 @@ static aom_codec_ctrl_fn_map_t decoder_ctrl_maps[] = {
   { AV1_SET_DECODE_TILE_ROW, ctrl_set_decode_tile_row },
   { AV1_SET_DECODE_TILE_COL, ctrl_set_decode_tile_col },
   { AV1_SET_INSPECTION_CALLBACK, ctrl_set_inspection_callback },
+  { AV1D_SET_ROW_MT, ctrl_set_row_mt },
+  { AV1D_SET_FRAME_TIMING, ctrl_set_frame_timing },
+  { AOM_SET_THREAD_POOL, ctrl_set_thread_pool },
 
   // Getters
   { AOMD_GET_FRAME_CORRUPTED, ctrl_get_frame_corrupted },
@@ -1184,6 +1321,7 @@ static aom_codec_ctrl_fn_map_t decoder_ctrl_maps[] = {
   { AV1_GET_ACCOUNTING, ctrl_get_accounting },
   { AV1_GET_NEW_FRAME_IMAGE, ctrl_get_new_frame_image },
   { AV1_GET_REFERENCE, ctrl_get_reference },
+  { AV1D_GET_FRAME_TIMING, ctrl_get_frame_timing },
 
   { -1, NULL },
 };
@@ -74,10 +74,25 @@ static void free_seg_map(AV1_COMMON *cm) {
   }
 }
 
+int av1_alloc_frame_bufs(BufferPool *pool, int num_frame_bufs) {
+  av1_free_frame_bufs(pool);
+  pool->frame_bufs = (RefCntBuffer *)aom_calloc(num_frame_bufs,
+                                                sizeof(*pool->frame_bufs));
+  if (pool->frame_bufs == NULL) return 1;
+  pool->num_frame_bufs = num_frame_bufs;
+  return 0;
+}
+
+void av1_free_frame_bufs(BufferPool *pool) {
+  aom_free(pool->frame_bufs);
+  pool->frame_bufs = NULL;
+  pool->num_frame_bufs = 0;
+}
+
 void av1_free_ref_frame_buffers(BufferPool *pool) {
   int i;
 
-  for (i = 0; i < FRAME_BUFFERS; ++i) {
+  for (i = 0; i < pool->num_frame_bufs; ++i) {
     if (pool->frame_bufs[i].ref_count > 0 &&
         pool->frame_bufs[i].raw_frame_buffer.data != NULL) {
       pool->release_fb_cb(pool->cb_priv, &pool->frame_bufs[i].raw_frame_buffer);
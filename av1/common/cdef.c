@@ -15,6 +15,7 @@
 
 #include "./aom_scale_rtcd.h"
 #include "aom/aom_integer.h"
+#include "aom_util/aom_job_queue.h"
 #include "av1/common/cdef.h"
 #include "av1/common/od_dering.h"
 #include "av1/common/onyxc_int.h"
@@ -170,12 +171,45 @@ static INLINE void copy_rect(uint16_t *dst, int dstride, const uint16_t *src,
   }
 }
 
-void av1_cdef_frame(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
-                    MACROBLOCKD *xd) {
+static int cdef_linebuf_stride(const AV1_COMMON *cm) {
+  return (cm->mi_cols << MI_SIZE_LOG2) + 2 * OD_FILT_HBORDER;
+}
+
+// Superblock rows [sbr_start, sbr_end) of the frame filtered by one thread.
+typedef struct CdefBand {
+  AV1_COMMON *cm;
+  MACROBLOCKD *xd;
+  int sbr_start;
+  int sbr_end;
+  // Unfiltered rows above the superblock row being filtered. They are saved
+  // before each superblock row is filtered.
+  uint16_t *linebuf[3];
+  // Unfiltered rows right below the band, which may be filtered by another
+  // thread before this band is complete. Unused by the last band.
+  uint16_t *bottom_linebuf[3];
+} CdefBand;
+
+// Returns 1 if superblock (sbr, sbc) is modified by cdef_filter_band().
+static int cdef_sb_filtered(const AV1_COMMON *cm, int sbr, int sbc) {
+  MODE_INFO *const mi =
+      cm->mi_grid_visible[MAX_MIB_SIZE * sbr * cm->mi_stride +
+                          MAX_MIB_SIZE * sbc];
+  dering_list dlist[MAX_MIB_SIZE * MAX_MIB_SIZE];
+  if (mi == NULL) return 0;
+  if (cm->cdef_strengths[mi->mbmi.cdef_strength] == 0 &&
+      cm->cdef_uv_strengths[mi->mbmi.cdef_strength] == 0)
+    return 0;
+  return sb_compute_dering_list(cm, sbr * MAX_MIB_SIZE, sbc * MAX_MIB_SIZE,
+                                dlist) > 0;
+}
+
+static int cdef_filter_band(CdefBand *band, void *unused) {
+  AV1_COMMON *const cm = band->cm;
+  MACROBLOCKD *const xd = band->xd;
   int sbr, sbc;
   int nhsb, nvsb;
   uint16_t src[OD_DERING_INBUF_SIZE];
-  uint16_t *linebuf[3];
+  uint16_t **const linebuf = band->linebuf;
   uint16_t colbuf[3][(MAX_SB_SIZE + 2 * OD_FILT_VBORDER) * OD_FILT_HBORDER];
   dering_list dlist[MAX_MIB_SIZE * MAX_MIB_SIZE];
   unsigned char *row_dering, *prev_row_dering, *curr_row_dering;
@@ -194,24 +228,27 @@ void av1_cdef_frame(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
   int chroma_dering =
       xd->plane[1].subsampling_x == xd->plane[1].subsampling_y &&
       xd->plane[2].subsampling_x == xd->plane[2].subsampling_y;
+  (void)unused;
   nvsb = (cm->mi_rows + MAX_MIB_SIZE - 1) / MAX_MIB_SIZE;
   nhsb = (cm->mi_cols + MAX_MIB_SIZE - 1) / MAX_MIB_SIZE;
-  av1_setup_dst_planes(xd->plane, frame, 0, 0);
   row_dering = aom_malloc(sizeof(*row_dering) * (nhsb + 2) * 2);
   memset(row_dering, 1, sizeof(*row_dering) * (nhsb + 2) * 2);
   prev_row_dering = row_dering + 1;
   curr_row_dering = prev_row_dering + nhsb + 2;
+  // The superblocks above the band that were not filtered are read directly
+  // from the frame, as when the whole frame is filtered in one band.
+  if (band->sbr_start > 0) {
+    for (sbc = 0; sbc < nhsb; sbc++)
+      prev_row_dering[sbc] = cdef_sb_filtered(cm, band->sbr_start - 1, sbc);
+  }
   for (pli = 0; pli < nplanes; pli++) {
     xdec[pli] = xd->plane[pli].subsampling_x;
     ydec[pli] = xd->plane[pli].subsampling_y;
     mi_wide_l2[pli] = MI_SIZE_LOG2 - xd->plane[pli].subsampling_x;
     mi_high_l2[pli] = MI_SIZE_LOG2 - xd->plane[pli].subsampling_y;
   }
-  stride = (cm->mi_cols << MI_SIZE_LOG2) + 2 * OD_FILT_HBORDER;
-  for (pli = 0; pli < nplanes; pli++) {
-    linebuf[pli] = aom_malloc(sizeof(*linebuf) * OD_FILT_VBORDER * stride);
-  }
-  for (sbr = 0; sbr < nvsb; sbr++) {
+  stride = cdef_linebuf_stride(cm);
+  for (sbr = band->sbr_start; sbr < band->sbr_end; sbr++) {
     for (pli = 0; pli < nplanes; pli++) {
       const int block_height =
           (MAX_MIB_SIZE << mi_high_l2[pli]) + 2 * OD_FILT_VBORDER;
@@ -325,6 +362,15 @@ void av1_cdef_frame(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
             OD_FILT_BSTRIDE, xd->plane[pli].dst.buf,
             (MAX_MIB_SIZE << mi_high_l2[pli]) * sbr, coffset + cstart,
             xd->plane[pli].dst.stride, rend, cend - cstart);
+        if (sbr == band->sbr_end - 1 && sbr != nvsb - 1) {
+          /* The rows below the band may already have been filtered by
+             another thread, so use the copy made before filtering. */
+          copy_rect(&src[(vsize + OD_FILT_VBORDER) * OD_FILT_BSTRIDE +
+                         OD_FILT_HBORDER + cstart],
+                    OD_FILT_BSTRIDE,
+                    &band->bottom_linebuf[pli][coffset + cstart], stride,
+                    OD_FILT_VBORDER, cend - cstart);
+        }
         if (!prev_row_dering[sbc]) {
           copy_sb8_16(cm, &src[OD_FILT_HBORDER], OD_FILT_BSTRIDE,
                       xd->plane[pli].dst.buf,
@@ -380,7 +426,13 @@ void av1_cdef_frame(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
             (MAX_MIB_SIZE << mi_high_l2[pli]) * (sbr + 1) - OD_FILT_VBORDER,
             coffset, xd->plane[pli].dst.stride, OD_FILT_VBORDER, hsize);
 
-        if (level == 0 && clpf_strength == 0) continue;
+        /* The chroma planes are deringed along the directions found in the
+           luma plane of the same superblock, so the directions are found
+           even if the luma plane itself is not filtered. od_dering() does
+           not write anything for a zero strength. */
+        if (level == 0 && clpf_strength == 0 &&
+            (pli != AOM_PLANE_Y || !chroma_dering || uv_level == 0))
+          continue;
         if (tile_top) {
           fill_rect(src, OD_FILT_BSTRIDE, OD_FILT_VBORDER,
                     hsize + 2 * OD_FILT_HBORDER, OD_DERING_VERY_LARGE);
@@ -437,7 +489,160 @@ void av1_cdef_frame(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
     }
   }
   aom_free(row_dering);
-  for (pli = 0; pli < nplanes; pli++) {
-    aom_free(linebuf[pli]);
+  return 1;
+}
+
+// Saves the unfiltered rows on both sides of the top edge of superblock row
+// sbr: the last rows of sbr - 1 to 'above' and the first rows of sbr to
+// 'below'.
+static void save_sb_row_edge(AV1_COMMON *cm, MACROBLOCKD *xd, int sbr,
+                             uint16_t *const above[3],
+                             uint16_t *const below[3]) {
+  const int stride = cdef_linebuf_stride(cm);
+  int pli;
+  for (pli = 0; pli < 3; pli++) {
+    struct macroblockd_plane *const pd = &xd->plane[pli];
+    const int width = cm->mi_cols << (MI_SIZE_LOG2 - pd->subsampling_x);
+    const int row = (sbr * MAX_MIB_SIZE) << (MI_SIZE_LOG2 - pd->subsampling_y);
+    copy_sb8_16(cm, above[pli], stride, pd->dst.buf, row - OD_FILT_VBORDER, 0,
+                pd->dst.stride, OD_FILT_VBORDER, width);
+    copy_sb8_16(cm, below[pli], stride, pd->dst.buf, row, 0, pd->dst.stride,
+                OD_FILT_VBORDER, width);
   }
 }
+
+// Returns the line buffers of a superblock row in the buffer laid out for
+// av1_cdef_filter_sb_row().
+static void get_sb_row_linebufs(const AV1_COMMON *cm, uint16_t *buf,
+                                uint16_t *linebuf[3],
+                                uint16_t *bottom_linebuf[3]) {
+  const int size = OD_FILT_VBORDER * cdef_linebuf_stride(cm);
+  int pli;
+  for (pli = 0; pli < 3; pli++) {
+    if (linebuf) linebuf[pli] = buf + pli * size;
+    if (bottom_linebuf) bottom_linebuf[pli] = buf + (3 + pli) * size;
+  }
+}
+
+int av1_cdef_sb_row_buf_size(const AV1_COMMON *cm) {
+  return 6 * OD_FILT_VBORDER * cdef_linebuf_stride(cm);
+}
+
+void av1_cdef_save_sb_row_edge(AV1_COMMON *cm, MACROBLOCKD *xd, int sbr,
+                               uint16_t *buf, uint16_t *next_buf) {
+  uint16_t *above[3], *below[3];
+  get_sb_row_linebufs(cm, buf, NULL, below);
+  get_sb_row_linebufs(cm, next_buf, above, NULL);
+  save_sb_row_edge(cm, xd, sbr + 1, above, below);
+}
+
+void av1_cdef_filter_sb_row(AV1_COMMON *cm, MACROBLOCKD *xd, int sbr,
+                            uint16_t *buf) {
+  CdefBand band;
+  band.cm = cm;
+  band.xd = xd;
+  band.sbr_start = sbr;
+  band.sbr_end = sbr + 1;
+  get_sb_row_linebufs(cm, buf, band.linebuf, band.bottom_linebuf);
+  cdef_filter_band(&band, NULL);
+}
+
+void av1_cdef_frame(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
+                    MACROBLOCKD *xd) {
+  const int stride = cdef_linebuf_stride(cm);
+  CdefBand band;
+  int pli;
+
+  av1_setup_dst_planes(xd->plane, frame, 0, 0);
+  band.cm = cm;
+  band.xd = xd;
+  band.sbr_start = 0;
+  band.sbr_end = (cm->mi_rows + MAX_MIB_SIZE - 1) / MAX_MIB_SIZE;
+  for (pli = 0; pli < 3; pli++) {
+    band.linebuf[pli] =
+        aom_malloc(sizeof(*band.linebuf[pli]) * OD_FILT_VBORDER * stride);
+    band.bottom_linebuf[pli] = NULL;
+  }
+  cdef_filter_band(&band, NULL);
+  for (pli = 0; pli < 3; pli++) aom_free(band.linebuf[pli]);
+}
+
+// Superblock rows filtered by a worker of av1_cdef_frame_mt().
+typedef struct {
+  AV1_COMMON *cm;
+  MACROBLOCKD *xd;
+  AVxJobQueue *jobs;
+  int worker;
+  // Line buffers of all the superblock rows.
+  uint16_t *buf;
+} CdefRowWorkerData;
+
+static int cdef_filter_sb_rows(CdefRowWorkerData *data, void *unused) {
+  const int size = av1_cdef_sb_row_buf_size(data->cm);
+  int sbr;
+  (void)unused;
+  while ((sbr = aom_job_queue_next(data->jobs, data->worker)) >= 0)
+    av1_cdef_filter_sb_row(data->cm, data->xd, sbr, data->buf + sbr * size);
+  return 1;
+}
+
+void av1_cdef_frame_mt(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
+                       MACROBLOCKD *xd, AVxWorker *workers, int num_workers) {
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+  const int nvsb = (cm->mi_rows + MAX_MIB_SIZE - 1) / MAX_MIB_SIZE;
+  const int size = av1_cdef_sb_row_buf_size(cm);
+  AVxJobQueue jobs = { NULL, 0, 0 };
+  CdefRowWorkerData *worker_data;
+  uint16_t *buf;
+  int i;
+
+  num_workers = AOMMIN(num_workers, nvsb);
+  if (num_workers <= 1) {
+    av1_cdef_frame(frame, cm, xd);
+    return;
+  }
+
+  worker_data = aom_malloc(num_workers * sizeof(*worker_data));
+  buf = aom_malloc(sizeof(*buf) * nvsb * size);
+  if (worker_data == NULL || buf == NULL ||
+      !aom_job_queue_alloc(&jobs, num_workers)) {
+    // Without the line buffers of the superblock rows, filter the frame
+    // serially.
+    aom_job_queue_free(&jobs);
+    aom_free(buf);
+    aom_free(worker_data);
+    av1_cdef_frame(frame, cm, xd);
+    return;
+  }
+  av1_setup_dst_planes(xd->plane, frame, 0, 0);
+
+  // Each superblock row keeps its own copy of the unfiltered rows around its
+  // edges, so that the rows can be filtered in any order.
+  for (i = 0; i < nvsb - 1; ++i)
+    av1_cdef_save_sb_row_edge(cm, xd, i, buf + i * size, buf + (i + 1) * size);
+  aom_job_queue_reset(&jobs, nvsb, num_workers);
+
+  for (i = 0; i < num_workers; ++i) {
+    AVxWorker *const worker = &workers[i];
+    CdefRowWorkerData *const data = &worker_data[i];
+    data->cm = cm;
+    data->xd = xd;
+    data->jobs = &jobs;
+    data->worker = i;
+    data->buf = buf;
+    worker->hook = (AVxWorkerHook)cdef_filter_sb_rows;
+    worker->data1 = data;
+    worker->data2 = NULL;
+    if (i == num_workers - 1) {
+      winterface->execute(worker);
+    } else {
+      winterface->launch(worker);
+    }
+  }
+
+  for (i = 0; i < num_workers; ++i) winterface->sync(&workers[i]);
+
+  aom_job_queue_free(&jobs);
+  aom_free(buf);
+  aom_free(worker_data);
+}
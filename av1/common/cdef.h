@@ -19,6 +19,7 @@
 #include "./aom_config.h"
 #include "aom/aom_integer.h"
 #include "aom_ports/mem.h"
+#include "aom_util/aom_thread.h"
 #include "av1/common/od_dering.h"
 #include "av1/common/onyxc_int.h"
 #include "./od_dering.h"
@@ -43,9 +44,30 @@ int sb_all_skip(const AV1_COMMON *const cm, int mi_row, int mi_col);
 int sb_compute_dering_list(const AV1_COMMON *const cm, int mi_row, int mi_col,
                            dering_list *dlist);
 void av1_cdef_frame(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm, MACROBLOCKD *xd);
+// Multi-threaded version of av1_cdef_frame(). The superblock rows of the
+// frame are filtered concurrently by the given workers.
+void av1_cdef_frame_mt(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
+                       MACROBLOCKD *xd, AVxWorker *workers, int num_workers);
 
+// Row-based CDEF, as used by the loop filter pipeline (see thread_common.h).
+// Each superblock row has a buffer of av1_cdef_sb_row_buf_size() elements.
+// av1_cdef_save_sb_row_edge() saves the unfiltered rows on both sides of the
+// edge between superblock rows sbr and sbr + 1 to their buffers. It must be
+// called before either of the two rows is filtered by
+// av1_cdef_filter_sb_row(). The planes of xd must point to the frame, see
+// av1_setup_dst_planes().
+int av1_cdef_sb_row_buf_size(const AV1_COMMON *cm);
+void av1_cdef_save_sb_row_edge(AV1_COMMON *cm, MACROBLOCKD *xd, int sbr,
+                               uint16_t *buf, uint16_t *next_buf);
+void av1_cdef_filter_sb_row(AV1_COMMON *cm, MACROBLOCKD *xd, int sbr,
+                            uint16_t *buf);
+
+// Picks the CDEF strengths of the frame. The distortion of the superblocks is
+// measured by the given workers. Only half of the deringing strengths are
+// tried if fast is set.
 void av1_cdef_search(YV12_BUFFER_CONFIG *frame, const YV12_BUFFER_CONFIG *ref,
-                     AV1_COMMON *cm, MACROBLOCKD *xd);
+                     AV1_COMMON *cm, MACROBLOCKD *xd, int fast,
+                     AVxWorker *workers, int num_workers);
 
 #ifdef __cplusplus
 }  // extern "C"
@@ -124,7 +124,8 @@ typedef struct {
 
   // row and col indicate which position frame has been decoded to in real
   // pixel unit. They are reset to -1 when decoding begins and set to INT_MAX
-  // when the frame is fully decoded.
+  // when the frame is fully decoded. row is read and written atomically, see
+  // av1_frameworker_wait().
   int row;
   int col;
 } RefCntBuffer;
@@ -143,7 +144,9 @@ typedef struct BufferPool {
   aom_get_frame_buffer_cb_fn_t get_fb_cb;
   aom_release_frame_buffer_cb_fn_t release_fb_cb;
 
-  RefCntBuffer frame_bufs[FRAME_BUFFERS];
+  // Allocated by av1_alloc_frame_bufs().
+  RefCntBuffer *frame_bufs;
+  int num_frame_bufs;
 
   // Frame buffers allocated internally by the codec.
   InternalFrameBufferList int_frame_buffers;
@@ -458,7 +461,7 @@ static void unlock_buffer_pool(BufferPool *const pool) {
 static INLINE YV12_BUFFER_CONFIG *get_ref_frame(AV1_COMMON *cm, int index) {
   if (index < 0 || index >= REF_FRAMES) return NULL;
   if (cm->ref_frame_map[index] < 0) return NULL;
-  assert(cm->ref_frame_map[index] < FRAME_BUFFERS);
+  assert(cm->ref_frame_map[index] < cm->buffer_pool->num_frame_bufs);
   return &cm->buffer_pool->frame_bufs[cm->ref_frame_map[index]].buf;
 }
 
@@ -472,10 +475,10 @@ static INLINE int get_free_fb(AV1_COMMON *cm) {
   int i;
 
   lock_buffer_pool(cm->buffer_pool);
-  for (i = 0; i < FRAME_BUFFERS; ++i)
+  for (i = 0; i < cm->buffer_pool->num_frame_bufs; ++i)
     if (frame_bufs[i].ref_count == 0) break;
 
-  if (i != FRAME_BUFFERS) {
+  if (i != cm->buffer_pool->num_frame_bufs) {
     frame_bufs[i].ref_count = 1;
   } else {
     // Reset i to be INVALID_IDX to indicate no free buffer found.
@@ -100,26 +100,39 @@ void av1_loop_restoration_precal() { GenSgrprojVtable(); }
 
 static void loop_restoration_init(RestorationInternal *rst, int kf) {
   rst->keyframe = kf;
+  rst->tile_start = 0;
+  rst->tile_stride = 1;
 }
 
-void extend_frame(uint8_t *data, int width, int height, int stride) {
+// Extends the rows [row_start, row_end) of the plane, and the rows above or
+// below it when the first or the last row of the plane is included.
+static void extend_frame_rows(uint8_t *data, int width, int height, int stride,
+                              int row_start, int row_end) {
   uint8_t *data_p;
   int i;
-  for (i = 0; i < height; ++i) {
+  for (i = row_start; i < row_end; ++i) {
     data_p = data + i * stride;
     memset(data_p - WIENER_HALFWIN, data_p[0], WIENER_HALFWIN);
     memset(data_p + width, data_p[width - 1], WIENER_HALFWIN);
   }
   data_p = data - WIENER_HALFWIN;
-  for (i = -WIENER_HALFWIN; i < 0; ++i) {
-    memcpy(data_p + i * stride, data_p, width + 2 * WIENER_HALFWIN);
+  if (row_start == 0) {
+    for (i = -WIENER_HALFWIN; i < 0; ++i) {
+      memcpy(data_p + i * stride, data_p, width + 2 * WIENER_HALFWIN);
+    }
   }
-  for (i = height; i < height + WIENER_HALFWIN; ++i) {
-    memcpy(data_p + i * stride, data_p + (height - 1) * stride,
-           width + 2 * WIENER_HALFWIN);
+  if (row_end == height) {
+    for (i = height; i < height + WIENER_HALFWIN; ++i) {
+      memcpy(data_p + i * stride, data_p + (height - 1) * stride,
+             width + 2 * WIENER_HALFWIN);
+    }
   }
 }
 
+void extend_frame(uint8_t *data, int width, int height, int stride) {
+  extend_frame_rows(data, width, height, stride, 0, height);
+}
+
 static void loop_copy_tile(uint8_t *data, int tile_idx, int subtile_idx,
                            int subtile_bits, int width, int height, int stride,
                            RestorationInternal *rst, uint8_t *dst,
@@ -170,8 +183,8 @@ static void loop_wiener_filter(uint8_t *data, int width, int height, int stride,
                                RestorationInternal *rst, uint8_t *dst,
                                int dst_stride) {
   int tile_idx;
-  extend_frame(data, width, height, stride);
-  for (tile_idx = 0; tile_idx < rst->ntiles; ++tile_idx) {
+  for (tile_idx = rst->tile_start; tile_idx < rst->ntiles;
+       tile_idx += rst->tile_stride) {
     loop_wiener_filter_tile(data, tile_idx, width, height, stride, rst, dst,
                             dst_stride);
   }
@@ -904,7 +917,8 @@ static void loop_sgrproj_filter(uint8_t *data, int width, int height,
                                 int stride, RestorationInternal *rst,
                                 uint8_t *dst, int dst_stride) {
   int tile_idx;
-  for (tile_idx = 0; tile_idx < rst->ntiles; ++tile_idx) {
+  for (tile_idx = rst->tile_start; tile_idx < rst->ntiles;
+       tile_idx += rst->tile_stride) {
     loop_sgrproj_filter_tile(data, tile_idx, width, height, stride, rst, dst,
                              dst_stride);
   }
@@ -914,8 +928,8 @@ static void loop_switchable_filter(uint8_t *data, int width, int height,
                                    int stride, RestorationInternal *rst,
                                    uint8_t *dst, int dst_stride) {
   int tile_idx;
-  extend_frame(data, width, height, stride);
-  for (tile_idx = 0; tile_idx < rst->ntiles; ++tile_idx) {
+  for (tile_idx = rst->tile_start; tile_idx < rst->ntiles;
+       tile_idx += rst->tile_stride) {
     if (rst->rsi->restoration_type[tile_idx] == RESTORE_NONE) {
       loop_copy_tile(data, tile_idx, 0, 0, width, height, stride, rst, dst,
                      dst_stride);
@@ -930,26 +944,35 @@ static void loop_switchable_filter(uint8_t *data, int width, int height,
 }
 
 #if CONFIG_AOM_HIGHBITDEPTH
-void extend_frame_highbd(uint16_t *data, int width, int height, int stride) {
+static void extend_frame_rows_highbd(uint16_t *data, int width, int height,
+                                     int stride, int row_start, int row_end) {
   uint16_t *data_p;
   int i, j;
-  for (i = 0; i < height; ++i) {
+  for (i = row_start; i < row_end; ++i) {
     data_p = data + i * stride;
     for (j = -WIENER_HALFWIN; j < 0; ++j) data_p[j] = data_p[0];
     for (j = width; j < width + WIENER_HALFWIN; ++j)
       data_p[j] = data_p[width - 1];
   }
   data_p = data - WIENER_HALFWIN;
-  for (i = -WIENER_HALFWIN; i < 0; ++i) {
-    memcpy(data_p + i * stride, data_p,
-           (width + 2 * WIENER_HALFWIN) * sizeof(uint16_t));
+  if (row_start == 0) {
+    for (i = -WIENER_HALFWIN; i < 0; ++i) {
+      memcpy(data_p + i * stride, data_p,
+             (width + 2 * WIENER_HALFWIN) * sizeof(uint16_t));
+    }
   }
-  for (i = height; i < height + WIENER_HALFWIN; ++i) {
-    memcpy(data_p + i * stride, data_p + (height - 1) * stride,
-           (width + 2 * WIENER_HALFWIN) * sizeof(uint16_t));
+  if (row_end == height) {
+    for (i = height; i < height + WIENER_HALFWIN; ++i) {
+      memcpy(data_p + i * stride, data_p + (height - 1) * stride,
+             (width + 2 * WIENER_HALFWIN) * sizeof(uint16_t));
+    }
   }
 }
 
+void extend_frame_highbd(uint16_t *data, int width, int height, int stride) {
+  extend_frame_rows_highbd(data, width, height, stride, 0, height);
+}
+
 static void loop_copy_tile_highbd(uint16_t *data, int tile_idx, int subtile_idx,
                                   int subtile_bits, int width, int height,
                                   int stride, RestorationInternal *rst,
@@ -1006,8 +1029,8 @@ static void loop_wiener_filter_highbd(uint8_t *data8, int width, int height,
   uint16_t *data = CONVERT_TO_SHORTPTR(data8);
   uint16_t *dst = CONVERT_TO_SHORTPTR(dst8);
   int tile_idx;
-  extend_frame_highbd(data, width, height, stride);
-  for (tile_idx = 0; tile_idx < rst->ntiles; ++tile_idx) {
+  for (tile_idx = rst->tile_start; tile_idx < rst->ntiles;
+       tile_idx += rst->tile_stride) {
     loop_wiener_filter_tile_highbd(data, tile_idx, width, height, stride, rst,
                                    bit_depth, dst, dst_stride);
   }
@@ -1189,7 +1212,8 @@ static void loop_sgrproj_filter_highbd(uint8_t *data8, int width, int height,
   int tile_idx;
   uint16_t *data = CONVERT_TO_SHORTPTR(data8);
   uint16_t *dst = CONVERT_TO_SHORTPTR(dst8);
-  for (tile_idx = 0; tile_idx < rst->ntiles; ++tile_idx) {
+  for (tile_idx = rst->tile_start; tile_idx < rst->ntiles;
+       tile_idx += rst->tile_stride) {
     loop_sgrproj_filter_tile_highbd(data, tile_idx, width, height, stride, rst,
                                     bit_depth, dst, dst_stride);
   }
@@ -1202,8 +1226,8 @@ static void loop_switchable_filter_highbd(uint8_t *data8, int width, int height,
   uint16_t *data = CONVERT_TO_SHORTPTR(data8);
   uint16_t *dst = CONVERT_TO_SHORTPTR(dst8);
   int tile_idx;
-  extend_frame_highbd(data, width, height, stride);
-  for (tile_idx = 0; tile_idx < rst->ntiles; ++tile_idx) {
+  for (tile_idx = rst->tile_start; tile_idx < rst->ntiles;
+       tile_idx += rst->tile_stride) {
     if (rst->rsi->restoration_type[tile_idx] == RESTORE_NONE) {
       loop_copy_tile_highbd(data, tile_idx, 0, 0, width, height, stride, rst,
                             dst, dst_stride);
@@ -1218,10 +1242,186 @@ static void loop_switchable_filter_highbd(uint8_t *data8, int width, int height,
 }
 #endif  // CONFIG_AOM_HIGHBITDEPTH
 
+// Per-thread data of the multi-threaded loop restoration filter. Each worker
+// filters the restoration tiles of a plane it takes from the job queue of
+// AV1LrSync, using its own copy of RestorationInternal and its own scratch
+// buffer.
+struct LRWorkerData {
+  restore_func_type restore_func;
+#if CONFIG_AOM_HIGHBITDEPTH
+  restore_func_highbd_type restore_func_highbd;
+  int use_highbitdepth;
+  int bit_depth;
+#endif  // CONFIG_AOM_HIGHBITDEPTH
+  uint8_t *data;
+  int width, height, stride;
+  uint8_t *dst;
+  int dst_stride;
+  RestorationInternal rst;
+  // Used by the row-based filtering only.
+  RestorationType type;
+  int sb_height;
+};
+
+static int loop_restoration_worker(LRWorkerData *const lr_data,
+                                   void *unused) {
+  (void)unused;
+#if CONFIG_AOM_HIGHBITDEPTH
+  if (lr_data->use_highbitdepth) {
+    lr_data->restore_func_highbd(lr_data->data, lr_data->width,
+                                 lr_data->height, lr_data->stride,
+                                 &lr_data->rst, lr_data->bit_depth,
+                                 lr_data->dst, lr_data->dst_stride);
+    return 1;
+  }
+#endif  // CONFIG_AOM_HIGHBITDEPTH
+  lr_data->restore_func(lr_data->data, lr_data->width, lr_data->height,
+                        lr_data->stride, &lr_data->rst, lr_data->dst,
+                        lr_data->dst_stride);
+  return 1;
+}
+
+// Filters the restoration tiles of a plane taken from the job queue, one at a
+// time.
+static int loop_restoration_tiles_worker(LRWorkerData *const lr_data,
+                                         AV1LrSync *const lr_sync) {
+  const int worker = (int)(lr_data - lr_sync->lrworkerdata);
+  int tile_idx;
+  while ((tile_idx = aom_job_queue_next(&lr_sync->tile_jobs, worker)) >= 0) {
+    lr_data->rst.tile_start = tile_idx;
+    loop_restoration_worker(lr_data, NULL);
+  }
+  return 1;
+}
+
+void av1_loop_restoration_alloc(AV1LrSync *lr_sync, AV1_COMMON *cm,
+                                int num_workers) {
+  int i;
+  CHECK_MEM_ERROR(cm, lr_sync->lrplanedata,
+                  aom_calloc(MAX_MB_PLANE, sizeof(*lr_sync->lrplanedata)));
+  lr_sync->num_workers = 0;
+  CHECK_MEM_ERROR(cm, lr_sync->lrworkerdata,
+                  aom_calloc(num_workers, sizeof(*lr_sync->lrworkerdata)));
+  lr_sync->num_workers = num_workers;
+  for (i = 0; i < num_workers; ++i) {
+    CHECK_MEM_ERROR(
+        cm, lr_sync->lrworkerdata[i].rst.tmpbuf,
+        (int32_t *)aom_memalign(16, RESTORATION_TMPBUF_SIZE));
+  }  if (!aom_job_queue_alloc(&lr_sync->tile_jobs, num_workers))
+    aom_internal_error(&cm->error, AOM_CODEC_MEM_ERROR,
+                       "Failed to allocate lr_sync->tile_jobs");
+}
+
+void av1_loop_restoration_dealloc(AV1LrSync *lr_sync) {
+  if (lr_sync != NULL) {
+    int i;
+    if (lr_sync->lrworkerdata != NULL) {
+      for (i = 0; i < lr_sync->num_workers; ++i)
+        aom_free(lr_sync->lrworkerdata[i].rst.tmpbuf);
+      aom_free(lr_sync->lrworkerdata);
+    }
+    aom_free(lr_sync->lrplanedata);
+    aom_free_frame_buffer(&lr_sync->dst);
+    aom_job_queue_free(&lr_sync->tile_jobs);
+    // clear the structure as the source of this call may be a resize in
+    // which case this call will be followed by an _alloc() which may fail.
+    av1_zero(*lr_sync);
+  }
+}
+
+// Filters one plane, splitting its restoration tiles between the workers when
+// there is more than one.
+static void loop_restoration_plane(AV1_COMMON *cm, RestorationInfo *rsi,
+                                   uint8_t *data, int width, int height,
+                                   int stride, uint8_t *dst, int dst_stride,
+                                   AVxWorker *workers, int num_workers,
+                                   AV1LrSync *lr_sync) {
+  static const restore_func_type restore_funcs[RESTORE_TYPES] = {
+    NULL, loop_wiener_filter, loop_sgrproj_filter, loop_switchable_filter
+  };
+#if CONFIG_AOM_HIGHBITDEPTH
+  static const restore_func_highbd_type restore_funcs_highbd[RESTORE_TYPES] = {
+    NULL, loop_wiener_filter_highbd, loop_sgrproj_filter_highbd,
+    loop_switchable_filter_highbd
+  };
+#endif  // CONFIG_AOM_HIGHBITDEPTH
+  const RestorationType type = rsi->frame_restoration_type;
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+  RestorationInternal *const rst = &cm->rst_internal;
+  int i;
+
+  rst->rsi = rsi;
+
+  // The Wiener filter reads past the edges of the plane. Extend them once,
+  // before the restoration tiles are filtered.
+  if (type == RESTORE_WIENER || type == RESTORE_SWITCHABLE) {
+#if CONFIG_AOM_HIGHBITDEPTH
+    if (cm->use_highbitdepth)
+      extend_frame_highbd(CONVERT_TO_SHORTPTR(data), width, height, stride);
+    else
+#endif  // CONFIG_AOM_HIGHBITDEPTH
+      extend_frame(data, width, height, stride);
+  }
+
+  num_workers = AOMMIN(num_workers, rst->ntiles);
+  if (num_workers <= 1) {
+#if CONFIG_AOM_HIGHBITDEPTH
+    if (cm->use_highbitdepth) {
+      restore_funcs_highbd[type](data, width, height, stride, rst,
+                                 cm->bit_depth, dst, dst_stride);
+      return;
+    }
+#endif  // CONFIG_AOM_HIGHBITDEPTH
+    restore_funcs[type](data, width, height, stride, rst, dst, dst_stride);
+    return;
+  }
+
+  if (lr_sync->num_workers < num_workers) {
+    av1_loop_restoration_dealloc(lr_sync);
+    av1_loop_restoration_alloc(lr_sync, cm, num_workers);
+  }
+
+  aom_job_queue_reset(&lr_sync->tile_jobs, rst->ntiles, num_workers);
+  for (i = 0; i < num_workers; ++i) {
+    AVxWorker *const worker = &workers[i];
+    LRWorkerData *const lr_data = &lr_sync->lrworkerdata[i];
+    int32_t *const tmpbuf = lr_data->rst.tmpbuf;
+
+    lr_data->restore_func = restore_funcs[type];
+#if CONFIG_AOM_HIGHBITDEPTH
+    lr_data->restore_func_highbd = restore_funcs_highbd[type];
+    lr_data->use_highbitdepth = cm->use_highbitdepth;
+    lr_data->bit_depth = cm->bit_depth;
+#endif  // CONFIG_AOM_HIGHBITDEPTH
+    lr_data->data = data;
+    lr_data->width = width;
+    lr_data->height = height;
+    lr_data->stride = stride;
+    lr_data->dst = dst;
+    lr_data->dst_stride = dst_stride;
+    lr_data->rst = *rst;
+    lr_data->rst.tmpbuf = tmpbuf;
+    // Only the tile taken from the job queue is filtered.
+    lr_data->rst.tile_stride = rst->ntiles;
+
+    worker->hook = (AVxWorkerHook)loop_restoration_tiles_worker;
+    worker->data1 = lr_data;
+    worker->data2 = lr_sync;
+    if (i == num_workers - 1) {
+      winterface->execute(worker);
+    } else {
+      winterface->launch(worker);
+    }
+  }
+
+  for (i = 0; i < num_workers; ++i) winterface->sync(&workers[i]);
+}
+
 static void loop_restoration_rows(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
                                   int start_mi_row, int end_mi_row,
                                   int components_pattern, RestorationInfo *rsi,
-                                  YV12_BUFFER_CONFIG *dst) {
+                                  YV12_BUFFER_CONFIG *dst, AVxWorker *workers,
+                                  int num_workers, AV1LrSync *lr_sync) {
   const int ywidth = frame->y_crop_width;
   const int ystride = frame->y_stride;
   const int uvwidth = frame->uv_crop_width;
@@ -1230,19 +1430,6 @@ static void loop_restoration_rows(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
   const int uvstart = ystart >> cm->subsampling_y;
   int yend = end_mi_row << MI_SIZE_LOG2;
   int uvend = yend >> cm->subsampling_y;
-  restore_func_type restore_funcs[RESTORE_TYPES] = {
-    NULL, loop_wiener_filter, loop_sgrproj_filter, loop_switchable_filter
-  };
-#if CONFIG_AOM_HIGHBITDEPTH
-  restore_func_highbd_type restore_funcs_highbd[RESTORE_TYPES] = {
-    NULL, loop_wiener_filter_highbd, loop_sgrproj_filter_highbd,
-    loop_switchable_filter_highbd
-  };
-#endif  // CONFIG_AOM_HIGHBITDEPTH
-  restore_func_type restore_func;
-#if CONFIG_AOM_HIGHBITDEPTH
-  restore_func_highbd_type restore_func_highbd;
-#endif  // CONFIG_AOM_HIGHBITDEPTH
   YV12_BUFFER_CONFIG dst_;
 
   yend = AOMMIN(yend, cm->height);
@@ -1296,22 +1483,11 @@ static void loop_restoration_rows(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
           cm->width, cm->height, cm->rst_info[AOM_PLANE_Y].restoration_tilesize,
           &cm->rst_internal.tile_width, &cm->rst_internal.tile_height,
           &cm->rst_internal.nhtiles, &cm->rst_internal.nvtiles);
-      cm->rst_internal.rsi = &rsi[0];
-      restore_func =
-          restore_funcs[cm->rst_internal.rsi->frame_restoration_type];
-#if CONFIG_AOM_HIGHBITDEPTH
-      restore_func_highbd =
-          restore_funcs_highbd[cm->rst_internal.rsi->frame_restoration_type];
-      if (cm->use_highbitdepth)
-        restore_func_highbd(
-            frame->y_buffer + ystart * ystride, ywidth, yend - ystart, ystride,
-            &cm->rst_internal, cm->bit_depth,
-            dst->y_buffer + ystart * dst->y_stride, dst->y_stride);
-      else
-#endif  // CONFIG_AOM_HIGHBITDEPTH
-        restore_func(frame->y_buffer + ystart * ystride, ywidth, yend - ystart,
-                     ystride, &cm->rst_internal,
-                     dst->y_buffer + ystart * dst->y_stride, dst->y_stride);
+      loop_restoration_plane(cm, &rsi[AOM_PLANE_Y],
+                             frame->y_buffer + ystart * ystride, ywidth,
+                             yend - ystart, ystride,
+                             dst->y_buffer + ystart * dst->y_stride,
+                             dst->y_stride, workers, num_workers, lr_sync);
     } else {
       aom_yv12_copy_y(frame, dst);
     }
@@ -1325,22 +1501,11 @@ static void loop_restoration_rows(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
           cm->rst_info[AOM_PLANE_U].restoration_tilesize,
           &cm->rst_internal.tile_width, &cm->rst_internal.tile_height,
           &cm->rst_internal.nhtiles, &cm->rst_internal.nvtiles);
-      cm->rst_internal.rsi = &rsi[AOM_PLANE_U];
-      restore_func =
-          restore_funcs[cm->rst_internal.rsi->frame_restoration_type];
-#if CONFIG_AOM_HIGHBITDEPTH
-      restore_func_highbd =
-          restore_funcs_highbd[cm->rst_internal.rsi->frame_restoration_type];
-      if (cm->use_highbitdepth)
-        restore_func_highbd(
-            frame->u_buffer + uvstart * uvstride, uvwidth, uvend - uvstart,
-            uvstride, &cm->rst_internal, cm->bit_depth,
-            dst->u_buffer + uvstart * dst->uv_stride, dst->uv_stride);
-      else
-#endif  // CONFIG_AOM_HIGHBITDEPTH
-        restore_func(frame->u_buffer + uvstart * uvstride, uvwidth,
-                     uvend - uvstart, uvstride, &cm->rst_internal,
-                     dst->u_buffer + uvstart * dst->uv_stride, dst->uv_stride);
+      loop_restoration_plane(cm, &rsi[AOM_PLANE_U],
+                             frame->u_buffer + uvstart * uvstride, uvwidth,
+                             uvend - uvstart, uvstride,
+                             dst->u_buffer + uvstart * dst->uv_stride,
+                             dst->uv_stride, workers, num_workers, lr_sync);
     } else {
       aom_yv12_copy_u(frame, dst);
     }
@@ -1354,22 +1519,11 @@ static void loop_restoration_rows(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
           cm->rst_info[AOM_PLANE_V].restoration_tilesize,
           &cm->rst_internal.tile_width, &cm->rst_internal.tile_height,
           &cm->rst_internal.nhtiles, &cm->rst_internal.nvtiles);
-      cm->rst_internal.rsi = &rsi[AOM_PLANE_V];
-      restore_func =
-          restore_funcs[cm->rst_internal.rsi->frame_restoration_type];
-#if CONFIG_AOM_HIGHBITDEPTH
-      restore_func_highbd =
-          restore_funcs_highbd[cm->rst_internal.rsi->frame_restoration_type];
-      if (cm->use_highbitdepth)
-        restore_func_highbd(
-            frame->v_buffer + uvstart * uvstride, uvwidth, uvend - uvstart,
-            uvstride, &cm->rst_internal, cm->bit_depth,
-            dst->v_buffer + uvstart * dst->uv_stride, dst->uv_stride);
-      else
-#endif  // CONFIG_AOM_HIGHBITDEPTH
-        restore_func(frame->v_buffer + uvstart * uvstride, uvwidth,
-                     uvend - uvstart, uvstride, &cm->rst_internal,
-                     dst->v_buffer + uvstart * dst->uv_stride, dst->uv_stride);
+      loop_restoration_plane(cm, &rsi[AOM_PLANE_V],
+                             frame->v_buffer + uvstart * uvstride, uvwidth,
+                             uvend - uvstart, uvstride,
+                             dst->v_buffer + uvstart * dst->uv_stride,
+                             dst->uv_stride, workers, num_workers, lr_sync);
     } else {
       aom_yv12_copy_v(frame, dst);
     }
@@ -1397,5 +1551,254 @@ void av1_loop_restoration_frame(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
   end_mi_row = start_mi_row + mi_rows_to_filter;
   loop_restoration_init(&cm->rst_internal, cm->frame_type == KEY_FRAME);
   loop_restoration_rows(frame, cm, start_mi_row, end_mi_row, components_pattern,
-                        rsi, dst);
+                        rsi, dst, NULL, 0, NULL);
+}
+
+void av1_loop_restoration_frame_mt(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
+                                   RestorationInfo *rsi,
+                                   int components_pattern,
+                                   YV12_BUFFER_CONFIG *dst, AVxWorker *workers,
+                                   int num_workers, AV1LrSync *lr_sync) {
+  loop_restoration_init(&cm->rst_internal, cm->frame_type == KEY_FRAME);
+  loop_restoration_rows(frame, cm, 0, cm->mi_rows, components_pattern, rsi,
+                        dst, workers, num_workers, lr_sync);
+}
+
+void av1_loop_restoration_tile(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
+                               RestorationInfo *rsi, int plane, int tile_idx,
+                               int32_t *tmpbuf, YV12_BUFFER_CONFIG *dst) {
+  const int width = plane ? frame->uv_crop_width : frame->y_crop_width;
+  const int height =
+      plane ? (cm->subsampling_y ? (cm->height + 1) >> 1 : cm->height)
+            : cm->height;
+  const int stride = plane ? frame->uv_stride : frame->y_stride;
+  const int dst_stride = plane ? dst->uv_stride : dst->y_stride;
+  uint8_t *const data = plane == AOM_PLANE_Y
+                            ? frame->y_buffer
+                            : plane == AOM_PLANE_U ? frame->u_buffer
+                                                   : frame->v_buffer;
+  uint8_t *const dst_data = plane == AOM_PLANE_Y
+                                ? dst->y_buffer
+                                : plane == AOM_PLANE_U ? dst->u_buffer
+                                                       : dst->v_buffer;
+  RestorationInternal rst;
+
+  loop_restoration_init(&rst, cm->frame_type == KEY_FRAME);
+  rst.rsi = rsi;
+  rst.tmpbuf = tmpbuf;
+  if (plane == AOM_PLANE_Y)
+    rst.ntiles = av1_get_rest_ntiles(
+        cm->width, cm->height, cm->rst_info[AOM_PLANE_Y].restoration_tilesize,
+        &rst.tile_width, &rst.tile_height, &rst.nhtiles, &rst.nvtiles);
+  else
+    rst.ntiles = av1_get_rest_ntiles(
+        ROUND_POWER_OF_TWO(cm->width, cm->subsampling_x),
+        ROUND_POWER_OF_TWO(cm->height, cm->subsampling_y),
+        cm->rst_info[plane].restoration_tilesize, &rst.tile_width,
+        &rst.tile_height, &rst.nhtiles, &rst.nvtiles);
+
+#if CONFIG_AOM_HIGHBITDEPTH
+  if (cm->use_highbitdepth) {
+    uint16_t *const data16 = CONVERT_TO_SHORTPTR(data);
+    uint16_t *const dst16 = CONVERT_TO_SHORTPTR(dst_data);
+    switch (rsi->restoration_type[tile_idx]) {
+      case RESTORE_WIENER:
+        loop_wiener_filter_tile_highbd(data16, tile_idx, width, height, stride,
+                                       &rst, cm->bit_depth, dst16, dst_stride);
+        break;
+      case RESTORE_SGRPROJ:
+        loop_sgrproj_filter_tile_highbd(data16, tile_idx, width, height,
+                                        stride, &rst, cm->bit_depth, dst16,
+                                        dst_stride);
+        break;
+      default:
+        loop_copy_tile_highbd(data16, tile_idx, 0, 0, width, height, stride,
+                              &rst, dst16, dst_stride);
+        break;
+    }
+    return;
+  }
+#endif  // CONFIG_AOM_HIGHBITDEPTH
+  switch (rsi->restoration_type[tile_idx]) {
+    case RESTORE_WIENER:
+      loop_wiener_filter_tile(data, tile_idx, width, height, stride, &rst,
+                              dst_data, dst_stride);
+      break;
+    case RESTORE_SGRPROJ:
+      loop_sgrproj_filter_tile(data, tile_idx, width, height, stride, &rst,
+                               dst_data, dst_stride);
+      break;
+    default:
+      loop_copy_tile(data, tile_idx, 0, 0, width, height, stride, &rst,
+                     dst_data, dst_stride);
+      break;
+  }
+}
+
+// Copies the filtered rows [row_start, row_end) of a plane back to the frame.
+static void copy_restored_rows(const LRWorkerData *lr, int row_start,
+                               int row_end) {
+  int i;
+#if CONFIG_AOM_HIGHBITDEPTH
+  if (lr->use_highbitdepth) {
+    const uint16_t *const src = CONVERT_TO_SHORTPTR(lr->dst);
+    uint16_t *const dst = CONVERT_TO_SHORTPTR(lr->data);
+    for (i = row_start; i < row_end; ++i)
+      memcpy(dst + i * lr->stride, src + i * lr->dst_stride,
+             lr->width * sizeof(*dst));
+    return;
+  }
+#endif  // CONFIG_AOM_HIGHBITDEPTH
+  for (i = row_start; i < row_end; ++i)
+    memcpy(lr->data + i * lr->stride, lr->dst + i * lr->dst_stride, lr->width);
+}
+
+void av1_loop_restoration_rows_init(AV1LrSync *lr_sync,
+                                    YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
+                                    RestorationInfo *rsi, int num_workers) {
+  static const restore_func_type restore_funcs[RESTORE_TYPES] = {
+    NULL, loop_wiener_filter, loop_sgrproj_filter, loop_switchable_filter
+  };
+#if CONFIG_AOM_HIGHBITDEPTH
+  static const restore_func_highbd_type restore_funcs_highbd[RESTORE_TYPES] = {
+    NULL, loop_wiener_filter_highbd, loop_sgrproj_filter_highbd,
+    loop_switchable_filter_highbd
+  };
+#endif  // CONFIG_AOM_HIGHBITDEPTH
+  const int yend = AOMMIN(cm->mi_rows << MI_SIZE_LOG2, cm->height);
+  const int uvend =
+      AOMMIN(yend >> cm->subsampling_y,
+             cm->subsampling_y ? (cm->height + 1) >> 1 : cm->height);
+  YV12_BUFFER_CONFIG *const dst = &lr_sync->dst;
+  int plane;
+
+  if (lr_sync->num_workers < num_workers) {
+    av1_loop_restoration_dealloc(lr_sync);
+    av1_loop_restoration_alloc(lr_sync, cm, num_workers);
+  }
+  if (aom_realloc_frame_buffer(
+          dst, cm->width, cm->height, cm->subsampling_x, cm->subsampling_y,
+#if CONFIG_AOM_HIGHBITDEPTH
+          cm->use_highbitdepth,
+#endif
+          AOM_BORDER_IN_PIXELS, cm->byte_alignment, NULL, NULL, NULL) < 0)
+    aom_internal_error(&cm->error, AOM_CODEC_MEM_ERROR,
+                       "Failed to allocate restoration dst buffer");
+
+  loop_restoration_init(&cm->rst_internal, cm->frame_type == KEY_FRAME);
+  for (plane = 0; plane < MAX_MB_PLANE; ++plane) {
+    LRWorkerData *const lr = &lr_sync->lrplanedata[plane];
+    const int ss_x = plane ? cm->subsampling_x : 0;
+    const int ss_y = plane ? cm->subsampling_y : 0;
+
+    lr->type = rsi[plane].frame_restoration_type;
+    if (lr->type == RESTORE_NONE) continue;
+
+    lr->restore_func = restore_funcs[lr->type];
+#if CONFIG_AOM_HIGHBITDEPTH
+    lr->restore_func_highbd = restore_funcs_highbd[lr->type];
+    lr->use_highbitdepth = cm->use_highbitdepth;
+    lr->bit_depth = cm->bit_depth;
+#endif  // CONFIG_AOM_HIGHBITDEPTH
+    if (plane == AOM_PLANE_Y) {
+      lr->data = frame->y_buffer;
+      lr->width = frame->y_crop_width;
+      lr->height = yend;
+      lr->stride = frame->y_stride;
+      lr->dst = dst->y_buffer;
+      lr->dst_stride = dst->y_stride;
+    } else {
+      lr->data = plane == AOM_PLANE_U ? frame->u_buffer : frame->v_buffer;
+      lr->width = frame->uv_crop_width;
+      lr->height = uvend;
+      lr->stride = frame->uv_stride;
+      lr->dst = plane == AOM_PLANE_U ? dst->u_buffer : dst->v_buffer;
+      lr->dst_stride = dst->uv_stride;
+    }
+    lr->rst = cm->rst_internal;
+    lr->rst.rsi = &rsi[plane];
+    lr->rst.tmpbuf = NULL;
+    lr->rst.ntiles = av1_get_rest_ntiles(
+        ROUND_POWER_OF_TWO(cm->width, ss_x),
+        ROUND_POWER_OF_TWO(cm->height, ss_y), rsi[plane].restoration_tilesize,
+        &lr->rst.tile_width, &lr->rst.tile_height, &lr->rst.nhtiles,
+        &lr->rst.nvtiles);
+    lr->sb_height = MAX_MIB_SIZE << (MI_SIZE_LOG2 - ss_y);
+  }
+}
+
+void av1_loop_restoration_extend_sb_row(AV1LrSync *lr_sync, int sb_row) {
+  int plane;
+  for (plane = 0; plane < MAX_MB_PLANE; ++plane) {
+    const LRWorkerData *const lr = &lr_sync->lrplanedata[plane];
+    const int row_start = sb_row * lr->sb_height;
+    const int row_end = AOMMIN(row_start + lr->sb_height, lr->height);
+
+    if (lr->type != RESTORE_WIENER && lr->type != RESTORE_SWITCHABLE) continue;
+    if (row_start >= row_end) continue;
+#if CONFIG_AOM_HIGHBITDEPTH
+    if (lr->use_highbitdepth)
+      extend_frame_rows_highbd(CONVERT_TO_SHORTPTR(lr->data), lr->width,
+                               lr->height, lr->stride, row_start, row_end);
+    else
+#endif  // CONFIG_AOM_HIGHBITDEPTH
+      extend_frame_rows(lr->data, lr->width, lr->height, lr->stride,
+                        row_start, row_end);
+  }
+}
+
+// Returns the superblock row that holds the last row read by the restoration
+// tiles in row tile_row of a plane.
+static int tile_row_last_sb_row(const LRWorkerData *lr, int tile_row) {
+  int last_row = lr->height - 1;
+  if (tile_row < lr->rst.nvtiles - 1)
+    last_row = AOMMIN((tile_row + 1) * lr->rst.tile_height + WIENER_HALFWIN,
+                      last_row);
+  return last_row / lr->sb_height;
+}
+
+void av1_loop_restoration_filter_sb_row(AV1LrSync *lr_sync, int sb_row,
+                                        int worker_idx) {
+  LRWorkerData *const lr_data = &lr_sync->lrworkerdata[worker_idx];
+  int32_t *const tmpbuf = lr_data->rst.tmpbuf;
+  int plane, tile_row;
+
+  for (plane = 0; plane < MAX_MB_PLANE; ++plane) {
+    const LRWorkerData *const lr = &lr_sync->lrplanedata[plane];
+    const int nvtiles = lr->rst.nvtiles;
+    const int tile_height = lr->rst.tile_height;
+
+    if (lr->type == RESTORE_NONE) continue;
+    for (tile_row = 0; tile_row < nvtiles; ++tile_row) {
+      if (tile_row_last_sb_row(lr, tile_row) != sb_row) continue;
+
+      *lr_data = *lr;
+      lr_data->rst.tmpbuf = tmpbuf;
+      lr_data->rst.tile_start = tile_row * lr->rst.nhtiles;
+      lr_data->rst.tile_stride = 1;
+      // Stop after the last tile of the row.
+      lr_data->rst.ntiles = (tile_row + 1) * lr->rst.nhtiles;
+      loop_restoration_worker(lr_data, NULL);
+
+      // The rows next to the neighbouring tile rows are still read by them
+      // and are copied back by av1_loop_restoration_rows_finish().
+      copy_restored_rows(
+          lr, tile_row > 0 ? tile_row * tile_height + WIENER_HALFWIN1 : 0,
+          tile_row < nvtiles - 1
+              ? (tile_row + 1) * tile_height - WIENER_HALFWIN1
+              : lr->height);
+    }
+  }
+}
+
+void av1_loop_restoration_rows_finish(AV1LrSync *lr_sync) {
+  int plane, tile_row;
+  for (plane = 0; plane < MAX_MB_PLANE; ++plane) {
+    const LRWorkerData *const lr = &lr_sync->lrplanedata[plane];
+    if (lr->type == RESTORE_NONE) continue;
+    for (tile_row = 1; tile_row < lr->rst.nvtiles; ++tile_row) {
+      const int row = tile_row * lr->rst.tile_height;
+      copy_restored_rows(lr, row - WIENER_HALFWIN1, row + WIENER_HALFWIN1);
+    }
+  }
 }
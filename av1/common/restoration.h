@@ -13,6 +13,8 @@
 #define AV1_COMMON_RESTORATION_H_
 
 #include "aom_ports/mem.h"
+#include "aom_util/aom_job_queue.h"
+#include "aom_util/aom_thread.h"
 #include "./aom_config.h"
 
 #include "av1/common/blockd.h"
@@ -156,9 +158,25 @@ typedef struct {
   int ntiles;
   int tile_width, tile_height;
   int nhtiles, nvtiles;
+  // Only the tiles tile_start, tile_start + tile_stride, ... are filtered.
+  int tile_start, tile_stride;
   int32_t *tmpbuf;
 } RestorationInternal;
 
+typedef struct LRWorkerData LRWorkerData;
+
+// Per-thread data of av1_loop_restoration_frame_mt().
+typedef struct AV1LrSyncData {
+  LRWorkerData *lrworkerdata;
+  int num_workers;
+  // Restoration tiles of the plane filtered by the workers.
+  AVxJobQueue tile_jobs;
+  // Planes filtered by av1_loop_restoration_filter_sb_row(), and the frame
+  // they are filtered into.
+  LRWorkerData *lrplanedata;
+  YV12_BUFFER_CONFIG dst;
+} AV1LrSync;
+
 static INLINE int av1_get_rest_ntiles(int width, int height, int tilesize,
                                       int *tile_width, int *tile_height,
                                       int *nhtiles, int *nvtiles) {
@@ -227,6 +245,46 @@ void av1_loop_restoration_frame(YV12_BUFFER_CONFIG *frame, struct AV1Common *cm,
                                 RestorationInfo *rsi, int components_pattern,
                                 int partial_frame, YV12_BUFFER_CONFIG *dst);
 void av1_loop_restoration_precal();
+
+// Multi-threaded version of av1_loop_restoration_frame() for the whole frame.
+// The restoration tiles of each plane are split between the workers.
+void av1_loop_restoration_frame_mt(YV12_BUFFER_CONFIG *frame,
+                                   struct AV1Common *cm, RestorationInfo *rsi,
+                                   int components_pattern,
+                                   YV12_BUFFER_CONFIG *dst, AVxWorker *workers,
+                                   int num_workers, AV1LrSync *lr_sync);
+// Filters the restoration tile tile_idx of a plane of frame into dst, as
+// av1_loop_restoration_frame() would, with the filter given by
+// rsi->restoration_type[tile_idx]. Different tiles may be filtered
+// concurrently, each with its own tmpbuf of RESTORATION_TMPBUF_SIZE bytes. The
+// edges of the plane must have been extended with extend_frame() for the
+// Wiener filter.
+void av1_loop_restoration_tile(YV12_BUFFER_CONFIG *frame, struct AV1Common *cm,
+                               RestorationInfo *rsi, int plane, int tile_idx,
+                               int32_t *tmpbuf, YV12_BUFFER_CONFIG *dst);
+void av1_loop_restoration_alloc(AV1LrSync *lr_sync, struct AV1Common *cm,
+                                int num_workers);
+void av1_loop_restoration_dealloc(AV1LrSync *lr_sync);
+
+// Row-based loop restoration of the whole frame, as used by the loop filter
+// pipeline (see thread_common.h). Each row of restoration tiles is filtered
+// once the superblock rows it reads are final. The rows of the frame must be
+// made final in order, calling av1_loop_restoration_extend_sb_row() for each
+// of them before av1_loop_restoration_filter_sb_row(). The latter may be
+// called from several threads for different superblock rows.
+void av1_loop_restoration_rows_init(AV1LrSync *lr_sync,
+                                    YV12_BUFFER_CONFIG *frame,
+                                    struct AV1Common *cm, RestorationInfo *rsi,
+                                    int num_workers);
+// Extends the borders of the superblock row for the Wiener filter.
+void av1_loop_restoration_extend_sb_row(AV1LrSync *lr_sync, int sb_row);
+// Filters the restoration tiles whose last input row is in superblock row
+// sb_row, using the scratch buffer of the given worker.
+void av1_loop_restoration_filter_sb_row(AV1LrSync *lr_sync, int sb_row,
+                                        int worker_idx);
+// Copies the rows of the frame left out by
+// av1_loop_restoration_filter_sb_row(). Called once all the rows are filtered.
+void av1_loop_restoration_rows_finish(AV1LrSync *lr_sync);
 #ifdef __cplusplus
 }  // extern "C"
 #endif
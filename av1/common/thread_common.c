@@ -9,12 +9,21 @@
  * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
  */
 
+#include <assert.h>
+
 #include "./aom_config.h"
 #include "aom_dsp/aom_dsp_common.h"
 #include "aom_mem/aom_mem.h"
+#include "aom_ports/aom_atomics.h"
 #include "av1/common/entropymode.h"
 #include "av1/common/thread_common.h"
 #include "av1/common/reconinter.h"
+#if CONFIG_CDEF
+#include "av1/common/cdef.h"
+#endif  // CONFIG_CDEF
+#if CONFIG_LOOP_RESTORATION
+#include "av1/common/restoration.h"
+#endif  // CONFIG_LOOP_RESTORATION
 
 #if CONFIG_MULTITHREAD
 static INLINE void mutex_lock(pthread_mutex_t *const mutex) {
@@ -33,17 +42,29 @@ static INLINE void mutex_lock(pthread_mutex_t *const mutex) {
 }
 #endif  // CONFIG_MULTITHREAD
 
+// Waits until superblock c of row r may be filtered. The progress of the row
+// above is polled for a while before blocking on its condition variable. A
+// blocked thread is counted in waiters[r - 1], so that sync_write() only takes
+// the lock of a row when there is a thread to wake up.
 static INLINE void sync_read(AV1LfSync *const lf_sync, int r, int c) {
 #if CONFIG_MULTITHREAD
   const int nsync = lf_sync->sync_range;
 
   if (r && !(c & (nsync - 1))) {
+    const int *const cur_sb_col = &lf_sync->cur_sb_col[r - 1];
+    int *const waiters = &lf_sync->waiters[r - 1];
     pthread_mutex_t *const mutex = &lf_sync->mutex_[r - 1];
-    mutex_lock(mutex);
+    int i;
+
+    for (i = 0; i < AOM_ATOMIC_SPIN_COUNT; ++i)
+      if (c <= aom_atomic_load_int(cur_sb_col) - nsync) return;
 
-    while (c > lf_sync->cur_sb_col[r - 1] - nsync) {
+    mutex_lock(mutex);
+    aom_atomic_store_int(waiters, *waiters + 1);
+    while (c > aom_atomic_load_int(cur_sb_col) - nsync) {
       pthread_cond_wait(&lf_sync->cond_[r - 1], mutex);
     }
+    aom_atomic_store_int(waiters, *waiters - 1);
     pthread_mutex_unlock(mutex);
   }
 #else
@@ -69,12 +90,13 @@ static INLINE void sync_write(AV1LfSync *const lf_sync, int r, int c,
   }
 
   if (sig) {
-    mutex_lock(&lf_sync->mutex_[r]);
-
-    lf_sync->cur_sb_col[r] = cur;
+    aom_atomic_store_int(&lf_sync->cur_sb_col[r], cur);
 
-    pthread_cond_signal(&lf_sync->cond_[r]);
-    pthread_mutex_unlock(&lf_sync->mutex_[r]);
+    if (aom_atomic_load_int(&lf_sync->waiters[r])) {
+      mutex_lock(&lf_sync->mutex_[r]);
+      pthread_cond_broadcast(&lf_sync->cond_[r]);
+      pthread_mutex_unlock(&lf_sync->mutex_[r]);
+    }
   }
 #else
   (void)lf_sync;
@@ -141,6 +163,15 @@ static INLINE void loop_filter_block_plane_hor(
   }
 }
 #endif
+
+// Returns the first mode info row of the next superblock row to filter by the
+// worker of lf_data, or -1 once all the rows of the stage are taken.
+static int next_lf_row(AV1LfSync *const lf_sync, LFWorkerData *const lf_data) {
+  const int job = aom_job_queue_next(&lf_sync->row_jobs,
+                                     (int)(lf_data - lf_sync->lfdata));
+  return job < 0 ? -1 : lf_data->start + job * lf_data->cm->mib_size;
+}
+
 // Row-based multi-threaded loopfilter hook
 #if CONFIG_PARALLEL_DEBLOCKING
 static int loop_filter_ver_row_worker(AV1LfSync *const lf_sync,
@@ -150,8 +181,7 @@ static int loop_filter_ver_row_worker(AV1LfSync *const lf_sync,
 #if !CONFIG_EXT_PARTITION_TYPES
   enum lf_path path = get_loop_filter_path(lf_data->y_only, lf_data->planes);
 #endif
-  for (mi_row = lf_data->start; mi_row < lf_data->stop;
-       mi_row += lf_sync->num_workers * lf_data->cm->mib_size) {
+  while ((mi_row = next_lf_row(lf_sync, lf_data)) >= 0) {
     MODE_INFO **const mi =
         lf_data->cm->mi_grid_visible + mi_row * lf_data->cm->mi_stride;
 
@@ -190,8 +220,7 @@ static int loop_filter_hor_row_worker(AV1LfSync *const lf_sync,
   enum lf_path path = get_loop_filter_path(lf_data->y_only, lf_data->planes);
 #endif
 
-  for (mi_row = lf_data->start; mi_row < lf_data->stop;
-       mi_row += lf_sync->num_workers * lf_data->cm->mib_size) {
+  while ((mi_row = next_lf_row(lf_sync, lf_data)) >= 0) {
     MODE_INFO **const mi =
         lf_data->cm->mi_grid_visible + mi_row * lf_data->cm->mi_stride;
 
@@ -225,16 +254,58 @@ static int loop_filter_hor_row_worker(AV1LfSync *const lf_sync,
   return 1;
 }
 #else  //  CONFIG_PARALLEL_DEBLOCKING
-static int loop_filter_row_worker(AV1LfSync *const lf_sync,
-                                  LFWorkerData *const lf_data) {
+static void loop_filter_sb_row(AV1LfSync *const lf_sync,
+                               LFWorkerData *const lf_data, int mi_row,
+                               int sb_cols) {
   const int num_planes = lf_data->y_only ? 1 : MAX_MB_PLANE;
-  const int sb_cols =
-      mi_cols_aligned_to_sb(lf_data->cm) >> lf_data->cm->mib_size_log2;
-  int mi_row, mi_col;
+  MODE_INFO **const mi =
+      lf_data->cm->mi_grid_visible + mi_row * lf_data->cm->mi_stride;
+  int mi_col;
 #if !CONFIG_EXT_PARTITION_TYPES
   enum lf_path path = get_loop_filter_path(lf_data->y_only, lf_data->planes);
 #endif  // !CONFIG_EXT_PARTITION_TYPES
 
+  for (mi_col = 0; mi_col < lf_data->cm->mi_cols;
+       mi_col += lf_data->cm->mib_size) {
+    const int r = mi_row >> lf_data->cm->mib_size_log2;
+    const int c = mi_col >> lf_data->cm->mib_size_log2;
+#if !CONFIG_EXT_PARTITION_TYPES
+    LOOP_FILTER_MASK lfm;
+#endif
+    int plane;
+
+    sync_read(lf_sync, r, c);
+
+    av1_setup_dst_planes(lf_data->planes, lf_data->frame_buffer, mi_row,
+                         mi_col);
+#if CONFIG_EXT_PARTITION_TYPES
+    for (plane = 0; plane < num_planes; ++plane) {
+      av1_filter_block_plane_non420_ver(lf_data->cm, &lf_data->planes[plane],
+                                        mi + mi_col, mi_row, mi_col);
+      av1_filter_block_plane_non420_hor(lf_data->cm, &lf_data->planes[plane],
+                                        mi + mi_col, mi_row, mi_col);
+    }
+#else
+    av1_setup_mask(lf_data->cm, mi_row, mi_col, mi + mi_col,
+                   lf_data->cm->mi_stride, &lfm);
+
+    for (plane = 0; plane < num_planes; ++plane) {
+      loop_filter_block_plane_ver(lf_data->cm, lf_data->planes, plane,
+                                  mi + mi_col, mi_row, mi_col, path, &lfm);
+      loop_filter_block_plane_hor(lf_data->cm, lf_data->planes, plane,
+                                  mi + mi_col, mi_row, mi_col, path, &lfm);
+    }
+#endif  // CONFIG_EXT_PARTITION_TYPES
+    sync_write(lf_sync, r, c, sb_cols);
+  }
+}
+
+static int loop_filter_row_worker(AV1LfSync *const lf_sync,
+                                  LFWorkerData *const lf_data) {
+  const int sb_cols =
+      mi_cols_aligned_to_sb(lf_data->cm) >> lf_data->cm->mib_size_log2;
+  int mi_row;
+
 #if CONFIG_EXT_PARTITION
   printf(
       "STOPPING: This code has not been modified to work with the "
@@ -242,47 +313,215 @@ static int loop_filter_row_worker(AV1LfSync *const lf_sync,
   exit(EXIT_FAILURE);
 #endif  // CONFIG_EXT_PARTITION
 
-  for (mi_row = lf_data->start; mi_row < lf_data->stop;
-       mi_row += lf_sync->num_workers * lf_data->cm->mib_size) {
-    MODE_INFO **const mi =
-        lf_data->cm->mi_grid_visible + mi_row * lf_data->cm->mi_stride;
+  while ((mi_row = next_lf_row(lf_sync, lf_data)) >= 0) {
+    loop_filter_sb_row(lf_sync, lf_data, mi_row, sb_cols);
+  }
+  return 1;
+}
 
-    for (mi_col = 0; mi_col < lf_data->cm->mi_cols;
-         mi_col += lf_data->cm->mib_size) {
-      const int r = mi_row >> lf_data->cm->mib_size_log2;
-      const int c = mi_col >> lf_data->cm->mib_size_log2;
-#if !CONFIG_EXT_PARTITION_TYPES
-      LOOP_FILTER_MASK lfm;
-#endif
-      int plane;
+// Stages of a superblock row in the loop filter pipeline, after it is
+// deblocked.
+#define PIPELINE_ROW_DEBLOCKED 0
+#define PIPELINE_ROW_CDEF_STARTED 1
+#define PIPELINE_ROW_DONE 2
 
-      sync_read(lf_sync, r, c);
+static void pipeline_lock(AV1LfSync *const lf_sync) {
+#if CONFIG_MULTITHREAD
+  mutex_lock(lf_sync->pipeline_mutex);
+#else
+  (void)lf_sync;
+#endif  // CONFIG_MULTITHREAD
+}
 
-      av1_setup_dst_planes(lf_data->planes, lf_data->frame_buffer, mi_row,
-                           mi_col);
-#if CONFIG_EXT_PARTITION_TYPES
-      for (plane = 0; plane < num_planes; ++plane) {
-        av1_filter_block_plane_non420_ver(lf_data->cm, &lf_data->planes[plane],
-                                          mi + mi_col, mi_row, mi_col);
-        av1_filter_block_plane_non420_hor(lf_data->cm, &lf_data->planes[plane],
-                                          mi + mi_col, mi_row, mi_col);
-      }
+static void pipeline_unlock(AV1LfSync *const lf_sync) {
+#if CONFIG_MULTITHREAD
+  pthread_mutex_unlock(lf_sync->pipeline_mutex);
 #else
-      av1_setup_mask(lf_data->cm, mi_row, mi_col, mi + mi_col,
-                     lf_data->cm->mi_stride, &lfm);
+  (void)lf_sync;
+#endif  // CONFIG_MULTITHREAD
+}
 
-      for (plane = 0; plane < num_planes; ++plane) {
-        loop_filter_block_plane_ver(lf_data->cm, lf_data->planes, plane,
-                                    mi + mi_col, mi_row, mi_col, path, &lfm);
-        loop_filter_block_plane_hor(lf_data->cm, lf_data->planes, plane,
-                                    mi + mi_col, mi_row, mi_col, path, &lfm);
-      }
-#endif  // CONFIG_EXT_PARTITION_TYPES
-      sync_write(lf_sync, r, c, sb_cols);
+// Waits for a change of the pipeline state. Must be called with the pipeline
+// mutex held. Without threads the state cannot change while waiting, so the
+// callers never have to wait then.
+static void pipeline_wait(AV1LfSync *const lf_sync) {
+#if CONFIG_MULTITHREAD
+  pthread_cond_wait(lf_sync->pipeline_cond, lf_sync->pipeline_mutex);
+#else
+  (void)lf_sync;
+  assert(0);
+#endif  // CONFIG_MULTITHREAD
+}
+
+static void pipeline_broadcast(AV1LfSync *const lf_sync) {
+#if CONFIG_MULTITHREAD
+  pthread_cond_broadcast(lf_sync->pipeline_cond);
+#else
+  (void)lf_sync;
+#endif  // CONFIG_MULTITHREAD
+}
+
+// Returns the next superblock row to deblock, once it and the row below it
+// are decoded. Returns -1 when all the rows are taken or decoding failed.
+static int get_next_pipeline_row(AV1LfSync *const lf_sync) {
+  int row = -1;
+  pipeline_lock(lf_sync);
+  while (!lf_sync->abort && lf_sync->next_row < lf_sync->rows) {
+    if (lf_sync->rows_decoded >=
+        AOMMIN(lf_sync->next_row + 2, lf_sync->rows)) {
+      row = lf_sync->next_row++;
+      break;
     }
+    pipeline_wait(lf_sync);
+  }
+  pipeline_unlock(lf_sync);
+  return row;
+}
+
+static void wait_row_stage(AV1LfSync *const lf_sync, int row, int stage) {
+  pipeline_lock(lf_sync);
+  while (lf_sync->row_stage[row] < stage) pipeline_wait(lf_sync);
+  pipeline_unlock(lf_sync);
+}
+
+static void set_row_stage(AV1LfSync *const lf_sync, int row, int stage) {
+  pipeline_lock(lf_sync);
+  lf_sync->row_stage[row] = stage;
+  while (lf_sync->rows_done < lf_sync->rows &&
+         lf_sync->row_stage[lf_sync->rows_done] == PIPELINE_ROW_DONE)
+    ++lf_sync->rows_done;
+  pipeline_broadcast(lf_sync);
+  pipeline_unlock(lf_sync);
+}
+
+// Applies CDEF and loop restoration to a superblock row once the row below it
+// is deblocked.
+static void filter_pipeline_row(AV1LfSync *const lf_sync,
+                                LFWorkerData *const lf_data, int row) {
+#if CONFIG_CDEF
+  if (lf_sync->cdef) {
+    AV1_COMMON *const cm = lf_sync->cm;
+    const int size = av1_cdef_sb_row_buf_size(cm);
+    uint16_t *const buf = lf_sync->cdef_buf + row * size;
+
+    // The rows above were saved when CDEF started on the previous row. Save
+    // the rows below before either row is filtered.
+    if (row > 0) wait_row_stage(lf_sync, row - 1, PIPELINE_ROW_CDEF_STARTED);
+    if (row < lf_sync->rows - 1)
+      av1_cdef_save_sb_row_edge(cm, lf_sync->xd, row, buf, buf + size);
+    set_row_stage(lf_sync, row, PIPELINE_ROW_CDEF_STARTED);
+    av1_cdef_filter_sb_row(cm, lf_sync->xd, row, buf);
+  }
+#endif  // CONFIG_CDEF
+#if CONFIG_LOOP_RESTORATION
+  if (lf_sync->lr_sync)
+    av1_loop_restoration_extend_sb_row(lf_sync->lr_sync, row);
+#endif  // CONFIG_LOOP_RESTORATION
+  set_row_stage(lf_sync, row, PIPELINE_ROW_DONE);
+#if CONFIG_LOOP_RESTORATION
+  if (lf_sync->lr_sync) {
+    // The restoration tiles may read all the rows above.
+    pipeline_lock(lf_sync);
+    while (lf_sync->rows_done <= row) pipeline_wait(lf_sync);
+    pipeline_unlock(lf_sync);
+    av1_loop_restoration_filter_sb_row(lf_sync->lr_sync, row,
+                                       (int)(lf_data - lf_sync->lfdata));
+  }
+#else
+  (void)lf_data;
+#endif  // CONFIG_LOOP_RESTORATION
+}
+
+int av1_loop_filter_pipeline_worker(AV1LfSync *const lf_sync,
+                                    LFWorkerData *const lf_data) {
+  AV1_COMMON *const cm = lf_sync->cm;
+  const int sb_cols = mi_cols_aligned_to_sb(cm) >> cm->mib_size_log2;
+  int row;
+
+  while ((row = get_next_pipeline_row(lf_sync)) >= 0) {
+    // Deblocking row 'row' modifies the bottom of the row above, which is
+    // only final once this is done.
+    if (lf_sync->filter_level)
+      loop_filter_sb_row(lf_sync, lf_data, row << cm->mib_size_log2, sb_cols);
+    if (row > 0) filter_pipeline_row(lf_sync, lf_data, row - 1);
+    if (row == lf_sync->rows - 1) filter_pipeline_row(lf_sync, lf_data, row);
   }
   return 1;
 }
+
+void av1_loop_filter_pipeline_init(AV1LfSync *lf_sync,
+                                   YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
+                                   MACROBLOCKD *xd, int filter_level, int cdef,
+                                   struct AV1LrSyncData *lr_sync,
+                                   int num_workers, int decoded) {
+  const int sb_rows = mi_rows_aligned_to_sb(cm) >> cm->mib_size_log2;
+  int i;
+
+  if (!lf_sync->sync_range || sb_rows != lf_sync->rows ||
+      num_workers > lf_sync->num_workers) {
+    av1_loop_filter_dealloc(lf_sync);
+    av1_loop_filter_alloc(lf_sync, cm, sb_rows, cm->width, num_workers);
+  }
+
+  memset(lf_sync->cur_sb_col, -1, sizeof(*lf_sync->cur_sb_col) * sb_rows);
+  for (i = 0; i < num_workers; ++i)
+    av1_loop_filter_data_reset(&lf_sync->lfdata[i], frame, cm, xd->plane);
+
+  lf_sync->cm = cm;
+  lf_sync->xd = xd;
+  lf_sync->filter_level = filter_level;
+  lf_sync->cdef = cdef;
+  lf_sync->lr_sync = lr_sync;
+  memset(lf_sync->tile_cols_decoded, 0,
+         sizeof(*lf_sync->tile_cols_decoded) * sb_rows);
+  lf_sync->rows_decoded = decoded ? sb_rows : 0;
+  lf_sync->next_row = 0;
+  memset(lf_sync->row_stage, PIPELINE_ROW_DEBLOCKED,
+         sizeof(*lf_sync->row_stage) * sb_rows);
+  lf_sync->rows_done = 0;
+  lf_sync->abort = 0;
+
+#if CONFIG_CDEF
+  if (cdef) {
+    const int size = sb_rows * av1_cdef_sb_row_buf_size(cm);
+    if (lf_sync->cdef_buf_size < size) {
+      aom_free(lf_sync->cdef_buf);
+      lf_sync->cdef_buf_size = 0;
+      CHECK_MEM_ERROR(cm, lf_sync->cdef_buf,
+                      aom_malloc(size * sizeof(*lf_sync->cdef_buf)));
+      lf_sync->cdef_buf_size = size;
+    }
+    av1_setup_dst_planes(xd->plane, frame, 0, 0);
+  }
+#endif  // CONFIG_CDEF
+}
+
+void av1_loop_filter_pipeline_row_decoded(AV1LfSync *lf_sync, int sb_row) {
+  AV1_COMMON *const cm = lf_sync->cm;
+  pipeline_lock(lf_sync);
+  if (++lf_sync->tile_cols_decoded[sb_row] == cm->tile_cols) {
+    while (lf_sync->rows_decoded < lf_sync->rows &&
+           lf_sync->tile_cols_decoded[lf_sync->rows_decoded] == cm->tile_cols)
+      ++lf_sync->rows_decoded;
+    pipeline_broadcast(lf_sync);
+  }
+  pipeline_unlock(lf_sync);
+}
+
+void av1_loop_filter_pipeline_abort(AV1LfSync *lf_sync) {
+  pipeline_lock(lf_sync);
+  lf_sync->abort = 1;
+  pipeline_broadcast(lf_sync);
+  pipeline_unlock(lf_sync);
+}
+
+void av1_loop_filter_pipeline_finish(AV1LfSync *lf_sync) {
+#if CONFIG_LOOP_RESTORATION
+  if (lf_sync->lr_sync) av1_loop_restoration_rows_finish(lf_sync->lr_sync);
+#else
+  (void)lf_sync;
+#endif  // CONFIG_LOOP_RESTORATION
+}
 #endif  //  CONFIG_PARALLEL_DEBLOCKING
 
 static void loop_filter_rows_mt(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
@@ -297,6 +536,8 @@ static void loop_filter_rows_mt(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
   // input.
   const int tile_cols = cm->tile_cols;
   const int num_workers = AOMMIN(nworkers, tile_cols);
+  // The workers take the superblock rows from start to stop from a job queue.
+  const int num_rows = (stop - start + cm->mib_size - 1) >> cm->mib_size_log2;
   int i;
 
 #if CONFIG_EXT_PARTITION
@@ -326,6 +567,7 @@ static void loop_filter_rows_mt(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
   memset(lf_sync->cur_sb_col, -1, sizeof(*lf_sync->cur_sb_col) * sb_rows);
 
   // Filter all the vertical edges in the whole frame
+  aom_job_queue_reset(&lf_sync->row_jobs, num_rows, num_workers);
   for (i = 0; i < num_workers; ++i) {
     AVxWorker *const worker = &workers[i];
     LFWorkerData *const lf_data = &lf_sync->lfdata[i];
@@ -336,7 +578,7 @@ static void loop_filter_rows_mt(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
 
     // Loopfilter data
     av1_loop_filter_data_reset(lf_data, frame, cm, planes);
-    lf_data->start = start + i * cm->mib_size;
+    lf_data->start = start;
     lf_data->stop = stop;
     lf_data->y_only = y_only;
 
@@ -355,6 +597,7 @@ static void loop_filter_rows_mt(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
 
   memset(lf_sync->cur_sb_col, -1, sizeof(*lf_sync->cur_sb_col) * sb_rows);
   // Filter all the horizontal edges in the whole frame
+  aom_job_queue_reset(&lf_sync->row_jobs, num_rows, num_workers);
   for (i = 0; i < num_workers; ++i) {
     AVxWorker *const worker = &workers[i];
     LFWorkerData *const lf_data = &lf_sync->lfdata[i];
@@ -365,7 +608,7 @@ static void loop_filter_rows_mt(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
 
     // Loopfilter data
     av1_loop_filter_data_reset(lf_data, frame, cm, planes);
-    lf_data->start = start + i * cm->mib_size;
+    lf_data->start = start;
     lf_data->stop = stop;
     lf_data->y_only = y_only;
 
@@ -385,6 +628,7 @@ static void loop_filter_rows_mt(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
   // Initialize cur_sb_col to -1 for all SB rows.
   memset(lf_sync->cur_sb_col, -1, sizeof(*lf_sync->cur_sb_col) * sb_rows);
 
+  aom_job_queue_reset(&lf_sync->row_jobs, num_rows, num_workers);
   for (i = 0; i < num_workers; ++i) {
     AVxWorker *const worker = &workers[i];
     LFWorkerData *const lf_data = &lf_sync->lfdata[i];
@@ -395,7 +639,7 @@ static void loop_filter_rows_mt(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
 
     // Loopfilter data
     av1_loop_filter_data_reset(lf_data, frame, cm, planes);
-    lf_data->start = start + i * cm->mib_size;
+    lf_data->start = start;
     lf_data->stop = stop;
     lf_data->y_only = y_only;
 
@@ -437,18 +681,26 @@ void av1_loop_filter_frame_mt(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
                       workers, num_workers, lf_sync);
 }
 
-// Set up nsync by width.
-static INLINE int get_sync_range(int width) {
+// Set up nsync by width and number of workers.
+static INLINE int get_sync_range(int width, int sb_cols, int num_workers) {
+  int nsync;
+
   // nsync numbers are picked by testing. For example, for 4k
   // video, using 4 gives best performance.
   if (width < 640)
-    return 1;
+    nsync = 1;
   else if (width <= 1280)
-    return 2;
+    nsync = 2;
   else if (width <= 4096)
-    return 4;
+    nsync = 4;
   else
-    return 8;
+    nsync = 8;
+
+  // Each row runs at least nsync superblocks behind the row above. Keep the
+  // lag of num_workers rows within the frame width, so that all the workers
+  // can filter at the same time.
+  while (nsync > 1 && nsync * num_workers > sb_cols) nsync >>= 1;
+  return nsync;
 }
 
 // Allocate memory for lf row synchronization
@@ -474,18 +726,41 @@ void av1_loop_filter_alloc(AV1LfSync *lf_sync, AV1_COMMON *cm, int rows,
         pthread_cond_init(&lf_sync->cond_[i], NULL);
       }
     }
+
+    CHECK_MEM_ERROR(cm, lf_sync->waiters,
+                    aom_calloc(rows, sizeof(*lf_sync->waiters)));
   }
 #endif  // CONFIG_MULTITHREAD
 
   CHECK_MEM_ERROR(cm, lf_sync->lfdata,
                   aom_malloc(num_workers * sizeof(*lf_sync->lfdata)));
   lf_sync->num_workers = num_workers;
+  if (!aom_job_queue_alloc(&lf_sync->row_jobs, num_workers))
+    aom_internal_error(&cm->error, AOM_CODEC_MEM_ERROR,
+                       "Failed to allocate the loop filter job queue");
 
   CHECK_MEM_ERROR(cm, lf_sync->cur_sb_col,
                   aom_malloc(sizeof(*lf_sync->cur_sb_col) * rows));
 
+#if CONFIG_MULTITHREAD
+  CHECK_MEM_ERROR(cm, lf_sync->pipeline_mutex,
+                  aom_malloc(sizeof(*lf_sync->pipeline_mutex)));
+  if (lf_sync->pipeline_mutex)
+    pthread_mutex_init(lf_sync->pipeline_mutex, NULL);
+  CHECK_MEM_ERROR(cm, lf_sync->pipeline_cond,
+                  aom_malloc(sizeof(*lf_sync->pipeline_cond)));
+  if (lf_sync->pipeline_cond)
+    pthread_cond_init(lf_sync->pipeline_cond, NULL);
+#endif  // CONFIG_MULTITHREAD
+  CHECK_MEM_ERROR(cm, lf_sync->tile_cols_decoded,
+                  aom_malloc(sizeof(*lf_sync->tile_cols_decoded) * rows));
+  CHECK_MEM_ERROR(cm, lf_sync->row_stage,
+                  aom_malloc(sizeof(*lf_sync->row_stage) * rows));
+
   // Set up nsync.
-  lf_sync->sync_range = get_sync_range(width);
+  lf_sync->sync_range =
+      get_sync_range(width, mi_cols_aligned_to_sb(cm) >> cm->mib_size_log2,
+                     num_workers);
 }
 
 // Deallocate lf synchronization related mutex and data
@@ -506,9 +781,22 @@ void av1_loop_filter_dealloc(AV1LfSync *lf_sync) {
       }
       aom_free(lf_sync->cond_);
     }
+    aom_free(lf_sync->waiters);
+    if (lf_sync->pipeline_mutex != NULL) {
+      pthread_mutex_destroy(lf_sync->pipeline_mutex);
+      aom_free(lf_sync->pipeline_mutex);
+    }
+    if (lf_sync->pipeline_cond != NULL) {
+      pthread_cond_destroy(lf_sync->pipeline_cond);
+      aom_free(lf_sync->pipeline_cond);
+    }
 #endif  // CONFIG_MULTITHREAD
     aom_free(lf_sync->lfdata);
+    aom_job_queue_free(&lf_sync->row_jobs);
     aom_free(lf_sync->cur_sb_col);
+    aom_free(lf_sync->tile_cols_decoded);
+    aom_free(lf_sync->row_stage);
+    aom_free(lf_sync->cdef_buf);
     // clear the structure as the source of this call may be a resize in which
     // case this call will be followed by an _alloc() which may fail.
     av1_zero(*lf_sync);
@@ -13,6 +13,7 @@
 #define AV1_COMMON_LOOPFILTER_THREAD_H_
 #include "./aom_config.h"
 #include "av1/common/av1_loopfilter.h"
+#include "aom_util/aom_job_queue.h"
 #include "aom_util/aom_thread.h"
 
 #ifdef __cplusplus
@@ -20,6 +21,7 @@ extern "C" {
 #endif
 
 struct AV1Common;
+struct AV1LrSyncData;
 struct FRAME_COUNTS;
 
 // Loopfilter row synchronization
@@ -27,8 +29,11 @@ typedef struct AV1LfSyncData {
 #if CONFIG_MULTITHREAD
   pthread_mutex_t *mutex_;
   pthread_cond_t *cond_;
+  // Number of threads blocked on the progress of each row.
+  int *waiters;
 #endif
   // Allocate memory to store the loop-filtered superblock index in each row.
+  // It is read and written atomically, see sync_read().
   int *cur_sb_col;
   // The optimal sync_range for different resolution and platform should be
   // determined by testing. Currently, it is chosen to be a power-of-2 number.
@@ -38,6 +43,33 @@ typedef struct AV1LfSyncData {
   // Row-based parallel loopfilter data
   LFWorkerData *lfdata;
   int num_workers;
+  // Superblock rows of the current filtering stage, one job per row.
+  AVxJobQueue row_jobs;
+
+  // Loop filter pipeline, see av1_loop_filter_pipeline_init().
+#if CONFIG_MULTITHREAD
+  pthread_mutex_t *pipeline_mutex;
+  pthread_cond_t *pipeline_cond;
+#endif
+  struct AV1Common *cm;
+  MACROBLOCKD *xd;
+  int filter_level;
+  int cdef;
+  struct AV1LrSyncData *lr_sync;
+  // Number of tile columns decoded in each superblock row.
+  int *tile_cols_decoded;
+  // Number of leading superblock rows decoded in all the tile columns.
+  int rows_decoded;
+  // Next superblock row to be deblocked.
+  int next_row;
+  // CDEF and loop restoration progress of each superblock row.
+  int *row_stage;
+  // Number of leading superblock rows that are filtered by CDEF.
+  int rows_done;
+  int abort;
+  // Unfiltered rows saved by av1_cdef_save_sb_row_edge().
+  uint16_t *cdef_buf;
+  int cdef_buf_size;
 } AV1LfSync;
 
 // Allocate memory for loopfilter row synchronization.
@@ -54,6 +86,34 @@ void av1_loop_filter_frame_mt(YV12_BUFFER_CONFIG *frame, struct AV1Common *cm,
                               int partial_frame, AVxWorker *workers,
                               int num_workers, AV1LfSync *lf_sync);
 
+#if !CONFIG_PARALLEL_DEBLOCKING
+// The loop filter pipeline applies the deblocking filter, CDEF and loop
+// restoration to the frame in a single sweep of superblock rows: when row r is
+// deblocked, row r - 1 is filtered by CDEF and then the restoration tiles
+// that read no rows below row r - 1 are restored. The rows are handed out in
+// order to the workers running av1_loop_filter_pipeline_worker(). A row is
+// deblocked once it and the row below it are decoded, so the sweep can run
+// while the tiles of the next rows are still being decoded.
+//
+// If 'decoded' is 0, the decoder reports each superblock row decoded in a
+// tile column with av1_loop_filter_pipeline_row_decoded(), or calls
+// av1_loop_filter_pipeline_abort() if decoding fails. 'filter_level' may be 0
+// and 'lr_sync' NULL to skip the deblocking filter and loop restoration. For
+// the latter, av1_loop_restoration_rows_init() must have been called.
+void av1_loop_filter_pipeline_init(AV1LfSync *lf_sync,
+                                   YV12_BUFFER_CONFIG *frame,
+                                   struct AV1Common *cm, MACROBLOCKD *xd,
+                                   int filter_level, int cdef,
+                                   struct AV1LrSyncData *lr_sync,
+                                   int num_workers, int decoded);
+int av1_loop_filter_pipeline_worker(AV1LfSync *const lf_sync,
+                                    LFWorkerData *const lf_data);
+void av1_loop_filter_pipeline_row_decoded(AV1LfSync *lf_sync, int sb_row);
+void av1_loop_filter_pipeline_abort(AV1LfSync *lf_sync);
+// Completes the frame once all the workers are done.
+void av1_loop_filter_pipeline_finish(AV1LfSync *lf_sync);
+#endif  // !CONFIG_PARALLEL_DEBLOCKING
+
 void av1_accumulate_frame_counts(struct FRAME_COUNTS *acc_counts,
                                  struct FRAME_COUNTS *counts);
 
@@ -23,6 +23,7 @@
 #include "aom_dsp/bitreader_buffer.h"
 #include "aom_dsp/binary_codes_reader.h"
 #include "aom_mem/aom_mem.h"
+#include "aom_ports/aom_atomics.h"
 #include "aom_ports/mem.h"
 #include "aom_ports/mem_ops.h"
 #include "aom_scale/aom_scale.h"
@@ -332,6 +333,125 @@ static void inverse_transform_block(MACROBLOCKD *xd, int plane,
   memset(dqcoeff, 0, (scan_line + 1) * sizeof(dqcoeff[0]));
 }
 
+// Row-based multi-threading decodes a tile in two passes. The parse pass reads
+// the bitstream serially and stores the tokens of each superblock row in a
+// DecRowBuffer; the reconstruction pass replays them on the tile workers. A
+// NULL cursor decodes and reconstructs in a single pass.
+static INLINE int is_row_mt_parse(const DecRowCursor *const rc) {
+  return rc != NULL && rc->parse;
+}
+
+static INLINE int is_row_mt_recon(const DecRowCursor *const rc) {
+  return rc != NULL && !rc->parse;
+}
+
+static void *grow_row_buffer(MACROBLOCKD *const xd, void *data, int *size,
+                             int used, int needed, size_t elem_size) {
+  void *new_data;
+  int new_size;
+
+  if (used + needed <= *size) return data;
+
+  new_size = AOMMAX(2 * *size, used + needed);
+  new_data = aom_malloc(new_size * elem_size);
+  if (new_data == NULL)
+    aom_internal_error(xd->error_info, AOM_CODEC_MEM_ERROR,
+                       "Failed to allocate row buffer");
+  if (used) memcpy(new_data, data, used * elem_size);
+  aom_free(data);
+  *size = new_size;
+  return new_data;
+}
+
+static void row_mt_store_block(MACROBLOCKD *const xd, DecRowCursor *const rc,
+                               int mi_row, int mi_col, BLOCK_SIZE bsize) {
+  DecRowBuffer *const buf = rc->buf;
+  DecBlockInfo *block;
+
+  buf->blocks = (DecBlockInfo *)grow_row_buffer(
+      xd, buf->blocks, &buf->blocks_size, buf->num_blocks, 1,
+      sizeof(*buf->blocks));
+  block = &buf->blocks[buf->num_blocks++];
+  block->mi_row = mi_row;
+  block->mi_col = mi_col;
+  block->bsize = bsize;
+}
+
+static void row_mt_store_tokens(MACROBLOCKD *const xd, DecRowCursor *const rc,
+                                int plane, int eob, int16_t max_scan_line) {
+  DecRowBuffer *const buf = rc->buf;
+  DecTxbInfo *txb;
+
+  buf->txbs = (DecTxbInfo *)grow_row_buffer(
+      xd, buf->txbs, &buf->txbs_size, buf->num_txbs, 1, sizeof(*buf->txbs));
+  txb = &buf->txbs[buf->num_txbs++];
+  txb->eob = eob;
+  txb->max_scan_line = max_scan_line;
+
+  if (eob) {
+    tran_low_t *const dqcoeff = xd->plane[plane].dqcoeff;
+    const int num_coeffs = max_scan_line + 1;
+    buf->dqcoeff = (tran_low_t *)grow_row_buffer(
+        xd, buf->dqcoeff, &buf->coeffs_size, buf->num_coeffs, num_coeffs,
+        sizeof(*buf->dqcoeff));
+    memcpy(buf->dqcoeff + buf->num_coeffs, dqcoeff,
+           num_coeffs * sizeof(*dqcoeff));
+    buf->num_coeffs += num_coeffs;
+    memset(dqcoeff, 0, num_coeffs * sizeof(*dqcoeff));
+  }
+}
+
+static int row_mt_load_tokens(MACROBLOCKD *const xd, DecRowCursor *const rc,
+                              int plane, int16_t *max_scan_line) {
+  const DecRowBuffer *const buf = rc->buf;
+  const DecTxbInfo *const txb = &buf->txbs[rc->txb_idx++];
+
+  assert(rc->txb_idx <= buf->num_txbs);
+  *max_scan_line = txb->max_scan_line;
+  if (txb->eob) {
+    const int num_coeffs = txb->max_scan_line + 1;
+    assert(rc->coeff_idx + num_coeffs <= buf->num_coeffs);
+    memcpy(xd->plane[plane].dqcoeff, buf->dqcoeff + rc->coeff_idx,
+           num_coeffs * sizeof(*buf->dqcoeff));
+    rc->coeff_idx += num_coeffs;
+  }
+  return txb->eob;
+}
+
+#if CONFIG_PALETTE
+static void row_mt_store_color_map(MACROBLOCKD *const xd,
+                                   DecRowCursor *const rc, int plane) {
+  DecRowBuffer *const buf = rc->buf;
+  int plane_block_width, plane_block_height, map_size;
+
+  av1_get_block_dimensions(xd->mi[0]->mbmi.sb_type, plane, xd,
+                           &plane_block_width, &plane_block_height, NULL,
+                           NULL);
+  map_size = plane_block_width * plane_block_height;
+  buf->color_index_map = (uint8_t *)grow_row_buffer(
+      xd, buf->color_index_map, &buf->colors_size, buf->num_colors, map_size,
+      sizeof(*buf->color_index_map));
+  memcpy(buf->color_index_map + buf->num_colors,
+         xd->plane[plane].color_index_map, map_size);
+  buf->num_colors += map_size;
+}
+
+static void row_mt_load_color_map(MACROBLOCKD *const xd,
+                                  DecRowCursor *const rc, int plane) {
+  const DecRowBuffer *const buf = rc->buf;
+  int plane_block_width, plane_block_height, map_size;
+
+  av1_get_block_dimensions(xd->mi[0]->mbmi.sb_type, plane, xd,
+                           &plane_block_width, &plane_block_height, NULL,
+                           NULL);
+  map_size = plane_block_width * plane_block_height;
+  assert(rc->color_idx + map_size <= buf->num_colors);
+  memcpy(xd->plane[plane].color_index_map,
+         buf->color_index_map + rc->color_idx, map_size);
+  rc->color_idx += map_size;
+}
+#endif  // CONFIG_PALETTE
+
 #if CONFIG_PVQ
 static int av1_pvq_decode_helper(MACROBLOCKD *xd, tran_low_t *ref_coeff,
                                  tran_low_t *dqcoeff, int16_t *quant, int pli,
@@ -506,30 +626,40 @@ static int av1_pvq_decode_helper2(AV1_COMMON *cm, MACROBLOCKD *const xd,
 
 static void predict_and_reconstruct_intra_block(
     AV1_COMMON *cm, MACROBLOCKD *const xd, aom_reader *const r,
-    MB_MODE_INFO *const mbmi, int plane, int row, int col, TX_SIZE tx_size) {
+    DecRowCursor *const rc, MB_MODE_INFO *const mbmi, int plane, int row,
+    int col, TX_SIZE tx_size) {
   PLANE_TYPE plane_type = get_plane_type(plane);
   const int block_idx = (row << 1) + col;
 #if CONFIG_PVQ
   (void)r;
+  (void)rc;
 #endif
-  av1_predict_intra_block_facade(xd, plane, block_idx, col, row, tx_size);
+  if (!is_row_mt_parse(rc))
+    av1_predict_intra_block_facade(xd, plane, block_idx, col, row, tx_size);
 
   if (!mbmi->skip) {
     TX_TYPE tx_type = get_tx_type(plane_type, xd, block_idx, tx_size);
 #if !CONFIG_PVQ
     struct macroblockd_plane *const pd = &xd->plane[plane];
-#if CONFIG_LV_MAP
     int16_t max_scan_line = 0;
     int eob;
-    av1_read_coeffs_txb_facade(cm, xd, r, row, col, block_idx, plane,
-                               pd->dqcoeff, &max_scan_line, &eob);
+    if (is_row_mt_recon(rc)) {
+      eob = row_mt_load_tokens(xd, rc, plane, &max_scan_line);
+    } else {
+#if CONFIG_LV_MAP
+      av1_read_coeffs_txb_facade(cm, xd, r, row, col, block_idx, plane,
+                                 pd->dqcoeff, &max_scan_line, &eob);
 #else   // CONFIG_LV_MAP
-    const SCAN_ORDER *scan_order = get_scan(cm, tx_size, tx_type, 0);
-    int16_t max_scan_line = 0;
-    const int eob =
-        av1_decode_block_tokens(cm, xd, plane, scan_order, col, row, tx_size,
-                                tx_type, &max_scan_line, r, mbmi->segment_id);
+      const SCAN_ORDER *scan_order = get_scan(cm, tx_size, tx_type, 0);
+      eob = av1_decode_block_tokens(cm, xd, plane, scan_order, col, row,
+                                    tx_size, tx_type, &max_scan_line, r,
+                                    mbmi->segment_id);
 #endif  // CONFIG_LV_MAP
+    }
+    if (is_row_mt_parse(rc)) {
+      row_mt_store_tokens(xd, rc, plane, eob, max_scan_line);
+      return;
+    }
     if (eob) {
       uint8_t *dst =
           &pd->dst.buf[(row * pd->dst.stride + col) << tx_size_wide_log2[0]];
@@ -544,9 +674,10 @@ static void predict_and_reconstruct_intra_block(
 
 #if CONFIG_VAR_TX && !CONFIG_COEF_INTERLEAVE
 static void decode_reconstruct_tx(AV1_COMMON *cm, MACROBLOCKD *const xd,
-                                  aom_reader *r, MB_MODE_INFO *const mbmi,
-                                  int plane, BLOCK_SIZE plane_bsize,
-                                  int blk_row, int blk_col, TX_SIZE tx_size,
+                                  aom_reader *r, DecRowCursor *const rc,
+                                  MB_MODE_INFO *const mbmi, int plane,
+                                  BLOCK_SIZE plane_bsize, int blk_row,
+                                  int blk_col, TX_SIZE tx_size,
                                   int *eob_total) {
   const struct macroblockd_plane *const pd = &xd->plane[plane];
   const BLOCK_SIZE bsize = txsize_to_bsize[tx_size];
@@ -565,24 +696,31 @@ static void decode_reconstruct_tx(AV1_COMMON *cm, MACROBLOCKD *const xd,
     PLANE_TYPE plane_type = get_plane_type(plane);
     int block_idx = (blk_row << 1) + blk_col;
     TX_TYPE tx_type = get_tx_type(plane_type, xd, block_idx, plane_tx_size);
-#if CONFIG_LV_MAP
-    (void)segment_id;
     int16_t max_scan_line = 0;
     int eob;
-    av1_read_coeffs_txb_facade(cm, xd, r, row, col, block_idx, plane,
-                               pd->dqcoeff, &max_scan_line, &eob);
+    if (is_row_mt_recon(rc)) {
+      eob = row_mt_load_tokens(xd, rc, plane, &max_scan_line);
+    } else {
+#if CONFIG_LV_MAP
+      (void)segment_id;
+      av1_read_coeffs_txb_facade(cm, xd, r, row, col, block_idx, plane,
+                                 pd->dqcoeff, &max_scan_line, &eob);
 #else   // CONFIG_LV_MAP
-    const SCAN_ORDER *sc = get_scan(cm, plane_tx_size, tx_type, 1);
-    int16_t max_scan_line = 0;
-    const int eob = av1_decode_block_tokens(
-        cm, xd, plane, sc, blk_col, blk_row, plane_tx_size, tx_type,
-        &max_scan_line, r, mbmi->segment_id);
+      const SCAN_ORDER *sc = get_scan(cm, plane_tx_size, tx_type, 1);
+      eob = av1_decode_block_tokens(cm, xd, plane, sc, blk_col, blk_row,
+                                    plane_tx_size, tx_type, &max_scan_line,
+                                    r, mbmi->segment_id);
 #endif  // CONFIG_LV_MAP
+    }
+    *eob_total += eob;
+    if (is_row_mt_parse(rc)) {
+      row_mt_store_tokens(xd, rc, plane, eob, max_scan_line);
+      return;
+    }
     inverse_transform_block(xd, plane, tx_type, plane_tx_size,
                             &pd->dst.buf[(blk_row * pd->dst.stride + blk_col)
                                          << tx_size_wide_log2[0]],
                             pd->dst.stride, max_scan_line, eob);
-    *eob_total += eob;
   } else {
     const TX_SIZE sub_txs = sub_tx_size_map[tx_size];
     const int bsl = tx_size_wide_unit[sub_txs];
@@ -596,7 +734,7 @@ static void decode_reconstruct_tx(AV1_COMMON *cm, MACROBLOCKD *const xd,
 
       if (offsetr >= max_blocks_high || offsetc >= max_blocks_wide) continue;
 
-      decode_reconstruct_tx(cm, xd, r, mbmi, plane, plane_bsize, offsetr,
+      decode_reconstruct_tx(cm, xd, r, rc, mbmi, plane, plane_bsize, offsetr,
                             offsetc, sub_txs, eob_total);
     }
   }
@@ -606,34 +744,40 @@ static void decode_reconstruct_tx(AV1_COMMON *cm, MACROBLOCKD *const xd,
 #if !CONFIG_VAR_TX || CONFIG_SUPERTX || CONFIG_COEF_INTERLEAVE || \
     (!CONFIG_VAR_TX && CONFIG_EXT_TX && CONFIG_RECT_TX)
 static int reconstruct_inter_block(AV1_COMMON *cm, MACROBLOCKD *const xd,
-                                   aom_reader *const r, int segment_id,
-                                   int plane, int row, int col,
+                                   aom_reader *const r, DecRowCursor *const rc,
+                                   int segment_id, int plane, int row, int col,
                                    TX_SIZE tx_size) {
   PLANE_TYPE plane_type = get_plane_type(plane);
   int block_idx = (row << 1) + col;
   TX_TYPE tx_type = get_tx_type(plane_type, xd, block_idx, tx_size);
-#if CONFIG_PVQ
   int eob;
+#if CONFIG_PVQ
   (void)r;
+  (void)rc;
   (void)segment_id;
 #else
   struct macroblockd_plane *const pd = &xd->plane[plane];
 #endif
 
 #if !CONFIG_PVQ
-#if CONFIG_LV_MAP
-  (void)segment_id;
   int16_t max_scan_line = 0;
-  int eob;
-  av1_read_coeffs_txb_facade(cm, xd, r, row, col, block_idx, plane, pd->dqcoeff,
-                             &max_scan_line, &eob);
+  if (is_row_mt_recon(rc)) {
+    eob = row_mt_load_tokens(xd, rc, plane, &max_scan_line);
+  } else {
+#if CONFIG_LV_MAP
+    (void)segment_id;
+    av1_read_coeffs_txb_facade(cm, xd, r, row, col, block_idx, plane,
+                               pd->dqcoeff, &max_scan_line, &eob);
 #else   // CONFIG_LV_MAP
-  int16_t max_scan_line = 0;
-  const SCAN_ORDER *scan_order = get_scan(cm, tx_size, tx_type, 1);
-  const int eob =
-      av1_decode_block_tokens(cm, xd, plane, scan_order, col, row, tx_size,
-                              tx_type, &max_scan_line, r, segment_id);
+    const SCAN_ORDER *scan_order = get_scan(cm, tx_size, tx_type, 1);
+    eob = av1_decode_block_tokens(cm, xd, plane, scan_order, col, row, tx_size,
+                                  tx_type, &max_scan_line, r, segment_id);
 #endif  // CONFIG_LV_MAP
+  }
+  if (is_row_mt_parse(rc)) {
+    row_mt_store_tokens(xd, rc, plane, eob, max_scan_line);
+    return eob;
+  }
   uint8_t *dst =
       &pd->dst.buf[(row * pd->dst.stride + col) << tx_size_wide_log2[0]];
   if (eob)
@@ -647,24 +791,17 @@ static int reconstruct_inter_block(AV1_COMMON *cm, MACROBLOCKD *const xd,
 }
 #endif  // !CONFIG_VAR_TX || CONFIG_SUPER_TX
 
-static void set_offsets(AV1_COMMON *const cm, MACROBLOCKD *const xd,
-                        BLOCK_SIZE bsize, int mi_row, int mi_col, int bw,
-                        int bh, int x_mis, int y_mis) {
-  const int offset = mi_row * cm->mi_stride + mi_col;
-  int x, y;
+// Sets up xd for the block at (mi_row, mi_col) whose mode info has already
+// been written to the mode info grid.
+static void set_block_offsets(AV1_COMMON *const cm, MACROBLOCKD *const xd,
+                              BLOCK_SIZE bsize, int mi_row, int mi_col, int bw,
+                              int bh) {
   const TileInfo *const tile = &xd->tile;
 
-  xd->mi = cm->mi_grid_visible + offset;
-  xd->mi[0] = &cm->mi[offset];
-  // TODO(slavarnway): Generate sb_type based on bwl and bhl, instead of
-  // passing bsize from decode_partition().
-  xd->mi[0]->mbmi.sb_type = bsize;
-#if CONFIG_RD_DEBUG
-  xd->mi[0]->mbmi.mi_row = mi_row;
-  xd->mi[0]->mbmi.mi_col = mi_col;
+  xd->mi = cm->mi_grid_visible + mi_row * cm->mi_stride + mi_col;
+#if !CONFIG_VAR_TX
+  (void)bsize;
 #endif
-  for (y = 0; y < y_mis; ++y)
-    for (x = !y; x < x_mis; ++x) xd->mi[y * cm->mi_stride + x] = xd->mi[0];
 
   set_plane_n4(xd, bw, bh);
   set_skip_context(xd, mi_row, mi_col);
@@ -685,6 +822,27 @@ static void set_offsets(AV1_COMMON *const cm, MACROBLOCKD *const xd,
   av1_setup_dst_planes(xd->plane, get_frame_new_buffer(cm), mi_row, mi_col);
 }
 
+static void set_offsets(AV1_COMMON *const cm, MACROBLOCKD *const xd,
+                        BLOCK_SIZE bsize, int mi_row, int mi_col, int bw,
+                        int bh, int x_mis, int y_mis) {
+  const int offset = mi_row * cm->mi_stride + mi_col;
+  int x, y;
+
+  xd->mi = cm->mi_grid_visible + offset;
+  xd->mi[0] = &cm->mi[offset];
+  // TODO(slavarnway): Generate sb_type based on bwl and bhl, instead of
+  // passing bsize from decode_partition().
+  xd->mi[0]->mbmi.sb_type = bsize;
+#if CONFIG_RD_DEBUG
+  xd->mi[0]->mbmi.mi_row = mi_row;
+  xd->mi[0]->mbmi.mi_col = mi_col;
+#endif
+  for (y = 0; y < y_mis; ++y)
+    for (x = !y; x < x_mis; ++x) xd->mi[y * cm->mi_stride + x] = xd->mi[0];
+
+  set_block_offsets(cm, xd, bsize, mi_row, mi_col, bw, bh);
+}
+
 #if CONFIG_SUPERTX
 static MB_MODE_INFO *set_offsets_extend(AV1_COMMON *const cm,
                                         MACROBLOCKD *const xd,
@@ -1500,9 +1658,75 @@ static void decode_mbmi_block(AV1Decoder *const pbi, MACROBLOCKD *const xd,
   aom_merge_corrupted_flag(&xd->corrupted, reader_corrupted_flag);
 }
 
+static void predict_inter_block(AV1_COMMON *const cm, MACROBLOCKD *const xd,
+                                int mi_row, int mi_col, BLOCK_SIZE bsize) {
+  MB_MODE_INFO *const mbmi = &xd->mi[0]->mbmi;
+  int ref;
+
+  for (ref = 0; ref < 1 + has_second_ref(mbmi); ++ref) {
+    const MV_REFERENCE_FRAME frame = mbmi->ref_frame[ref];
+    RefBuffer *ref_buf = &cm->frame_refs[frame - LAST_FRAME];
+
+    xd->block_refs[ref] = ref_buf;
+    if ((!av1_is_valid_scale(&ref_buf->sf)))
+      aom_internal_error(xd->error_info, AOM_CODEC_UNSUP_BITSTREAM,
+                         "Reference frame has invalid dimensions");
+    av1_setup_pre_planes(xd, ref, ref_buf->buf, mi_row, mi_col, &ref_buf->sf);
+  }
+#if CONFIG_WARPED_MOTION
+  if (mbmi->motion_mode == WARPED_CAUSAL) {
+    int i;
+    assert_motion_mode_valid(WARPED_CAUSAL,
+#if CONFIG_GLOBAL_MOTION && SEPARATE_GLOBAL_MOTION
+                             0, cm->global_motion,
+#endif  // CONFIG_GLOBAL_MOTION && SEPARATE_GLOBAL_MOTION
+                             xd->mi[0]);
+    for (i = 0; i < 3; ++i) {
+      const struct macroblockd_plane *pd = &xd->plane[i];
+      av1_warp_plane(&mbmi->wm_params[0],
+#if CONFIG_AOM_HIGHBITDEPTH
+                     xd->cur_buf->flags & YV12_FLAG_HIGHBITDEPTH, xd->bd,
+#endif  // CONFIG_AOM_HIGHBITDEPTH
+                     pd->pre[0].buf0, pd->pre[0].width, pd->pre[0].height,
+                     pd->pre[0].stride, pd->dst.buf,
+                     ((mi_col * MI_SIZE) >> pd->subsampling_x),
+                     ((mi_row * MI_SIZE) >> pd->subsampling_y),
+                     xd->n8_w * (MI_SIZE >> pd->subsampling_x),
+                     xd->n8_h * (MI_SIZE >> pd->subsampling_y),
+                     pd->dst.stride, pd->subsampling_x, pd->subsampling_y, 16,
+                     16, 0);
+    }
+  } else {
+#endif  // CONFIG_WARPED_MOTION
+#if CONFIG_CB4X4
+    av1_build_inter_predictors_sb(xd, mi_row, mi_col, NULL, bsize);
+#else
+  av1_build_inter_predictors_sb(xd, mi_row, mi_col, NULL,
+                                AOMMAX(bsize, BLOCK_8X8));
+#endif
+#if CONFIG_WARPED_MOTION
+  }
+#endif  // CONFIG_WARPED_MOTION
+#if CONFIG_MOTION_VAR
+  if (mbmi->motion_mode == OBMC_CAUSAL) {
+    assert_motion_mode_valid(OBMC_CAUSAL,
+#if CONFIG_GLOBAL_MOTION && SEPARATE_GLOBAL_MOTION
+                             0, cm->global_motion,
+#endif  // CONFIG_GLOBAL_MOTION && SEPARATE_GLOBAL_MOTION
+                             xd->mi[0]);
+#if CONFIG_NCOBMC
+    av1_build_ncobmc_inter_predictors_sb(cm, xd, mi_row, mi_col);
+#else
+    av1_build_obmc_inter_predictors_sb(cm, xd, mi_row, mi_col);
+#endif
+  }
+#endif  // CONFIG_MOTION_VAR
+}
+
 static void decode_token_and_recon_block(AV1Decoder *const pbi,
                                          MACROBLOCKD *const xd, int mi_row,
                                          int mi_col, aom_reader *r,
+                                         DecRowCursor *const rc,
                                          BLOCK_SIZE bsize) {
   AV1_COMMON *const cm = &pbi->common;
   const int bw = mi_size_wide[bsize];
@@ -1510,11 +1734,16 @@ static void decode_token_and_recon_block(AV1Decoder *const pbi,
   const int x_mis = AOMMIN(bw, cm->mi_cols - mi_col);
   const int y_mis = AOMMIN(bh, cm->mi_rows - mi_row);
 
-  set_offsets(cm, xd, bsize, mi_row, mi_col, bw, bh, x_mis, y_mis);
+  if (is_row_mt_recon(rc)) {
+    set_block_offsets(cm, xd, bsize, mi_row, mi_col, bw, bh);
+  } else {
+    set_offsets(cm, xd, bsize, mi_row, mi_col, bw, bh, x_mis, y_mis);
+    if (is_row_mt_parse(rc)) row_mt_store_block(xd, rc, mi_row, mi_col, bsize);
+  }
   MB_MODE_INFO *mbmi = &xd->mi[0]->mbmi;
 
 #if CONFIG_DELTA_Q
-  if (cm->delta_q_present_flag) {
+  if (cm->delta_q_present_flag && !is_row_mt_recon(rc)) {
     int i;
     for (i = 0; i < MAX_SEGMENTS; i++) {
       xd->plane[0].seg_dequant[i][0] =
@@ -1533,11 +1762,13 @@ static void decode_token_and_recon_block(AV1Decoder *const pbi,
   }
 #endif
 
+  if (mbmi->skip && !is_row_mt_recon(rc)) {
 #if CONFIG_CB4X4
-  if (mbmi->skip) reset_skip_context(xd, bsize);
+    reset_skip_context(xd, bsize);
 #else
-  if (mbmi->skip) reset_skip_context(xd, AOMMAX(BLOCK_8X8, bsize));
+    reset_skip_context(xd, AOMMAX(BLOCK_8X8, bsize));
 #endif
+  }
 
 #if CONFIG_COEF_INTERLEAVE
   {
@@ -1583,15 +1814,16 @@ static void decode_token_and_recon_block(AV1Decoder *const pbi,
       for (row_y = 0; row_y < tu_num_h_y; row_y++) {
         for (col_y = 0; col_y < tu_num_w_y; col_y++) {
           // luma
-          predict_and_reconstruct_intra_block(
-              cm, xd, r, mbmi, 0, row_y * tx_sz_y, col_y * tx_sz_y, tx_log2_y);
+          predict_and_reconstruct_intra_block(cm, xd, r, rc, mbmi, 0,
+                                              row_y * tx_sz_y, col_y * tx_sz_y,
+                                              tx_log2_y);
           // chroma
           if (tu_idx_c < tu_num_c) {
             row_c = (tu_idx_c / tu_num_w_c) * tx_sz_c;
             col_c = (tu_idx_c % tu_num_w_c) * tx_sz_c;
-            predict_and_reconstruct_intra_block(cm, xd, r, mbmi, 1, row_c,
+            predict_and_reconstruct_intra_block(cm, xd, r, rc, mbmi, 1, row_c,
                                                 col_c, tx_log2_c);
-            predict_and_reconstruct_intra_block(cm, xd, r, mbmi, 2, row_c,
+            predict_and_reconstruct_intra_block(cm, xd, r, rc, mbmi, 2, row_c,
                                                 col_c, tx_log2_c);
             tu_idx_c++;
           }
@@ -1602,10 +1834,10 @@ static void decode_token_and_recon_block(AV1Decoder *const pbi,
       while (tu_idx_c < tu_num_c) {
         row_c = (tu_idx_c / tu_num_w_c) * tx_sz_c;
         col_c = (tu_idx_c % tu_num_w_c) * tx_sz_c;
-        predict_and_reconstruct_intra_block(cm, xd, r, mbmi, 1, row_c, col_c,
-                                            tx_log2_c);
-        predict_and_reconstruct_intra_block(cm, xd, r, mbmi, 2, row_c, col_c,
-                                            tx_log2_c);
+        predict_and_reconstruct_intra_block(cm, xd, r, rc, mbmi, 1, row_c,
+                                            col_c, tx_log2_c);
+        predict_and_reconstruct_intra_block(cm, xd, r, rc, mbmi, 2, row_c,
+                                            col_c, tx_log2_c);
         tu_idx_c++;
       }
     } else {
@@ -1622,17 +1854,19 @@ static void decode_token_and_recon_block(AV1Decoder *const pbi,
         for (row_y = 0; row_y < tu_num_h_y; row_y++) {
           for (col_y = 0; col_y < tu_num_w_y; col_y++) {
             // luma
-            eobtotal += reconstruct_inter_block(cm, xd, r, mbmi->segment_id, 0,
-                                                row_y * tx_sz_y,
-                                                col_y * tx_sz_y, tx_log2_y);
+            eobtotal += reconstruct_inter_block(
+                cm, xd, r, rc, mbmi->segment_id, 0, row_y * tx_sz_y,
+                col_y * tx_sz_y, tx_log2_y);
             // chroma
             if (tu_idx_c < tu_num_c) {
               row_c = (tu_idx_c / tu_num_w_c) * tx_sz_c;
               col_c = (tu_idx_c % tu_num_w_c) * tx_sz_c;
-              eobtotal += reconstruct_inter_block(cm, xd, r, mbmi->segment_id,
-                                                  1, row_c, col_c, tx_log2_c);
-              eobtotal += reconstruct_inter_block(cm, xd, r, mbmi->segment_id,
-                                                  2, row_c, col_c, tx_log2_c);
+              eobtotal +=
+                  reconstruct_inter_block(cm, xd, r, rc, mbmi->segment_id, 1,
+                                          row_c, col_c, tx_log2_c);
+              eobtotal +=
+                  reconstruct_inter_block(cm, xd, r, rc, mbmi->segment_id, 2,
+                                          row_c, col_c, tx_log2_c);
               tu_idx_c++;
             }
           }
@@ -1642,10 +1876,10 @@ static void decode_token_and_recon_block(AV1Decoder *const pbi,
         while (tu_idx_c < tu_num_c) {
           row_c = (tu_idx_c / tu_num_w_c) * tx_sz_c;
           col_c = (tu_idx_c % tu_num_w_c) * tx_sz_c;
-          eobtotal += reconstruct_inter_block(cm, xd, r, mbmi->segment_id, 1,
-                                              row_c, col_c, tx_log2_c);
-          eobtotal += reconstruct_inter_block(cm, xd, r, mbmi->segment_id, 2,
-                                              row_c, col_c, tx_log2_c);
+          eobtotal += reconstruct_inter_block(cm, xd, r, rc, mbmi->segment_id,
+                                              1, row_c, col_c, tx_log2_c);
+          eobtotal += reconstruct_inter_block(cm, xd, r, rc, mbmi->segment_id,
+                                              2, row_c, col_c, tx_log2_c);
           tu_idx_c++;
         }
 
@@ -1660,8 +1894,13 @@ static void decode_token_and_recon_block(AV1Decoder *const pbi,
     int plane;
 #if CONFIG_PALETTE
     for (plane = 0; plane <= 1; ++plane) {
-      if (mbmi->palette_mode_info.palette_size[plane])
+      if (!mbmi->palette_mode_info.palette_size[plane]) continue;
+      if (is_row_mt_recon(rc)) {
+        row_mt_load_color_map(xd, rc, plane);
+      } else {
         av1_decode_palette_tokens(xd, plane, r);
+        if (is_row_mt_parse(rc)) row_mt_store_color_map(xd, rc, plane);
+      }
     }
 #endif  // CONFIG_PALETTE
     for (plane = 0; plane < MAX_MB_PLANE; ++plane) {
@@ -1691,71 +1930,12 @@ static void decode_token_and_recon_block(AV1Decoder *const pbi,
 
       for (row = 0; row < max_blocks_high; row += stepr)
         for (col = 0; col < max_blocks_wide; col += stepc)
-          predict_and_reconstruct_intra_block(cm, xd, r, mbmi, plane, row, col,
-                                              tx_size);
+          predict_and_reconstruct_intra_block(cm, xd, r, rc, mbmi, plane, row,
+                                              col, tx_size);
     }
   } else {
-    int ref;
-
-    for (ref = 0; ref < 1 + has_second_ref(mbmi); ++ref) {
-      const MV_REFERENCE_FRAME frame = mbmi->ref_frame[ref];
-      RefBuffer *ref_buf = &cm->frame_refs[frame - LAST_FRAME];
-
-      xd->block_refs[ref] = ref_buf;
-      if ((!av1_is_valid_scale(&ref_buf->sf)))
-        aom_internal_error(xd->error_info, AOM_CODEC_UNSUP_BITSTREAM,
-                           "Reference frame has invalid dimensions");
-      av1_setup_pre_planes(xd, ref, ref_buf->buf, mi_row, mi_col, &ref_buf->sf);
-    }
-#if CONFIG_WARPED_MOTION
-    if (mbmi->motion_mode == WARPED_CAUSAL) {
-      int i;
-      assert_motion_mode_valid(WARPED_CAUSAL,
-#if CONFIG_GLOBAL_MOTION && SEPARATE_GLOBAL_MOTION
-                               0, cm->global_motion,
-#endif  // CONFIG_GLOBAL_MOTION && SEPARATE_GLOBAL_MOTION
-                               xd->mi[0]);
-      for (i = 0; i < 3; ++i) {
-        const struct macroblockd_plane *pd = &xd->plane[i];
-
-        av1_warp_plane(&mbmi->wm_params[0],
-#if CONFIG_AOM_HIGHBITDEPTH
-                       xd->cur_buf->flags & YV12_FLAG_HIGHBITDEPTH, xd->bd,
-#endif  // CONFIG_AOM_HIGHBITDEPTH
-                       pd->pre[0].buf0, pd->pre[0].width, pd->pre[0].height,
-                       pd->pre[0].stride, pd->dst.buf,
-                       ((mi_col * MI_SIZE) >> pd->subsampling_x),
-                       ((mi_row * MI_SIZE) >> pd->subsampling_y),
-                       xd->n8_w * (MI_SIZE >> pd->subsampling_x),
-                       xd->n8_h * (MI_SIZE >> pd->subsampling_y),
-                       pd->dst.stride, pd->subsampling_x, pd->subsampling_y, 16,
-                       16, 0);
-      }
-    } else {
-#endif  // CONFIG_WARPED_MOTION
-#if CONFIG_CB4X4
-      av1_build_inter_predictors_sb(xd, mi_row, mi_col, NULL, bsize);
-#else
-    av1_build_inter_predictors_sb(xd, mi_row, mi_col, NULL,
-                                  AOMMAX(bsize, BLOCK_8X8));
-#endif
-#if CONFIG_WARPED_MOTION
-    }
-#endif  // CONFIG_WARPED_MOTION
-#if CONFIG_MOTION_VAR
-    if (mbmi->motion_mode == OBMC_CAUSAL) {
-      assert_motion_mode_valid(OBMC_CAUSAL,
-#if CONFIG_GLOBAL_MOTION && SEPARATE_GLOBAL_MOTION
-                               0, cm->global_motion,
-#endif  // CONFIG_GLOBAL_MOTION && SEPARATE_GLOBAL_MOTION
-                               xd->mi[0]);
-#if CONFIG_NCOBMC
-      av1_build_ncobmc_inter_predictors_sb(cm, xd, mi_row, mi_col);
-#else
-      av1_build_obmc_inter_predictors_sb(cm, xd, mi_row, mi_col);
-#endif
-    }
-#endif  // CONFIG_MOTION_VAR
+    if (!is_row_mt_parse(rc))
+      predict_inter_block(cm, xd, mi_row, mi_col, bsize);
 
     // Reconstruction
     if (!mbmi->skip) {
@@ -1791,15 +1971,15 @@ static void decode_token_and_recon_block(AV1Decoder *const pbi,
         const int bw_var_tx = tx_size_wide_unit[max_tx_size];
         for (row = 0; row < max_blocks_high; row += bh_var_tx)
           for (col = 0; col < max_blocks_wide; col += bw_var_tx)
-            decode_reconstruct_tx(cm, xd, r, mbmi, plane, plane_bsize, row, col,
-                                  max_tx_size, &eobtotal);
+            decode_reconstruct_tx(cm, xd, r, rc, mbmi, plane, plane_bsize, row,
+                                  col, max_tx_size, &eobtotal);
 #else
         const TX_SIZE tx_size = get_tx_size(plane, xd);
         const int stepr = tx_size_high_unit[tx_size];
         const int stepc = tx_size_wide_unit[tx_size];
         for (row = 0; row < max_blocks_high; row += stepr)
           for (col = 0; col < max_blocks_wide; col += stepc)
-            eobtotal += reconstruct_inter_block(cm, xd, r, mbmi->segment_id,
+            eobtotal += reconstruct_inter_block(cm, xd, r, rc, mbmi->segment_id,
                                                 plane, row, col, tx_size);
 #endif
       }
@@ -1807,8 +1987,10 @@ static void decode_token_and_recon_block(AV1Decoder *const pbi,
   }
 #endif  // CONFIG_COEF_INTERLEAVE
 
-  int reader_corrupted_flag = aom_reader_has_error(r);
-  aom_merge_corrupted_flag(&xd->corrupted, reader_corrupted_flag);
+  if (!is_row_mt_recon(rc)) {
+    int reader_corrupted_flag = aom_reader_has_error(r);
+    aom_merge_corrupted_flag(&xd->corrupted, reader_corrupted_flag);
+  }
 }
 
 #if CONFIG_NCOBMC && CONFIG_MOTION_VAR
@@ -1838,22 +2020,22 @@ static void detoken_and_recon_sb(AV1Decoder *const pbi, MACROBLOCKD *const xd,
   if (!hbs && !unify_bsize) {
     xd->bmode_blocks_wl = 1 >> !!(partition & PARTITION_VERT);
     xd->bmode_blocks_hl = 1 >> !!(partition & PARTITION_HORZ);
-    decode_token_and_recon_block(pbi, xd, mi_row, mi_col, r, subsize);
+    decode_token_and_recon_block(pbi, xd, mi_row, mi_col, r, NULL, subsize);
   } else {
     switch (partition) {
       case PARTITION_NONE:
-        decode_token_and_recon_block(pbi, xd, mi_row, mi_col, r, bsize);
+        decode_token_and_recon_block(pbi, xd, mi_row, mi_col, r, NULL, bsize);
         break;
       case PARTITION_HORZ:
-        decode_token_and_recon_block(pbi, xd, mi_row, mi_col, r, subsize);
+        decode_token_and_recon_block(pbi, xd, mi_row, mi_col, r, NULL, subsize);
         if (has_rows)
-          decode_token_and_recon_block(pbi, xd, mi_row + hbs, mi_col, r,
+          decode_token_and_recon_block(pbi, xd, mi_row + hbs, mi_col, r, NULL,
                                        subsize);
         break;
       case PARTITION_VERT:
-        decode_token_and_recon_block(pbi, xd, mi_row, mi_col, r, subsize);
+        decode_token_and_recon_block(pbi, xd, mi_row, mi_col, r, NULL, subsize);
         if (has_cols)
-          decode_token_and_recon_block(pbi, xd, mi_row, mi_col + hbs, r,
+          decode_token_and_recon_block(pbi, xd, mi_row, mi_col + hbs, r, NULL,
                                        subsize);
         break;
       case PARTITION_SPLIT:
@@ -1864,26 +2046,32 @@ static void detoken_and_recon_sb(AV1Decoder *const pbi, MACROBLOCKD *const xd,
         break;
 #if CONFIG_EXT_PARTITION_TYPES
       case PARTITION_HORZ_A:
-        decode_token_and_recon_block(pbi, xd, mi_row, mi_col, r, bsize2);
-        decode_token_and_recon_block(pbi, xd, mi_row, mi_col + hbs, r, bsize2);
-        decode_token_and_recon_block(pbi, xd, mi_row + hbs, mi_col, r, subsize);
+        decode_token_and_recon_block(pbi, xd, mi_row, mi_col, r, NULL, bsize2);
+        decode_token_and_recon_block(pbi, xd, mi_row, mi_col + hbs, r, NULL,
+                                     bsize2);
+        decode_token_and_recon_block(pbi, xd, mi_row + hbs, mi_col, r, NULL,
+                                     subsize);
         break;
       case PARTITION_HORZ_B:
-        decode_token_and_recon_block(pbi, xd, mi_row, mi_col, r, subsize);
-        decode_token_and_recon_block(pbi, xd, mi_row + hbs, mi_col, r, bsize2);
-        decode_token_and_recon_block(pbi, xd, mi_row + hbs, mi_col + hbs, r,
+        decode_token_and_recon_block(pbi, xd, mi_row, mi_col, r, NULL, subsize);
+        decode_token_and_recon_block(pbi, xd, mi_row + hbs, mi_col, r, NULL,
                                      bsize2);
+        decode_token_and_recon_block(pbi, xd, mi_row + hbs, mi_col + hbs, r,
+                                     NULL, bsize2);
         break;
       case PARTITION_VERT_A:
-        decode_token_and_recon_block(pbi, xd, mi_row, mi_col, r, bsize2);
-        decode_token_and_recon_block(pbi, xd, mi_row + hbs, mi_col, r, bsize2);
-        decode_token_and_recon_block(pbi, xd, mi_row, mi_col + hbs, r, subsize);
+        decode_token_and_recon_block(pbi, xd, mi_row, mi_col, r, NULL, bsize2);
+        decode_token_and_recon_block(pbi, xd, mi_row + hbs, mi_col, r, NULL,
+                                     bsize2);
+        decode_token_and_recon_block(pbi, xd, mi_row, mi_col + hbs, r, NULL,
+                                     subsize);
         break;
       case PARTITION_VERT_B:
-        decode_token_and_recon_block(pbi, xd, mi_row, mi_col, r, subsize);
-        decode_token_and_recon_block(pbi, xd, mi_row, mi_col + hbs, r, bsize2);
-        decode_token_and_recon_block(pbi, xd, mi_row + hbs, mi_col + hbs, r,
+        decode_token_and_recon_block(pbi, xd, mi_row, mi_col, r, NULL, subsize);
+        decode_token_and_recon_block(pbi, xd, mi_row, mi_col + hbs, r, NULL,
                                      bsize2);
+        decode_token_and_recon_block(pbi, xd, mi_row + hbs, mi_col + hbs, r,
+                                     NULL, bsize2);
         break;
 #endif
       default: assert(0 && "Invalid partition type");
@@ -1897,6 +2085,7 @@ static void decode_block(AV1Decoder *const pbi, MACROBLOCKD *const xd,
                          int supertx_enabled,
 #endif  // CONFIG_SUPERTX
                          int mi_row, int mi_col, aom_reader *r,
+                         DecRowCursor *const rc,
 #if CONFIG_EXT_PARTITION_TYPES
                          PARTITION_TYPE partition,
 #endif  // CONFIG_EXT_PARTITION_TYPES
@@ -1914,7 +2103,9 @@ static void decode_block(AV1Decoder *const pbi, MACROBLOCKD *const xd,
 #if CONFIG_SUPERTX
   if (!supertx_enabled)
 #endif  // CONFIG_SUPERTX
-    decode_token_and_recon_block(pbi, xd, mi_row, mi_col, r, bsize);
+    decode_token_and_recon_block(pbi, xd, mi_row, mi_col, r, rc, bsize);
+#else
+  (void)rc;
 #endif
 }
 
@@ -2003,7 +2194,8 @@ static void decode_partition(AV1Decoder *const pbi, MACROBLOCKD *const xd,
                              int supertx_enabled,
 #endif
                              int mi_row, int mi_col, aom_reader *r,
-                             BLOCK_SIZE bsize, int n4x4_l2) {
+                             DecRowCursor *const rc, BLOCK_SIZE bsize,
+                             int n4x4_l2) {
   AV1_COMMON *const cm = &pbi->common;
   const int n8x8_l2 = n4x4_l2 - 1;
   const int num_8x8_wh = mi_size_wide[bsize];
@@ -2060,7 +2252,7 @@ static void decode_partition(AV1Decoder *const pbi, MACROBLOCKD *const xd,
 #if CONFIG_SUPERTX
                  supertx_enabled,
 #endif  // CONFIG_SUPERTX
-                 mi_row, mi_col, r,
+                 mi_row, mi_col, r, rc,
 #if CONFIG_EXT_PARTITION_TYPES
                  partition,
 #endif  // CONFIG_EXT_PARTITION_TYPES
@@ -2072,7 +2264,7 @@ static void decode_partition(AV1Decoder *const pbi, MACROBLOCKD *const xd,
 #if CONFIG_SUPERTX
                      supertx_enabled,
 #endif  // CONFIG_SUPERTX
-                     mi_row, mi_col, r,
+                     mi_row, mi_col, r, rc,
 #if CONFIG_EXT_PARTITION_TYPES
                      partition,
 #endif  // CONFIG_EXT_PARTITION_TYPES
@@ -2083,7 +2275,7 @@ static void decode_partition(AV1Decoder *const pbi, MACROBLOCKD *const xd,
 #if CONFIG_SUPERTX
                      supertx_enabled,
 #endif  // CONFIG_SUPERTX
-                     mi_row, mi_col, r,
+                     mi_row, mi_col, r, rc,
 #if CONFIG_EXT_PARTITION_TYPES
                      partition,
 #endif  // CONFIG_EXT_PARTITION_TYPES
@@ -2093,7 +2285,7 @@ static void decode_partition(AV1Decoder *const pbi, MACROBLOCKD *const xd,
 #if CONFIG_SUPERTX
                        supertx_enabled,
 #endif  // CONFIG_SUPERTX
-                       mi_row + hbs, mi_col, r,
+                       mi_row + hbs, mi_col, r, rc,
 #if CONFIG_EXT_PARTITION_TYPES
                        partition,
 #endif  // CONFIG_EXT_PARTITION_TYPES
@@ -2104,7 +2296,7 @@ static void decode_partition(AV1Decoder *const pbi, MACROBLOCKD *const xd,
 #if CONFIG_SUPERTX
                      supertx_enabled,
 #endif  // CONFIG_SUPERTX
-                     mi_row, mi_col, r,
+                     mi_row, mi_col, r, rc,
 #if CONFIG_EXT_PARTITION_TYPES
                      partition,
 #endif  // CONFIG_EXT_PARTITION_TYPES
@@ -2114,7 +2306,7 @@ static void decode_partition(AV1Decoder *const pbi, MACROBLOCKD *const xd,
 #if CONFIG_SUPERTX
                        supertx_enabled,
 #endif  // CONFIG_SUPERTX
-                       mi_row, mi_col + hbs, r,
+                       mi_row, mi_col + hbs, r, rc,
 #if CONFIG_EXT_PARTITION_TYPES
                        partition,
 #endif  // CONFIG_EXT_PARTITION_TYPES
@@ -2125,22 +2317,23 @@ static void decode_partition(AV1Decoder *const pbi, MACROBLOCKD *const xd,
 #if CONFIG_SUPERTX
                          supertx_enabled,
 #endif  // CONFIG_SUPERTX
-                         mi_row, mi_col, r, subsize, n8x8_l2);
+                         mi_row, mi_col, r, rc, subsize, n8x8_l2);
         decode_partition(pbi, xd,
 #if CONFIG_SUPERTX
                          supertx_enabled,
 #endif  // CONFIG_SUPERTX
-                         mi_row, mi_col + hbs, r, subsize, n8x8_l2);
+                         mi_row, mi_col + hbs, r, rc, subsize, n8x8_l2);
         decode_partition(pbi, xd,
 #if CONFIG_SUPERTX
                          supertx_enabled,
 #endif  // CONFIG_SUPERTX
-                         mi_row + hbs, mi_col, r, subsize, n8x8_l2);
+                         mi_row + hbs, mi_col, r, rc, subsize, n8x8_l2);
         decode_partition(pbi, xd,
 #if CONFIG_SUPERTX
                          supertx_enabled,
 #endif  // CONFIG_SUPERTX
-                         mi_row + hbs, mi_col + hbs, r, subsize, n8x8_l2);
+                         mi_row + hbs, mi_col + hbs, r, rc, subsize,
+                         n8x8_l2);
         break;
 #if CONFIG_EXT_PARTITION_TYPES
       case PARTITION_HORZ_A:
@@ -2148,68 +2341,68 @@ static void decode_partition(AV1Decoder *const pbi, MACROBLOCKD *const xd,
 #if CONFIG_SUPERTX
                      supertx_enabled,
 #endif
-                     mi_row, mi_col, r, partition, bsize2);
+                     mi_row, mi_col, r, rc, partition, bsize2);
         decode_block(pbi, xd,
 #if CONFIG_SUPERTX
                      supertx_enabled,
 #endif
-                     mi_row, mi_col + hbs, r, partition, bsize2);
+                     mi_row, mi_col + hbs, r, rc, partition, bsize2);
         decode_block(pbi, xd,
 #if CONFIG_SUPERTX
                      supertx_enabled,
 #endif
-                     mi_row + hbs, mi_col, r, partition, subsize);
+                     mi_row + hbs, mi_col, r, rc, partition, subsize);
         break;
       case PARTITION_HORZ_B:
         decode_block(pbi, xd,
 #if CONFIG_SUPERTX
                      supertx_enabled,
 #endif
-                     mi_row, mi_col, r, partition, subsize);
+                     mi_row, mi_col, r, rc, partition, subsize);
         decode_block(pbi, xd,
 #if CONFIG_SUPERTX
                      supertx_enabled,
 #endif
-                     mi_row + hbs, mi_col, r, partition, bsize2);
+                     mi_row + hbs, mi_col, r, rc, partition, bsize2);
         decode_block(pbi, xd,
 #if CONFIG_SUPERTX
                      supertx_enabled,
 #endif
-                     mi_row + hbs, mi_col + hbs, r, partition, bsize2);
+                     mi_row + hbs, mi_col + hbs, r, rc, partition, bsize2);
         break;
       case PARTITION_VERT_A:
         decode_block(pbi, xd,
 #if CONFIG_SUPERTX
                      supertx_enabled,
 #endif
-                     mi_row, mi_col, r, partition, bsize2);
+                     mi_row, mi_col, r, rc, partition, bsize2);
         decode_block(pbi, xd,
 #if CONFIG_SUPERTX
                      supertx_enabled,
 #endif
-                     mi_row + hbs, mi_col, r, partition, bsize2);
+                     mi_row + hbs, mi_col, r, rc, partition, bsize2);
         decode_block(pbi, xd,
 #if CONFIG_SUPERTX
                      supertx_enabled,
 #endif
-                     mi_row, mi_col + hbs, r, partition, subsize);
+                     mi_row, mi_col + hbs, r, rc, partition, subsize);
         break;
       case PARTITION_VERT_B:
         decode_block(pbi, xd,
 #if CONFIG_SUPERTX
                      supertx_enabled,
 #endif
-                     mi_row, mi_col, r, partition, subsize);
+                     mi_row, mi_col, r, rc, partition, subsize);
         decode_block(pbi, xd,
 #if CONFIG_SUPERTX
                      supertx_enabled,
 #endif
-                     mi_row, mi_col + hbs, r, partition, bsize2);
+                     mi_row, mi_col + hbs, r, rc, partition, bsize2);
         decode_block(pbi, xd,
 #if CONFIG_SUPERTX
                      supertx_enabled,
 #endif
-                     mi_row + hbs, mi_col + hbs, r, partition, bsize2);
+                     mi_row + hbs, mi_col + hbs, r, rc, partition, bsize2);
         break;
 #endif
       default: assert(0 && "Invalid partition type");
@@ -2306,8 +2499,9 @@ static void decode_partition(AV1Decoder *const pbi, MACROBLOCKD *const xd,
 
         for (row = 0; row < max_blocks_high; row += stepr)
           for (col = 0; col < max_blocks_wide; col += stepc)
-            eobtotal += reconstruct_inter_block(
-                cm, xd, r, mbmi->segment_id_supertx, i, row, col, tx_size);
+            eobtotal += reconstruct_inter_block(cm, xd, r, NULL,
+                                                mbmi->segment_id_supertx, i,
+                                                row, col, tx_size);
       }
       if ((unify_bsize || !(subsize < BLOCK_8X8)) && eobtotal == 0) skip = 1;
     }
@@ -3164,6 +3358,7 @@ static void get_tile_buffers(
 
       // Get the whole of the last column, otherwise stop at the required tile.
       for (r = 0; r < (is_last ? tile_rows : tile_rows_end); ++r) {
+        tile_buffers[r][c].row = r;
         tile_buffers[r][c].col = c;
 
         get_tile_buffer(tile_col_data_end[c], &pbi->common.error, &data,
@@ -3179,6 +3374,7 @@ static void get_tile_buffers(
       data = tile_col_data_end[c - 1];
 
       for (r = 0; r < tile_rows; ++r) {
+        tile_buffers[r][c].row = r;
         tile_buffers[r][c].col = c;
 
         get_tile_buffer(tile_col_data_end[c], &pbi->common.error, &data,
@@ -3253,6 +3449,7 @@ static void get_tile_buffers(
       const int is_last = (r == tile_rows - 1) && (c == tile_cols - 1);
       hdr_offset = (tc && tc == first_tile_in_tg) ? hdr_size : 0;
 
+      buf->row = r;
       buf->col = c;
       if (hdr_offset) {
         init_read_bit_buffer(pbi, &rb_tg_hdr, data, data_end, clear_data);
@@ -3286,6 +3483,7 @@ static void get_tile_buffers(
     for (c = 0; c < tile_cols; ++c) {
       const int is_last = (r == tile_rows - 1) && (c == tile_cols - 1);
       TileBufferDec *const buf = &tile_buffers[r][c];
+      buf->row = r;
       buf->col = c;
       get_tile_buffer(data_end, pbi->tile_size_bytes, is_last, &cm->error,
                       &data, pbi->decrypt_cb, pbi->decrypt_state, buf);
@@ -3345,6 +3543,220 @@ static void daala_dec_init(AV1_COMMON *const cm, daala_dec_ctx *daala_dec,
 }
 #endif  // #if CONFIG_PVQ
 
+// Creates the tile worker threads shared by tile-based and row-based
+// multi-threaded decoding, or borrows them from the worker pool shared by the
+// frame workers.
+static void init_tile_workers(AV1Decoder *pbi) {
+  AV1_COMMON *const cm = &pbi->common;
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+  int i;
+
+  if (pbi->worker_pool != NULL) {
+    if (pbi->tile_worker_data == NULL) {
+      assert((sizeof(*pbi->tile_worker_data) % 16) == 0);
+      CHECK_MEM_ERROR(cm, pbi->tile_worker_data,
+                      aom_memalign(32, pbi->max_threads *
+                                           sizeof(*pbi->tile_worker_data)));
+      memset(pbi->tile_worker_data, 0,
+             pbi->max_threads * sizeof(*pbi->tile_worker_data));
+      winterface->init(&pbi->serial_tile_worker);
+    }
+    if (pbi->num_tile_workers == 0) {
+      pbi->num_tile_workers = av1_dec_worker_pool_acquire(
+          pbi->worker_pool, pbi->max_threads, &pbi->tile_workers);
+      if (pbi->num_tile_workers == 0) {
+        pbi->tile_workers = &pbi->serial_tile_worker;
+        pbi->num_tile_workers = 1;
+      }
+    }
+    return;
+  }
+
+  // TODO(jzern): See if we can remove the restriction of passing in max
+  // threads to the decoder.
+  if (pbi->num_tile_workers == 0) {
+    const int num_threads = pbi->max_threads;
+    CHECK_MEM_ERROR(cm, pbi->tile_workers,
+                    aom_malloc(num_threads * sizeof(*pbi->tile_workers)));
+    // Ensure tile data offsets will be properly aligned. This may fail on
+    // platforms without DECLARE_ALIGNED().
+    assert((sizeof(*pbi->tile_worker_data) % 16) == 0);
+    CHECK_MEM_ERROR(
+        cm, pbi->tile_worker_data,
+        aom_memalign(32, num_threads * sizeof(*pbi->tile_worker_data)));
+    memset(pbi->tile_worker_data, 0,
+           num_threads * sizeof(*pbi->tile_worker_data));
+    for (i = 0; i < num_threads; ++i) {
+      AVxWorker *const worker = &pbi->tile_workers[i];
+      ++pbi->num_tile_workers;
+
+      winterface->init(worker);
+      if (pbi->pool_client.pool != NULL) worker->pool = &pbi->pool_client;
+      if (i < num_threads - 1 && !winterface->reset(worker)) {
+        aom_internal_error(&cm->error, AOM_CODEC_ERROR,
+                           "Tile decoder thread creation failed");
+      }
+    }
+  }
+}
+
+// Row-based multi-threading is only supported by the configurations where the
+// tokens of a block can be read without reconstructing it.
+#define ROW_MT_SUPPORTED                                        \
+  (!CONFIG_PVQ && !CONFIG_SUPERTX && !CONFIG_COEF_INTERLEAVE && \
+   !(CONFIG_MOTION_VAR && CONFIG_NCOBMC))
+
+static void alloc_row_mt_data(AV1Decoder *pbi) {
+  AV1_COMMON *const cm = &pbi->common;
+  const int sb_rows = mi_rows_aligned_to_sb(cm) >> cm->mib_size_log2;
+
+  init_tile_workers(pbi);
+
+  if (pbi->num_row_bufs < sb_rows) {
+    av1_free_row_mt_buffers(pbi);
+    CHECK_MEM_ERROR(cm, pbi->row_bufs,
+                    aom_calloc(sb_rows, sizeof(*pbi->row_bufs)));
+    pbi->num_row_bufs = sb_rows;
+  }
+
+  if (pbi->row_mt_sync.rows < sb_rows) {
+    av1_dec_row_mt_dealloc(&pbi->row_mt_sync);
+    av1_dec_row_mt_alloc(&pbi->row_mt_sync, cm, sb_rows);
+  }
+}
+
+static void init_row_mt_cursor(DecRowCursor *const rc, DecRowBuffer *buf,
+                               int parse) {
+  rc->buf = buf;
+  rc->parse = parse;
+  rc->block_idx = 0;
+  rc->txb_idx = 0;
+  rc->coeff_idx = 0;
+  rc->color_idx = 0;
+  if (parse) {
+    buf->num_blocks = 0;
+    buf->num_txbs = 0;
+    buf->num_coeffs = 0;
+#if CONFIG_PALETTE
+    buf->num_colors = 0;
+#endif  // CONFIG_PALETTE
+  }
+}
+
+// Reconstructs the parsed superblock rows of a tile. The workers take the rows
+// in order as soon as they are parsed, and each stays behind the above-right
+// superblock of the row above it.
+static int row_mt_worker_hook(TileWorkerData *const tile_data,
+                              const TileInfo *const tile) {
+  AV1Decoder *const pbi = tile_data->pbi;
+  AV1_COMMON *const cm = &pbi->common;
+  AV1DecRowMTSync *const row_mt_sync = &pbi->row_mt_sync;
+  const int sb_cols =
+      (tile->mi_col_end - tile->mi_col_start + cm->mib_size - 1) >>
+      cm->mib_size_log2;
+  volatile int sb_row = -1;
+
+  if (setjmp(tile_data->error_info.jmp)) {
+    tile_data->error_info.setjmp = 0;
+    aom_merge_corrupted_flag(&tile_data->xd.corrupted, 1);
+    // Unblock the worker waiting on the row of this worker.
+    if (sb_row >= 0)
+      av1_dec_row_mt_sync_write(row_mt_sync, sb_row, sb_cols - 1, sb_cols);
+    return 0;
+  }
+
+  tile_data->error_info.setjmp = 1;
+  tile_data->xd.error_info = &tile_data->error_info;
+
+  while ((sb_row = av1_dec_row_mt_get_row(row_mt_sync)) >= 0) {
+    DecRowCursor rc;
+    int sb_col;
+
+    init_row_mt_cursor(&rc, &pbi->row_bufs[sb_row], 0);
+    for (sb_col = 0; sb_col < sb_cols; ++sb_col) {
+      const int mi_col_end =
+          tile->mi_col_start + ((sb_col + 1) << cm->mib_size_log2);
+
+      av1_dec_row_mt_sync_read(row_mt_sync, sb_row, sb_col);
+      while (rc.block_idx < rc.buf->num_blocks &&
+             rc.buf->blocks[rc.block_idx].mi_col < mi_col_end) {
+        const DecBlockInfo *const block = &rc.buf->blocks[rc.block_idx++];
+        decode_token_and_recon_block(pbi, &tile_data->xd, block->mi_row,
+                                     block->mi_col, NULL, &rc, block->bsize);
+      }
+      av1_dec_row_mt_sync_write(row_mt_sync, sb_row, sb_col, sb_cols);
+    }
+  }
+  tile_data->error_info.setjmp = 0;
+  return !tile_data->xd.corrupted;
+}
+
+// Returns the number of workers reconstructing the rows of a tile.
+static int get_row_mt_workers(const AV1Decoder *pbi, const TileInfo *tile) {
+  const AV1_COMMON *const cm = &pbi->common;
+  const int sb_rows =
+      (tile->mi_row_end - tile->mi_row_start + cm->mib_size - 1) >>
+      cm->mib_size_log2;
+  return AOMMIN(pbi->num_tile_workers, sb_rows);
+}
+
+// Starts the workers that reconstruct the superblock rows of a tile while the
+// calling thread parses them. The last worker is run by the calling thread
+// once the whole tile is parsed.
+static void launch_tile_rows_mt(AV1Decoder *pbi, const TileData *td,
+                                const TileInfo *tile) {
+  AV1_COMMON *const cm = &pbi->common;
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+  const int sb_rows =
+      (tile->mi_row_end - tile->mi_row_start + cm->mib_size - 1) >>
+      cm->mib_size_log2;
+  const int num_workers = get_row_mt_workers(pbi, tile);
+  int i;
+
+  av1_dec_row_mt_start_tile(&pbi->row_mt_sync, sb_rows);
+  pbi->row_mt_tile = *tile;
+
+  for (i = 0; i < num_workers; ++i) {
+    AVxWorker *const worker = &pbi->tile_workers[i];
+    TileWorkerData *const twd = &pbi->tile_worker_data[i];
+    int plane;
+
+    winterface->sync(worker);
+    twd->pbi = pbi;
+    twd->xd = td->xd;
+    twd->xd.corrupted = 0;
+    twd->xd.counts = NULL;
+    av1_zero(twd->dqcoeff);
+    for (plane = 0; plane < MAX_MB_PLANE; ++plane)
+      twd->xd.plane[plane].dqcoeff = twd->dqcoeff;
+#if CONFIG_PALETTE
+    twd->xd.plane[0].color_index_map = twd->color_index_map[0];
+    twd->xd.plane[1].color_index_map = twd->color_index_map[1];
+#endif  // CONFIG_PALETTE
+
+    worker->hook = (AVxWorkerHook)row_mt_worker_hook;
+    worker->data1 = twd;
+    worker->data2 = &pbi->row_mt_tile;
+    worker->had_error = 0;
+    if (i < num_workers - 1) winterface->launch(worker);
+  }
+}
+
+// Joins the reconstruction of a tile once all its rows are parsed.
+static void finish_tile_rows_mt(AV1Decoder *pbi, const TileInfo *tile) {
+  AV1_COMMON *const cm = &pbi->common;
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+  const int num_workers = get_row_mt_workers(pbi, tile);
+  int i;
+
+  winterface->execute(&pbi->tile_workers[num_workers - 1]);
+  for (i = 0; i < num_workers; ++i)
+    pbi->mb.corrupted |= !winterface->sync(&pbi->tile_workers[i]);
+  if (pbi->mb.corrupted)
+    aom_internal_error(&cm->error, AOM_CODEC_CORRUPT_FRAME,
+                       "Failed to decode tile data");
+}
+
 static const uint8_t *decode_tiles(AV1Decoder *pbi, const uint8_t *data,
                                    const uint8_t *data_end) {
   AV1_COMMON *const cm = &pbi->common;
@@ -3372,18 +3784,22 @@ static const uint8_t *decode_tiles(AV1Decoder *pbi, const uint8_t *data,
   const int inv_col_order = pbi->inv_tile_order;
   const int inv_row_order = pbi->inv_tile_order;
 #endif  // CONFIG_EXT_TILE
+  const int row_mt = ROW_MT_SUPPORTED && pbi->row_mt && pbi->max_threads > 1;
   int tile_row, tile_col;
 
 #if CONFIG_SUBFRAME_PROB_UPDATE
   cm->do_subframe_update = n_tiles == 1;
 #endif  // CONFIG_SUBFRAME_PROB_UPDATE
 
+  if (row_mt) alloc_row_mt_data(pbi);
+
   if (cm->lf.filter_level && !cm->skip_loop_filter &&
       pbi->lf_worker.data1 == NULL) {
     CHECK_MEM_ERROR(cm, pbi->lf_worker.data1,
                     aom_memalign(32, sizeof(LFWorkerData)));
     pbi->lf_worker.hook = (AVxWorkerHook)av1_loop_filter_worker;
-    if (pbi->max_threads > 1 && !winterface->reset(&pbi->lf_worker)) {
+    if (pbi->max_threads > 1 && pbi->worker_pool == NULL &&
+        !winterface->reset(&pbi->lf_worker)) {
       aom_internal_error(&cm->error, AOM_CODEC_ERROR,
                          "Loop filter thread creation failed");
     }
@@ -3472,6 +3888,7 @@ static const uint8_t *decode_tiles(AV1Decoder *pbi, const uint8_t *data,
     const int row = inv_row_order ? tile_rows - 1 - tile_row : tile_row;
     int mi_row = 0;
     TileInfo tile_info;
+    struct aom_usec_timer tile_timer;
 
     av1_tile_set_row(&tile_info, cm, row);
 
@@ -3502,10 +3919,24 @@ static const uint8_t *decode_tiles(AV1Decoder *pbi, const uint8_t *data,
       av1_zero_above_context(cm, tile_info.mi_col_start, tile_info.mi_col_end);
 #endif
 
+      dec_timer_start(pbi, &tile_timer);
+      if (row_mt) launch_tile_rows_mt(pbi, td, &tile_info);
+
       for (mi_row = tile_info.mi_row_start; mi_row < tile_info.mi_row_end;
            mi_row += cm->mib_size) {
+        DecRowCursor parse_cursor;
+        DecRowCursor *rc = NULL;
         int mi_col;
 
+        // With row-based multi-threading only the tokens are read here. The
+        // tile workers reconstruct the superblock rows once they are parsed.
+        if (row_mt) {
+          const int sb_row =
+              (mi_row - tile_info.mi_row_start) >> cm->mib_size_log2;
+          init_row_mt_cursor(&parse_cursor, &pbi->row_bufs[sb_row], 1);
+          rc = &parse_cursor;
+        }
+
         av1_zero_left_context(&td->xd);
 
         for (mi_col = tile_info.mi_col_start; mi_col < tile_info.mi_col_end;
@@ -3515,7 +3946,7 @@ static const uint8_t *decode_tiles(AV1Decoder *pbi, const uint8_t *data,
 #if CONFIG_SUPERTX
                            0,
 #endif  // CONFIG_SUPERTX
-                           mi_row, mi_col, &td->bit_reader, cm->sb_size,
+                           mi_row, mi_col, &td->bit_reader, rc, cm->sb_size,
                            b_width_log2_lookup[cm->sb_size]);
 #if CONFIG_NCOBMC && CONFIG_MOTION_VAR
           detoken_and_recon_sb(pbi, &td->xd, mi_row, mi_col, &td->bit_reader,
@@ -3526,6 +3957,12 @@ static const uint8_t *decode_tiles(AV1Decoder *pbi, const uint8_t *data,
         if (pbi->mb.corrupted)
           aom_internal_error(&cm->error, AOM_CODEC_CORRUPT_FRAME,
                              "Failed to decode tile data");
+        if (row_mt) {
+          av1_dec_row_mt_set_parsed(
+              &pbi->row_mt_sync,
+              (mi_row - tile_info.mi_row_start + cm->mib_size) >>
+                  cm->mib_size_log2);
+        }
 #if CONFIG_SUBFRAME_PROB_UPDATE
         if (cm->do_subframe_update &&
             cm->refresh_frame_context == REFRESH_FRAME_CONTEXT_BACKWARD) {
@@ -3540,6 +3977,9 @@ static const uint8_t *decode_tiles(AV1Decoder *pbi, const uint8_t *data,
         }
 #endif  // CONFIG_SUBFRAME_PROB_UPDATE
       }
+      if (row_mt) finish_tile_rows_mt(pbi, &tile_info);
+      dec_timer_add(pbi, &tile_timer,
+                    &pbi->tile_timing[tile_cols * row + col]);
     }
 
     assert(mi_row > 0);
@@ -3564,7 +4004,7 @@ static const uint8_t *decode_tiles(AV1Decoder *pbi, const uint8_t *data,
       winterface->sync(&pbi->lf_worker);
       lf_data->start = lf_start;
       lf_data->stop = lf_end;
-      if (pbi->max_threads > 1) {
+      if (pbi->max_threads > 1 && pbi->worker_pool == NULL) {
         winterface->launch(&pbi->lf_worker);
       } else {
         winterface->execute(&pbi->lf_worker);
@@ -3572,8 +4012,8 @@ static const uint8_t *decode_tiles(AV1Decoder *pbi, const uint8_t *data,
     }
 #endif  // !CONFIG_VAR_TX && !CONFIG_PARALLEL_DEBLOCKING
 
-    // After loopfiltering, the last 7 row pixels in each superblock row may
-    // still be changed by the longest loopfilter of the next superblock row.
+    // Only the motion vectors of the decoded rows are final here; the pixels
+    // are still changed by the in-loop filters applied after decode_tiles().
     if (cm->frame_parallel_decode)
       av1_frameworker_broadcast(pbi->cur_buf, mi_row << cm->mib_size_log2);
   }
@@ -3603,8 +4043,6 @@ static const uint8_t *decode_tiles(AV1Decoder *pbi, const uint8_t *data,
   }
 #endif  // CONFIG_PARALLEL_DEBLOCKING
 #endif  // CONFIG_VAR_TX
-  if (cm->frame_parallel_decode)
-    av1_frameworker_broadcast(pbi->cur_buf, INT_MAX);
 
 #if CONFIG_EXT_TILE
   if (n_tiles == 1) {
@@ -3631,31 +4069,141 @@ static const uint8_t *decode_tiles(AV1Decoder *pbi, const uint8_t *data,
 #endif  // CONFIG_EXT_TILE
 }
 
-static int tile_worker_hook(TileWorkerData *const tile_data,
-                            const TileInfo *const tile) {
+// Returns 1 if tiles from different tile rows can be decoded at the same time.
+// Each tile worker then uses its own above context arrays. The transform size
+// context of CONFIG_VAR_TX is always accessed through AV1_COMMON, so the tile
+// rows are decoded one after the other in that configuration.
+static int tile_rows_independent(const AV1_COMMON *cm) {
+#if CONFIG_VAR_TX
+  (void)cm;
+  return 0;
+#elif CONFIG_DEPENDENT_HORZTILES
+  return !cm->dependent_horz_tiles;
+#else
+  (void)cm;
+  return 1;
+#endif
+}
+
+static void alloc_tile_worker_above_context(AV1_COMMON *cm,
+                                            TileWorkerData *twd) {
+  const int aligned_mi_cols = cm->above_context_alloc_cols;
+  int i;
+
+  if (twd->above_context_alloc_cols >= aligned_mi_cols) return;
+
+  for (i = 0; i < MAX_MB_PLANE; ++i) {
+    aom_free(twd->above_context[i]);
+    twd->above_context[i] = NULL;
+  }
+  aom_free(twd->above_seg_context);
+  twd->above_seg_context = NULL;
+  twd->above_context_alloc_cols = 0;
+
+  for (i = 0; i < MAX_MB_PLANE; ++i) {
+    CHECK_MEM_ERROR(cm, twd->above_context[i],
+                    (ENTROPY_CONTEXT *)aom_calloc(
+                        2 * aligned_mi_cols, sizeof(*twd->above_context[0])));
+  }
+  CHECK_MEM_ERROR(cm, twd->above_seg_context,
+                  (PARTITION_CONTEXT *)aom_calloc(
+                      aligned_mi_cols, sizeof(*twd->above_seg_context)));
+  twd->above_context_alloc_cols = aligned_mi_cols;
+}
+
+// Same as av1_zero_above_context() for the above contexts pointed to by xd.
+static void zero_tile_above_context(const AV1_COMMON *cm, MACROBLOCKD *xd,
+                                    int mi_col_start, int mi_col_end) {
+  const int width = mi_col_end - mi_col_start;
+  const int offset_y = 2 * mi_col_start;
+  const int width_y = 2 * width;
+  const int offset_uv = offset_y >> cm->subsampling_x;
+  const int width_uv = width_y >> cm->subsampling_x;
+
+  av1_zero_array(xd->above_context[0] + offset_y, width_y);
+  av1_zero_array(xd->above_context[1] + offset_uv, width_uv);
+  av1_zero_array(xd->above_context[2] + offset_uv, width_uv);
+  av1_zero_array(xd->above_seg_context + mi_col_start, width);
+}
+
+// Takes the next tile from the tile queue for the worker of tile_data. Returns
+// NULL once the queue is empty.
+static const TileBufferDec *get_next_tile(TileWorkerData *const tile_data) {
   AV1Decoder *const pbi = tile_data->pbi;
-  const AV1_COMMON *const cm = &pbi->common;
-  int mi_row, mi_col;
+  const int job = aom_job_queue_next(
+      &pbi->tile_jobs, (int)(tile_data - pbi->tile_worker_data));
+  return job >= 0 ? &pbi->tile_queue[job] : NULL;
+}
 
-  if (setjmp(tile_data->error_info.jmp)) {
-    tile_data->error_info.setjmp = 0;
-    aom_merge_corrupted_flag(&tile_data->xd.corrupted, 1);
-    return 0;
+static void init_tile_worker_data(TileWorkerData *const twd,
+                                  const TileBufferDec *const buf,
+                                  const uint8_t *data_end) {
+  AV1Decoder *const pbi = twd->pbi;
+  AV1_COMMON *const cm = &pbi->common;
+
+  twd->xd = pbi->mb;
+  twd->xd.corrupted = 0;
+  twd->xd.counts = cm->refresh_frame_context == REFRESH_FRAME_CONTEXT_BACKWARD
+                       ? &twd->counts
+                       : NULL;
+  av1_zero(twd->dqcoeff);
+  av1_tile_init(&twd->xd.tile, cm, buf->row, buf->col);
+  setup_bool_decoder(buf->data, data_end, buf->size, &twd->error_info,
+                     &twd->bit_reader,
+#if CONFIG_ANS && ANS_MAX_SYMBOLS
+                     1 << cm->ans_window_size_log2,
+#endif  // CONFIG_ANS && ANS_MAX_SYMBOLS
+                     pbi->decrypt_cb, pbi->decrypt_state);
+  av1_init_macroblockd(cm, &twd->xd,
+#if CONFIG_PVQ
+                       twd->pvq_ref_coeff,
+#endif
+                       twd->dqcoeff);
+  twd->xd.error_info = &twd->error_info;
+  if (tile_rows_independent(cm)) {
+    int i;
+    for (i = 0; i < MAX_MB_PLANE; ++i)
+      twd->xd.above_context[i] = twd->above_context[i];
+    twd->xd.above_seg_context = twd->above_seg_context;
   }
+#if CONFIG_PVQ
+  daala_dec_init(cm, &twd->xd.daala_dec, &twd->bit_reader);
+  twd->xd.daala_dec.state.adapt = &twd->tctx.pvq_context;
+#endif
+#if CONFIG_EC_ADAPT
+  // Initialise the tile context from the frame context
+  twd->tctx = *cm->fc;
+  twd->xd.tile_ctx = &twd->tctx;
+#endif
+#if CONFIG_PALETTE
+  twd->xd.plane[0].color_index_map = twd->color_index_map[0];
+  twd->xd.plane[1].color_index_map = twd->color_index_map[1];
+#endif  // CONFIG_PALETTE
+}
 
-  tile_data->error_info.setjmp = 1;
-  tile_data->xd.error_info = &tile_data->error_info;
+static void decode_tile_mt(TileWorkerData *const tile_data,
+                           const TileInfo *const tile) {
+  AV1Decoder *const pbi = tile_data->pbi;
+  AV1_COMMON *const cm = &pbi->common;
+  int mi_row, mi_col;
+
+  if (tile_rows_independent(cm)) {
+    zero_tile_above_context(cm, &tile_data->xd, tile->mi_col_start,
+                            tile->mi_col_end);
+  } else {
 #if CONFIG_DEPENDENT_HORZTILES
 #if CONFIG_TILE_GROUPS
-  if (!cm->dependent_horz_tiles || tile->tg_horz_boundary) {
+    if (!cm->dependent_horz_tiles || tile->mi_row_start == 0 ||
+        tile->tg_horz_boundary) {
 #else
-  if (!cm->dependent_horz_tiles) {
+    if (!cm->dependent_horz_tiles || tile->mi_row_start == 0) {
 #endif
-    av1_zero_above_context(&pbi->common, tile->mi_col_start, tile->mi_col_end);
-  }
+      av1_zero_above_context(cm, tile->mi_col_start, tile->mi_col_end);
+    }
 #else
-  av1_zero_above_context(&pbi->common, tile->mi_col_start, tile->mi_col_end);
+    av1_zero_above_context(cm, tile->mi_col_start, tile->mi_col_end);
 #endif
+  }
 
   for (mi_row = tile->mi_row_start; mi_row < tile->mi_row_end;
        mi_row += cm->mib_size) {
@@ -3663,21 +4211,137 @@ static int tile_worker_hook(TileWorkerData *const tile_data,
 
     for (mi_col = tile->mi_col_start; mi_col < tile->mi_col_end;
          mi_col += cm->mib_size) {
+      av1_update_boundary_info(cm, tile, mi_row, mi_col);
       decode_partition(pbi, &tile_data->xd,
 #if CONFIG_SUPERTX
                        0,
 #endif
-                       mi_row, mi_col, &tile_data->bit_reader, cm->sb_size,
-                       b_width_log2_lookup[cm->sb_size]);
+                       mi_row, mi_col, &tile_data->bit_reader, NULL,
+                       cm->sb_size, b_width_log2_lookup[cm->sb_size]);
 #if CONFIG_NCOBMC && CONFIG_MOTION_VAR
       detoken_and_recon_sb(pbi, &tile_data->xd, mi_row, mi_col,
                            &tile_data->bit_reader, cm->sb_size);
 #endif
     }
+#if !CONFIG_PARALLEL_DEBLOCKING
+    if (pbi->lf_pipeline_overlap && !tile_data->xd.corrupted)
+      av1_loop_filter_pipeline_row_decoded(&pbi->lf_row_sync,
+                                           mi_row >> cm->mib_size_log2);
+#endif  // !CONFIG_PARALLEL_DEBLOCKING
   }
+}
+
+// Decodes tiles from the tile queue until it is empty or a tile fails, then
+// joins the loop filter pipeline if it runs during the decoding.
+static int tile_worker_hook(TileWorkerData *const tile_data,
+                            const uint8_t *data_end) {
+  AV1Decoder *const pbi = tile_data->pbi;
+  const AV1_COMMON *const cm = &pbi->common;
+  const TileBufferDec *buf;
+
+  if (setjmp(tile_data->error_info.jmp)) {
+    tile_data->error_info.setjmp = 0;
+    aom_merge_corrupted_flag(&tile_data->xd.corrupted, 1);
+#if !CONFIG_PARALLEL_DEBLOCKING
+    if (pbi->lf_pipeline_overlap)
+      av1_loop_filter_pipeline_abort(&pbi->lf_row_sync);
+#endif  // !CONFIG_PARALLEL_DEBLOCKING
+    return 0;
+  }
+
+  tile_data->error_info.setjmp = 1;
+  while ((buf = get_next_tile(tile_data)) != NULL) {
+    const int tile_idx = cm->tile_cols * buf->row + buf->col;
+    TileData *const td = pbi->tile_data + tile_idx;
+    struct aom_usec_timer timer;
+
+    dec_timer_start(pbi, &timer);
+    init_tile_worker_data(tile_data, buf, data_end);
+    decode_tile_mt(tile_data, &tile_data->xd.tile);
+    dec_timer_add(pbi, &timer, &pbi->tile_timing[tile_idx]);
+    if (tile_data->xd.corrupted) {
+#if !CONFIG_PARALLEL_DEBLOCKING
+      if (pbi->lf_pipeline_overlap)
+        av1_loop_filter_pipeline_abort(&pbi->lf_row_sync);
+#endif  // !CONFIG_PARALLEL_DEBLOCKING
+      break;
+    }
+
+    // Keep the final state of the tile for the tile context averaging and
+    // for locating the end of the tile data.
+    td->bit_reader = tile_data->bit_reader;
+#if CONFIG_EC_ADAPT
+    td->tctx = tile_data->tctx;
+#endif
+  }
+  tile_data->error_info.setjmp = 0;
+#if !CONFIG_PARALLEL_DEBLOCKING
+  if (pbi->lf_pipeline_overlap && !tile_data->xd.corrupted) {
+    const int worker_idx = (int)(tile_data - pbi->tile_worker_data);
+    av1_loop_filter_pipeline_worker(&pbi->lf_row_sync,
+                                    &pbi->lf_row_sync.lfdata[worker_idx]);
+  }
+#endif  // !CONFIG_PARALLEL_DEBLOCKING
   return !tile_data->xd.corrupted;
 }
 
+#if !CONFIG_PARALLEL_DEBLOCKING
+static int use_lf_pipeline(const AV1Decoder *pbi) {
+#if CONFIG_EXT_TILE
+  // The rows of a single tile row do not cover the frame.
+  if (pbi->dec_tile_row >= 0) return 0;
+#endif  // CONFIG_EXT_TILE
+  (void)pbi;
+#if CONFIG_EXT_PARTITION
+  // The row-based loop filter does not support 128x128 superblocks.
+  return 0;
+#else
+  return 1;
+#endif  // CONFIG_EXT_PARTITION
+}
+
+static void init_lf_pipeline(AV1Decoder *pbi, int decoded) {
+  AV1_COMMON *const cm = &pbi->common;
+  struct AV1LrSyncData *lr_sync = NULL;
+
+#if CONFIG_LOOP_RESTORATION
+  if (cm->rst_info[0].frame_restoration_type != RESTORE_NONE ||
+      cm->rst_info[1].frame_restoration_type != RESTORE_NONE ||
+      cm->rst_info[2].frame_restoration_type != RESTORE_NONE) {
+    lr_sync = &pbi->lr_sync;
+    av1_loop_restoration_rows_init(lr_sync, get_frame_new_buffer(cm), cm,
+                                   cm->rst_info, pbi->num_tile_workers);
+  }
+#endif  // CONFIG_LOOP_RESTORATION
+  av1_loop_filter_pipeline_init(
+      &pbi->lf_row_sync, get_frame_new_buffer(cm), cm, &pbi->mb,
+      cm->skip_loop_filter ? 0 : cm->lf.filter_level,
+      CONFIG_CDEF && !cm->skip_loop_filter, lr_sync, pbi->num_tile_workers,
+      decoded);
+}
+
+// Runs the loop filter pipeline on a decoded frame.
+static void run_lf_pipeline(AV1Decoder *pbi) {
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+  AV1LfSync *const lf_sync = &pbi->lf_row_sync;
+  int i;
+
+  for (i = 0; i < pbi->num_tile_workers; ++i) {
+    AVxWorker *const worker = &pbi->tile_workers[i];
+    worker->hook = (AVxWorkerHook)av1_loop_filter_pipeline_worker;
+    worker->data1 = lf_sync;
+    worker->data2 = &lf_sync->lfdata[i];
+    if (i == pbi->num_tile_workers - 1) {
+      winterface->execute(worker);
+    } else {
+      winterface->launch(worker);
+    }
+  }
+  for (i = 0; i < pbi->num_tile_workers; ++i)
+    winterface->sync(&pbi->tile_workers[i]);
+}
+#endif  // !CONFIG_PARALLEL_DEBLOCKING
+
 // sorts in descending order
 static int compare_tile_buffers(const void *a, const void *b) {
   const TileBufferDec *const buf1 = (const TileBufferDec *)a;
@@ -3685,13 +4349,29 @@ static int compare_tile_buffers(const void *a, const void *b) {
   return (int)(buf2->size - buf1->size);
 }
 
+static void alloc_tile_queue(AV1Decoder *pbi, int n_tiles) {
+  AV1_COMMON *const cm = &pbi->common;
+
+  if (pbi->tile_queue_size < n_tiles) {
+    aom_free(pbi->tile_queue);
+    pbi->tile_queue_size = 0;
+    CHECK_MEM_ERROR(cm, pbi->tile_queue,
+                    aom_malloc(n_tiles * sizeof(*pbi->tile_queue)));
+    pbi->tile_queue_size = n_tiles;
+  }
+  if (!aom_job_queue_alloc(&pbi->tile_jobs, pbi->num_tile_workers))
+    aom_internal_error(&cm->error, AOM_CODEC_MEM_ERROR,
+                       "Failed to allocate the tile job queue");
+}
+
 static const uint8_t *decode_tiles_mt(AV1Decoder *pbi, const uint8_t *data,
                                       const uint8_t *data_end) {
   AV1_COMMON *const cm = &pbi->common;
   const AVxWorkerInterface *const winterface = aom_get_worker_interface();
   const int tile_cols = cm->tile_cols;
   const int tile_rows = cm->tile_rows;
-  const int num_workers = AOMMIN(pbi->max_threads & ~1, tile_cols);
+  const int n_tiles = tile_cols * tile_rows;
+  const int rows_independent = tile_rows_independent(cm);
   TileBufferDec(*const tile_buffers)[MAX_TILE_COLS] = pbi->tile_buffers;
 #if CONFIG_EXT_TILE
   const int dec_tile_row = AOMMIN(pbi->dec_tile_row, tile_rows);
@@ -3709,55 +4389,39 @@ static const uint8_t *decode_tiles_mt(AV1Decoder *pbi, const uint8_t *data,
   const int tile_cols_end = tile_cols;
 #endif  // CONFIG_EXT_TILE
   int tile_row, tile_col;
+  int jobs_row_end;
   int i;
 
-#if !(CONFIG_ANS || CONFIG_EXT_TILE)
-  int final_worker = -1;
-#endif  // !(CONFIG_ANS || CONFIG_EXT_TILE)
-
   assert(tile_rows <= MAX_TILE_ROWS);
   assert(tile_cols <= MAX_TILE_COLS);
 
   assert(tile_cols * tile_rows > 1);
 
-  // TODO(jzern): See if we can remove the restriction of passing in max
-  // threads to the decoder.
-  if (pbi->num_tile_workers == 0) {
-    const int num_threads = pbi->max_threads & ~1;
-    CHECK_MEM_ERROR(cm, pbi->tile_workers,
-                    aom_malloc(num_threads * sizeof(*pbi->tile_workers)));
-    // Ensure tile data offsets will be properly aligned. This may fail on
-    // platforms without DECLARE_ALIGNED().
-    assert((sizeof(*pbi->tile_worker_data) % 16) == 0);
-    CHECK_MEM_ERROR(
-        cm, pbi->tile_worker_data,
-        aom_memalign(32, num_threads * sizeof(*pbi->tile_worker_data)));
-    CHECK_MEM_ERROR(cm, pbi->tile_worker_info,
-                    aom_malloc(num_threads * sizeof(*pbi->tile_worker_info)));
-    for (i = 0; i < num_threads; ++i) {
-      AVxWorker *const worker = &pbi->tile_workers[i];
-      ++pbi->num_tile_workers;
+  init_tile_workers(pbi);
+  alloc_tile_queue(pbi, n_tiles);
 
-      winterface->init(worker);
-      if (i < num_threads - 1 && !winterface->reset(worker)) {
-        aom_internal_error(&cm->error, AOM_CODEC_ERROR,
-                           "Tile decoder thread creation failed");
-      }
-    }
+  if (pbi->tile_data == NULL || n_tiles != pbi->allocated_tiles) {
+    aom_free(pbi->tile_data);
+    CHECK_MEM_ERROR(cm, pbi->tile_data,
+                    aom_memalign(32, n_tiles * (sizeof(*pbi->tile_data))));
+    pbi->allocated_tiles = n_tiles;
   }
 
   // Reset tile decoding hook
-  for (i = 0; i < num_workers; ++i) {
+  for (i = 0; i < pbi->num_tile_workers; ++i) {
     AVxWorker *const worker = &pbi->tile_workers[i];
+    TileWorkerData *const twd = &pbi->tile_worker_data[i];
     winterface->sync(worker);
     worker->hook = (AVxWorkerHook)tile_worker_hook;
-    worker->data1 = &pbi->tile_worker_data[i];
-    worker->data2 = &pbi->tile_worker_info[i];
+    worker->data1 = twd;
+    worker->data2 = (void *)data_end;
+    twd->pbi = pbi;
+    if (rows_independent) alloc_tile_worker_above_context(cm, twd);
   }
 
   // Initialize thread frame counts.
   if (cm->refresh_frame_context == REFRESH_FRAME_CONTEXT_BACKWARD) {
-    for (i = 0; i < num_workers; ++i) {
+    for (i = 0; i < pbi->num_tile_workers; ++i) {
       TileWorkerData *const twd = (TileWorkerData *)pbi->tile_workers[i].data1;
       av1_zero(twd->counts);
     }
@@ -3766,102 +4430,63 @@ static const uint8_t *decode_tiles_mt(AV1Decoder *pbi, const uint8_t *data,
   // Load tile data into tile_buffers
   get_tile_buffers(pbi, data, data_end, tile_buffers);
 
-  for (tile_row = tile_rows_start; tile_row < tile_rows_end; ++tile_row) {
-    // Sort the buffers in this tile row based on size in descending order.
-    qsort(&tile_buffers[tile_row][tile_cols_start],
-          tile_cols_end - tile_cols_start, sizeof(tile_buffers[0][0]),
-          compare_tile_buffers);
-
-    // Rearrange the tile buffers in this tile row such that per-tile group
-    // the largest, and presumably the most difficult tile will be decoded in
-    // the main thread. This should help minimize the number of instances
-    // where the main thread is waiting for a worker to complete.
-    {
-      int group_start;
-      for (group_start = tile_cols_start; group_start < tile_cols_end;
-           group_start += num_workers) {
-        const int group_end = AOMMIN(group_start + num_workers, tile_cols);
-        const TileBufferDec largest = tile_buffers[tile_row][group_start];
-        memmove(&tile_buffers[tile_row][group_start],
-                &tile_buffers[tile_row][group_start + 1],
-                (group_end - group_start - 1) * sizeof(tile_buffers[0][0]));
-        tile_buffers[tile_row][group_end - 1] = largest;
-      }
+#if !CONFIG_PARALLEL_DEBLOCKING
+  // The loop filter pipeline runs in the workers once the tile queue is empty.
+  // It can only start before the last tiles are decoded if all the tiles are
+  // queued together.
+  pbi->lf_pipeline = use_lf_pipeline(pbi);
+  pbi->lf_pipeline_overlap =
+      pbi->lf_pipeline && CONFIG_MULTITHREAD && rows_independent;
+  if (pbi->lf_pipeline) init_lf_pipeline(pbi, !pbi->lf_pipeline_overlap);
+#endif  // !CONFIG_PARALLEL_DEBLOCKING
+
+  // All the tiles of the frame are queued together unless a tile row depends
+  // on the above context left by the previous one.
+  for (tile_row = tile_rows_start; tile_row < tile_rows_end;
+       tile_row = jobs_row_end) {
+    int num_workers;
+    int num_jobs = 0;
+    int row;
+
+    jobs_row_end = rows_independent ? tile_rows_end : tile_row + 1;
+
+    for (row = tile_row; row < jobs_row_end; ++row) {
+      for (tile_col = tile_cols_start; tile_col < tile_cols_end; ++tile_col)
+        pbi->tile_queue[num_jobs++] = tile_buffers[row][tile_col];
     }
 
-    for (tile_col = tile_cols_start; tile_col < tile_cols_end;) {
-      // Launch workers for individual columns
-      for (i = 0; i < num_workers && tile_col < tile_cols_end;
-           ++i, ++tile_col) {
-        TileBufferDec *const buf = &tile_buffers[tile_row][tile_col];
-        AVxWorker *const worker = &pbi->tile_workers[i];
-        TileWorkerData *const twd = (TileWorkerData *)worker->data1;
-        TileInfo *const tile_info = (TileInfo *)worker->data2;
-
-        twd->pbi = pbi;
-        twd->xd = pbi->mb;
-        twd->xd.corrupted = 0;
-        twd->xd.counts =
-            cm->refresh_frame_context == REFRESH_FRAME_CONTEXT_BACKWARD
-                ? &twd->counts
-                : NULL;
-        av1_zero(twd->dqcoeff);
-        av1_tile_init(tile_info, cm, tile_row, buf->col);
-        av1_tile_init(&twd->xd.tile, cm, tile_row, buf->col);
-        setup_bool_decoder(buf->data, data_end, buf->size, &cm->error,
-                           &twd->bit_reader,
-#if CONFIG_ANS && ANS_MAX_SYMBOLS
-                           1 << cm->ans_window_size_log2,
-#endif  // CONFIG_ANS && ANS_MAX_SYMBOLS
-                           pbi->decrypt_cb, pbi->decrypt_state);
-        av1_init_macroblockd(cm, &twd->xd,
-#if CONFIG_PVQ
-                             twd->pvq_ref_coeff,
-#endif
-                             twd->dqcoeff);
-#if CONFIG_PVQ
-        daala_dec_init(cm, &twd->xd.daala_dec, &twd->bit_reader);
-        twd->xd.daala_dec.state.adapt = &twd->tctx.pvq_context;
-#endif
-#if CONFIG_EC_ADAPT
-        // Initialise the tile context from the frame context
-        twd->tctx = *cm->fc;
-        twd->xd.tile_ctx = &twd->tctx;
-#endif
-#if CONFIG_PALETTE
-        twd->xd.plane[0].color_index_map = twd->color_index_map[0];
-        twd->xd.plane[1].color_index_map = twd->color_index_map[1];
-#endif  // CONFIG_PALETTE
-
-        worker->had_error = 0;
-        if (i == num_workers - 1 || tile_col == tile_cols_end - 1) {
-          winterface->execute(worker);
-        } else {
-          winterface->launch(worker);
-        }
+    // Sort the tiles based on size in descending order, so that the largest,
+    // and presumably the most difficult, tiles are decoded first. This
+    // minimizes the time spent waiting for the last tile to complete.
+    qsort(pbi->tile_queue, num_jobs, sizeof(*pbi->tile_queue),
+          compare_tile_buffers);
 
-#if !(CONFIG_ANS || CONFIG_EXT_TILE)
-        if (tile_row == tile_rows - 1 && buf->col == tile_cols - 1) {
-          final_worker = i;
-        }
-#endif  // !(CONFIG_ANS || CONFIG_EXT_TILE)
+    num_workers = AOMMIN(pbi->num_tile_workers, num_jobs);
+    aom_job_queue_reset(&pbi->tile_jobs, num_jobs, num_workers);
+    for (i = 0; i < num_workers; ++i) {
+      AVxWorker *const worker = &pbi->tile_workers[i];
+      worker->had_error = 0;
+      if (i == num_workers - 1) {
+        winterface->execute(worker);
+      } else {
+        winterface->launch(worker);
       }
+    }
 
-      // Sync all workers
-      for (; i > 0; --i) {
-        AVxWorker *const worker = &pbi->tile_workers[i - 1];
-        // TODO(jzern): The tile may have specific error data associated with
-        // its aom_internal_error_info which could be propagated to the main
-        // info in cm. Additionally once the threads have been synced and an
-        // error is detected, there's no point in continuing to decode tiles.
-        pbi->mb.corrupted |= !winterface->sync(worker);
-      }
+    // Sync all workers
+    for (; i > 0; --i) {
+      AVxWorker *const worker = &pbi->tile_workers[i - 1];
+      // TODO(jzern): The tile may have specific error data associated with
+      // its aom_internal_error_info which could be propagated to the main
+      // info in cm. Additionally once the threads have been synced and an
+      // error is detected, there's no point in continuing to decode tiles.
+      pbi->mb.corrupted |= !winterface->sync(worker);
     }
   }
 
   // Accumulate thread frame counts.
   if (cm->refresh_frame_context == REFRESH_FRAME_CONTEXT_BACKWARD) {
-    for (i = 0; i < num_workers; ++i) {
+    for (i = 0; i < pbi->num_tile_workers; ++i) {
       TileWorkerData *const twd = (TileWorkerData *)pbi->tile_workers[i].data1;
       av1_accumulate_frame_counts(&cm->counts, &twd->counts);
     }
@@ -3874,11 +4499,11 @@ static const uint8_t *decode_tiles_mt(AV1Decoder *pbi, const uint8_t *data,
 #if CONFIG_ANS
   return data_end;
 #else
-  assert(final_worker != -1);
+  if (pbi->mb.corrupted) return data_end;
   {
-    TileWorkerData *const twd =
-        (TileWorkerData *)pbi->tile_workers[final_worker].data1;
-    return aom_reader_find_end(&twd->bit_reader);
+    // Get last tile data.
+    TileData *const td = pbi->tile_data + tile_cols * tile_rows - 1;
+    return aom_reader_find_end(&td->bit_reader);
   }
 #endif  // CONFIG_ANS
 #endif  // CONFIG_EXT_TILE
@@ -4824,6 +5449,48 @@ static void make_update_tile_list_dec(AV1Decoder *pbi, const int tile_rows,
 }
 #endif
 
+// Sizes the per-tile decoding times for the tiles of the current frame. The
+// array is kept even when the timing is disabled so that the tile decoders can
+// always address it. The times of the frames of one decode call are summed per
+// tile index.
+static void setup_tile_timing(AV1Decoder *pbi) {
+  AV1_COMMON *const cm = &pbi->common;
+  const int n_tiles = cm->tile_rows * cm->tile_cols;
+
+  if (n_tiles > pbi->tile_timing_size) {
+    int64_t *tile_timing;
+    CHECK_MEM_ERROR(cm, tile_timing,
+                    aom_calloc(n_tiles, sizeof(*pbi->tile_timing)));
+    if (pbi->tile_timing != NULL) {
+      memcpy(tile_timing, pbi->tile_timing,
+             pbi->tile_timing_size * sizeof(*pbi->tile_timing));
+      aom_free(pbi->tile_timing);
+    }
+    pbi->tile_timing = tile_timing;
+    pbi->tile_timing_size = n_tiles;
+  }
+  pbi->timing.num_tiles = AOMMAX(pbi->timing.num_tiles, n_tiles);
+  pbi->timing.tile_us = pbi->tile_timing;
+}
+
+// In frame parallel mode, waits until the reference frames of the current
+// frame have been completely decoded, filtered and border extended by the
+// frame workers that own them. Motion vectors are not bounded and the
+// prediction of a block may read anywhere in the reference, so the whole frame
+// is waited for rather than the rows below the block.
+static void wait_for_ref_frames(AV1Decoder *pbi) {
+  AV1_COMMON *const cm = &pbi->common;
+  RefCntBuffer *const frame_bufs = cm->buffer_pool->frame_bufs;
+  int i;
+
+  if (frame_is_intra_only(cm)) return;
+  for (i = 0; i < INTER_REFS_PER_FRAME; ++i) {
+    const int idx = cm->frame_refs[i].idx;
+    if (idx == INVALID_IDX) continue;
+    av1_frameworker_wait(pbi->frame_worker_owner, &frame_bufs[idx], INT_MAX);
+  }
+}
+
 void av1_decode_frame(AV1Decoder *pbi, const uint8_t *data,
                       const uint8_t *data_end, const uint8_t **p_data_end) {
   AV1_COMMON *const cm = &pbi->common;
@@ -4833,11 +5500,13 @@ void av1_decode_frame(AV1Decoder *pbi, const uint8_t *data,
   uint8_t clear_data[MAX_AV1_HEADER_SIZE];
   size_t first_partition_size;
   YV12_BUFFER_CONFIG *new_fb;
+  struct aom_usec_timer timer;
 
 #if CONFIG_BITSTREAM_DEBUG
   bitstream_queue_set_frame_read(cm->current_video_frame * 2 + cm->show_frame);
 #endif
 
+  dec_timer_start(pbi, &timer);
   first_partition_size = read_uncompressed_header(
       pbi, init_read_bit_buffer(pbi, &rb, data, data_end, clear_data));
 #if CONFIG_TILE_GROUPS
@@ -4858,6 +5527,7 @@ void av1_decode_frame(AV1Decoder *pbi, const uint8_t *data,
   if (!first_partition_size) {
     // showing a frame directly
     *p_data_end = data + aom_rb_bytes_read(&rb);
+    dec_timer_add(pbi, &timer, &pbi->timing.header_us);
     return;
   }
 
@@ -4921,6 +5591,8 @@ void av1_decode_frame(AV1Decoder *pbi, const uint8_t *data,
   if (cm->lf.filter_level && !cm->skip_loop_filter) {
     av1_loop_filter_frame_init(cm, cm->lf.filter_level);
   }
+  dec_timer_add(pbi, &timer, &pbi->timing.header_us);
+  setup_tile_timing(pbi);
 
   // If encoded in frame parallel mode, frame context is ready after decoding
   // the frame header.
@@ -4933,7 +5605,7 @@ void av1_decode_frame(AV1Decoder *pbi, const uint8_t *data,
       cm->frame_contexts[cm->frame_context_idx] = *cm->fc;
     }
     av1_frameworker_lock_stats(worker);
-    pbi->cur_buf->row = -1;
+    aom_atomic_store_int(&pbi->cur_buf->row, -1);
     pbi->cur_buf->col = -1;
     frame_worker_data->frame_context_ready = 1;
     // Signal the main thread that context is ready.
@@ -4941,20 +5613,32 @@ void av1_decode_frame(AV1Decoder *pbi, const uint8_t *data,
     av1_frameworker_unlock_stats(worker);
   }
 
+  if (cm->frame_parallel_decode) wait_for_ref_frames(pbi);
+
 #if CONFIG_SUBFRAME_PROB_UPDATE
   av1_copy(cm->starting_coef_probs, cm->fc->coef_probs);
   cm->coef_probs_update_idx = 0;
 #endif  // CONFIG_SUBFRAME_PROB_UPDATE
 
+  pbi->lf_pipeline = 0;
+  pbi->lf_pipeline_overlap = 0;
+  dec_timer_start(pbi, &timer);
   if (pbi->max_threads > 1
 #if CONFIG_EXT_TILE
       && pbi->dec_tile_col < 0  // Decoding all columns
 #endif                          // CONFIG_EXT_TILE
-      && cm->tile_cols > 1) {
+      && cm->tile_cols * cm->tile_rows > 1) {
     // Multi-threaded tile decoder
     *p_data_end = decode_tiles_mt(pbi, data + first_partition_size, data_end);
+    dec_timer_add(pbi, &timer, &pbi->timing.tile_decode_us);
+    dec_timer_start(pbi, &timer);
     if (!xd->corrupted) {
-      if (!cm->skip_loop_filter) {
+      if (pbi->lf_pipeline) {
+#if !CONFIG_PARALLEL_DEBLOCKING
+        if (!pbi->lf_pipeline_overlap) run_lf_pipeline(pbi);
+        av1_loop_filter_pipeline_finish(&pbi->lf_row_sync);
+#endif  // !CONFIG_PARALLEL_DEBLOCKING
+      } else if (!cm->skip_loop_filter) {
         // If multiple threads are used to decode tiles, then we use those
         // threads to do parallel loopfiltering.
         av1_loop_filter_frame_mt(new_fb, cm, pbi->mb.plane, cm->lf.filter_level,
@@ -4965,24 +5649,45 @@ void av1_decode_frame(AV1Decoder *pbi, const uint8_t *data,
       aom_internal_error(&cm->error, AOM_CODEC_CORRUPT_FRAME,
                          "Decode failed. Frame data is corrupted.");
     }
+    dec_timer_add(pbi, &timer, &pbi->timing.loop_filter_us);
   } else {
     *p_data_end = decode_tiles(pbi, data + first_partition_size, data_end);
+    dec_timer_add(pbi, &timer, &pbi->timing.tile_decode_us);
   }
 
 #if CONFIG_CDEF
-  if (!cm->skip_loop_filter) {
-    av1_cdef_frame(&pbi->cur_buf->buf, cm, &pbi->mb);
+  dec_timer_start(pbi, &timer);
+  if (!cm->skip_loop_filter && !pbi->lf_pipeline) {
+    if (pbi->max_threads > 1) {
+      init_tile_workers(pbi);
+      av1_cdef_frame_mt(&pbi->cur_buf->buf, cm, &pbi->mb, pbi->tile_workers,
+                        pbi->num_tile_workers);
+    } else {
+      av1_cdef_frame(&pbi->cur_buf->buf, cm, &pbi->mb);
+    }
   }
+  dec_timer_add(pbi, &timer, &pbi->timing.cdef_us);
 #endif  // CONFIG_CDEF
 
 #if CONFIG_LOOP_RESTORATION
-  if (cm->rst_info[0].frame_restoration_type != RESTORE_NONE ||
-      cm->rst_info[1].frame_restoration_type != RESTORE_NONE ||
-      cm->rst_info[2].frame_restoration_type != RESTORE_NONE) {
-    av1_loop_restoration_frame(new_fb, cm, cm->rst_info, 7, 0, NULL);
+  dec_timer_start(pbi, &timer);
+  if (!pbi->lf_pipeline &&
+      (cm->rst_info[0].frame_restoration_type != RESTORE_NONE ||
+       cm->rst_info[1].frame_restoration_type != RESTORE_NONE ||
+       cm->rst_info[2].frame_restoration_type != RESTORE_NONE)) {
+    if (pbi->max_threads > 1) {
+      init_tile_workers(pbi);
+      av1_loop_restoration_frame_mt(new_fb, cm, cm->rst_info, 7, NULL,
+                                    pbi->tile_workers, pbi->num_tile_workers,
+                                    &pbi->lr_sync);
+    } else {
+      av1_loop_restoration_frame(new_fb, cm, cm->rst_info, 7, 0, NULL);
+    }
   }
+  dec_timer_add(pbi, &timer, &pbi->timing.loop_restoration_us);
 #endif  // CONFIG_LOOP_RESTORATION
 
+  dec_timer_start(pbi, &timer);
   if (!xd->corrupted) {
     if (cm->refresh_frame_context == REFRESH_FRAME_CONTEXT_BACKWARD) {
 #if CONFIG_EC_ADAPT
@@ -5034,6 +5739,7 @@ void av1_decode_frame(AV1Decoder *pbi, const uint8_t *data,
     aom_internal_error(&cm->error, AOM_CODEC_CORRUPT_FRAME,
                        "Decode failed. Frame data is corrupted.");
   }
+  dec_timer_add(pbi, &timer, &pbi->timing.adaptation_us);
 
 #if CONFIG_INSPECTION
   if (pbi->inspect_cb != NULL) {
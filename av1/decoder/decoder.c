@@ -12,6 +12,7 @@
 #include <assert.h>
 #include <limits.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "./av1_rtcd.h"
 #include "./aom_dsp_rtcd.h"
@@ -19,6 +20,7 @@
 
 #include "aom_mem/aom_mem.h"
 #include "aom_ports/system_state.h"
+#include "aom_ports/aom_atomics.h"
 #include "aom_ports/aom_once.h"
 #include "aom_ports/aom_timer.h"
 #include "aom_scale/aom_scale.h"
@@ -157,7 +159,33 @@ AV1Decoder *av1_decoder_create(BufferPool *const pool) {
   return pbi;
 }
 
+void av1_free_row_mt_buffers(AV1Decoder *pbi) {
+  int i;
+
+  for (i = 0; i < pbi->num_row_bufs; ++i) {
+    DecRowBuffer *const buf = &pbi->row_bufs[i];
+    aom_free(buf->blocks);
+    aom_free(buf->txbs);
+    aom_free(buf->dqcoeff);
+#if CONFIG_PALETTE
+    aom_free(buf->color_index_map);
+#endif  // CONFIG_PALETTE
+  }
+  aom_free(pbi->row_bufs);
+  pbi->row_bufs = NULL;
+  pbi->num_row_bufs = 0;
+}
+
+void av1_reset_frame_timing(AV1Decoder *pbi) {
+  av1_zero(pbi->timing);
+  if (pbi->tile_timing != NULL)
+    memset(pbi->tile_timing, 0,
+           pbi->tile_timing_size * sizeof(*pbi->tile_timing));
+  pbi->timing.tile_us = pbi->tile_timing;
+}
+
 void av1_decoder_remove(AV1Decoder *pbi) {
+  int num_tile_worker_data;
   int i;
 
   if (!pbi) return;
@@ -165,17 +193,39 @@ void av1_decoder_remove(AV1Decoder *pbi) {
   aom_get_worker_interface()->end(&pbi->lf_worker);
   aom_free(pbi->lf_worker.data1);
   aom_free(pbi->tile_data);
-  for (i = 0; i < pbi->num_tile_workers; ++i) {
-    AVxWorker *const worker = &pbi->tile_workers[i];
-    aom_get_worker_interface()->end(worker);
+  if (pbi->worker_pool != NULL) {
+    // The tile workers belong to the pool and were released after the last
+    // frame.
+    num_tile_worker_data = pbi->tile_worker_data ? pbi->max_threads : 0;
+  } else {
+    for (i = 0; i < pbi->num_tile_workers; ++i)
+      aom_get_worker_interface()->end(&pbi->tile_workers[i]);
+    aom_free(pbi->tile_workers);
+    num_tile_worker_data = pbi->num_tile_workers;
+  }
+  aom_thread_pool_client_free(&pbi->pool_client);
+  for (i = 0; i < num_tile_worker_data; ++i) {
+    TileWorkerData *const twd = &pbi->tile_worker_data[i];
+    int plane;
+    for (plane = 0; plane < MAX_MB_PLANE; ++plane)
+      aom_free(twd->above_context[plane]);
+    aom_free(twd->above_seg_context);
   }
   aom_free(pbi->tile_worker_data);
-  aom_free(pbi->tile_worker_info);
-  aom_free(pbi->tile_workers);
 
-  if (pbi->num_tile_workers > 0) {
+  if (num_tile_worker_data > 0) {
     av1_loop_filter_dealloc(&pbi->lf_row_sync);
   }
+#if CONFIG_LOOP_RESTORATION
+  av1_loop_restoration_dealloc(&pbi->lr_sync);
+#endif  // CONFIG_LOOP_RESTORATION
+
+  aom_free(pbi->tile_queue);
+  aom_job_queue_free(&pbi->tile_jobs);
+
+  av1_free_row_mt_buffers(pbi);
+  av1_dec_row_mt_dealloc(&pbi->row_mt_sync);
+  aom_free(pbi->tile_timing);
 
 #if CONFIG_ACCOUNTING
   aom_accounting_clear(&pbi->accounting);
@@ -270,7 +320,7 @@ aom_codec_err_t av1_set_reference_dec(AV1_COMMON *cm,
     return cm->error.error_code;
   }
 
-  if (idx < 0 || idx >= FRAME_BUFFERS) {
+  if (idx < 0 || idx >= cm->buffer_pool->num_frame_bufs) {
     aom_internal_error(&cm->error, AOM_CODEC_ERROR,
                        "Invalid reference frame map");
     return cm->error.error_code;
@@ -336,14 +386,27 @@ static void swap_frame_buffers(AV1Decoder *pbi) {
   }
 }
 
+// Returns the tile workers borrowed from the worker pool for the last frame.
+static void release_tile_workers(AV1Decoder *pbi) {
+  if (pbi->worker_pool == NULL || pbi->num_tile_workers == 0) return;
+  if (pbi->tile_workers != &pbi->serial_tile_worker) {
+    av1_dec_worker_pool_release(pbi->worker_pool, pbi->tile_workers,
+                                pbi->num_tile_workers);
+  }
+  pbi->tile_workers = NULL;
+  pbi->num_tile_workers = 0;
+}
+
 int av1_receive_compressed_data(AV1Decoder *pbi, size_t size,
                                 const uint8_t **psource) {
   AV1_COMMON *volatile const cm = &pbi->common;
   BufferPool *volatile const pool = cm->buffer_pool;
   RefCntBuffer *volatile const frame_bufs = cm->buffer_pool->frame_bufs;
   const uint8_t *source = *psource;
+  struct aom_usec_timer timer;
   int retcode = 0;
   cm->error.error_code = AOM_CODEC_OK;
+  dec_timer_start(pbi, &timer);
 
   if (size == 0) {
     // This is used to signal that we are missing frames.
@@ -386,7 +449,7 @@ int av1_receive_compressed_data(AV1Decoder *pbi, size_t size,
     frame_bufs[cm->new_fb_idx].frame_worker_owner = worker;
     // Reset decoding progress.
     pbi->cur_buf = &frame_bufs[cm->new_fb_idx];
-    pbi->cur_buf->row = -1;
+    aom_atomic_store_int(&pbi->cur_buf->row, -1);
     pbi->cur_buf->col = -1;
     av1_frameworker_unlock_stats(worker);
   } else {
@@ -401,11 +464,14 @@ int av1_receive_compressed_data(AV1Decoder *pbi, size_t size,
     pbi->ready_for_new_data = 1;
 
     // Synchronize all threads immediately as a subsequent decode call may
-    // cause a resize invalidating some allocations.
+    // cause a resize invalidating some allocations. The row workers waiting
+    // for rows that will not be parsed are released first.
+    av1_dec_row_mt_abort(&pbi->row_mt_sync);
     winterface->sync(&pbi->lf_worker);
     for (i = 0; i < pbi->num_tile_workers; ++i) {
       winterface->sync(&pbi->tile_workers[i]);
     }
+    release_tile_workers(pbi);
 
     lock_buffer_pool(pool);
     // Release all the reference buffers if worker thread is holding them.
@@ -439,6 +505,7 @@ int av1_receive_compressed_data(AV1Decoder *pbi, size_t size,
 
   cm->error.setjmp = 1;
   av1_decode_frame(pbi, source, source + size, psource);
+  release_tile_workers(pbi);
 
   swap_frame_buffers(pbi);
 
@@ -476,6 +543,9 @@ int av1_receive_compressed_data(AV1Decoder *pbi, size_t size,
     if (cm->show_frame) {
       cm->current_video_frame++;
     }
+    // The frame is now filtered and border extended, so the workers that
+    // predict from it can go ahead.
+    aom_atomic_store_int(&pbi->cur_buf->row, INT_MAX);
     frame_worker_data->frame_decoded = 1;
     frame_worker_data->frame_context_ready = 1;
     av1_frameworker_signal_stats(worker);
@@ -488,6 +558,9 @@ int av1_receive_compressed_data(AV1Decoder *pbi, size_t size,
     }
   }
 
+  dec_timer_add(pbi, &timer, &pbi->timing.total_us);
+  ++pbi->timing.num_frames;
+
   cm->error.setjmp = 0;
   return retcode;
 }
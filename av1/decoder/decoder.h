@@ -15,9 +15,13 @@
 #include "./aom_config.h"
 
 #include "aom/aom_codec.h"
+#include "aom/aomdx.h"
 #include "aom_dsp/bitreader.h"
+#include "aom_ports/aom_timer.h"
 #include "aom_scale/yv12config.h"
+#include "aom_util/aom_job_queue.h"
 #include "aom_util/aom_thread.h"
+#include "aom_util/aom_thread_pool.h"
 
 #include "av1/common/thread_common.h"
 #include "av1/common/onyxc_int.h"
@@ -75,14 +79,65 @@ typedef struct TileWorkerData {
 #if CONFIG_PALETTE
   DECLARE_ALIGNED(16, uint8_t, color_index_map[2][MAX_SB_SQUARE]);
 #endif  // CONFIG_PALETTE
+  // Above contexts owned by the worker. They are used instead of the ones in
+  // AV1_COMMON when tiles from different tile rows are decoded concurrently.
+  ENTROPY_CONTEXT *above_context[MAX_MB_PLANE];
+  PARTITION_CONTEXT *above_seg_context;
+  int above_context_alloc_cols;
   struct aom_internal_error_info error_info;
 } TileWorkerData;
 
+// Transform block recorded by the parse pass of the row-based multi-threaded
+// decoder.
+typedef struct DecTxbInfo {
+  int16_t eob;
+  int16_t max_scan_line;
+} DecTxbInfo;
+
+// Coding block whose tokens have been parsed but not yet reconstructed.
+typedef struct DecBlockInfo {
+  int mi_row;
+  int mi_col;
+  BLOCK_SIZE bsize;
+} DecBlockInfo;
+
+// Parsed blocks and dequantized coefficients of one superblock row. The
+// buffers grow on demand and are reused from frame to frame.
+typedef struct DecRowBuffer {
+  DecBlockInfo *blocks;
+  int num_blocks;
+  int blocks_size;
+  DecTxbInfo *txbs;
+  int num_txbs;
+  int txbs_size;
+  tran_low_t *dqcoeff;
+  int num_coeffs;
+  int coeffs_size;
+#if CONFIG_PALETTE
+  uint8_t *color_index_map;
+  int num_colors;
+  int colors_size;
+#endif  // CONFIG_PALETTE
+} DecRowBuffer;
+
+// Read/write position in a DecRowBuffer. In the parse pass the tokens read by
+// decode_partition() are appended to 'buf' instead of being reconstructed. In
+// the reconstruction pass they are consumed in the order they were stored.
+typedef struct DecRowCursor {
+  DecRowBuffer *buf;
+  int parse;
+  int block_idx;
+  int txb_idx;
+  int coeff_idx;
+  int color_idx;
+} DecRowCursor;
+
 typedef struct TileBufferDec {
   const uint8_t *data;
   size_t size;
   const uint8_t *raw_data_end;  // The end of the raw tile buffer in the
                                 // bit stream.
+  int row;                      // only used with multi-threaded decoding
   int col;                      // only used with multi-threaded decoding
 } TileBufferDec;
 
@@ -102,16 +157,42 @@ typedef struct AV1Decoder {
   AVxWorker *frame_worker_owner;  // frame_worker that owns this pbi.
   AVxWorker lf_worker;
   AVxWorker *tile_workers;
+  // Runs lf_worker and the tile workers on a shared thread pool, when set.
+  AVxThreadPoolClient pool_client;
   TileWorkerData *tile_worker_data;
-  TileInfo *tile_worker_info;
   int num_tile_workers;
+  // In frame parallel mode the tile workers are borrowed from worker_pool for
+  // each frame, or serial_tile_worker is used when none of them is idle.
+  AV1DecWorkerPool *worker_pool;
+  AVxWorker serial_tile_worker;
 
   TileData *tile_data;
   int allocated_tiles;
 
   TileBufferDec tile_buffers[MAX_TILE_ROWS][MAX_TILE_COLS];
 
+  // Tiles waiting to be picked up by the tile workers, largest first, and the
+  // job queue the workers take them from.
+  TileBufferDec *tile_queue;
+  int tile_queue_size;
+  AVxJobQueue tile_jobs;
+
   AV1LfSync lf_row_sync;
+#if CONFIG_LOOP_RESTORATION
+  AV1LrSync lr_sync;
+#endif  // CONFIG_LOOP_RESTORATION
+  // The in-loop filters of the frame are applied by the loop filter pipeline
+  // of lf_row_sync, while the tiles are decoded if lf_pipeline_overlap is set.
+  int lf_pipeline;
+  int lf_pipeline_overlap;
+
+  // Row-based multi-threaded reconstruction within a tile. The tile workers
+  // reconstruct the superblock rows of row_mt_tile while it is parsed.
+  int row_mt;
+  DecRowBuffer *row_bufs;
+  int num_row_bufs;
+  TileInfo row_mt_tile;
+  AV1DecRowMTSync row_mt_sync;
 
   aom_decrypt_cb decrypt_cb;
   void *decrypt_state;
@@ -144,6 +225,13 @@ typedef struct AV1Decoder {
   aom_inspect_cb inspect_cb;
   void *inspect_ctx;
 #endif
+
+  // Decoding times of the frames of the last decode call. They are only
+  // collected when frame_timing is set.
+  int frame_timing;
+  aom_frame_timing_t timing;
+  int64_t *tile_timing;
+  int tile_timing_size;
 } AV1Decoder;
 
 int av1_receive_compressed_data(struct AV1Decoder *pbi, size_t size,
@@ -182,6 +270,26 @@ struct AV1Decoder *av1_decoder_create(BufferPool *const pool);
 
 void av1_decoder_remove(struct AV1Decoder *pbi);
 
+// Releases the superblock row buffers of the row-based multi-threaded decoder.
+void av1_free_row_mt_buffers(struct AV1Decoder *pbi);
+
+// Clears the decoding times before the frames of a new decode call.
+void av1_reset_frame_timing(struct AV1Decoder *pbi);
+
+static INLINE void dec_timer_start(const AV1Decoder *pbi,
+                                   struct aom_usec_timer *timer) {
+  if (pbi->frame_timing) aom_usec_timer_start(timer);
+}
+
+// Adds the time elapsed since dec_timer_start() to *us.
+static INLINE void dec_timer_add(const AV1Decoder *pbi,
+                                 struct aom_usec_timer *timer, int64_t *us) {
+  if (pbi->frame_timing) {
+    aom_usec_timer_mark(timer);
+    *us += aom_usec_timer_elapsed(timer);
+  }
+}
+
 static INLINE void decrease_ref_count(int idx, RefCntBuffer *const frame_bufs,
                                       BufferPool *const pool) {
   if (idx >= 0) {
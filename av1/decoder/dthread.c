@@ -11,6 +11,7 @@
 
 #include "./aom_config.h"
 #include "aom_mem/aom_mem.h"
+#include "aom_ports/aom_atomics.h"
 #include "av1/common/reconinter.h"
 #include "av1/decoder/dthread.h"
 #include "av1/decoder/decoder.h"
@@ -39,14 +40,7 @@ void av1_frameworker_unlock_stats(AVxWorker *const worker) {
 void av1_frameworker_signal_stats(AVxWorker *const worker) {
 #if CONFIG_MULTITHREAD
   FrameWorkerData *const worker_data = worker->data1;
-
-// TODO(hkuang): Fix the pthread_cond_broadcast in windows wrapper.
-#if defined(_WIN32) && !HAVE_PTHREAD_H
-  pthread_cond_signal(&worker_data->stats_cond);
-#else
   pthread_cond_broadcast(&worker_data->stats_cond);
-#endif
-
 #else
   (void)worker;
 #endif
@@ -66,9 +60,17 @@ void av1_frameworker_wait(AVxWorker *const worker, RefCntBuffer *const ref_buf,
   if (!ref_buf) return;
 
 #ifndef BUILDING_WITH_TSAN
-  // The following line of code will get harmless tsan error but it is the key
-  // to get best performance.
-  if (ref_buf->row >= row && ref_buf->buf.corrupted != 1) return;
+  {
+    // The following lines of code will get harmless tsan error on corrupted
+    // but they are the key to get best performance. The decoding progress is
+    // polled for a while before blocking on the owner of the frame.
+    int i;
+    for (i = 0; i < AOM_ATOMIC_SPIN_COUNT; ++i) {
+      if (aom_atomic_load_int(&ref_buf->row) >= row &&
+          ref_buf->buf.corrupted != 1)
+        return;
+    }
+  }
 #endif
 
   {
@@ -89,11 +91,15 @@ void av1_frameworker_wait(AVxWorker *const worker, RefCntBuffer *const ref_buf,
 #endif
 
     av1_frameworker_lock_stats(ref_worker);
-    while (ref_buf->row < row && pbi->cur_buf == ref_buf &&
-           ref_buf->buf.corrupted != 1) {
+    aom_atomic_store_int(&ref_worker_data->row_waiters,
+                         ref_worker_data->row_waiters + 1);
+    while (aom_atomic_load_int(&ref_buf->row) < row &&
+           pbi->cur_buf == ref_buf && ref_buf->buf.corrupted != 1) {
       pthread_cond_wait(&ref_worker_data->stats_cond,
                         &ref_worker_data->stats_mutex);
     }
+    aom_atomic_store_int(&ref_worker_data->row_waiters,
+                         ref_worker_data->row_waiters - 1);
 
     if (ref_buf->buf.corrupted == 1) {
       FrameWorkerData *const worker_data = (FrameWorkerData *)worker->data1;
@@ -115,6 +121,7 @@ void av1_frameworker_wait(AVxWorker *const worker, RefCntBuffer *const ref_buf,
 void av1_frameworker_broadcast(RefCntBuffer *const buf, int row) {
 #if CONFIG_MULTITHREAD
   AVxWorker *worker = buf->frame_worker_owner;
+  FrameWorkerData *const worker_data = (FrameWorkerData *)worker->data1;
 
 #ifdef DEBUG_THREAD
   {
@@ -124,10 +131,14 @@ void av1_frameworker_broadcast(RefCntBuffer *const buf, int row) {
   }
 #endif
 
-  av1_frameworker_lock_stats(worker);
-  buf->row = row;
-  av1_frameworker_signal_stats(worker);
-  av1_frameworker_unlock_stats(worker);
+  // Only wake the workers up when one of them waits on the progress, the
+  // others poll it.
+  aom_atomic_store_int(&buf->row, row);
+  if (aom_atomic_load_int(&worker_data->row_waiters)) {
+    av1_frameworker_lock_stats(worker);
+    av1_frameworker_signal_stats(worker);
+    av1_frameworker_unlock_stats(worker);
+  }
 #else
   (void)buf;
   (void)row;
@@ -177,6 +188,13 @@ void av1_frameworker_copy_context(AVxWorker *const dst_worker,
                                 : src_cm->last_show_frame;
   for (i = 0; i < REF_FRAMES; ++i)
     dst_cm->ref_frame_map[i] = src_cm->next_ref_frame_map[i];
+#if CONFIG_REFERENCE_BUFFER
+  dst_cm->current_frame_id = src_cm->current_frame_id;
+  memcpy(dst_cm->ref_frame_id, src_cm->ref_frame_id,
+         sizeof(dst_cm->ref_frame_id));
+  memcpy(dst_cm->valid_for_referencing, src_cm->valid_for_referencing,
+         sizeof(dst_cm->valid_for_referencing));
+#endif  // CONFIG_REFERENCE_BUFFER
 
   memcpy(dst_cm->lf_info.lfthr, src_cm->lf_info.lfthr,
          (MAX_LOOP_FILTER + 1) * sizeof(loop_filter_thresh));
@@ -192,3 +210,283 @@ void av1_frameworker_copy_context(AVxWorker *const dst_worker,
   (void)src_worker;
 #endif  // CONFIG_MULTITHREAD
 }
+
+int av1_dec_worker_pool_init(AV1DecWorkerPool *pool, int num_workers) {
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+  int i;
+
+  av1_zero(*pool);
+#if CONFIG_MULTITHREAD
+  if (pthread_mutex_init(&pool->mutex, NULL)) return -1;
+#endif
+  pool->workers = (AVxWorker *)aom_malloc(num_workers * sizeof(*pool->workers));
+  pool->busy = (int *)aom_calloc(num_workers, sizeof(*pool->busy));
+  if (pool->workers == NULL || pool->busy == NULL) goto Error;
+  for (i = 0; i < num_workers; ++i) {
+    AVxWorker *const worker = &pool->workers[i];
+    winterface->init(worker);
+    ++pool->num_workers;
+    if (!winterface->reset(worker)) goto Error;
+  }
+  return 0;
+
+Error:
+  for (i = 0; i < pool->num_workers; ++i) winterface->end(&pool->workers[i]);
+  aom_free(pool->workers);
+  aom_free(pool->busy);
+#if CONFIG_MULTITHREAD
+  pthread_mutex_destroy(&pool->mutex);
+#endif
+  av1_zero(*pool);
+  return -1;
+}
+
+void av1_dec_worker_pool_end(AV1DecWorkerPool *pool) {
+  int i;
+
+  if (pool->workers == NULL) return;
+  for (i = 0; i < pool->num_workers; ++i)
+    aom_get_worker_interface()->end(&pool->workers[i]);
+  aom_free(pool->workers);
+  aom_free(pool->busy);
+#if CONFIG_MULTITHREAD
+  pthread_mutex_destroy(&pool->mutex);
+#endif
+  av1_zero(*pool);
+}
+
+int av1_dec_worker_pool_acquire(AV1DecWorkerPool *pool, int max_workers,
+                                AVxWorker **workers) {
+  int best_start = 0, best_len = 0;
+  int start, len, i;
+
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(&pool->mutex);
+#endif
+  for (start = 0; start < pool->num_workers && best_len < max_workers;
+       start += len + 1) {
+    len = 0;
+    while (start + len < pool->num_workers && !pool->busy[start + len]) ++len;
+    if (len > best_len) {
+      best_start = start;
+      best_len = len;
+    }
+  }
+  best_len = AOMMIN(best_len, max_workers);
+  for (i = 0; i < best_len; ++i) {
+    AVxWorker *const worker = &pool->workers[best_start + i];
+    pool->busy[best_start + i] = 1;
+    worker->had_error = 0;
+  }
+#if CONFIG_MULTITHREAD
+  pthread_mutex_unlock(&pool->mutex);
+#endif
+  *workers = best_len ? &pool->workers[best_start] : NULL;
+  return best_len;
+}
+
+void av1_dec_worker_pool_release(AV1DecWorkerPool *pool, AVxWorker *workers,
+                                 int num_workers) {
+  const int start = (int)(workers - pool->workers);
+  int i;
+
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(&pool->mutex);
+#endif
+  for (i = 0; i < num_workers; ++i) pool->busy[start + i] = 0;
+#if CONFIG_MULTITHREAD
+  pthread_mutex_unlock(&pool->mutex);
+#endif
+}
+
+void av1_dec_row_mt_alloc(AV1DecRowMTSync *row_mt_sync, AV1_COMMON *cm,
+                          int rows) {
+  row_mt_sync->rows = rows;
+#if CONFIG_MULTITHREAD
+  {
+    int i;
+
+    CHECK_MEM_ERROR(cm, row_mt_sync->mutex_,
+                    aom_malloc(sizeof(*row_mt_sync->mutex_) * rows));
+    if (row_mt_sync->mutex_) {
+      for (i = 0; i < rows; ++i) {
+        pthread_mutex_init(&row_mt_sync->mutex_[i], NULL);
+      }
+    }
+
+    CHECK_MEM_ERROR(cm, row_mt_sync->cond_,
+                    aom_malloc(sizeof(*row_mt_sync->cond_) * rows));
+    if (row_mt_sync->cond_) {
+      for (i = 0; i < rows; ++i) {
+        pthread_cond_init(&row_mt_sync->cond_[i], NULL);
+      }
+    }
+
+    CHECK_MEM_ERROR(cm, row_mt_sync->waiters,
+                    aom_calloc(rows, sizeof(*row_mt_sync->waiters)));
+
+    CHECK_MEM_ERROR(cm, row_mt_sync->job_mutex,
+                    aom_malloc(sizeof(*row_mt_sync->job_mutex)));
+    if (row_mt_sync->job_mutex)
+      pthread_mutex_init(row_mt_sync->job_mutex, NULL);
+
+    CHECK_MEM_ERROR(cm, row_mt_sync->job_cond,
+                    aom_malloc(sizeof(*row_mt_sync->job_cond)));
+    if (row_mt_sync->job_cond) pthread_cond_init(row_mt_sync->job_cond, NULL);
+  }
+#endif  // CONFIG_MULTITHREAD
+
+  CHECK_MEM_ERROR(cm, row_mt_sync->cur_sb_col,
+                  aom_malloc(sizeof(*row_mt_sync->cur_sb_col) * rows));
+
+  // Intra prediction and motion vector references reach up to the above-right
+  // superblock, so a row may only run one superblock behind the row above.
+  row_mt_sync->sync_range = 1;
+}
+
+void av1_dec_row_mt_dealloc(AV1DecRowMTSync *row_mt_sync) {
+  if (row_mt_sync != NULL) {
+#if CONFIG_MULTITHREAD
+    int i;
+
+    if (row_mt_sync->mutex_ != NULL) {
+      for (i = 0; i < row_mt_sync->rows; ++i) {
+        pthread_mutex_destroy(&row_mt_sync->mutex_[i]);
+      }
+      aom_free(row_mt_sync->mutex_);
+    }
+    if (row_mt_sync->cond_ != NULL) {
+      for (i = 0; i < row_mt_sync->rows; ++i) {
+        pthread_cond_destroy(&row_mt_sync->cond_[i]);
+      }
+      aom_free(row_mt_sync->cond_);
+    }
+    aom_free(row_mt_sync->waiters);
+    if (row_mt_sync->job_mutex != NULL) {
+      pthread_mutex_destroy(row_mt_sync->job_mutex);
+      aom_free(row_mt_sync->job_mutex);
+    }
+    if (row_mt_sync->job_cond != NULL) {
+      pthread_cond_destroy(row_mt_sync->job_cond);
+      aom_free(row_mt_sync->job_cond);
+    }
+#endif  // CONFIG_MULTITHREAD
+    aom_free(row_mt_sync->cur_sb_col);
+    av1_zero(*row_mt_sync);
+  }
+}
+
+void av1_dec_row_mt_start_tile(AV1DecRowMTSync *row_mt_sync, int tile_rows) {
+  memset(row_mt_sync->cur_sb_col, -1,
+         sizeof(*row_mt_sync->cur_sb_col) * tile_rows);
+  row_mt_sync->tile_rows = tile_rows;
+  row_mt_sync->parsed_rows = 0;
+  row_mt_sync->next_row = 0;
+  row_mt_sync->parse_aborted = 0;
+}
+
+void av1_dec_row_mt_set_parsed(AV1DecRowMTSync *row_mt_sync, int parsed_rows) {
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(row_mt_sync->job_mutex);
+  row_mt_sync->parsed_rows = parsed_rows;
+  pthread_cond_broadcast(row_mt_sync->job_cond);
+  pthread_mutex_unlock(row_mt_sync->job_mutex);
+#else
+  row_mt_sync->parsed_rows = parsed_rows;
+#endif  // CONFIG_MULTITHREAD
+}
+
+void av1_dec_row_mt_abort(AV1DecRowMTSync *row_mt_sync) {
+#if CONFIG_MULTITHREAD
+  if (row_mt_sync->job_mutex == NULL) return;
+  pthread_mutex_lock(row_mt_sync->job_mutex);
+  row_mt_sync->parse_aborted = 1;
+  pthread_cond_broadcast(row_mt_sync->job_cond);
+  pthread_mutex_unlock(row_mt_sync->job_mutex);
+#else
+  row_mt_sync->parse_aborted = 1;
+#endif  // CONFIG_MULTITHREAD
+}
+
+int av1_dec_row_mt_get_row(AV1DecRowMTSync *row_mt_sync) {
+  int row = -1;
+
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(row_mt_sync->job_mutex);
+  while (row_mt_sync->next_row < row_mt_sync->tile_rows &&
+         row_mt_sync->next_row >= row_mt_sync->parsed_rows &&
+         !row_mt_sync->parse_aborted) {
+    pthread_cond_wait(row_mt_sync->job_cond, row_mt_sync->job_mutex);
+  }
+#endif  // CONFIG_MULTITHREAD
+  if (row_mt_sync->next_row < row_mt_sync->parsed_rows)
+    row = row_mt_sync->next_row++;
+#if CONFIG_MULTITHREAD
+  pthread_mutex_unlock(row_mt_sync->job_mutex);
+#endif  // CONFIG_MULTITHREAD
+  return row;
+}
+
+// As in the loop filter's sync_read(), the progress of the row above is polled
+// for a while before blocking, and sync_write() only takes the lock of a row
+// when a thread is blocked on it.
+void av1_dec_row_mt_sync_read(AV1DecRowMTSync *const row_mt_sync, int r,
+                              int c) {
+#if CONFIG_MULTITHREAD
+  const int nsync = row_mt_sync->sync_range;
+
+  if (r && !(c & (nsync - 1))) {
+    const int *const cur_sb_col = &row_mt_sync->cur_sb_col[r - 1];
+    int *const waiters = &row_mt_sync->waiters[r - 1];
+    pthread_mutex_t *const mutex = &row_mt_sync->mutex_[r - 1];
+    int i;
+
+    for (i = 0; i < AOM_ATOMIC_SPIN_COUNT; ++i)
+      if (c <= aom_atomic_load_int(cur_sb_col) - nsync) return;
+
+    pthread_mutex_lock(mutex);
+    aom_atomic_store_int(waiters, *waiters + 1);
+    while (c > aom_atomic_load_int(cur_sb_col) - nsync) {
+      pthread_cond_wait(&row_mt_sync->cond_[r - 1], mutex);
+    }
+    aom_atomic_store_int(waiters, *waiters - 1);
+    pthread_mutex_unlock(mutex);
+  }
+#else
+  (void)row_mt_sync;
+  (void)r;
+  (void)c;
+#endif  // CONFIG_MULTITHREAD
+}
+
+void av1_dec_row_mt_sync_write(AV1DecRowMTSync *const row_mt_sync, int r,
+                               int c, const int sb_cols) {
+#if CONFIG_MULTITHREAD
+  const int nsync = row_mt_sync->sync_range;
+  int cur;
+  int sig = 1;
+
+  if (c < sb_cols - 1) {
+    cur = c;
+    if (c % nsync) sig = 0;
+  } else {
+    cur = sb_cols + nsync;
+  }
+
+  if (sig) {
+    aom_atomic_store_int(&row_mt_sync->cur_sb_col[r], cur);
+
+    // Only the row below waits on this row.
+    if (aom_atomic_load_int(&row_mt_sync->waiters[r])) {
+      pthread_mutex_lock(&row_mt_sync->mutex_[r]);
+      pthread_cond_signal(&row_mt_sync->cond_[r]);
+      pthread_mutex_unlock(&row_mt_sync->mutex_[r]);
+    }
+  }
+#else
+  (void)row_mt_sync;
+  (void)r;
+  (void)c;
+  (void)sb_cols;
+#endif  // CONFIG_MULTITHREAD
+}
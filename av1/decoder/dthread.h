@@ -43,6 +43,9 @@ typedef struct FrameWorkerData {
 #if CONFIG_MULTITHREAD
   pthread_mutex_t stats_mutex;
   pthread_cond_t stats_cond;
+  // Number of workers blocked in av1_frameworker_wait() on the decoding
+  // progress of this worker's frame.
+  int row_waiters;
 #endif
 
   int frame_context_ready;  // Current frame's context is ready to read.
@@ -68,6 +71,90 @@ void av1_frameworker_broadcast(RefCntBuffer *const buf, int row);
 void av1_frameworker_copy_context(AVxWorker *const dst_worker,
                                   AVxWorker *const src_worker);
 
+// Tile worker threads shared by the frame workers in frame parallel mode. A
+// frame worker borrows the idle workers of the pool for the duration of a
+// frame, so the threads not busy with frames decode tiles and rows instead.
+typedef struct AV1DecWorkerPool {
+#if CONFIG_MULTITHREAD
+  pthread_mutex_t mutex;
+#endif
+  AVxWorker *workers;
+  int *busy;
+  int num_workers;
+} AV1DecWorkerPool;
+
+// Creates the num_workers threads of the pool. Returns 0 on success.
+int av1_dec_worker_pool_init(AV1DecWorkerPool *pool, int num_workers);
+
+// Joins the threads and frees the pool.
+void av1_dec_worker_pool_end(AV1DecWorkerPool *pool);
+
+// Borrows the longest run of idle workers, at most max_workers long. Returns
+// the number of workers borrowed, and the first of them in *workers.
+int av1_dec_worker_pool_acquire(AV1DecWorkerPool *pool, int max_workers,
+                                AVxWorker **workers);
+
+// Returns the workers borrowed by av1_dec_worker_pool_acquire().
+void av1_dec_worker_pool_release(AV1DecWorkerPool *pool, AVxWorker *workers,
+                                 int num_workers);
+
+// Superblock row synchronization of the row-based multi-threaded decoder.
+typedef struct AV1DecRowMTSync {
+#if CONFIG_MULTITHREAD
+  pthread_mutex_t *mutex_;
+  pthread_cond_t *cond_;
+  // Number of threads blocked on the progress of each row.
+  int *waiters;
+#endif
+  // Index of the last reconstructed superblock in each row. It is read and
+  // written atomically, see av1_dec_row_mt_sync_read().
+  int *cur_sb_col;
+  int sync_range;
+  int rows;
+
+  // The rows of a tile are handed to the workers in order as soon as the
+  // parsing thread has read their tokens.
+#if CONFIG_MULTITHREAD
+  pthread_mutex_t *job_mutex;
+  pthread_cond_t *job_cond;
+#endif
+  int tile_rows;
+  int parsed_rows;
+  int next_row;
+  int parse_aborted;
+} AV1DecRowMTSync;
+
+// Allocate memory for superblock row synchronization.
+void av1_dec_row_mt_alloc(AV1DecRowMTSync *row_mt_sync, struct AV1Common *cm,
+                          int rows);
+
+// Deallocate superblock row synchronization related mutex and data.
+void av1_dec_row_mt_dealloc(AV1DecRowMTSync *row_mt_sync);
+
+// Prepares the reconstruction of the rows of a tile, none of them parsed yet.
+void av1_dec_row_mt_start_tile(AV1DecRowMTSync *row_mt_sync, int tile_rows);
+
+// Signal that the first parsed_rows rows of the tile have been parsed.
+void av1_dec_row_mt_set_parsed(AV1DecRowMTSync *row_mt_sync, int parsed_rows);
+
+// Signal that the remaining rows of the tile will not be parsed.
+void av1_dec_row_mt_abort(AV1DecRowMTSync *row_mt_sync);
+
+// Returns the next row of the tile to reconstruct, once it has been parsed, or
+// -1 if no row is left. The rows are handed out in the order they are parsed
+// rather than dealt to the workers up front as by an AVxJobQueue, since the
+// last worker only starts once the whole tile is parsed.
+int av1_dec_row_mt_get_row(AV1DecRowMTSync *row_mt_sync);
+
+// Wait until superblock c of row r may be reconstructed, i.e. until the above
+// and above-right superblocks of row r - 1 are done.
+void av1_dec_row_mt_sync_read(AV1DecRowMTSync *const row_mt_sync, int r,
+                              int c);
+
+// Signal that superblock c of row r has been reconstructed.
+void av1_dec_row_mt_sync_write(AV1DecRowMTSync *const row_mt_sync, int r,
+                               int c, const int sb_cols);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
@@ -58,6 +58,15 @@
 #include "av1/encoder/pvq_encoder.h"
 #endif
 
+// Block state of a tile being packed and the statistics gathered while packing
+// it. The tiles of a tile row may be packed concurrently by the encoder
+// workers, each with its own TilePackState.
+typedef struct TilePackState {
+  MACROBLOCK *x;
+  int interp_filter_selected[SWITCHABLE];
+  unsigned int max_mv_magnitude;
+} TilePackState;
+
 static struct av1_token intra_mode_encodings[INTRA_MODES];
 static struct av1_token switchable_interp_encodings[SWITCHABLE_FILTERS];
 #if CONFIG_EXT_PARTITION_TYPES && !CONFIG_EC_MULTISYMBOL
@@ -1329,8 +1338,8 @@ static void write_intra_angle_info(const MACROBLOCKD *xd,
 }
 #endif  // CONFIG_EXT_INTRA
 
-static void write_mb_interp_filter(AV1_COMP *cpi, const MACROBLOCKD *xd,
-                                   aom_writer *w) {
+static void write_mb_interp_filter(AV1_COMP *cpi, TilePackState *const ps,
+                                   const MACROBLOCKD *xd, aom_writer *w) {
   AV1_COMMON *const cm = &cpi->common;
   const MB_MODE_INFO *const mbmi = &xd->mi[0]->mbmi;
 #if CONFIG_EC_ADAPT
@@ -1359,7 +1368,7 @@ static void write_mb_interp_filter(AV1_COMP *cpi, const MACROBLOCKD *xd,
                         ec_ctx->switchable_interp_prob[ctx],
                         &switchable_interp_encodings[mbmi->interp_filter[dir]]);
 #endif
-        ++cpi->interp_filter_selected[0][mbmi->interp_filter[dir]];
+        ++ps->interp_filter_selected[mbmi->interp_filter[dir]];
       } else {
         assert(mbmi->interp_filter[dir] == EIGHTTAP_REGULAR);
       }
@@ -1375,7 +1384,7 @@ static void write_mb_interp_filter(AV1_COMP *cpi, const MACROBLOCKD *xd,
                       ec_ctx->switchable_interp_prob[ctx],
                       &switchable_interp_encodings[mbmi->interp_filter]);
 #endif
-      ++cpi->interp_filter_selected[0][mbmi->interp_filter];
+      ++ps->interp_filter_selected[mbmi->interp_filter];
     }
 #endif  // CONFIG_DUAL_FILTER
   }
@@ -1559,18 +1568,19 @@ static void write_intra_uv_mode(FRAME_CONTEXT *frame_ctx,
 #endif
 }
 
-static void pack_inter_mode_mvs(AV1_COMP *cpi, const MODE_INFO *mi,
-                                const int mi_row, const int mi_col,
+static void pack_inter_mode_mvs(AV1_COMP *cpi, TilePackState *const ps,
+                                const MODE_INFO *mi, const int mi_row,
+                                const int mi_col,
 #if CONFIG_SUPERTX
                                 int supertx_enabled,
 #endif
                                 aom_writer *w) {
   AV1_COMMON *const cm = &cpi->common;
 #if CONFIG_DELTA_Q || CONFIG_EC_ADAPT
-  MACROBLOCK *const x = &cpi->td.mb;
+  MACROBLOCK *const x = ps->x;
   MACROBLOCKD *const xd = &x->e_mbd;
 #else
-  const MACROBLOCK *x = &cpi->td.mb;
+  const MACROBLOCK *x = ps->x;
   const MACROBLOCKD *xd = &x->e_mbd;
 #endif
 #if CONFIG_EC_ADAPT
@@ -1755,7 +1765,7 @@ static void pack_inter_mode_mvs(AV1_COMP *cpi, const MODE_INFO *mi,
     }
 
 #if !CONFIG_DUAL_FILTER && !CONFIG_WARPED_MOTION && !CONFIG_GLOBAL_MOTION
-    write_mb_interp_filter(cpi, xd, w);
+    write_mb_interp_filter(cpi, ps, xd, w);
 #endif  // !CONFIG_DUAL_FILTER && !CONFIG_WARPED_MOTION
 
     if (bsize < BLOCK_8X8 && !unify_bsize) {
@@ -1808,7 +1818,7 @@ static void pack_inter_mode_mvs(AV1_COMP *cpi, const MODE_INFO *mi,
                             &mbmi_ext->ref_mvs[mbmi->ref_frame[ref]][0].as_mv,
 #endif  // CONFIG_REF_MV
 #endif  // CONFIG_EXT_INTER
-                            nmvc, allow_hp);
+                            nmvc, allow_hp, &ps->max_mv_magnitude);
             }
           }
 #if CONFIG_EXT_INTER
@@ -1821,7 +1831,8 @@ static void pack_inter_mode_mvs(AV1_COMP *cpi, const MODE_INFO *mi,
             nmv_context *nmvc = &ec_ctx->nmvc[nmv_ctx];
 #endif
             av1_encode_mv(cpi, w, &mi->bmi[j].as_mv[1].as_mv,
-                          &mi->bmi[j].ref_mv[1].as_mv, nmvc, allow_hp);
+                          &mi->bmi[j].ref_mv[1].as_mv, nmvc, allow_hp,
+                          &ps->max_mv_magnitude);
           } else if (b_mode == NEW_NEARESTMV || b_mode == NEW_NEARMV) {
 #if CONFIG_REF_MV
             int8_t rf_type = av1_ref_frame_type(mbmi->ref_frame);
@@ -1831,7 +1842,8 @@ static void pack_inter_mode_mvs(AV1_COMP *cpi, const MODE_INFO *mi,
             nmv_context *nmvc = &ec_ctx->nmvc[nmv_ctx];
 #endif
             av1_encode_mv(cpi, w, &mi->bmi[j].as_mv[0].as_mv,
-                          &mi->bmi[j].ref_mv[0].as_mv, nmvc, allow_hp);
+                          &mi->bmi[j].ref_mv[0].as_mv, nmvc, allow_hp,
+                          &ps->max_mv_magnitude);
           }
 #endif  // CONFIG_EXT_INTER
         }
@@ -1856,11 +1868,11 @@ static void pack_inter_mode_mvs(AV1_COMP *cpi, const MODE_INFO *mi,
           if (mode == NEWFROMNEARMV)
             av1_encode_mv(cpi, w, &mbmi->mv[ref].as_mv,
                           &mbmi_ext->ref_mvs[mbmi->ref_frame[ref]][1].as_mv,
-                          nmvc, allow_hp);
+                          nmvc, allow_hp, &ps->max_mv_magnitude);
           else
 #endif  // CONFIG_EXT_INTER
             av1_encode_mv(cpi, w, &mbmi->mv[ref].as_mv, &ref_mv.as_mv, nmvc,
-                          allow_hp);
+                          allow_hp, &ps->max_mv_magnitude);
         }
 #if CONFIG_EXT_INTER
       } else if (mode == NEAREST_NEWMV || mode == NEAR_NEWMV) {
@@ -1873,7 +1885,7 @@ static void pack_inter_mode_mvs(AV1_COMP *cpi, const MODE_INFO *mi,
 #endif
         av1_encode_mv(cpi, w, &mbmi->mv[1].as_mv,
                       &mbmi_ext->ref_mvs[mbmi->ref_frame[1]][0].as_mv, nmvc,
-                      allow_hp);
+                      allow_hp, &ps->max_mv_magnitude);
       } else if (mode == NEW_NEARESTMV || mode == NEW_NEARMV) {
 #if CONFIG_REF_MV
         int8_t rf_type = av1_ref_frame_type(mbmi->ref_frame);
@@ -1884,7 +1896,7 @@ static void pack_inter_mode_mvs(AV1_COMP *cpi, const MODE_INFO *mi,
 #endif
         av1_encode_mv(cpi, w, &mbmi->mv[0].as_mv,
                       &mbmi_ext->ref_mvs[mbmi->ref_frame[0]][0].as_mv, nmvc,
-                      allow_hp);
+                      allow_hp, &ps->max_mv_magnitude);
 #endif  // CONFIG_EXT_INTER
       }
     }
@@ -1952,7 +1964,7 @@ static void pack_inter_mode_mvs(AV1_COMP *cpi, const MODE_INFO *mi,
     if (mbmi->motion_mode != WARPED_CAUSAL)
 #endif  // CONFIG_WARPED_MOTION
 #if CONFIG_DUAL_FILTER || CONFIG_WARPED_MOTION || CONFIG_GLOBAL_MOTION
-      write_mb_interp_filter(cpi, xd, w);
+      write_mb_interp_filter(cpi, ps, xd, w);
 #endif  // CONFIG_DUAL_FILTE || CONFIG_WARPED_MOTION
   }
 
@@ -2070,13 +2082,14 @@ static void write_mb_modes_kf(AV1_COMMON *cm, const MACROBLOCKD *xd,
 }
 
 #if CONFIG_SUPERTX
-#define write_modes_b_wrapper(cpi, tile, w, tok, tok_end, supertx_enabled, \
-                              mi_row, mi_col)                              \
-  write_modes_b(cpi, tile, w, tok, tok_end, supertx_enabled, mi_row, mi_col)
+#define write_modes_b_wrapper(cpi, ps, tile, w, tok, tok_end,            \
+                              supertx_enabled, mi_row, mi_col)           \
+  write_modes_b(cpi, ps, tile, w, tok, tok_end, supertx_enabled, mi_row, \
+                mi_col)
 #else
-#define write_modes_b_wrapper(cpi, tile, w, tok, tok_end, supertx_enabled, \
-                              mi_row, mi_col)                              \
-  write_modes_b(cpi, tile, w, tok, tok_end, mi_row, mi_col)
+#define write_modes_b_wrapper(cpi, ps, tile, w, tok, tok_end,  \
+                              supertx_enabled, mi_row, mi_col) \
+  write_modes_b(cpi, ps, tile, w, tok, tok_end, mi_row, mi_col)
 #endif  // CONFIG_SUPERTX
 
 #if CONFIG_RD_DEBUG
@@ -2122,14 +2135,14 @@ static int rd_token_stats_mismatch(RD_STATS *rd_stats, TOKEN_STATS *token_stats,
 }
 #endif
 
-static void write_mbmi_b(AV1_COMP *cpi, const TileInfo *const tile,
-                         aom_writer *w,
+static void write_mbmi_b(AV1_COMP *cpi, TilePackState *const ps,
+                         const TileInfo *const tile, aom_writer *w,
 #if CONFIG_SUPERTX
                          int supertx_enabled,
 #endif
                          int mi_row, int mi_col) {
   AV1_COMMON *const cm = &cpi->common;
-  MACROBLOCKD *const xd = &cpi->td.mb.e_mbd;
+  MACROBLOCKD *const xd = &ps->x->e_mbd;
   MODE_INFO *m;
   int bh, bw;
   xd->mi = cm->mi_grid_visible + (mi_row * cm->mi_stride + mi_col);
@@ -2140,7 +2153,7 @@ static void write_mbmi_b(AV1_COMP *cpi, const TileInfo *const tile,
   bh = mi_size_high[m->mbmi.sb_type];
   bw = mi_size_wide[m->mbmi.sb_type];
 
-  cpi->td.mb.mbmi_ext = cpi->mbmi_ext_base + (mi_row * cm->mi_cols + mi_col);
+  ps->x->mbmi_ext = cpi->mbmi_ext_base + (mi_row * cm->mi_cols + mi_col);
 
 #if CONFIG_DEPENDENT_HORZTILES
   set_mi_row_col(xd, tile, mi_row, bh, mi_col, bw, cm->mi_rows, cm->mi_cols,
@@ -2187,7 +2200,7 @@ static void write_mbmi_b(AV1_COMP *cpi, const TileInfo *const tile,
              m->mbmi.ref_frame[0], m->mbmi.ref_frame[1]);
     }
 #endif  // 0
-    pack_inter_mode_mvs(cpi, m, mi_row, mi_col,
+    pack_inter_mode_mvs(cpi, ps, m, mi_row, mi_col,
 #if CONFIG_SUPERTX
                         supertx_enabled,
 #endif
@@ -2195,18 +2208,19 @@ static void write_mbmi_b(AV1_COMP *cpi, const TileInfo *const tile,
   }
 }
 
-static void write_tokens_b(AV1_COMP *cpi, const TileInfo *const tile,
-                           aom_writer *w, const TOKENEXTRA **tok,
+static void write_tokens_b(AV1_COMP *cpi, TilePackState *const ps,
+                           const TileInfo *const tile, aom_writer *w,
+                           const TOKENEXTRA **tok,
                            const TOKENEXTRA *const tok_end, int mi_row,
                            int mi_col) {
   AV1_COMMON *const cm = &cpi->common;
-  MACROBLOCKD *const xd = &cpi->td.mb.e_mbd;
+  MACROBLOCKD *const xd = &ps->x->e_mbd;
   MODE_INFO *const m = xd->mi[0];
   MB_MODE_INFO *const mbmi = &m->mbmi;
   int plane;
   int bh, bw;
 #if CONFIG_PVQ || CONFIG_LV_MAP
-  MACROBLOCK *const x = &cpi->td.mb;
+  MACROBLOCK *const x = ps->x;
   (void)tok;
   (void)tok_end;
 #endif
@@ -2216,7 +2230,7 @@ static void write_tokens_b(AV1_COMP *cpi, const TileInfo *const tile,
 
   bh = mi_size_high[mbmi->sb_type];
   bw = mi_size_wide[mbmi->sb_type];
-  cpi->td.mb.mbmi_ext = cpi->mbmi_ext_base + (mi_row * cm->mi_cols + mi_col);
+  ps->x->mbmi_ext = cpi->mbmi_ext_base + (mi_row * cm->mi_cols + mi_col);
 
 #if CONFIG_DEPENDENT_HORZTILES
   set_mi_row_col(xd, tile, mi_row, bh, mi_col, bw, cm->mi_rows, cm->mi_cols,
@@ -2432,8 +2446,9 @@ static void write_tokens_b(AV1_COMP *cpi, const TileInfo *const tile,
 }
 
 #if CONFIG_MOTION_VAR && CONFIG_NCOBMC
-static void write_tokens_sb(AV1_COMP *cpi, const TileInfo *const tile,
-                            aom_writer *w, const TOKENEXTRA **tok,
+static void write_tokens_sb(AV1_COMP *cpi, TilePackState *const ps,
+                            const TileInfo *const tile, aom_writer *w,
+                            const TOKENEXTRA **tok,
                             const TOKENEXTRA *const tok_end, int mi_row,
                             int mi_col, BLOCK_SIZE bsize) {
   const AV1_COMMON *const cm = &cpi->common;
@@ -2452,51 +2467,54 @@ static void write_tokens_sb(AV1_COMP *cpi, const TileInfo *const tile,
   subsize = get_subsize(bsize, partition);
 
   if (subsize < BLOCK_8X8 && !unify_bsize) {
-    write_tokens_b(cpi, tile, w, tok, tok_end, mi_row, mi_col);
+    write_tokens_b(cpi, ps, tile, w, tok, tok_end, mi_row, mi_col);
   } else {
     switch (partition) {
       case PARTITION_NONE:
-        write_tokens_b(cpi, tile, w, tok, tok_end, mi_row, mi_col);
+        write_tokens_b(cpi, ps, tile, w, tok, tok_end, mi_row, mi_col);
         break;
       case PARTITION_HORZ:
-        write_tokens_b(cpi, tile, w, tok, tok_end, mi_row, mi_col);
+        write_tokens_b(cpi, ps, tile, w, tok, tok_end, mi_row, mi_col);
         if (mi_row + hbs < cm->mi_rows)
-          write_tokens_b(cpi, tile, w, tok, tok_end, mi_row + hbs, mi_col);
+          write_tokens_b(cpi, ps, tile, w, tok, tok_end, mi_row + hbs, mi_col);
         break;
       case PARTITION_VERT:
-        write_tokens_b(cpi, tile, w, tok, tok_end, mi_row, mi_col);
+        write_tokens_b(cpi, ps, tile, w, tok, tok_end, mi_row, mi_col);
         if (mi_col + hbs < cm->mi_cols)
-          write_tokens_b(cpi, tile, w, tok, tok_end, mi_row, mi_col + hbs);
+          write_tokens_b(cpi, ps, tile, w, tok, tok_end, mi_row, mi_col + hbs);
         break;
       case PARTITION_SPLIT:
-        write_tokens_sb(cpi, tile, w, tok, tok_end, mi_row, mi_col, subsize);
-        write_tokens_sb(cpi, tile, w, tok, tok_end, mi_row, mi_col + hbs,
+        write_tokens_sb(cpi, ps, tile, w, tok, tok_end, mi_row, mi_col,
                         subsize);
-        write_tokens_sb(cpi, tile, w, tok, tok_end, mi_row + hbs, mi_col,
+        write_tokens_sb(cpi, ps, tile, w, tok, tok_end, mi_row, mi_col + hbs,
                         subsize);
-        write_tokens_sb(cpi, tile, w, tok, tok_end, mi_row + hbs, mi_col + hbs,
+        write_tokens_sb(cpi, ps, tile, w, tok, tok_end, mi_row + hbs, mi_col,
                         subsize);
+        write_tokens_sb(cpi, ps, tile, w, tok, tok_end, mi_row + hbs,
+                        mi_col + hbs, subsize);
         break;
 #if CONFIG_EXT_PARTITION_TYPES
       case PARTITION_HORZ_A:
-        write_tokens_b(cpi, tile, w, tok, tok_end, mi_row, mi_col);
-        write_tokens_b(cpi, tile, w, tok, tok_end, mi_row, mi_col + hbs);
-        write_tokens_b(cpi, tile, w, tok, tok_end, mi_row + hbs, mi_col);
+        write_tokens_b(cpi, ps, tile, w, tok, tok_end, mi_row, mi_col);
+        write_tokens_b(cpi, ps, tile, w, tok, tok_end, mi_row, mi_col + hbs);
+        write_tokens_b(cpi, ps, tile, w, tok, tok_end, mi_row + hbs, mi_col);
         break;
       case PARTITION_HORZ_B:
-        write_tokens_b(cpi, tile, w, tok, tok_end, mi_row, mi_col);
-        write_tokens_b(cpi, tile, w, tok, tok_end, mi_row + hbs, mi_col);
-        write_tokens_b(cpi, tile, w, tok, tok_end, mi_row + hbs, mi_col + hbs);
+        write_tokens_b(cpi, ps, tile, w, tok, tok_end, mi_row, mi_col);
+        write_tokens_b(cpi, ps, tile, w, tok, tok_end, mi_row + hbs, mi_col);
+        write_tokens_b(cpi, ps, tile, w, tok, tok_end, mi_row + hbs,
+                       mi_col + hbs);
         break;
       case PARTITION_VERT_A:
-        write_tokens_b(cpi, tile, w, tok, tok_end, mi_row, mi_col);
-        write_tokens_b(cpi, tile, w, tok, tok_end, mi_row + hbs, mi_col);
-        write_tokens_b(cpi, tile, w, tok, tok_end, mi_row, mi_col + hbs);
+        write_tokens_b(cpi, ps, tile, w, tok, tok_end, mi_row, mi_col);
+        write_tokens_b(cpi, ps, tile, w, tok, tok_end, mi_row + hbs, mi_col);
+        write_tokens_b(cpi, ps, tile, w, tok, tok_end, mi_row, mi_col + hbs);
         break;
       case PARTITION_VERT_B:
-        write_tokens_b(cpi, tile, w, tok, tok_end, mi_row, mi_col);
-        write_tokens_b(cpi, tile, w, tok, tok_end, mi_row, mi_col + hbs);
-        write_tokens_b(cpi, tile, w, tok, tok_end, mi_row + hbs, mi_col + hbs);
+        write_tokens_b(cpi, ps, tile, w, tok, tok_end, mi_row, mi_col);
+        write_tokens_b(cpi, ps, tile, w, tok, tok_end, mi_row, mi_col + hbs);
+        write_tokens_b(cpi, ps, tile, w, tok, tok_end, mi_row + hbs,
+                       mi_col + hbs);
         break;
 #endif  // CONFIG_EXT_PARTITION_TYPES
       default: assert(0);
@@ -2505,14 +2523,15 @@ static void write_tokens_sb(AV1_COMP *cpi, const TileInfo *const tile,
 }
 #endif
 
-static void write_modes_b(AV1_COMP *cpi, const TileInfo *const tile,
-                          aom_writer *w, const TOKENEXTRA **tok,
+static void write_modes_b(AV1_COMP *cpi, TilePackState *const ps,
+                          const TileInfo *const tile, aom_writer *w,
+                          const TOKENEXTRA **tok,
                           const TOKENEXTRA *const tok_end,
 #if CONFIG_SUPERTX
                           int supertx_enabled,
 #endif
                           int mi_row, int mi_col) {
-  write_mbmi_b(cpi, tile, w,
+  write_mbmi_b(cpi, ps, tile, w,
 #if CONFIG_SUPERTX
                supertx_enabled,
 #endif
@@ -2524,7 +2543,7 @@ static void write_modes_b(AV1_COMP *cpi, const TileInfo *const tile,
 #if !CONFIG_PVQ && CONFIG_SUPERTX
   if (!supertx_enabled)
 #endif
-    write_tokens_b(cpi, tile, w, tok, tok_end, mi_row, mi_col);
+    write_tokens_b(cpi, ps, tile, w, tok, tok_end, mi_row, mi_col);
 #endif
 }
 
@@ -2592,25 +2611,26 @@ static void write_partition(const AV1_COMMON *const cm,
 }
 
 #if CONFIG_SUPERTX
-#define write_modes_sb_wrapper(cpi, tile, w, tok, tok_end, supertx_enabled,   \
-                               mi_row, mi_col, bsize)                         \
-  write_modes_sb(cpi, tile, w, tok, tok_end, supertx_enabled, mi_row, mi_col, \
-                 bsize)
+#define write_modes_sb_wrapper(cpi, ps, tile, w, tok, tok_end,            \
+                               supertx_enabled, mi_row, mi_col, bsize)    \
+  write_modes_sb(cpi, ps, tile, w, tok, tok_end, supertx_enabled, mi_row, \
+                 mi_col, bsize)
 #else
-#define write_modes_sb_wrapper(cpi, tile, w, tok, tok_end, supertx_enabled, \
-                               mi_row, mi_col, bsize)                       \
-  write_modes_sb(cpi, tile, w, tok, tok_end, mi_row, mi_col, bsize)
+#define write_modes_sb_wrapper(cpi, ps, tile, w, tok, tok_end,         \
+                               supertx_enabled, mi_row, mi_col, bsize) \
+  write_modes_sb(cpi, ps, tile, w, tok, tok_end, mi_row, mi_col, bsize)
 #endif  // CONFIG_SUPERTX
 
-static void write_modes_sb(AV1_COMP *const cpi, const TileInfo *const tile,
-                           aom_writer *const w, const TOKENEXTRA **tok,
+static void write_modes_sb(AV1_COMP *const cpi, TilePackState *const ps,
+                           const TileInfo *const tile, aom_writer *const w,
+                           const TOKENEXTRA **tok,
                            const TOKENEXTRA *const tok_end,
 #if CONFIG_SUPERTX
                            int supertx_enabled,
 #endif
                            int mi_row, int mi_col, BLOCK_SIZE bsize) {
   const AV1_COMMON *const cm = &cpi->common;
-  MACROBLOCKD *const xd = &cpi->td.mb.e_mbd;
+  MACROBLOCKD *const xd = &ps->x->e_mbd;
   const int hbs = mi_size_wide[bsize] / 2;
   const PARTITION_TYPE partition = get_partition(cm, mi_row, mi_col, bsize);
   const BLOCK_SIZE subsize = get_subsize(bsize, partition);
@@ -2654,69 +2674,69 @@ static void write_modes_sb(AV1_COMP *const cpi, const TileInfo *const tile,
   }
 #endif  // CONFIG_SUPERTX
   if (subsize < BLOCK_8X8 && !unify_bsize) {
-    write_modes_b_wrapper(cpi, tile, w, tok, tok_end, supertx_enabled, mi_row,
-                          mi_col);
+    write_modes_b_wrapper(cpi, ps, tile, w, tok, tok_end, supertx_enabled,
+                          mi_row, mi_col);
   } else {
     switch (partition) {
       case PARTITION_NONE:
-        write_modes_b_wrapper(cpi, tile, w, tok, tok_end, supertx_enabled,
+        write_modes_b_wrapper(cpi, ps, tile, w, tok, tok_end, supertx_enabled,
                               mi_row, mi_col);
         break;
       case PARTITION_HORZ:
-        write_modes_b_wrapper(cpi, tile, w, tok, tok_end, supertx_enabled,
+        write_modes_b_wrapper(cpi, ps, tile, w, tok, tok_end, supertx_enabled,
                               mi_row, mi_col);
         if (mi_row + hbs < cm->mi_rows)
-          write_modes_b_wrapper(cpi, tile, w, tok, tok_end, supertx_enabled,
+          write_modes_b_wrapper(cpi, ps, tile, w, tok, tok_end, supertx_enabled,
                                 mi_row + hbs, mi_col);
         break;
       case PARTITION_VERT:
-        write_modes_b_wrapper(cpi, tile, w, tok, tok_end, supertx_enabled,
+        write_modes_b_wrapper(cpi, ps, tile, w, tok, tok_end, supertx_enabled,
                               mi_row, mi_col);
         if (mi_col + hbs < cm->mi_cols)
-          write_modes_b_wrapper(cpi, tile, w, tok, tok_end, supertx_enabled,
+          write_modes_b_wrapper(cpi, ps, tile, w, tok, tok_end, supertx_enabled,
                                 mi_row, mi_col + hbs);
         break;
       case PARTITION_SPLIT:
-        write_modes_sb_wrapper(cpi, tile, w, tok, tok_end, supertx_enabled,
+        write_modes_sb_wrapper(cpi, ps, tile, w, tok, tok_end, supertx_enabled,
                                mi_row, mi_col, subsize);
-        write_modes_sb_wrapper(cpi, tile, w, tok, tok_end, supertx_enabled,
+        write_modes_sb_wrapper(cpi, ps, tile, w, tok, tok_end, supertx_enabled,
                                mi_row, mi_col + hbs, subsize);
-        write_modes_sb_wrapper(cpi, tile, w, tok, tok_end, supertx_enabled,
+        write_modes_sb_wrapper(cpi, ps, tile, w, tok, tok_end, supertx_enabled,
                                mi_row + hbs, mi_col, subsize);
-        write_modes_sb_wrapper(cpi, tile, w, tok, tok_end, supertx_enabled,
+        write_modes_sb_wrapper(cpi, ps, tile, w, tok, tok_end, supertx_enabled,
                                mi_row + hbs, mi_col + hbs, subsize);
         break;
 #if CONFIG_EXT_PARTITION_TYPES
       case PARTITION_HORZ_A:
-        write_modes_b_wrapper(cpi, tile, w, tok, tok_end, supertx_enabled,
+        write_modes_b_wrapper(cpi, ps, tile, w, tok, tok_end, supertx_enabled,
                               mi_row, mi_col);
-        write_modes_b_wrapper(cpi, tile, w, tok, tok_end, supertx_enabled,
+        write_modes_b_wrapper(cpi, ps, tile, w, tok, tok_end, supertx_enabled,
                               mi_row, mi_col + hbs);
-        write_modes_b_wrapper(cpi, tile, w, tok, tok_end, supertx_enabled,
+        write_modes_b_wrapper(cpi, ps, tile, w, tok, tok_end, supertx_enabled,
                               mi_row + hbs, mi_col);
         break;
       case PARTITION_HORZ_B:
-        write_modes_b_wrapper(cpi, tile, w, tok, tok_end, supertx_enabled,
+        write_modes_b_wrapper(cpi, ps, tile, w, tok, tok_end, supertx_enabled,
                               mi_row, mi_col);
-        write_modes_b_wrapper(cpi, tile, w, tok, tok_end, supertx_enabled,
+        write_modes_b_wrapper(cpi, ps, tile, w, tok, tok_end, supertx_enabled,
                               mi_row + hbs, mi_col);
-        write_modes_b_wrapper(cpi, tile, w, tok, tok_end, supertx_enabled,
+        write_modes_b_wrapper(cpi, ps, tile, w, tok, tok_end, supertx_enabled,
                               mi_row + hbs, mi_col + hbs);
         break;
       case PARTITION_VERT_A:
-        write_modes_b_wrapper(cpi, tile, w, tok, tok_end, supertx_enabled,
+        write_modes_b_wrapper(cpi, ps, tile, w, tok, tok_end, supertx_enabled,
                               mi_row, mi_col);
-        write_modes_b_wrapper(cpi, tile, w, tok, tok_end, supertx_enabled,
+        write_modes_b_wrapper(cpi, ps, tile, w, tok, tok_end, supertx_enabled,
                               mi_row + hbs, mi_col);
-        write_modes_b_wrapper(cpi, tile, w, tok, tok_end, supertx_enabled,
+        write_modes_b_wrapper(cpi, ps, tile, w, tok, tok_end, supertx_enabled,
                               mi_row, mi_col + hbs);
         break;
       case PARTITION_VERT_B:
-        write_modes_b_wrapper(cpi, tile, w, tok, tok_end, supertx_enabled,
+        write_modes_b_wrapper(cpi, ps, tile, w, tok, tok_end, supertx_enabled,
                               mi_row, mi_col);
-        write_modes_b_wrapper(cpi, tile, w, tok, tok_end, supertx_enabled,
+        write_modes_b_wrapper(cpi, ps, tile, w, tok, tok_end, supertx_enabled,
                               mi_row, mi_col + hbs);
-        write_modes_b_wrapper(cpi, tile, w, tok, tok_end, supertx_enabled,
+        write_modes_b_wrapper(cpi, ps, tile, w, tok, tok_end, supertx_enabled,
                               mi_row + hbs, mi_col + hbs);
         break;
 #endif  // CONFIG_EXT_PARTITION_TYPES
@@ -2837,11 +2857,12 @@ static void write_modes_sb(AV1_COMP *const cpi, const TileInfo *const tile,
 #endif
 }
 
-static void write_modes(AV1_COMP *const cpi, const TileInfo *const tile,
-                        aom_writer *const w, const TOKENEXTRA **tok,
+static void write_modes(AV1_COMP *const cpi, TilePackState *const ps,
+                        const TileInfo *const tile, aom_writer *const w,
+                        const TOKENEXTRA **tok,
                         const TOKENEXTRA *const tok_end) {
   AV1_COMMON *const cm = &cpi->common;
-  MACROBLOCKD *const xd = &cpi->td.mb.e_mbd;
+  MACROBLOCKD *const xd = &ps->x->e_mbd;
   const int mi_row_start = tile->mi_row_start;
   const int mi_row_end = tile->mi_row_end;
   const int mi_col_start = tile->mi_col_start;
@@ -2861,7 +2882,7 @@ static void write_modes(AV1_COMP *const cpi, const TileInfo *const tile,
   av1_zero_above_context(cm, mi_col_start, mi_col_end);
 #endif
 #if CONFIG_PVQ
-  assert(cpi->td.mb.pvq_q->curr_pos == 0);
+  assert(ps->x->pvq_q->curr_pos == 0);
 #endif
 #if CONFIG_DELTA_Q
   if (cpi->common.delta_q_present_flag) {
@@ -2873,19 +2894,20 @@ static void write_modes(AV1_COMP *const cpi, const TileInfo *const tile,
     av1_zero_left_context(xd);
 
     for (mi_col = mi_col_start; mi_col < mi_col_end; mi_col += cm->mib_size) {
-      write_modes_sb_wrapper(cpi, tile, w, tok, tok_end, 0, mi_row, mi_col,
+      write_modes_sb_wrapper(cpi, ps, tile, w, tok, tok_end, 0, mi_row, mi_col,
                              cm->sb_size);
 #if CONFIG_MOTION_VAR && CONFIG_NCOBMC
-      write_tokens_sb(cpi, tile, w, tok, tok_end, mi_row, mi_col, cm->sb_size);
+      write_tokens_sb(cpi, ps, tile, w, tok, tok_end, mi_row, mi_col,
+                      cm->sb_size);
 #endif
     }
   }
 #if CONFIG_PVQ
   // Check that the number of PVQ blocks encoded and written to the bitstream
   // are the same
-  assert(cpi->td.mb.pvq_q->curr_pos == cpi->td.mb.pvq_q->last_pos);
+  assert(ps->x->pvq_q->curr_pos == ps->x->pvq_q->last_pos);
   // Reset curr_pos in case we repack the bitstream
-  cpi->td.mb.pvq_q->curr_pos = 0;
+  ps->x->pvq_q->curr_pos = 0;
 #endif
 }
 
@@ -3885,6 +3907,195 @@ static INLINE int find_identical_tile(
 }
 #endif  // CONFIG_EXT_TILE
 
+// Writes the modes and tokens of a tile to dst and returns their size.
+static uint32_t pack_tile(AV1_COMP *const cpi, TilePackState *const ps,
+                          const TileInfo *const tile_info, int tile_row,
+                          int tile_col, uint8_t *const dst) {
+  const TOKENEXTRA *tok = cpi->tile_tok[tile_row][tile_col];
+  const TOKENEXTRA *const tok_end = tok + cpi->tok_count[tile_row][tile_col];
+#if CONFIG_PVQ || CONFIG_EC_ADAPT
+  TileDataEnc *const this_tile =
+      &cpi->tile_data[tile_row * cpi->common.tile_cols + tile_col];
+#endif
+#if CONFIG_ANS
+  struct BufAnsCoder *const buf_ans = &cpi->buf_ans;
+#else
+  aom_writer mode_bc;
+#endif  // CONFIG_ANS
+  uint32_t tile_size;
+
+#if CONFIG_EC_ADAPT
+  // Initialise tile context from the frame context
+  this_tile->tctx = *cpi->common.fc;
+  ps->x->e_mbd.tile_ctx = &this_tile->tctx;
+#endif
+#if CONFIG_PVQ
+  ps->x->pvq_q = &this_tile->pvq_q;
+  ps->x->daala_enc.state.adapt = &this_tile->tctx.pvq_context;
+#endif  // CONFIG_PVQ
+#if CONFIG_ANS
+  buf_ans_write_init(buf_ans, dst);
+  write_modes(cpi, ps, tile_info, buf_ans, &tok, tok_end);
+  assert(tok == tok_end);
+  aom_buf_ans_flush(buf_ans);
+  tile_size = buf_ans_write_end(buf_ans);
+#else
+  aom_start_encode(&mode_bc, dst);
+  write_modes(cpi, ps, tile_info, &mode_bc, &tok, tok_end);
+#if !CONFIG_LV_MAP
+  assert(tok == tok_end);
+#endif  // !CONFIG_LV_MAP
+  aom_stop_encode(&mode_bc);
+  tile_size = mode_bc.pos;
+#endif  // CONFIG_ANS
+#if CONFIG_PVQ
+  ps->x->pvq_q = NULL;
+#endif
+
+  return tile_size;
+}
+
+static void init_tile_pack_state(TilePackState *const ps, MACROBLOCK *x) {
+  av1_zero(*ps);
+  ps->x = x;
+}
+
+// Adds the statistics gathered while packing tiles to the ones of the frame.
+static void merge_tile_pack_state(AV1_COMP *const cpi,
+                                  const TilePackState *const ps) {
+  int i;
+  for (i = 0; i < SWITCHABLE; ++i)
+    cpi->interp_filter_selected[0][i] += ps->interp_filter_selected[i];
+  cpi->max_mv_magnitude = AOMMAX(cpi->max_mv_magnitude, ps->max_mv_magnitude);
+}
+
+#if !CONFIG_EXT_TILE
+// The tiles of a tile row are packed concurrently by the encoder workers when
+// each tile has an entropy coder of its own that keeps the coded data until it
+// is stopped. The ANS coder and the PVQ state are shared by all the tiles, the
+// bitstream debugging queue expects the symbols in order, and the dk writer
+// writes to its buffer as it goes, so these configurations pack the tiles one
+// after the other.
+#define PACK_TILES_MT \
+  (CONFIG_DAALA_EC && !CONFIG_ANS && !CONFIG_PVQ && !CONFIG_BITSTREAM_DEBUG)
+
+// Whether the tiles of each tile row are packed concurrently by the encoder
+// workers.
+static int use_tile_pack_workers(const AV1_COMP *const cpi) {
+#if PACK_TILES_MT
+  return cpi->num_workers > 1 && cpi->common.tile_cols > 1;
+#else
+  (void)cpi;
+  return 0;
+#endif
+}
+
+#if PACK_TILES_MT
+// Tiles of a tile row packed by one encoder worker, taken from the job queue
+// of the encoder.
+typedef struct TilePackJob {
+  AV1_COMP *cpi;
+  TilePackState ps;
+  aom_writer *writers;
+  int tile_row;
+  int worker;
+} TilePackJob;
+
+// Codes the tile like pack_tile() does, but leaves the coded data in w. The
+// data is written to the bitstream by finish_tile().
+static void code_tile(AV1_COMP *const cpi, TilePackState *const ps,
+                      const TileInfo *const tile_info, int tile_row,
+                      int tile_col, aom_writer *const w) {
+  const TOKENEXTRA *tok = cpi->tile_tok[tile_row][tile_col];
+  const TOKENEXTRA *const tok_end = tok + cpi->tok_count[tile_row][tile_col];
+#if CONFIG_EC_ADAPT
+  TileDataEnc *const this_tile =
+      &cpi->tile_data[tile_row * cpi->common.tile_cols + tile_col];
+
+  // Initialise tile context from the frame context
+  this_tile->tctx = *cpi->common.fc;
+  ps->x->e_mbd.tile_ctx = &this_tile->tctx;
+#endif
+  aom_start_encode(w, NULL);
+  write_modes(cpi, ps, tile_info, w, &tok, tok_end);
+#if !CONFIG_LV_MAP
+  assert(tok == tok_end);
+#endif  // !CONFIG_LV_MAP
+}
+
+// Writes the data coded by code_tile() to dst and returns its size.
+static uint32_t finish_tile(aom_writer *const w, uint8_t *const dst) {
+  w->buffer = dst;
+  aom_stop_encode(w);
+  return w->pos;
+}
+
+static int tile_pack_worker_hook(TilePackJob *const job, void *unused) {
+  AV1_COMP *const cpi = job->cpi;
+  const AV1_COMMON *const cm = &cpi->common;
+  int tile_col;
+  (void)unused;
+
+  while ((tile_col = aom_job_queue_next(&cpi->job_queue, job->worker)) >= 0) {
+    TileInfo tile_info;
+    av1_tile_set_row(&tile_info, cm, job->tile_row);
+    av1_tile_set_col(&tile_info, cm, tile_col);
+#if CONFIG_DEPENDENT_HORZTILES && CONFIG_TILE_GROUPS
+    // The tile group layout is known before the tiles are packed.
+    av1_tile_set_tg_boundary(&tile_info, cm, job->tile_row, tile_col);
+#endif
+    code_tile(cpi, &job->ps, &tile_info, job->tile_row, tile_col,
+              &job->writers[tile_col]);
+  }
+  return 1;
+}
+
+// Codes the tiles of tile_row concurrently, tile tile_col with
+// writers[tile_col]. The tiles of different tile rows share the above
+// context, so only the tiles of one tile row are coded at a time.
+static void pack_tile_row_mt(AV1_COMP *const cpi, int tile_row,
+                             aom_writer *const writers) {
+  AV1_COMMON *const cm = &cpi->common;
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+  const int num_workers = AOMMIN(cpi->num_workers, cm->tile_cols);
+  TilePackJob jobs[MAX_TILE_COLS];
+  int i;
+
+  aom_job_queue_reset(&cpi->job_queue, cm->tile_cols, num_workers);
+  for (i = 0; i < num_workers; ++i) {
+    AVxWorker *const worker = &cpi->workers[i];
+    TilePackJob *const job = &jobs[i];
+    // The last job runs on the main thread with the macroblock of cpi. The
+    // others use the macroblock of the thread data of their worker, which
+    // only needs the block state of cpi's.
+    MACROBLOCK *const x = i == num_workers - 1
+                              ? &cpi->td.mb
+                              : &cpi->tile_thr_data[i].td->mb;
+    if (x != &cpi->td.mb) x->e_mbd = cpi->td.mb.e_mbd;
+
+    job->cpi = cpi;
+    init_tile_pack_state(&job->ps, x);
+    job->writers = writers;
+    job->tile_row = tile_row;
+    job->worker = i;
+
+    worker->hook = (AVxWorkerHook)tile_pack_worker_hook;
+    worker->data1 = job;
+    worker->data2 = NULL;
+    if (i == num_workers - 1)
+      winterface->execute(worker);
+    else
+      winterface->launch(worker);
+  }
+
+  for (i = 0; i < num_workers; ++i) {
+    winterface->sync(&cpi->workers[i]);
+    merge_tile_pack_state(cpi, &jobs[i].ps);
+  }
+}
+#endif  // PACK_TILES_MT
+#endif  // !CONFIG_EXT_TILE
+
 #if CONFIG_TILE_GROUPS
 static uint32_t write_tiles(AV1_COMP *const cpi,
                             struct aom_write_bit_buffer *wb,
@@ -3896,13 +4107,7 @@ static uint32_t write_tiles(AV1_COMP *const cpi, uint8_t *const dst,
                             unsigned int *max_tile_col_size) {
 #endif
   const AV1_COMMON *const cm = &cpi->common;
-#if CONFIG_ANS
-  struct BufAnsCoder *buf_ans = &cpi->buf_ans;
-#else
-  aom_writer mode_bc;
-#endif  // CONFIG_ANS
   int tile_row, tile_col;
-  TOKENEXTRA *(*const tok_buffers)[MAX_TILE_COLS] = cpi->tile_tok;
   TileBufferEnc(*const tile_buffers)[MAX_TILE_COLS] = cpi->tile_buffers;
   size_t total_size = 0;
   const int tile_cols = cm->tile_cols;
@@ -3931,6 +4136,11 @@ static uint32_t write_tiles(AV1_COMP *const cpi, uint8_t *const dst,
 #endif
 #if CONFIG_EXT_TILE
   const int have_tiles = tile_cols * tile_rows > 1;
+#else
+  const int pack_mt = use_tile_pack_workers(cpi);
+#if PACK_TILES_MT
+  aom_writer tile_writers[MAX_TILE_COLS];
+#endif
 #endif  // CONFIG_EXT_TILE
 
   *max_tile_size = 0;
@@ -3952,13 +4162,8 @@ static uint32_t write_tiles(AV1_COMP *const cpi, uint8_t *const dst,
 
     for (tile_row = 0; tile_row < tile_rows; tile_row++) {
       TileBufferEnc *const buf = &tile_buffers[tile_row][tile_col];
-      const TOKENEXTRA *tok = tok_buffers[tile_row][tile_col];
-      const TOKENEXTRA *tok_end = tok + cpi->tok_count[tile_row][tile_col];
       const int data_offset = have_tiles ? 4 : 0;
-#if CONFIG_EC_ADAPT
-      const int tile_idx = tile_row * tile_cols + tile_col;
-      TileDataEnc *this_tile = &cpi->tile_data[tile_idx];
-#endif
+      TilePackState ps;
       av1_tile_set_row(&tile_info, cm, tile_row);
 
       buf->data = dst + total_size;
@@ -3966,31 +4171,10 @@ static uint32_t write_tiles(AV1_COMP *const cpi, uint8_t *const dst,
       // Is CONFIG_EXT_TILE = 1, every tile in the row has a header,
       // even for the last one, unless no tiling is used at all.
       total_size += data_offset;
-#if CONFIG_EC_ADAPT
-      // Initialise tile context from the frame context
-      this_tile->tctx = *cm->fc;
-      cpi->td.mb.e_mbd.tile_ctx = &this_tile->tctx;
-#endif
-#if CONFIG_PVQ
-      cpi->td.mb.pvq_q = &this_tile->pvq_q;
-      cpi->td.mb.daala_enc.state.adapt = &this_tile->tctx.pvq_context;
-#endif  // CONFIG_PVQ
-#if !CONFIG_ANS
-      aom_start_encode(&mode_bc, buf->data + data_offset);
-      write_modes(cpi, &tile_info, &mode_bc, &tok, tok_end);
-      assert(tok == tok_end);
-      aom_stop_encode(&mode_bc);
-      tile_size = mode_bc.pos;
-#else
-      buf_ans_write_init(buf_ans, buf->data + data_offset);
-      write_modes(cpi, &tile_info, buf_ans, &tok, tok_end);
-      assert(tok == tok_end);
-      aom_buf_ans_flush(buf_ans);
-      tile_size = buf_ans_write_end(buf_ans);
-#endif  // !CONFIG_ANS
-#if CONFIG_PVQ
-      cpi->td.mb.pvq_q = NULL;
-#endif
+      init_tile_pack_state(&ps, &cpi->td.mb);
+      tile_size = pack_tile(cpi, &ps, &tile_info, tile_row, tile_col,
+                            buf->data + data_offset);
+      merge_tile_pack_state(cpi, &ps);
       buf->size = tile_size;
 
       // Record the maximum tile size we see, so we can compact headers later.
@@ -4069,16 +4253,17 @@ static uint32_t write_tiles(AV1_COMP *const cpi, uint8_t *const dst,
     const int is_last_row = (tile_row == tile_rows - 1);
     av1_tile_set_row(&tile_info, cm, tile_row);
 
+#if PACK_TILES_MT
+    if (pack_mt) pack_tile_row_mt(cpi, tile_row, tile_writers);
+#endif
+
     for (tile_col = 0; tile_col < tile_cols; tile_col++) {
       const int tile_idx = tile_row * tile_cols + tile_col;
       TileBufferEnc *const buf = &tile_buffers[tile_row][tile_col];
-#if CONFIG_PVQ || CONFIG_EC_ADAPT
-      TileDataEnc *this_tile = &cpi->tile_data[tile_idx];
-#endif
-      const TOKENEXTRA *tok = tok_buffers[tile_row][tile_col];
-      const TOKENEXTRA *tok_end = tok + cpi->tok_count[tile_row][tile_col];
       const int is_last_col = (tile_col == tile_cols - 1);
       const int is_last_tile = is_last_col && is_last_row;
+      // The last tile does not have a header.
+      const int data_offset = is_last_tile ? 0 : 4;
 #if !CONFIG_TILE_GROUPS
       (void)tile_idx;
 #else
@@ -4139,38 +4324,20 @@ static uint32_t write_tiles(AV1_COMP *const cpi, uint8_t *const dst,
 #if CONFIG_DEPENDENT_HORZTILES && CONFIG_TILE_GROUPS
       av1_tile_set_tg_boundary(&tile_info, cm, tile_row, tile_col);
 #endif
-      buf->data = dst + total_size;
-
-      // The last tile does not have a header.
-      if (!is_last_tile) total_size += 4;
-
-#if CONFIG_EC_ADAPT
-      // Initialise tile context from the frame context
-      this_tile->tctx = *cm->fc;
-      cpi->td.mb.e_mbd.tile_ctx = &this_tile->tctx;
-#endif
-#if CONFIG_PVQ
-      cpi->td.mb.pvq_q = &this_tile->pvq_q;
-      cpi->td.mb.daala_enc.state.adapt = &this_tile->tctx.pvq_context;
-#endif  // CONFIG_PVQ
-#if CONFIG_ANS
-      buf_ans_write_init(buf_ans, dst + total_size);
-      write_modes(cpi, &tile_info, buf_ans, &tok, tok_end);
-      assert(tok == tok_end);
-      aom_buf_ans_flush(buf_ans);
-      tile_size = buf_ans_write_end(buf_ans);
-#else
-      aom_start_encode(&mode_bc, dst + total_size);
-      write_modes(cpi, &tile_info, &mode_bc, &tok, tok_end);
-#if !CONFIG_LV_MAP
-      assert(tok == tok_end);
-#endif  // !CONFIG_LV_MAP
-      aom_stop_encode(&mode_bc);
-      tile_size = mode_bc.pos;
-#endif  // CONFIG_ANS
-#if CONFIG_PVQ
-      cpi->td.mb.pvq_q = NULL;
+      if (pack_mt) {
+#if PACK_TILES_MT
+        tile_size = finish_tile(&tile_writers[tile_col],
+                                dst + total_size + data_offset);
 #endif
+      } else {
+        TilePackState ps;
+        init_tile_pack_state(&ps, &cpi->td.mb);
+        tile_size = pack_tile(cpi, &ps, &tile_info, tile_row, tile_col,
+                              dst + total_size + data_offset);
+        merge_tile_pack_state(cpi, &ps);
+      }
+      buf->data = dst + total_size;
+      total_size += data_offset;
 
       assert(tile_size > 0);
 
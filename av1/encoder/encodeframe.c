@@ -4558,14 +4558,42 @@ static void rd_pick_partition(const AV1_COMP *const cpi, ThreadData *td,
   }
 }
 
+static void save_row_search_state(RowSearchState *state,
+                                  const TileDataEnc *tile_data) {
+  memcpy(state->thresh_freq_fact, tile_data->thresh_freq_fact,
+         sizeof(state->thresh_freq_fact));
+  memcpy(state->mode_map, tile_data->mode_map, sizeof(state->mode_map));
+  state->m_search_count = tile_data->m_search_count;
+  state->ex_search_count = tile_data->ex_search_count;
+}
+
+static void load_row_search_state(TileDataEnc *tile_data,
+                                  const RowSearchState *state) {
+  memcpy(tile_data->thresh_freq_fact, state->thresh_freq_fact,
+         sizeof(tile_data->thresh_freq_fact));
+  memcpy(tile_data->mode_map, state->mode_map, sizeof(tile_data->mode_map));
+  tile_data->m_search_count = state->m_search_count;
+  tile_data->ex_search_count = state->ex_search_count;
+}
+
+// Encodes the superblock row of the tile at mi_row. In row based
+// multi-threading (row_mt_sync != NULL) each superblock waits for the above and
+// above-right superblocks of the row above, and the row starts from the mode
+// search state saved by the row above.
 static void encode_rd_sb_row(AV1_COMP *cpi, ThreadData *td,
                              TileDataEnc *tile_data, int mi_row,
-                             TOKENEXTRA **tp) {
+                             TOKENEXTRA **tp, AV1EncRowMTSync *row_mt_sync,
+                             int tile_col) {
   AV1_COMMON *const cm = &cpi->common;
   const TileInfo *const tile_info = &tile_data->tile_info;
   MACROBLOCK *const x = &td->mb;
   MACROBLOCKD *const xd = &x->e_mbd;
   SPEED_FEATURES *const sf = &cpi->sf;
+  const int tile_sb_row =
+      (mi_row - tile_info->mi_row_start) >> cm->mib_size_log2;
+  const int sb_cols =
+      (tile_info->mi_col_end - tile_info->mi_col_start + cm->mib_size - 1) >>
+      cm->mib_size_log2;
   int mi_col;
 #if CONFIG_EXT_PARTITION
   const int leaf_nodes = 256;
@@ -4598,6 +4626,16 @@ static void encode_rd_sb_row(AV1_COMP *cpi, ThreadData *td,
     const int idx_str = cm->mi_stride * mi_row + mi_col;
     MODE_INFO **mi = cm->mi_grid_visible + idx_str;
     PC_TREE *const pc_root = td->pc_root[cm->mib_size_log2 - MIN_MIB_SIZE_LOG2];
+    const int tile_sb_col =
+        (mi_col - tile_info->mi_col_start) >> cm->mib_size_log2;
+
+    if (row_mt_sync != NULL) {
+      const int row = tile_col * row_mt_sync->max_sb_rows + tile_sb_row;
+      av1_enc_row_mt_sync_read(row_mt_sync, tile_col, tile_sb_row,
+                               tile_sb_col);
+      if (tile_sb_col == 0)
+        load_row_search_state(tile_data, &row_mt_sync->row_state[row]);
+    }
 
     av1_update_boundary_info(cm, tile_info, mi_row, mi_col);
 
@@ -4695,6 +4733,15 @@ static void encode_rd_sb_row(AV1_COMP *cpi, ThreadData *td,
 #endif  // CONFIG_SUPERTX
                         INT64_MAX, pc_root);
     }
+
+    if (row_mt_sync != NULL) {
+      const int row = tile_col * row_mt_sync->max_sb_rows + tile_sb_row;
+      if (tile_sb_col == AOMMIN(1, sb_cols - 1) &&
+          mi_row + cm->mib_size < tile_info->mi_row_end)
+        save_row_search_state(&row_mt_sync->row_state[row + 1], tile_data);
+      av1_enc_row_mt_sync_write(row_mt_sync, tile_col, tile_sb_row,
+                                tile_sb_col, sb_cols);
+    }
   }
 #if CONFIG_SUBFRAME_PROB_UPDATE
   if (cm->do_subframe_update &&
@@ -4833,6 +4880,7 @@ void av1_init_tile_data(AV1_COMP *cpi) {
             tile_data->mode_map[i][j] = j;
           }
         }
+        tile_data->encode_time = 0;
 #if CONFIG_PVQ
         // This will be dynamically increased as more pvq block is encoded.
         tile_data->pvq_q.buf_len = 1000;
@@ -4860,15 +4908,8 @@ void av1_init_tile_data(AV1_COMP *cpi) {
   }
 }
 
-void av1_encode_tile(AV1_COMP *cpi, ThreadData *td, int tile_row,
-                     int tile_col) {
-  AV1_COMMON *const cm = &cpi->common;
-  TileDataEnc *const this_tile =
-      &cpi->tile_data[tile_row * cm->tile_cols + tile_col];
-  const TileInfo *const tile_info = &this_tile->tile_info;
-  TOKENEXTRA *tok = cpi->tile_tok[tile_row][tile_col];
-  int mi_row;
-
+static void init_tile_above_context(AV1_COMMON *cm,
+                                    const TileInfo *tile_info, int tile_row) {
 #if CONFIG_DEPENDENT_HORZTILES
 #if CONFIG_TILE_GROUPS
   if ((!cm->dependent_horz_tiles) || (tile_row == 0) ||
@@ -4879,8 +4920,21 @@ void av1_encode_tile(AV1_COMP *cpi, ThreadData *td, int tile_row,
     av1_zero_above_context(cm, tile_info->mi_col_start, tile_info->mi_col_end);
   }
 #else
+  (void)tile_row;
   av1_zero_above_context(cm, tile_info->mi_col_start, tile_info->mi_col_end);
 #endif
+}
+
+void av1_encode_tile(AV1_COMP *cpi, ThreadData *td, int tile_row,
+                     int tile_col) {
+  AV1_COMMON *const cm = &cpi->common;
+  TileDataEnc *const this_tile =
+      &cpi->tile_data[tile_row * cm->tile_cols + tile_col];
+  const TileInfo *const tile_info = &this_tile->tile_info;
+  TOKENEXTRA *tok = cpi->tile_tok[tile_row][tile_col];
+  int mi_row;
+
+  init_tile_above_context(cm, tile_info, tile_row);
 
   // Set up pointers to per thread motion search counters.
   this_tile->m_search_count = 0;   // Count of motion search hits.
@@ -4975,7 +5029,7 @@ void av1_encode_tile(AV1_COMP *cpi, ThreadData *td, int tile_row,
 
   for (mi_row = tile_info->mi_row_start; mi_row < tile_info->mi_row_end;
        mi_row += cm->mib_size) {
-    encode_rd_sb_row(cpi, td, this_tile, mi_row, &tok);
+    encode_rd_sb_row(cpi, td, this_tile, mi_row, &tok, NULL, tile_col);
   }
 
   cpi->tok_count[tile_row][tile_col] =
@@ -4997,6 +5051,100 @@ void av1_encode_tile(AV1_COMP *cpi, ThreadData *td, int tile_row,
 #endif
 }
 
+void av1_init_tile_row_mt(AV1_COMP *cpi, int tile_row) {
+  AV1_COMMON *const cm = &cpi->common;
+  AV1EncRowMTSync *const row_mt_sync = &cpi->row_mt_sync;
+  int tile_col;
+
+  for (tile_col = 0; tile_col < cm->tile_cols; ++tile_col) {
+    TileDataEnc *const this_tile =
+        &cpi->tile_data[tile_row * cm->tile_cols + tile_col];
+
+    init_tile_above_context(cm, &this_tile->tile_info, tile_row);
+
+    this_tile->m_search_count = 0;
+    this_tile->ex_search_count = 0;
+    save_row_search_state(
+        &row_mt_sync->row_state[tile_col * row_mt_sync->max_sb_rows],
+        this_tile);
+
+#if CONFIG_EC_ADAPT
+    this_tile->tctx = *cm->fc;
+#endif  // CONFIG_EC_ADAPT
+  }
+}
+
+void av1_encode_sb_row(AV1_COMP *cpi, ThreadData *td, TileDataEnc *row_tile,
+                       int tile_row, int tile_col, int sb_row) {
+  AV1_COMMON *const cm = &cpi->common;
+  AV1EncRowMTSync *const row_mt_sync = &cpi->row_mt_sync;
+  TileDataEnc *const this_tile =
+      &cpi->tile_data[tile_row * cm->tile_cols + tile_col];
+  const TileInfo *const tile_info = &this_tile->tile_info;
+  const int mi_row = tile_info->mi_row_start + (sb_row << cm->mib_size_log2);
+  TOKENEXTRA *const tok_start = cpi->tile_tok[tile_row][tile_col] +
+                                allocated_tokens_above(*tile_info, mi_row);
+  TOKENEXTRA *tok = tok_start;
+
+  // The mode search state is private to the row, and loaded from the state
+  // saved by the row above when encoding the first superblock.
+  row_tile->tile_info = *tile_info;
+  td->mb.m_search_count_ptr = &row_tile->m_search_count;
+  td->mb.ex_search_count_ptr = &row_tile->ex_search_count;
+#if CONFIG_EC_ADAPT
+  // The rows of a tile only read the tile context, which is adapted when the
+  // tokens are packed.
+  td->mb.e_mbd.tile_ctx = &this_tile->tctx;
+#endif  // CONFIG_EC_ADAPT
+
+  encode_rd_sb_row(cpi, td, row_tile, mi_row, &tok, row_mt_sync, tile_col);
+
+  row_mt_sync->row_tok_count[tile_col * row_mt_sync->max_sb_rows + sb_row] =
+      (unsigned int)(tok - tok_start);
+
+  // The last row hands its state on to the same tile of the next frame.
+  if (mi_row + cm->mib_size >= tile_info->mi_row_end) {
+    memcpy(this_tile->thresh_freq_fact, row_tile->thresh_freq_fact,
+           sizeof(this_tile->thresh_freq_fact));
+    memcpy(this_tile->mode_map, row_tile->mode_map,
+           sizeof(this_tile->mode_map));
+  }
+}
+
+void av1_finish_tile_row_mt(AV1_COMP *cpi, int tile_row) {
+  AV1_COMMON *const cm = &cpi->common;
+  const AV1EncRowMTSync *const row_mt_sync = &cpi->row_mt_sync;
+  int tile_col;
+
+  // Pack the tokens of the superblock rows of each tile contiguously, as the
+  // bitstream writer expects.
+  for (tile_col = 0; tile_col < cm->tile_cols; ++tile_col) {
+    const TileInfo *const tile_info =
+        &cpi->tile_data[tile_row * cm->tile_cols + tile_col].tile_info;
+    TOKENEXTRA *const tok_start = cpi->tile_tok[tile_row][tile_col];
+    TOKENEXTRA *tok = tok_start;
+    int mi_row, sb_row = 0;
+
+    for (mi_row = tile_info->mi_row_start; mi_row < tile_info->mi_row_end;
+         mi_row += cm->mib_size, ++sb_row) {
+      const TOKENEXTRA *const row_tok =
+          tok_start + allocated_tokens_above(*tile_info, mi_row);
+      const unsigned int count =
+          row_mt_sync->row_tok_count[tile_col * row_mt_sync->max_sb_rows +
+                                     sb_row];
+      assert(mi_row + cm->mib_size >= tile_info->mi_row_end ||
+             count <= allocated_tokens_above(*tile_info,
+                                             mi_row + cm->mib_size) -
+                          allocated_tokens_above(*tile_info, mi_row));
+      if (row_tok != tok) memmove(tok, row_tok, count * sizeof(*tok));
+      tok += count;
+    }
+
+    cpi->tok_count[tile_row][tile_col] = (unsigned int)(tok - tok_start);
+    assert(cpi->tok_count[tile_row][tile_col] <= allocated_tokens(*tile_info));
+  }
+}
+
 static void encode_tiles(AV1_COMP *cpi) {
   AV1_COMMON *const cm = &cpi->common;
   int tile_col, tile_row;
@@ -5090,6 +5238,105 @@ static int gm_get_params_cost(WarpedMotionParams *gm,
 }
 #endif  // CONFIG_GLOBAL_MOTION
 
+// Returns whether the superblock rows of the tiles are encoded in parallel.
+// Delta q and sub-frame probability updates carry state from one superblock row
+// to the next, so they need the rows in raster order.
+static int use_row_mt(const AV1_COMP *cpi) {
+#if CONFIG_PVQ
+  (void)cpi;
+  return 0;
+#else
+  const AV1_COMMON *const cm = &cpi->common;
+
+  if (!cpi->oxcf.row_mt) return 0;
+#if CONFIG_DELTA_Q
+  if (cm->delta_q_present_flag) return 0;
+#endif  // CONFIG_DELTA_Q
+#if CONFIG_SUBFRAME_PROB_UPDATE
+  if (cm->do_subframe_update) return 0;
+#endif  // CONFIG_SUBFRAME_PROB_UPDATE
+  (void)cm;
+  return 1;
+#endif  // CONFIG_PVQ
+}
+
+#if CONFIG_GLOBAL_MOTION
+void av1_global_motion_search(AV1_COMP *cpi, GlobalMotionJob *job) {
+  AV1_COMMON *const cm = &cpi->common;
+#if CONFIG_AOM_HIGHBITDEPTH
+  const MACROBLOCKD *const xd = &cpi->td.mb.e_mbd;
+#endif  // CONFIG_AOM_HIGHBITDEPTH
+  YV12_BUFFER_CONFIG *const ref_buf = get_ref_frame_buffer(cpi, job->frame);
+  WarpedMotionParams *const params = &job->params;
+  double params_by_motion[RANSAC_NUM_MOTIONS * (MAX_PARAMDIM - 1)];
+  const double *params_this_motion;
+  int inliers_by_motion[RANSAC_NUM_MOTIONS];
+  WarpedMotionParams tmp_wm_params;
+  double best_erroradvantage = 1e12;
+  static const double kIdentityParams[MAX_PARAMDIM - 1] = {
+    0.0, 0.0, 1.0, 0.0, 0.0, 1.0, 0.0, 0.0
+  };
+  int i;
+
+  aom_clear_system_state();
+  set_default_gmparams(params);
+
+  // Initially set all params to identity.
+  for (i = 0; i < RANSAC_NUM_MOTIONS; ++i) {
+    memcpy(params_by_motion + (MAX_PARAMDIM - 1) * i, kIdentityParams,
+           (MAX_PARAMDIM - 1) * sizeof(*params_by_motion));
+  }
+
+  compute_global_motion_feature_based(
+      job->model, cpi->Source, ref_buf,
+#if CONFIG_AOM_HIGHBITDEPTH
+      cpi->common.bit_depth,
+#endif  // CONFIG_AOM_HIGHBITDEPTH
+      inliers_by_motion, params_by_motion, RANSAC_NUM_MOTIONS);
+
+  for (i = 0; i < RANSAC_NUM_MOTIONS; ++i) {
+    if (inliers_by_motion[i] == 0) continue;
+
+    params_this_motion = params_by_motion + (MAX_PARAMDIM - 1) * i;
+    convert_model_to_params(params_this_motion, &tmp_wm_params);
+
+    if (tmp_wm_params.wmtype != IDENTITY) {
+      const double erroradv_this_motion = refine_integerized_param(
+          &tmp_wm_params, tmp_wm_params.wmtype,
+#if CONFIG_AOM_HIGHBITDEPTH
+          xd->cur_buf->flags & YV12_FLAG_HIGHBITDEPTH, xd->bd,
+#endif  // CONFIG_AOM_HIGHBITDEPTH
+          ref_buf->y_buffer, ref_buf->y_width, ref_buf->y_height,
+          ref_buf->y_stride, cpi->Source->y_buffer, cpi->Source->y_width,
+          cpi->Source->y_height, cpi->Source->y_stride, 3);
+      if (erroradv_this_motion < best_erroradvantage) {
+        best_erroradvantage = erroradv_this_motion;
+        // Save the wm_params modified by refine_integerized_param()
+        // rather than motion index to avoid rerunning refine() below.
+        *params = tmp_wm_params;
+      }
+    }
+  }
+  // If the best error advantage found doesn't meet the threshold for
+  // this motion type, revert to IDENTITY.
+  if (best_erroradvantage > gm_advantage_thresh[params->wmtype])
+    set_default_gmparams(params);
+
+  if (params->wmtype <= AFFINE)
+    if (!get_shear_params(params)) set_default_gmparams(params);
+
+  if (params->wmtype == TRANSLATION) {
+    params->wmmat[0] = convert_to_trans_prec(cm->allow_high_precision_mv,
+                                             params->wmmat[0]) *
+                       GM_TRANS_ONLY_DECODE_FACTOR;
+    params->wmmat[1] = convert_to_trans_prec(cm->allow_high_precision_mv,
+                                             params->wmmat[1]) *
+                       GM_TRANS_ONLY_DECODE_FACTOR;
+  }
+  aom_clear_system_state();
+}
+#endif  // CONFIG_GLOBAL_MOTION
+
 static void encode_frame_internal(AV1_COMP *cpi) {
   ThreadData *const td = &cpi->td;
   MACROBLOCK *const x = &td->mb;
@@ -5115,90 +5362,37 @@ static void encode_frame_internal(AV1_COMP *cpi) {
   av1_zero(cpi->global_motion_used);
   if (cpi->common.frame_type == INTER_FRAME && cpi->Source &&
       !cpi->global_motion_search_done) {
-    YV12_BUFFER_CONFIG *ref_buf;
-    int frame;
-    double params_by_motion[RANSAC_NUM_MOTIONS * (MAX_PARAMDIM - 1)];
-    const double *params_this_motion;
-    int inliers_by_motion[RANSAC_NUM_MOTIONS];
-    WarpedMotionParams tmp_wm_params;
-    static const double kInfiniteErrAdv = 1e12;
-    static const double kIdentityParams[MAX_PARAMDIM - 1] = {
-      0.0, 0.0, 1.0, 0.0, 0.0, 1.0, 0.0, 0.0
-    };
+    GlobalMotionJob jobs[TOTAL_REFS_PER_FRAME * GLOBAL_TRANS_TYPES];
+    int num_jobs = 0;
+    int use_mt;
+    int frame, j;
 
+    // One search per reference frame and motion model. They are independent,
+    // so with several threads they run on the encoder workers.
     for (frame = LAST_FRAME; frame <= ALTREF_FRAME; ++frame) {
-      ref_buf = get_ref_frame_buffer(cpi, frame);
-      if (ref_buf) {
-        TransformationType model;
-        aom_clear_system_state();
-        for (model = ROTZOOM; model < GLOBAL_TRANS_TYPES; ++model) {
-          double best_erroradvantage = kInfiniteErrAdv;
-
-          // Initially set all params to identity.
-          for (i = 0; i < RANSAC_NUM_MOTIONS; ++i) {
-            memcpy(params_by_motion + (MAX_PARAMDIM - 1) * i, kIdentityParams,
-                   (MAX_PARAMDIM - 1) * sizeof(*params_by_motion));
-          }
-
-          compute_global_motion_feature_based(
-              model, cpi->Source, ref_buf,
-#if CONFIG_AOM_HIGHBITDEPTH
-              cpi->common.bit_depth,
-#endif  // CONFIG_AOM_HIGHBITDEPTH
-              inliers_by_motion, params_by_motion, RANSAC_NUM_MOTIONS);
-
-          for (i = 0; i < RANSAC_NUM_MOTIONS; ++i) {
-            if (inliers_by_motion[i] == 0) continue;
-
-            params_this_motion = params_by_motion + (MAX_PARAMDIM - 1) * i;
-            convert_model_to_params(params_this_motion, &tmp_wm_params);
-
-            if (tmp_wm_params.wmtype != IDENTITY) {
-              const double erroradv_this_motion = refine_integerized_param(
-                  &tmp_wm_params, tmp_wm_params.wmtype,
-#if CONFIG_AOM_HIGHBITDEPTH
-                  xd->cur_buf->flags & YV12_FLAG_HIGHBITDEPTH, xd->bd,
-#endif  // CONFIG_AOM_HIGHBITDEPTH
-                  ref_buf->y_buffer, ref_buf->y_width, ref_buf->y_height,
-                  ref_buf->y_stride, cpi->Source->y_buffer,
-                  cpi->Source->y_width, cpi->Source->y_height,
-                  cpi->Source->y_stride, 3);
-              if (erroradv_this_motion < best_erroradvantage) {
-                best_erroradvantage = erroradv_this_motion;
-                // Save the wm_params modified by refine_integerized_param()
-                // rather than motion index to avoid rerunning refine() below.
-                memcpy(&(cm->global_motion[frame]), &tmp_wm_params,
-                       sizeof(WarpedMotionParams));
-              }
-            }
-          }
-          // If the best error advantage found doesn't meet the threshold for
-          // this motion type, revert to IDENTITY.
-          if (best_erroradvantage >
-              gm_advantage_thresh[cm->global_motion[frame].wmtype]) {
-            set_default_gmparams(&cm->global_motion[frame]);
-          }
-
-          if (cm->global_motion[frame].wmtype <= AFFINE)
-            if (!get_shear_params(&cm->global_motion[frame]))
-              set_default_gmparams(&cm->global_motion[frame]);
-
-          if (cm->global_motion[frame].wmtype != IDENTITY) {
-            if (cm->global_motion[frame].wmtype == TRANSLATION) {
-              cm->global_motion[frame].wmmat[0] =
-                  convert_to_trans_prec(cm->allow_high_precision_mv,
-                                        cm->global_motion[frame].wmmat[0]) *
-                  GM_TRANS_ONLY_DECODE_FACTOR;
-              cm->global_motion[frame].wmmat[1] =
-                  convert_to_trans_prec(cm->allow_high_precision_mv,
-                                        cm->global_motion[frame].wmmat[1]) *
-                  GM_TRANS_ONLY_DECODE_FACTOR;
-            }
-            break;
-          }
-        }
-        aom_clear_system_state();
+      TransformationType model;
+      if (!get_ref_frame_buffer(cpi, frame)) continue;
+      for (model = ROTZOOM; model < GLOBAL_TRANS_TYPES; ++model) {
+        jobs[num_jobs].frame = frame;
+        jobs[num_jobs].model = model;
+        ++num_jobs;
       }
+    }
+    use_mt = cpi->oxcf.max_threads > 1 && num_jobs > 1;
+    if (use_mt) av1_global_motion_search_mt(cpi, jobs, num_jobs);
+
+    for (j = 0; j < num_jobs; ++j) {
+      GlobalMotionJob *const job = &jobs[j];
+      // Each reference frame uses the first motion model giving a non-identity
+      // motion. The later models are only searched when using the workers.
+      if (job->model != ROTZOOM &&
+          cm->global_motion[job->frame].wmtype != IDENTITY)
+        continue;
+      if (!use_mt) av1_global_motion_search(cpi, job);
+      cm->global_motion[job->frame] = job->params;
+    }
+
+    for (frame = LAST_FRAME; frame <= ALTREF_FRAME; ++frame) {
       cpi->gmparams_cost[frame] =
           gm_get_params_cost(&cm->global_motion[frame],
                              &cm->prev_frame->global_motion[frame],
@@ -5302,7 +5496,10 @@ static void encode_frame_internal(AV1_COMP *cpi) {
     // TODO(geza.lore): The multi-threaded encoder is not safe with more than
     // 1 tile rows, as it uses the single above_context et al arrays from
     // cpi->common
-    if (AOMMIN(cpi->oxcf.max_threads, cm->tile_cols) > 1 && cm->tile_rows == 1)
+    if (use_row_mt(cpi))
+      av1_encode_tiles_row_mt(cpi);
+    else if (AOMMIN(cpi->oxcf.max_threads, cm->tile_cols) > 1 &&
+             cm->tile_rows == 1)
       av1_encode_tiles_mt(cpi);
     else
       encode_tiles(cpi);
@@ -12,6 +12,7 @@
 #ifndef AV1_ENCODER_ENCODEFRAME_H_
 #define AV1_ENCODER_ENCODEFRAME_H_
 
+#include "./aom_config.h"
 #include "aom/aom_integer.h"
 
 #ifdef __cplusplus
@@ -21,7 +22,9 @@ extern "C" {
 struct macroblock;
 struct yv12_buffer_config;
 struct AV1_COMP;
+struct GlobalMotionJob;
 struct ThreadData;
+struct TileDataEnc;
 
 // Constants used in SOURCE_VAR_BASED_PARTITION
 #define VAR_HIST_MAX_BG_VAR 1000
@@ -40,8 +43,24 @@ void av1_init_tile_data(struct AV1_COMP *cpi);
 void av1_encode_tile(struct AV1_COMP *cpi, struct ThreadData *td, int tile_row,
                      int tile_col);
 
+// Row based multi-threading: av1_init_tile_row_mt() prepares the tiles of a
+// tile row, whose superblock rows are then encoded by av1_encode_sb_row() in
+// any order allowed by cpi->row_mt_sync, and av1_finish_tile_row_mt() collects
+// the tokens of the rows.
+void av1_init_tile_row_mt(struct AV1_COMP *cpi, int tile_row);
+void av1_encode_sb_row(struct AV1_COMP *cpi, struct ThreadData *td,
+                       struct TileDataEnc *row_tile, int tile_row, int tile_col,
+                       int sb_row);
+void av1_finish_tile_row_mt(struct AV1_COMP *cpi, int tile_row);
+
 void av1_set_variance_partition_thresholds(struct AV1_COMP *cpi, int q);
 
+#if CONFIG_GLOBAL_MOTION
+// Searches the global motion of job->frame with the motion model job->model.
+void av1_global_motion_search(struct AV1_COMP *cpi,
+                              struct GlobalMotionJob *job);
+#endif  // CONFIG_GLOBAL_MOTION
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
@@ -463,6 +463,8 @@ static void dealloc_compressor_data(AV1_COMP *cpi) {
   av1_free_context_buffers(cm);
 
   aom_free_frame_buffer(&cpi->last_frame_uf);
+  aom_free_frame_buffer(&cpi->lf_search_frame[0]);
+  aom_free_frame_buffer(&cpi->lf_search_frame[1]);
 #if CONFIG_LOOP_RESTORATION
   av1_free_restoration_buffers(cm);
   aom_free_frame_buffer(&cpi->last_frame_db);
@@ -470,6 +472,7 @@ static void dealloc_compressor_data(AV1_COMP *cpi) {
   aom_free(cpi->extra_rstbuf);
   for (i = 0; i < MAX_MB_PLANE; ++i)
     av1_free_restoration_struct(&cpi->rst_search[i]);
+  av1_free_rst_search_bufs(cpi);
 #endif  // CONFIG_LOOP_RESTORATION
   aom_free_frame_buffer(&cpi->scaled_source);
   aom_free_frame_buffer(&cpi->scaled_last_source);
@@ -2655,19 +2658,28 @@ void av1_remove_compressor(AV1_COMP *cpi) {
     // Deallocate allocated thread data.
     if (t < cpi->num_workers - 1) {
 #if CONFIG_PALETTE
-      if (cpi->common.allow_screen_content_tools)
-        aom_free(thread_data->td->mb.palette_buffer);
+      aom_free(thread_data->td->mb.palette_buffer);
 #endif  // CONFIG_PALETTE
       aom_free(thread_data->td->counts);
       av1_free_pc_tree(thread_data->td);
       av1_free_var_tree(thread_data->td);
       aom_free(thread_data->td);
     }
+    aom_free(thread_data->row_tile_data);
+    aom_free(thread_data->mi);
+    aom_free(thread_data->mi_grid);
   }
+  aom_thread_pool_client_free(&cpi->pool_client);
   aom_free(cpi->tile_thr_data);
+  aom_free(cpi->tile_queue);
+  aom_job_queue_free(&cpi->job_queue);
+  av1_enc_row_mt_dealloc(&cpi->row_mt_sync);
   aom_free(cpi->workers);
 
   if (cpi->num_workers > 1) av1_loop_filter_dealloc(&cpi->lf_row_sync);
+#if CONFIG_LOOP_RESTORATION
+  av1_loop_restoration_dealloc(&cpi->lr_sync);
+#endif  // CONFIG_LOOP_RESTORATION
 
   dealloc_compressor_data(cpi);
 
@@ -2676,6 +2688,9 @@ void av1_remove_compressor(AV1_COMP *cpi) {
     aom_free(cpi->mbgraph_stats[i].mb_stats);
   }
 
+  aom_free(cpi->twopass.row_stats);
+  aom_free(cpi->twopass.mb_factors);
+
 #if CONFIG_FP_MB_STATS
   if (cpi->use_fp_mb_stats) {
     aom_free(cpi->twopass.frame_mb_stats_buf);
@@ -3498,6 +3513,7 @@ void av1_update_reference_frames(AV1_COMP *cpi) {
 static void loopfilter_frame(AV1_COMP *cpi, AV1_COMMON *cm) {
   MACROBLOCKD *xd = &cpi->td.mb.e_mbd;
   struct loopfilter *lf = &cm->lf;
+  av1_setup_filter_workers(cpi);
   if (is_lossless_requested(&cpi->oxcf)) {
     lf->filter_level = 0;
   } else {
@@ -3517,10 +3533,10 @@ static void loopfilter_frame(AV1_COMP *cpi, AV1_COMMON *cm) {
 #if CONFIG_VAR_TX || CONFIG_EXT_PARTITION
     av1_loop_filter_frame(cm->frame_to_show, cm, xd, lf->filter_level, 0, 0);
 #else
-    if (cpi->num_workers > 1)
+    if (cpi->num_filter_workers > 1)
       av1_loop_filter_frame_mt(cm->frame_to_show, cm, xd->plane,
                                lf->filter_level, 0, 0, cpi->workers,
-                               cpi->num_workers, &cpi->lf_row_sync);
+                               cpi->num_filter_workers, &cpi->lf_row_sync);
     else
       av1_loop_filter_frame(cm->frame_to_show, cm, xd, lf->filter_level, 0, 0);
 #endif
@@ -3532,10 +3548,16 @@ static void loopfilter_frame(AV1_COMP *cpi, AV1_COMMON *cm) {
     cm->nb_cdef_strengths = 1;
   } else {
     // Find cm->dering_level, cm->clpf_strength_u and cm->clpf_strength_v
-    av1_cdef_search(cm->frame_to_show, cpi->Source, cm, xd);
+    av1_cdef_search(cm->frame_to_show, cpi->Source, cm, xd,
+                    cpi->sf.cdef_pick_method == CDEF_FAST_SEARCH, cpi->workers,
+                    cpi->num_filter_workers);
 
     // Apply the filter
-    av1_cdef_frame(cm->frame_to_show, cm, xd);
+    if (cpi->num_filter_workers > 1)
+      av1_cdef_frame_mt(cm->frame_to_show, cm, xd, cpi->workers,
+                        cpi->num_filter_workers);
+    else
+      av1_cdef_frame(cm->frame_to_show, cm, xd);
   }
 #endif
 #if CONFIG_LOOP_RESTORATION
@@ -3543,7 +3565,13 @@ static void loopfilter_frame(AV1_COMP *cpi, AV1_COMMON *cm) {
   if (cm->rst_info[0].frame_restoration_type != RESTORE_NONE ||
       cm->rst_info[1].frame_restoration_type != RESTORE_NONE ||
       cm->rst_info[2].frame_restoration_type != RESTORE_NONE) {
-    av1_loop_restoration_frame(cm->frame_to_show, cm, cm->rst_info, 7, 0, NULL);
+    if (cpi->num_filter_workers > 1)
+      av1_loop_restoration_frame_mt(cm->frame_to_show, cm, cm->rst_info, 7,
+                                    NULL, cpi->workers, cpi->num_filter_workers,
+                                    &cpi->lr_sync);
+    else
+      av1_loop_restoration_frame(cm->frame_to_show, cm, cm->rst_info, 7, 0,
+                                 NULL);
   }
 #endif  // CONFIG_LOOP_RESTORATION
   aom_extend_frame_inner_borders(cm->frame_to_show);
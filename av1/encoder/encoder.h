@@ -29,6 +29,7 @@
 #include "av1/encoder/av1_quantize.h"
 #include "av1/encoder/context_tree.h"
 #include "av1/encoder/encodemb.h"
+#include "av1/encoder/ethread.h"
 #include "av1/encoder/firstpass.h"
 #include "av1/encoder/lookahead.h"
 #include "av1/encoder/mbgraph.h"
@@ -47,7 +48,9 @@
 #endif
 #include "aom_dsp/variance.h"
 #include "aom/internal/aom_codec_internal.h"
+#include "aom_util/aom_job_queue.h"
 #include "aom_util/aom_thread.h"
+#include "aom_util/aom_thread_pool.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -248,6 +251,10 @@ typedef struct AV1EncoderConfig {
 #endif  // CONFIG_LOOPFILTERING_ACROSS_TILES
 
   int max_threads;
+  // Threads shared with other codec instances, or NULL.
+  AVxThreadPool *thread_pool;
+  // Encode the superblock rows of a tile in parallel.
+  int row_mt;
 
   aom_fixed_buf_t two_pass_stats_in;
   struct aom_codec_pkt_list *output_pkt_list;
@@ -291,8 +298,21 @@ typedef struct TileDataEnc {
 #if CONFIG_EC_ADAPT
   FRAME_CONTEXT tctx;
 #endif
+  // Time spent encoding the tile in the last frame, in microseconds. The tile
+  // workers take the most expensive tiles first.
+  int64_t encode_time;
 } TileDataEnc;
 
+// Adaptive mode search state of TileDataEnc. In row based multi-threading each
+// superblock row starts from the state of the row above, saved once the
+// above-right superblock of the first superblock of the row is encoded.
+typedef struct RowSearchState {
+  int thresh_freq_fact[BLOCK_SIZES][MAX_MODES];
+  int mode_map[BLOCK_SIZES][MAX_MODES];
+  int m_search_count;
+  int ex_search_count;
+} RowSearchState;
+
 typedef struct RD_COUNTS {
   av1_coeff_count coef_counts[TX_SIZES][PLANE_TYPES];
   int64_t comp_pred_diff[REFERENCE_MODES];
@@ -412,12 +432,19 @@ typedef struct AV1_COMP {
   int ext_refresh_frame_context;
 
   YV12_BUFFER_CONFIG last_frame_uf;
+  // Frames the two loop filter levels of a search step are tried on by the
+  // workers.
+  YV12_BUFFER_CONFIG lf_search_frame[2];
 #if CONFIG_LOOP_RESTORATION
   YV12_BUFFER_CONFIG last_frame_db;
   YV12_BUFFER_CONFIG trial_frame_rst;
   uint8_t *extra_rstbuf;  // Extra buffers used in restoration search
   RestorationInfo rst_search[MAX_MB_PLANE];  // Used for encoder side search
-#endif                                       // CONFIG_LOOP_RESTORATION
+  // Frames and scratch buffers the workers try the restoration tiles with.
+  YV12_BUFFER_CONFIG *rst_search_frames;
+  int32_t **rst_search_tmpbufs;
+  int num_rst_search_bufs;
+#endif  // CONFIG_LOOP_RESTORATION
 
   // Ambient reconstruction err target for force key frames
   int64_t ambient_err;
@@ -635,9 +662,28 @@ typedef struct AV1_COMP {
 
   // Multi-threading
   int num_workers;
+  // Number of workers taking part in the stage running on the workers. The
+  // first num_stage_workers - 1 workers run on their threads, and the last
+  // worker runs on the main thread.
+  int num_stage_workers;
+  // Number of workers running the in-loop filters of the frame and their
+  // searches, see av1_setup_filter_workers().
+  int num_filter_workers;
   AVxWorker *workers;
+  // Runs the workers on oxcf.thread_pool, when set.
+  AVxThreadPoolClient pool_client;
   struct EncWorkerData *tile_thr_data;
+  // Tiles in the order the tile workers encode them.
+  TileDataEnc **tile_queue;
+  int tile_queue_size;
+  // Jobs of the stage running on the workers: tiles, superblock or macroblock
+  // rows, or global motion searches.
+  AVxJobQueue job_queue;
+  AV1EncRowMTSync row_mt_sync;
   AV1LfSync lf_row_sync;
+#if CONFIG_LOOP_RESTORATION
+  AV1LrSync lr_sync;
+#endif  // CONFIG_LOOP_RESTORATION
 #if CONFIG_SUBFRAME_PROB_UPDATE
   SUBFRAME_STATS subframe_stats;
   // TODO(yaowu): minimize the size of count buffers
@@ -796,6 +842,21 @@ static INLINE unsigned int allocated_tokens(TileInfo tile) {
   return get_token_alloc(tile_mb_rows, tile_mb_cols);
 }
 
+// Get the number of tokens allocated to the rows of a tile above mi_row, which
+// is at a superblock boundary. The tokens of the superblock rows of a tile are
+// stored from this offset in row based multi-threading.
+static INLINE unsigned int allocated_tokens_above(TileInfo tile, int mi_row) {
+#if CONFIG_CB4X4
+  int mb_rows = (mi_row - tile.mi_row_start) >> 2;
+  int tile_mb_cols = (tile.mi_col_end - tile.mi_col_start + 2) >> 2;
+#else
+  int mb_rows = (mi_row - tile.mi_row_start) >> 1;
+  int tile_mb_cols = (tile.mi_col_end - tile.mi_col_start + 1) >> 1;
+#endif
+
+  return get_token_alloc(mb_rows, tile_mb_cols);
+}
+
 void av1_alloc_compressor_data(AV1_COMP *cpi);
 
 void av1_scale_references(AV1_COMP *cpi);
@@ -9,162 +9,709 @@
  * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
  */
 
+#include <stdlib.h>
+
 #include "av1/encoder/encodeframe.h"
 #include "av1/encoder/encoder.h"
 #include "av1/encoder/ethread.h"
+#include "av1/encoder/firstpass.h"
+#if CONFIG_GLOBAL_MOTION
+#include "av1/encoder/global_motion.h"
+#endif  // CONFIG_GLOBAL_MOTION
+#include "av1/encoder/temporal_filter.h"
 #include "aom_dsp/aom_dsp_common.h"
+#include "aom_ports/aom_atomics.h"
+#include "aom_ports/aom_timer.h"
+
+// Below this number of workers to merge, summing their counts on the main
+// thread is cheaper than waking the workers up to sum a slice each.
+#define MIN_PARALLEL_COUNTS_MERGE 4
+
+// Adds the n counts of src to acc and clears them in src.
+static void merge_counts(unsigned int *acc, unsigned int *src, size_t n) {
+  size_t i;
+  for (i = 0; i < n; ++i) acc[i] += src[i];
+  memset(src, 0, n * sizeof(*src));
+}
+
+// Returns the first of the n counts in slice 'slice' of num_slices. The slices
+// start on a multiple of 16 counts so that the workers summing them rarely
+// share a cache line.
+static size_t counts_slice_start(size_t n, int slice, int num_slices) {
+  if (slice == num_slices) return n;
+  return (n * slice / num_slices) & ~(size_t)15;
+}
+
+// Adds slice 'slice' of num_slices of the frame counts and the coefficient rd
+// counts of the workers that encoded part of the frame to those of cpi->td.
+static void merge_worker_counts_slice(AV1_COMP *cpi, int slice,
+                                      int num_slices) {
+  unsigned int *const counts = (unsigned int *)&cpi->common.counts;
+  unsigned int *const coef_counts =
+      (unsigned int *)cpi->td.rd_counts.coef_counts;
+  const size_t n_counts = sizeof(cpi->common.counts) / sizeof(*counts);
+  const size_t n_coef_counts =
+      sizeof(cpi->td.rd_counts.coef_counts) / sizeof(*coef_counts);
+  const size_t counts_start = counts_slice_start(n_counts, slice, num_slices);
+  const size_t counts_end = counts_slice_start(n_counts, slice + 1, num_slices);
+  const size_t coef_start =
+      counts_slice_start(n_coef_counts, slice, num_slices);
+  const size_t coef_end =
+      counts_slice_start(n_coef_counts, slice + 1, num_slices);
+  int i;
 
-static void accumulate_rd_opt(ThreadData *td, ThreadData *td_t) {
-  int i, j, k, l, m, n;
+  for (i = 0; i < cpi->num_workers - 1; i++) {
+    ThreadData *const td = cpi->tile_thr_data[i].td;
+    if (!cpi->tile_thr_data[i].counts_used) continue;
+    merge_counts(counts + counts_start,
+                 (unsigned int *)td->counts + counts_start,
+                 counts_end - counts_start);
+    merge_counts(coef_counts + coef_start,
+                 (unsigned int *)td->rd_counts.coef_counts + coef_start,
+                 coef_end - coef_start);
+  }
+}
 
-  for (i = 0; i < REFERENCE_MODES; i++)
-    td->rd_counts.comp_pred_diff[i] += td_t->rd_counts.comp_pred_diff[i];
+// Returns the worker that takes part in the current stage as its i-th worker.
+// The last one is the worker of the main thread.
+static int get_stage_worker(const AV1_COMP *cpi, int i) {
+  return i == cpi->num_stage_workers - 1 ? cpi->num_workers - 1 : i;
+}
 
-  for (i = 0; i < TX_SIZES; i++)
-    for (j = 0; j < PLANE_TYPES; j++)
-      for (k = 0; k < REF_TYPES; k++)
-        for (l = 0; l < COEF_BANDS; l++)
-          for (m = 0; m < COEFF_CONTEXTS; m++)
-            for (n = 0; n < ENTROPY_TOKENS; n++)
-              td->rd_counts.coef_counts[i][j][k][l][m][n] +=
-                  td_t->rd_counts.coef_counts[i][j][k][l][m][n];
+// Returns the index of the worker of thread_data among the workers of the
+// current stage.
+static int get_stage_index(const EncWorkerData *thread_data) {
+  const AV1_COMP *const cpi = thread_data->cpi;
+  const int i = (int)(thread_data - cpi->tile_thr_data);
+  return i == cpi->num_workers - 1 ? cpi->num_stage_workers - 1 : i;
+}
+
+static int merge_counts_worker_hook(EncWorkerData *const thread_data,
+                                    void *unused) {
+  AV1_COMP *const cpi = thread_data->cpi;
+  (void)unused;
+
+  merge_worker_counts_slice(cpi, get_stage_index(thread_data),
+                            cpi->num_stage_workers);
+  return 0;
+}
+
+// Returns the index of the next job for the worker of thread_data, or -1 once
+// all the jobs of the stage have been taken.
+static int get_next_job(EncWorkerData *const thread_data) {
+  AV1_COMP *const cpi = thread_data->cpi;
+  return aom_job_queue_next(&cpi->job_queue, get_stage_index(thread_data));
+}
+
+// Takes the next tile from the tile queue. Returns NULL once the queue is
+// empty.
+static TileDataEnc *get_next_tile(EncWorkerData *const thread_data) {
+  const int job = get_next_job(thread_data);
+  return job >= 0 ? thread_data->cpi->tile_queue[job] : NULL;
 }
 
 static int enc_worker_hook(EncWorkerData *const thread_data, void *unused) {
   AV1_COMP *const cpi = thread_data->cpi;
   const AV1_COMMON *const cm = &cpi->common;
   const int tile_cols = cm->tile_cols;
-  const int tile_rows = cm->tile_rows;
-  int t;
+  TileDataEnc *tile_data;
 
   (void)unused;
 
-  for (t = thread_data->start; t < tile_rows * tile_cols;
-       t += cpi->num_workers) {
-    int tile_row = t / tile_cols;
-    int tile_col = t % tile_cols;
+  while ((tile_data = get_next_tile(thread_data)) != NULL) {
+    const int t = (int)(tile_data - cpi->tile_data);
+    struct aom_usec_timer timer;
 
-    av1_encode_tile(cpi, thread_data->td, tile_row, tile_col);
+    thread_data->counts_used = 1;
+    aom_usec_timer_start(&timer);
+    av1_encode_tile(cpi, thread_data->td, t / tile_cols, t % tile_cols);
+    aom_usec_timer_mark(&timer);
+    tile_data->encode_time = aom_usec_timer_elapsed(&timer);
   }
 
   return 0;
 }
 
-void av1_encode_tiles_mt(AV1_COMP *cpi) {
+// Sorts the tiles by the time they took in the last frame, in descending
+// order, so that the most expensive tiles are not left to the end of the
+// frame. Tiles of equal cost, e.g. in the first frame, stay in raster order.
+static int compare_tile_cost(const void *a, const void *b) {
+  const TileDataEnc *const tile1 = *(const TileDataEnc *const *)a;
+  const TileDataEnc *const tile2 = *(const TileDataEnc *const *)b;
+  if (tile1->encode_time != tile2->encode_time)
+    return tile1->encode_time < tile2->encode_time ? 1 : -1;
+  return tile1 < tile2 ? -1 : 1;
+}
+
+static void init_tile_queue(AV1_COMP *cpi) {
+  AV1_COMMON *const cm = &cpi->common;
+  const int n_tiles = cm->tile_rows * cm->tile_cols;
+  int i;
+
+  if (cpi->tile_queue_size < n_tiles) {
+    aom_free(cpi->tile_queue);
+    cpi->tile_queue_size = 0;
+    CHECK_MEM_ERROR(cm, cpi->tile_queue,
+                    aom_malloc(n_tiles * sizeof(*cpi->tile_queue)));
+    cpi->tile_queue_size = n_tiles;
+  }
+
+  for (i = 0; i < n_tiles; ++i) cpi->tile_queue[i] = &cpi->tile_data[i];
+  qsort(cpi->tile_queue, n_tiles, sizeof(*cpi->tile_queue), compare_tile_cost);
+  aom_job_queue_reset(&cpi->job_queue, n_tiles, cpi->num_stage_workers);
+}
+
+// Creates the workers and their thread data once, one worker per thread
+// allowed. Each stage then chooses how many of them it runs. The last worker
+// runs on the main thread and uses the thread data in cpi.
+static void create_enc_workers(AV1_COMP *cpi) {
   AV1_COMMON *const cm = &cpi->common;
-  const int tile_cols = cm->tile_cols;
   const AVxWorkerInterface *const winterface = aom_get_worker_interface();
-  const int num_workers = AOMMIN(cpi->oxcf.max_threads, tile_cols);
+  const int num_workers = cpi->oxcf.max_threads;
   int i;
 
-  av1_init_tile_data(cpi);
+  if (cpi->num_workers > 0) return;
 
-  // Only run once to create threads and allocate thread data.
-  if (cpi->num_workers == 0) {
-    CHECK_MEM_ERROR(cm, cpi->workers,
-                    aom_malloc(num_workers * sizeof(*cpi->workers)));
+  CHECK_MEM_ERROR(cm, cpi->workers,
+                  aom_malloc(num_workers * sizeof(*cpi->workers)));
 
-    CHECK_MEM_ERROR(cm, cpi->tile_thr_data,
-                    aom_calloc(num_workers, sizeof(*cpi->tile_thr_data)));
+  CHECK_MEM_ERROR(cm, cpi->tile_thr_data,
+                  aom_calloc(num_workers, sizeof(*cpi->tile_thr_data)));
 
-    for (i = 0; i < num_workers; i++) {
-      AVxWorker *const worker = &cpi->workers[i];
-      EncWorkerData *const thread_data = &cpi->tile_thr_data[i];
-
-      ++cpi->num_workers;
-      winterface->init(worker);
-
-      thread_data->cpi = cpi;
-
-      if (i < num_workers - 1) {
-        // Allocate thread data.
-        CHECK_MEM_ERROR(cm, thread_data->td,
-                        aom_memalign(32, sizeof(*thread_data->td)));
-        av1_zero(*thread_data->td);
-
-        // Set up pc_tree.
-        thread_data->td->leaf_tree = NULL;
-        thread_data->td->pc_tree = NULL;
-        av1_setup_pc_tree(cm, thread_data->td);
-
-        // Set up variance tree if needed.
-        if (cpi->sf.partition_search_type == VAR_BASED_PARTITION)
-          av1_setup_var_tree(cm, thread_data->td);
-
-        // Allocate frame counters in thread data.
-        CHECK_MEM_ERROR(cm, thread_data->td->counts,
-                        aom_calloc(1, sizeof(*thread_data->td->counts)));
-
-        // Create threads
-        if (!winterface->reset(worker))
-          aom_internal_error(&cm->error, AOM_CODEC_ERROR,
-                             "Tile encoder thread creation failed");
-      } else {
-        // Main thread acts as a worker and uses the thread data in cpi.
-        thread_data->td = &cpi->td;
-      }
+  if (!aom_job_queue_alloc(&cpi->job_queue, num_workers))
+    aom_internal_error(&cm->error, AOM_CODEC_MEM_ERROR,
+                       "Failed to allocate the job queue");
 
-      winterface->sync(worker);
-    }
-  }
+  if (cpi->oxcf.thread_pool != NULL && num_workers > 1 &&
+      !aom_thread_pool_client_init(&cpi->pool_client, cpi->oxcf.thread_pool,
+                                   num_workers - 1))
+    aom_internal_error(&cm->error, AOM_CODEC_ERROR,
+                       "Failed to attach the thread pool");
 
   for (i = 0; i < num_workers; i++) {
     AVxWorker *const worker = &cpi->workers[i];
+    EncWorkerData *const thread_data = &cpi->tile_thr_data[i];
+
+    ++cpi->num_workers;
+    winterface->init(worker);
+
+    thread_data->cpi = cpi;
+
+    if (i < num_workers - 1) {
+      // Allocate thread data.
+      CHECK_MEM_ERROR(cm, thread_data->td,
+                      aom_memalign(32, sizeof(*thread_data->td)));
+      av1_zero(*thread_data->td);
+
+      // Set up pc_tree.
+      thread_data->td->leaf_tree = NULL;
+      thread_data->td->pc_tree = NULL;
+      av1_setup_pc_tree(cm, thread_data->td);
+
+      // Set up variance tree if needed.
+      if (cpi->sf.partition_search_type == VAR_BASED_PARTITION)
+        av1_setup_var_tree(cm, thread_data->td);
+
+      // Allocate frame counters in thread data.
+      CHECK_MEM_ERROR(cm, thread_data->td->counts,
+                      aom_calloc(1, sizeof(*thread_data->td->counts)));
+
+      // Create threads
+      if (cpi->pool_client.pool != NULL) worker->pool = &cpi->pool_client;
+      if (!winterface->reset(worker))
+        aom_internal_error(&cm->error, AOM_CODEC_ERROR,
+                           "Tile encoder thread creation failed");
+    } else {
+      // Main thread acts as a worker and uses the thread data in cpi.
+      thread_data->td = &cpi->td;
+    }
+
+    winterface->sync(worker);
+  }
+}
+
+// Sets up the first num_workers - 1 workers and the worker of the main thread
+// to run hook in the next stage.
+static void prepare_enc_workers(AV1_COMP *cpi, AVxWorkerHook hook,
+                                int num_workers) {
+  AV1_COMMON *const cm = &cpi->common;
+  int i;
+
+  cpi->num_stage_workers = AOMMAX(1, AOMMIN(num_workers, cpi->num_workers));
+  for (i = 0; i < cpi->num_stage_workers; i++) {
+    AVxWorker *const worker = &cpi->workers[get_stage_worker(cpi, i)];
     EncWorkerData *thread_data;
 
-    worker->hook = (AVxWorkerHook)enc_worker_hook;
-    worker->data1 = &cpi->tile_thr_data[i];
+    worker->hook = hook;
+    worker->data1 = &cpi->tile_thr_data[get_stage_worker(cpi, i)];
     worker->data2 = NULL;
     thread_data = (EncWorkerData *)worker->data1;
 
-    // Before encoding a frame, copy the thread data from cpi.
+    // Before encoding a frame, copy the thread data from cpi. The counts of a
+    // worker are cleared when they are merged into those of the frame, so only
+    // the ones left over by an aborted frame are cleared here.
     if (thread_data->td != &cpi->td) {
+#if CONFIG_PALETTE
+      // Each worker keeps its own palette buffer.
+      PALETTE_BUFFER *const palette_buffer = thread_data->td->mb.palette_buffer;
       thread_data->td->mb = cpi->td.mb;
-      thread_data->td->rd_counts = cpi->td.rd_counts;
-    }
-    if (thread_data->td->counts != &cpi->common.counts) {
-      memcpy(thread_data->td->counts, &cpi->common.counts,
-             sizeof(cpi->common.counts));
+      thread_data->td->mb.palette_buffer = palette_buffer;
+#else
+      thread_data->td->mb = cpi->td.mb;
+#endif  // CONFIG_PALETTE
+      if (thread_data->counts_used) {
+        av1_zero(*thread_data->td->counts);
+        av1_zero(thread_data->td->rd_counts);
+        thread_data->counts_used = 0;
+      }
     }
 
 #if CONFIG_PALETTE
     // Allocate buffers used by palette coding mode.
-    if (cpi->common.allow_screen_content_tools && i < num_workers - 1) {
+    if (cpi->common.allow_screen_content_tools && thread_data->td != &cpi->td &&
+        thread_data->td->mb.palette_buffer == NULL) {
       MACROBLOCK *x = &thread_data->td->mb;
       CHECK_MEM_ERROR(cm, x->palette_buffer,
                       aom_memalign(16, sizeof(*x->palette_buffer)));
     }
+#else
+    (void)cm;
 #endif  // CONFIG_PALETTE
   }
+}
 
-  // Encode a frame
-  for (i = 0; i < num_workers; i++) {
-    AVxWorker *const worker = &cpi->workers[i];
-    EncWorkerData *const thread_data = (EncWorkerData *)worker->data1;
+static void run_enc_workers(AV1_COMP *cpi) {
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+  int i;
 
-    // Set the starting tile for each thread.
-    thread_data->start = i;
+  for (i = 0; i < cpi->num_stage_workers; i++) {
+    AVxWorker *const worker = &cpi->workers[get_stage_worker(cpi, i)];
 
-    if (i == cpi->num_workers - 1)
+    if (i == cpi->num_stage_workers - 1)
       winterface->execute(worker);
     else
       winterface->launch(worker);
   }
 
-  // Encoding ends.
-  for (i = 0; i < num_workers; i++) {
-    AVxWorker *const worker = &cpi->workers[i];
+  for (i = 0; i < cpi->num_stage_workers; i++) {
+    AVxWorker *const worker = &cpi->workers[get_stage_worker(cpi, i)];
     winterface->sync(worker);
   }
+}
 
-  for (i = 0; i < num_workers; i++) {
-    AVxWorker *const worker = &cpi->workers[i];
-    EncWorkerData *const thread_data = (EncWorkerData *)worker->data1;
+// Adds the counts of the workers that encoded part of the frame to those of
+// the frame. The merge is split over all the workers when there are enough
+// counts to sum.
+static void accumulate_worker_counts(AV1_COMP *cpi) {
+  int num_used = 0;
+  int i, j;
+
+  for (i = 0; i < cpi->num_workers - 1; i++) {
+    ThreadData *const td = cpi->tile_thr_data[i].td;
+    if (!cpi->tile_thr_data[i].counts_used) continue;
+    for (j = 0; j < REFERENCE_MODES; j++)
+      cpi->td.rd_counts.comp_pred_diff[j] += td->rd_counts.comp_pred_diff[j];
+    av1_zero(td->rd_counts.comp_pred_diff);
+    ++num_used;
+  }
+
+  if (num_used >= MIN_PARALLEL_COUNTS_MERGE) {
+    cpi->num_stage_workers = cpi->num_workers;
+    for (i = 0; i < cpi->num_workers; i++) {
+      AVxWorker *const worker = &cpi->workers[i];
+      worker->hook = (AVxWorkerHook)merge_counts_worker_hook;
+      worker->data1 = &cpi->tile_thr_data[i];
+      worker->data2 = NULL;
+    }
+    run_enc_workers(cpi);
+  } else if (num_used > 0) {
+    merge_worker_counts_slice(cpi, 0, 1);
+  }
 
-    // Accumulate counters.
-    if (i < cpi->num_workers - 1) {
-      av1_accumulate_frame_counts(&cm->counts, thread_data->td->counts);
-      accumulate_rd_opt(&cpi->td, thread_data->td);
+  for (i = 0; i < cpi->num_workers; i++) cpi->tile_thr_data[i].counts_used = 0;
+}
+
+void av1_encode_tiles_mt(AV1_COMP *cpi) {
+  AV1_COMMON *const cm = &cpi->common;
+
+  av1_init_tile_data(cpi);
+
+  // Only run once to create threads and allocate thread data.
+  create_enc_workers(cpi);
+
+  // A worker encodes one tile at a time.
+  prepare_enc_workers(cpi, (AVxWorkerHook)enc_worker_hook, cm->tile_cols);
+
+  // The workers take the tiles from a shared queue, most expensive first.
+  init_tile_queue(cpi);
+
+  // Encode a frame
+  run_enc_workers(cpi);
+
+  // Accumulate counters.
+  accumulate_worker_counts(cpi);
+}
+
+void av1_enc_row_mt_alloc(AV1EncRowMTSync *row_mt_sync, AV1_COMMON *cm,
+                          int tile_cols, int max_sb_rows) {
+  const int rows = tile_cols * max_sb_rows;
+
+  row_mt_sync->rows = rows;
+  row_mt_sync->tile_cols = tile_cols;
+  row_mt_sync->max_sb_rows = max_sb_rows;
+#if CONFIG_MULTITHREAD
+  {
+    int i;
+
+    CHECK_MEM_ERROR(cm, row_mt_sync->mutex_,
+                    aom_malloc(sizeof(*row_mt_sync->mutex_) * rows));
+    if (row_mt_sync->mutex_) {
+      for (i = 0; i < rows; ++i) {
+        pthread_mutex_init(&row_mt_sync->mutex_[i], NULL);
+      }
     }
+
+    CHECK_MEM_ERROR(cm, row_mt_sync->cond_,
+                    aom_malloc(sizeof(*row_mt_sync->cond_) * rows));
+    if (row_mt_sync->cond_) {
+      for (i = 0; i < rows; ++i) {
+        pthread_cond_init(&row_mt_sync->cond_[i], NULL);
+      }
+    }
+
+    CHECK_MEM_ERROR(cm, row_mt_sync->waiters,
+                    aom_calloc(rows, sizeof(*row_mt_sync->waiters)));
   }
+#endif  // CONFIG_MULTITHREAD
+
+  CHECK_MEM_ERROR(cm, row_mt_sync->cur_sb_col,
+                  aom_malloc(sizeof(*row_mt_sync->cur_sb_col) * rows));
+  CHECK_MEM_ERROR(cm, row_mt_sync->row_state,
+                  aom_malloc(sizeof(*row_mt_sync->row_state) * rows));
+  CHECK_MEM_ERROR(cm, row_mt_sync->row_tok_count,
+                  aom_malloc(sizeof(*row_mt_sync->row_tok_count) * rows));
+
+  // Intra prediction and motion vector references reach up to the above-right
+  // superblock, so a row may only run one superblock behind the row above.
+  row_mt_sync->sync_range = 1;
+}
+
+void av1_enc_row_mt_dealloc(AV1EncRowMTSync *row_mt_sync) {
+  if (row_mt_sync != NULL) {
+#if CONFIG_MULTITHREAD
+    int i;
+
+    if (row_mt_sync->mutex_ != NULL) {
+      for (i = 0; i < row_mt_sync->rows; ++i) {
+        pthread_mutex_destroy(&row_mt_sync->mutex_[i]);
+      }
+      aom_free(row_mt_sync->mutex_);
+    }
+    if (row_mt_sync->cond_ != NULL) {
+      for (i = 0; i < row_mt_sync->rows; ++i) {
+        pthread_cond_destroy(&row_mt_sync->cond_[i]);
+      }
+      aom_free(row_mt_sync->cond_);
+    }
+    aom_free(row_mt_sync->waiters);
+#endif  // CONFIG_MULTITHREAD
+    aom_free(row_mt_sync->cur_sb_col);
+    aom_free(row_mt_sync->row_state);
+    aom_free(row_mt_sync->row_tok_count);
+    av1_zero(*row_mt_sync);
+  }
+}
+
+// As in the loop filter's sync_read(), the progress of the row above is polled
+// for a while before blocking, and sync_write() only takes the lock of a row
+// when a thread is blocked on it.
+void av1_enc_row_mt_sync_read(AV1EncRowMTSync *const row_mt_sync, int tile_col,
+                              int r, int c) {
+#if CONFIG_MULTITHREAD
+  const int nsync = row_mt_sync->sync_range;
+
+  if (r && !(c & (nsync - 1))) {
+    const int row = tile_col * row_mt_sync->max_sb_rows + r - 1;
+    const int *const cur_sb_col = &row_mt_sync->cur_sb_col[row];
+    int *const waiters = &row_mt_sync->waiters[row];
+    pthread_mutex_t *const mutex = &row_mt_sync->mutex_[row];
+    int i;
+
+    for (i = 0; i < AOM_ATOMIC_SPIN_COUNT; ++i)
+      if (c <= aom_atomic_load_int(cur_sb_col) - nsync) return;
+
+    pthread_mutex_lock(mutex);
+    aom_atomic_store_int(waiters, *waiters + 1);
+    while (c > aom_atomic_load_int(cur_sb_col) - nsync) {
+      pthread_cond_wait(&row_mt_sync->cond_[row], mutex);
+    }
+    aom_atomic_store_int(waiters, *waiters - 1);
+    pthread_mutex_unlock(mutex);
+  }
+#else
+  (void)row_mt_sync;
+  (void)tile_col;
+  (void)r;
+  (void)c;
+#endif  // CONFIG_MULTITHREAD
+}
+
+void av1_enc_row_mt_sync_write(AV1EncRowMTSync *const row_mt_sync,
+                               int tile_col, int r, int c, const int sb_cols) {
+#if CONFIG_MULTITHREAD
+  const int nsync = row_mt_sync->sync_range;
+  const int row = tile_col * row_mt_sync->max_sb_rows + r;
+  int cur;
+  int sig = 1;
+
+  if (c < sb_cols - 1) {
+    cur = c;
+    if (c % nsync) sig = 0;
+  } else {
+    cur = sb_cols + nsync;
+  }
+
+  if (sig) {
+    aom_atomic_store_int(&row_mt_sync->cur_sb_col[row], cur);
+
+    // Only the row below waits on this row.
+    if (aom_atomic_load_int(&row_mt_sync->waiters[row])) {
+      pthread_mutex_lock(&row_mt_sync->mutex_[row]);
+      pthread_cond_signal(&row_mt_sync->cond_[row]);
+      pthread_mutex_unlock(&row_mt_sync->mutex_[row]);
+    }
+  }
+#else
+  (void)row_mt_sync;
+  (void)tile_col;
+  (void)r;
+  (void)c;
+  (void)sb_cols;
+#endif  // CONFIG_MULTITHREAD
+}
+
+static int enc_row_mt_worker_hook(EncWorkerData *const thread_data,
+                                  void *unused) {
+  AV1_COMP *const cpi = thread_data->cpi;
+  AV1EncRowMTSync *const row_mt_sync = &cpi->row_mt_sync;
+  int job;
+
+  (void)unused;
+
+  // The jobs are the superblock rows numbered sb_row * tile_cols + tile_col.
+  // The job queue runs the lowest job left first, so a row never waits for a
+  // row that is not being encoded.
+  while ((job = get_next_job(thread_data)) >= 0) {
+    const int tile_col = job % row_mt_sync->tile_cols;
+    const int sb_row = job / row_mt_sync->tile_cols;
+
+    thread_data->counts_used = 1;
+    av1_encode_sb_row(cpi, thread_data->td, thread_data->row_tile_data,
+                      row_mt_sync->tile_row, tile_col, sb_row);
+  }
+
+  return 1;
+}
+
+void av1_encode_tiles_row_mt(AV1_COMP *cpi) {
+  AV1_COMMON *const cm = &cpi->common;
+  AV1EncRowMTSync *const row_mt_sync = &cpi->row_mt_sync;
+  const int tile_cols = cm->tile_cols;
+  // No tile has more superblock rows than the frame.
+  const int max_sb_rows =
+      (cm->mi_rows + cm->mib_size - 1) >> cm->mib_size_log2;
+  int tile_row, i;
+
+  av1_init_tile_data(cpi);
+
+  create_enc_workers(cpi);
+
+  if (row_mt_sync->tile_cols != tile_cols ||
+      row_mt_sync->max_sb_rows < max_sb_rows) {
+    av1_enc_row_mt_dealloc(row_mt_sync);
+    av1_enc_row_mt_alloc(row_mt_sync, cm, tile_cols, max_sb_rows);
+  }
+
+  for (i = 0; i < cpi->num_workers; i++) {
+    EncWorkerData *const thread_data = &cpi->tile_thr_data[i];
+    if (thread_data->row_tile_data == NULL)
+      CHECK_MEM_ERROR(cm, thread_data->row_tile_data,
+                      aom_memalign(32, sizeof(*thread_data->row_tile_data)));
+  }
+
+  prepare_enc_workers(cpi, (AVxWorkerHook)enc_row_mt_worker_hook,
+                      cpi->num_workers);
+
+  // The tile rows share the above context, so they are encoded one after the
+  // other.
+  for (tile_row = 0; tile_row < cm->tile_rows; ++tile_row) {
+    const TileInfo *const tile_info =
+        &cpi->tile_data[tile_row * tile_cols].tile_info;
+
+    row_mt_sync->tile_row = tile_row;
+    row_mt_sync->sb_rows =
+        (tile_info->mi_row_end - tile_info->mi_row_start + cm->mib_size - 1) >>
+        cm->mib_size_log2;
+    memset(row_mt_sync->cur_sb_col, -1,
+           sizeof(*row_mt_sync->cur_sb_col) * row_mt_sync->rows);
+    aom_job_queue_reset(&cpi->job_queue, row_mt_sync->sb_rows * tile_cols,
+                        cpi->num_stage_workers);
+
+    av1_init_tile_row_mt(cpi, tile_row);
+    run_enc_workers(cpi);
+    av1_finish_tile_row_mt(cpi, tile_row);
+  }
+
+  accumulate_worker_counts(cpi);
+}
+
+// Points the mode info of a worker other than the main one at a private copy of
+// the mode info of the main thread, with no neighbours available.
+static void setup_worker_mode_info(AV1_COMP *cpi, EncWorkerData *thread_data) {
+  AV1_COMMON *const cm = &cpi->common;
+  MACROBLOCKD *const xd = &thread_data->td->mb.e_mbd;
+  const int grid_size = cm->mi_stride + 1;
+
+  if (thread_data->mi == NULL)
+    CHECK_MEM_ERROR(cm, thread_data->mi, aom_malloc(sizeof(*thread_data->mi)));
+  if (thread_data->mi_grid_size < grid_size) {
+    aom_free(thread_data->mi_grid);
+    thread_data->mi_grid_size = 0;
+    CHECK_MEM_ERROR(cm, thread_data->mi_grid,
+                    aom_malloc(grid_size * sizeof(*thread_data->mi_grid)));
+    thread_data->mi_grid_size = grid_size;
+  }
+  *thread_data->mi = *cpi->td.mb.e_mbd.mi[0];
+  memset(thread_data->mi_grid, 0, grid_size * sizeof(*thread_data->mi_grid));
+  thread_data->mi_grid[cm->mi_stride] = thread_data->mi;
+  xd->mi = thread_data->mi_grid + cm->mi_stride;
+}
+
+static int first_pass_worker_hook(EncWorkerData *const thread_data,
+                                  void *unused) {
+  AV1_COMP *const cpi = thread_data->cpi;
+  AV1EncRowMTSync *const row_mt_sync = &cpi->row_mt_sync;
+  int mb_row;
+
+  (void)unused;
+
+  while ((mb_row = get_next_job(thread_data)) >= 0)
+    av1_first_pass_row(cpi, &thread_data->td->mb, mb_row, row_mt_sync);
+
+  return 1;
+}
+
+void av1_first_pass_rows_mt(AV1_COMP *cpi) {
+  AV1_COMMON *const cm = &cpi->common;
+  AV1EncRowMTSync *const row_mt_sync = &cpi->row_mt_sync;
+  int i;
+
+  create_enc_workers(cpi);
+
+  // The first pass has no tiles and a macroblock row is synchronized like a
+  // superblock row.
+  if (row_mt_sync->tile_cols != 1 || row_mt_sync->max_sb_rows < cm->mb_rows) {
+    av1_enc_row_mt_dealloc(row_mt_sync);
+    av1_enc_row_mt_alloc(row_mt_sync, cm, 1, cm->mb_rows);
+  }
+  row_mt_sync->tile_row = 0;
+  row_mt_sync->sb_rows = cm->mb_rows;
+  memset(row_mt_sync->cur_sb_col, -1,
+         sizeof(*row_mt_sync->cur_sb_col) * row_mt_sync->rows);
+
+  prepare_enc_workers(cpi, (AVxWorkerHook)first_pass_worker_hook,
+                      cpi->num_workers);
+  aom_job_queue_reset(&cpi->job_queue, cm->mb_rows, cpi->num_stage_workers);
+
+  for (i = 0; i < cpi->num_stage_workers - 1; i++) {
+    setup_worker_mode_info(cpi, &cpi->tile_thr_data[i]);
+    av1_first_pass_setup_coeffs(cpi->tile_thr_data[i].td);
+  }
+
+  run_enc_workers(cpi);
+}
+
+static int temporal_filter_worker_hook(EncWorkerData *const thread_data,
+                                       const TemporalFilterParams *params) {
+  int mb_row;
+
+  while ((mb_row = get_next_job(thread_data)) >= 0)
+    av1_temporal_filter_row(thread_data->cpi, &thread_data->td->mb, params,
+                            mb_row);
+
+  return 1;
+}
+
+void av1_temporal_filter_rows_mt(AV1_COMP *cpi,
+                                 const TemporalFilterParams *params) {
+  MACROBLOCKD *const xd = &cpi->td.mb.e_mbd;
+  const YV12_BUFFER_CONFIG *const f = params->frames[params->alt_ref_index];
+  uint8_t *input_buffer[MAX_MB_PLANE];
+  int i;
+
+  for (i = 0; i < MAX_MB_PLANE; i++) input_buffer[i] = xd->plane[i].pre[0].buf;
+
+  create_enc_workers(cpi);
+  prepare_enc_workers(cpi, (AVxWorkerHook)temporal_filter_worker_hook,
+                      cpi->num_workers);
+  aom_job_queue_reset(&cpi->job_queue, (f->y_crop_height + 15) >> 4,
+                      cpi->num_stage_workers);
+
+  for (i = 0; i < cpi->num_stage_workers; i++) {
+    cpi->workers[get_stage_worker(cpi, i)].data2 = (void *)params;
+    if (i < cpi->num_stage_workers - 1)
+      setup_worker_mode_info(cpi, &cpi->tile_thr_data[i]);
+  }
+
+  run_enc_workers(cpi);
+
+  for (i = 0; i < MAX_MB_PLANE; i++) xd->plane[i].pre[0].buf = input_buffer[i];
+}
+
+void av1_setup_filter_workers(AV1_COMP *cpi) {
+  const AV1_COMMON *const cm = &cpi->common;
+  const int sb_rows = (cm->mi_rows + cm->mib_size - 1) >> cm->mib_size_log2;
+
+  // The filters share the superblock rows of the frame among the workers.
+  if (cpi->oxcf.max_threads > 1 && sb_rows > 1) {
+    create_enc_workers(cpi);
+    cpi->num_filter_workers = cpi->num_workers;
+  } else {
+    cpi->num_filter_workers = 1;
+  }
+}
+
+#if CONFIG_GLOBAL_MOTION
+static int global_motion_worker_hook(EncWorkerData *const thread_data,
+                                     GlobalMotionJob *jobs) {
+  int j;
+
+  while ((j = get_next_job(thread_data)) >= 0)
+    av1_global_motion_search(thread_data->cpi, &jobs[j]);
+
+  return 1;
+}
+
+void av1_global_motion_search_mt(AV1_COMP *cpi, GlobalMotionJob *jobs,
+                                 int num_jobs) {
+  int i;
+
+#if CONFIG_AOM_HIGHBITDEPTH
+  // The searches share the 8-bit copies of the frames, make them first.
+  get_frame_buffer_8bit(cpi->Source, cpi->common.bit_depth);
+  for (i = 0; i < num_jobs; i++)
+    get_frame_buffer_8bit(get_ref_frame_buffer(cpi, jobs[i].frame),
+                          cpi->common.bit_depth);
+#endif  // CONFIG_AOM_HIGHBITDEPTH
+
+  create_enc_workers(cpi);
+  // A worker searches the global motion of one reference frame at a time.
+  prepare_enc_workers(cpi, (AVxWorkerHook)global_motion_worker_hook, num_jobs);
+  aom_job_queue_reset(&cpi->job_queue, num_jobs, cpi->num_stage_workers);
+
+  for (i = 0; i < cpi->num_stage_workers; i++)
+    cpi->workers[get_stage_worker(cpi, i)].data2 = jobs;
+
+  run_enc_workers(cpi);
 }
+#endif  // CONFIG_GLOBAL_MOTION
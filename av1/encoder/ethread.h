@@ -12,21 +12,110 @@
 #ifndef AV1_ENCODER_ETHREAD_H_
 #define AV1_ENCODER_ETHREAD_H_
 
+#include "./aom_config.h"
+#include "aom_util/aom_thread.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 struct AV1_COMP;
+struct AV1Common;
+struct GlobalMotionJob;
+struct MODE_INFO;
+struct RowSearchState;
+struct TemporalFilterParams;
 struct ThreadData;
+struct TileDataEnc;
 
 typedef struct EncWorkerData {
   struct AV1_COMP *cpi;
   struct ThreadData *td;
-  int start;
+  // Tile data holding the mode search state of the superblock row encoded by
+  // the worker in row based multi-threading.
+  struct TileDataEnc *row_tile_data;
+  // Mode info of the macroblocks encoded by the worker in the first pass and
+  // the temporal filter, and the grid it is reached through. The grid has no
+  // neighbours, like the border of the frame's grid seen by the first pass.
+  struct MODE_INFO *mi;
+  struct MODE_INFO **mi_grid;
+  int mi_grid_size;
+  // Set once the worker has added to the counts of its thread data. They are
+  // cleared again when they are merged into the counts of the frame.
+  int counts_used;
 } EncWorkerData;
 
+// Superblock row synchronization of the row-based multi-threaded encoder. The
+// superblock rows of all the tiles of one tile row are encoded at the same
+// time. The rows of tile column c use the entries starting at c * max_sb_rows.
+typedef struct AV1EncRowMTSync {
+#if CONFIG_MULTITHREAD
+  pthread_mutex_t *mutex_;
+  pthread_cond_t *cond_;
+  // Number of threads blocked on the progress of each row.
+  int *waiters;
+#endif
+  // Index of the last encoded superblock in each row. It is read and written
+  // atomically, see av1_enc_row_mt_sync_read().
+  int *cur_sb_col;
+  int sync_range;
+  int rows;
+  int max_sb_rows;
+
+  // Mode search state each row starts from, saved by the row above, and the
+  // number of tokens of each row.
+  struct RowSearchState *row_state;
+  unsigned int *row_tok_count;
+
+  // The superblock rows of the tiles of tile row tile_row, handed to the
+  // workers through the job queue.
+  int tile_row;
+  int tile_cols;
+  int sb_rows;
+} AV1EncRowMTSync;
+
+// Allocate memory for superblock row synchronization of tile_cols tiles of up
+// to max_sb_rows superblock rows.
+void av1_enc_row_mt_alloc(AV1EncRowMTSync *row_mt_sync, struct AV1Common *cm,
+                          int tile_cols, int max_sb_rows);
+
+// Deallocate superblock row synchronization related mutex and data.
+void av1_enc_row_mt_dealloc(AV1EncRowMTSync *row_mt_sync);
+
+// Wait until superblock c of row r of tile column tile_col may be encoded, i.e.
+// until the above and above-right superblocks of row r - 1 are done.
+void av1_enc_row_mt_sync_read(AV1EncRowMTSync *const row_mt_sync, int tile_col,
+                              int r, int c);
+
+// Signal that superblock c of row r of tile column tile_col has been encoded.
+void av1_enc_row_mt_sync_write(AV1EncRowMTSync *const row_mt_sync,
+                               int tile_col, int r, int c, const int sb_cols);
+
 void av1_encode_tiles_mt(struct AV1_COMP *cpi);
 
+// Encodes the tiles with the superblock rows of each tile spread over the
+// workers.
+void av1_encode_tiles_row_mt(struct AV1_COMP *cpi);
+
+// Encodes the macroblock rows of a first pass frame on all the workers.
+void av1_first_pass_rows_mt(struct AV1_COMP *cpi);
+
+// Filters the macroblock rows of an alt-ref frame on all the workers.
+void av1_temporal_filter_rows_mt(struct AV1_COMP *cpi,
+                                 const struct TemporalFilterParams *params);
+
+// Sets cpi->num_filter_workers, the number of workers running the in-loop
+// filters of the frame and their searches, and creates the workers if needed.
+// It only depends on oxcf.max_threads and the size of the frame, not on the
+// stages that ran on the workers before.
+void av1_setup_filter_workers(struct AV1_COMP *cpi);
+
+#if CONFIG_GLOBAL_MOTION
+// Runs the global motion searches of jobs on all the workers.
+void av1_global_motion_search_mt(struct AV1_COMP *cpi,
+                                 struct GlobalMotionJob *jobs, int num_jobs);
+#endif  // CONFIG_GLOBAL_MOTION
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
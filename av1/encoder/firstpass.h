@@ -12,6 +12,7 @@
 #ifndef AV1_ENCODER_FIRSTPASS_H_
 #define AV1_ENCODER_FIRSTPASS_H_
 
+#include "av1/common/mv.h"
 #include "av1/encoder/lookahead.h"
 #include "av1/encoder/ratectrl.h"
 
@@ -79,6 +80,40 @@ typedef struct {
   double count;
 } FIRSTPASS_STATS;
 
+// Statistics of a macroblock row of the first pass. The rows may be encoded in
+// any order and are merged in raster order, so that the frame statistics do
+// not depend on the number of threads.
+typedef struct {
+  int64_t intra_error;
+  int64_t coded_error;
+  int64_t sr_coded_error;
+  int64_t sum_mvrs;
+  int64_t sum_mvcs;
+  int sum_mvr;
+  int sum_mvc;
+  int sum_mvr_abs;
+  int sum_mvc_abs;
+  int mvcount;
+  int intercount;
+  int second_ref_count;
+  int intra_skip_count;
+  int sum_in_vectors;
+  // Whether the row has a textured block after the first column.
+  int image_data;
+  // Number of non-zero vectors that differ from the previous one in the row,
+  // not counting the first one.
+  int new_mv_count;
+  MV first_mv;
+  MV last_mv;
+} FIRSTPASS_ROW_STATS;
+
+// Floating point terms of each macroblock, summed in raster order.
+typedef struct {
+  double intra_factor;
+  double brightness_factor;
+  double neutral_count;
+} FIRSTPASS_MB_FACTORS;
+
 typedef enum {
   KF_UPDATE = 0,
   LF_UPDATE = 1,
@@ -132,6 +167,11 @@ typedef struct {
   double modified_error_left;
   double mb_av_energy;
 
+  FIRSTPASS_ROW_STATS *row_stats;
+  int row_stats_size;
+  FIRSTPASS_MB_FACTORS *mb_factors;
+  int mb_factors_size;
+
 #if CONFIG_FP_MB_STATS
   uint8_t *frame_mb_stats_buf;
   uint8_t *this_frame_mb_stats;
@@ -164,10 +204,19 @@ typedef struct {
 } TWO_PASS;
 
 struct AV1_COMP;
+struct AV1EncRowMTSync;
+struct macroblock;
+struct ThreadData;
 
 void av1_init_first_pass(struct AV1_COMP *cpi);
 void av1_rc_get_first_pass_params(struct AV1_COMP *cpi);
 void av1_first_pass(struct AV1_COMP *cpi, const struct lookahead_entry *source);
+// Points the coefficient buffers of td->mb at its own pick mode context.
+void av1_first_pass_setup_coeffs(struct ThreadData *td);
+// Encodes one macroblock row into twopass->row_stats[mb_row]. If row_mt_sync
+// is not NULL, each macroblock waits for its above-right neighbour.
+void av1_first_pass_row(struct AV1_COMP *cpi, struct macroblock *x, int mb_row,
+                        struct AV1EncRowMTSync *row_mt_sync);
 void av1_end_first_pass(struct AV1_COMP *cpi);
 
 void av1_init_second_pass(struct AV1_COMP *cpi);
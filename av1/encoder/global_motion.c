@@ -251,6 +251,15 @@ unsigned char *downconvert_frame(YV12_BUFFER_CONFIG *frm, int bit_depth) {
 
   return buf;
 }
+
+unsigned char *get_frame_buffer_8bit(YV12_BUFFER_CONFIG *frm, int bit_depth) {
+  if (!(frm->flags & YV12_FLAG_HIGHBITDEPTH)) return frm->y_buffer;
+  // The frame buffer is 16-bit, so we need to convert to 8 bits for the
+  // feature detection. We cache the result until the frame is released.
+  if (!frm->y_buffer_8bit)
+    frm->y_buffer_8bit = downconvert_frame(frm, bit_depth);
+  return frm->y_buffer_8bit;
+}
 #endif
 
 int compute_global_motion_feature_based(
@@ -269,20 +278,8 @@ int compute_global_motion_feature_based(
   RansacFunc ransac = get_ransac_type(type);
 
 #if CONFIG_AOM_HIGHBITDEPTH
-  if (frm->flags & YV12_FLAG_HIGHBITDEPTH) {
-    // The frame buffer is 16-bit, so we need to convert to 8 bits for the
-    // following code. We cache the result until the frame is released.
-    if (frm->y_buffer_8bit)
-      frm_buffer = frm->y_buffer_8bit;
-    else
-      frm_buffer = frm->y_buffer_8bit = downconvert_frame(frm, bit_depth);
-  }
-  if (ref->flags & YV12_FLAG_HIGHBITDEPTH) {
-    if (ref->y_buffer_8bit)
-      ref_buffer = ref->y_buffer_8bit;
-    else
-      ref_buffer = ref->y_buffer_8bit = downconvert_frame(ref, bit_depth);
-  }
+  frm_buffer = get_frame_buffer_8bit(frm, bit_depth);
+  ref_buffer = get_frame_buffer_8bit(ref, bit_depth);
 #endif
 
   // compute interest points in images using FAST features
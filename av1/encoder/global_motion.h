@@ -22,6 +22,14 @@ extern "C" {
 
 #define RANSAC_NUM_MOTIONS 1
 
+// Global motion search of one reference frame with one motion model. params
+// receives the motion found, or the identity if the model does not fit.
+typedef struct GlobalMotionJob {
+  int frame;
+  TransformationType model;
+  WarpedMotionParams params;
+} GlobalMotionJob;
+
 extern const double gm_advantage_thresh[TRANS_TYPES];
 
 void convert_model_to_params(const double *params, WarpedMotionParams *model);
@@ -55,6 +63,13 @@ double refine_integerized_param(WarpedMotionParams *wm,
   number of inlier feature points for each motion. Params for which the
   num_inliers entry is 0 should be ignored by the caller.
 */
+#if CONFIG_AOM_HIGHBITDEPTH
+// Returns the 8-bit luma plane the features of frm are detected in. High bit
+// depth frames are converted on first use, so searches running concurrently
+// on a frame need it to be called beforehand.
+unsigned char *get_frame_buffer_8bit(YV12_BUFFER_CONFIG *frm, int bit_depth);
+#endif  // CONFIG_AOM_HIGHBITDEPTH
+
 int compute_global_motion_feature_based(
     TransformationType type, YV12_BUFFER_CONFIG *frm, YV12_BUFFER_CONFIG *ref,
 #if CONFIG_AOM_HIGHBITDEPTH
@@ -14,6 +14,7 @@
 
 #include "./aom_scale_rtcd.h"
 #include "aom/aom_integer.h"
+#include "aom_util/aom_job_queue.h"
 #include "av1/common/cdef.h"
 #include "av1/common/onyxc_int.h"
 #include "av1/common/reconinter.h"
@@ -22,9 +23,11 @@
 #define TOTAL_STRENGTHS (DERING_STRENGTHS * CLPF_STRENGTHS)
 
 /* Search for the best strength to add as an option, knowing we
-   already selected nb_strengths options. */
+   already selected nb_strengths options. Only the total_strengths strengths
+   listed in strengths are considered. */
 static uint64_t search_one(int *lev, int nb_strengths,
-                           uint64_t mse[][TOTAL_STRENGTHS], int sb_count) {
+                           uint64_t mse[][TOTAL_STRENGTHS], int sb_count,
+                           const int *strengths, int total_strengths) {
   uint64_t tot_mse[TOTAL_STRENGTHS];
   int i, j;
   uint64_t best_tot_mse = (uint64_t)1 << 63;
@@ -40,16 +43,16 @@ static uint64_t search_one(int *lev, int nb_strengths,
       }
     }
     /* Find best mse when adding each possible new option. */
-    for (j = 0; j < TOTAL_STRENGTHS; j++) {
+    for (j = 0; j < total_strengths; j++) {
       uint64_t best = best_mse;
-      if (mse[i][j] < best) best = mse[i][j];
+      if (mse[i][strengths[j]] < best) best = mse[i][strengths[j]];
       tot_mse[j] += best;
     }
   }
-  for (j = 0; j < TOTAL_STRENGTHS; j++) {
+  for (j = 0; j < total_strengths; j++) {
     if (tot_mse[j] < best_tot_mse) {
       best_tot_mse = tot_mse[j];
-      best_id = j;
+      best_id = strengths[j];
     }
   }
   lev[nb_strengths] = best_id;
@@ -60,7 +63,8 @@ static uint64_t search_one(int *lev, int nb_strengths,
    already selected nb_strengths options. */
 static uint64_t search_one_dual(int *lev0, int *lev1, int nb_strengths,
                                 uint64_t (**mse)[TOTAL_STRENGTHS],
-                                int sb_count) {
+                                int sb_count, const int *strengths,
+                                int total_strengths) {
   uint64_t tot_mse[TOTAL_STRENGTHS][TOTAL_STRENGTHS];
   int i, j;
   uint64_t best_tot_mse = (uint64_t)1 << 63;
@@ -79,24 +83,24 @@ static uint64_t search_one_dual(int *lev0, int *lev1, int nb_strengths,
       }
     }
     /* Find best mse when adding each possible new option. */
-    for (j = 0; j < TOTAL_STRENGTHS; j++) {
+    for (j = 0; j < total_strengths; j++) {
       int k;
-      for (k = 0; k < TOTAL_STRENGTHS; k++) {
+      for (k = 0; k < total_strengths; k++) {
         uint64_t best = best_mse;
-        uint64_t curr = mse[0][i][j];
-        curr += mse[1][i][k];
+        uint64_t curr = mse[0][i][strengths[j]];
+        curr += mse[1][i][strengths[k]];
         if (curr < best) best = curr;
         tot_mse[j][k] += best;
       }
     }
   }
-  for (j = 0; j < TOTAL_STRENGTHS; j++) {
+  for (j = 0; j < total_strengths; j++) {
     int k;
-    for (k = 0; k < TOTAL_STRENGTHS; k++) {
+    for (k = 0; k < total_strengths; k++) {
       if (tot_mse[j][k] < best_tot_mse) {
         best_tot_mse = tot_mse[j][k];
-        best_id0 = j;
-        best_id1 = k;
+        best_id0 = strengths[j];
+        best_id1 = strengths[k];
       }
     }
   }
@@ -108,20 +112,23 @@ static uint64_t search_one_dual(int *lev0, int *lev1, int nb_strengths,
 /* Search for the set of strengths that minimizes mse. */
 static uint64_t joint_strength_search(int *best_lev, int nb_strengths,
                                       uint64_t mse[][TOTAL_STRENGTHS],
-                                      int sb_count) {
+                                      int sb_count, const int *strengths,
+                                      int total_strengths) {
   uint64_t best_tot_mse;
   int i;
   best_tot_mse = (uint64_t)1 << 63;
   /* Greedy search: add one strength options at a time. */
   for (i = 0; i < nb_strengths; i++) {
-    best_tot_mse = search_one(best_lev, i, mse, sb_count);
+    best_tot_mse = search_one(best_lev, i, mse, sb_count, strengths,
+                              total_strengths);
   }
   /* Trying to refine the greedy search by reconsidering each
      already-selected option. */
   for (i = 0; i < 4 * nb_strengths; i++) {
     int j;
     for (j = 0; j < nb_strengths - 1; j++) best_lev[j] = best_lev[j + 1];
-    best_tot_mse = search_one(best_lev, nb_strengths - 1, mse, sb_count);
+    best_tot_mse = search_one(best_lev, nb_strengths - 1, mse, sb_count,
+                              strengths, total_strengths);
   }
   return best_tot_mse;
 }
@@ -130,13 +137,15 @@ static uint64_t joint_strength_search(int *best_lev, int nb_strengths,
 static uint64_t joint_strength_search_dual(int *best_lev0, int *best_lev1,
                                            int nb_strengths,
                                            uint64_t (**mse)[TOTAL_STRENGTHS],
-                                           int sb_count) {
+                                           int sb_count, const int *strengths,
+                                           int total_strengths) {
   uint64_t best_tot_mse;
   int i;
   best_tot_mse = (uint64_t)1 << 63;
   /* Greedy search: add one strength options at a time. */
   for (i = 0; i < nb_strengths; i++) {
-    best_tot_mse = search_one_dual(best_lev0, best_lev1, i, mse, sb_count);
+    best_tot_mse = search_one_dual(best_lev0, best_lev1, i, mse, sb_count,
+                                   strengths, total_strengths);
   }
   /* Trying to refine the greedy search by reconsidering each
      already-selected option. */
@@ -146,8 +155,8 @@ static uint64_t joint_strength_search_dual(int *best_lev0, int *best_lev1,
       best_lev0[j] = best_lev0[j + 1];
       best_lev1[j] = best_lev1[j + 1];
     }
-    best_tot_mse =
-        search_one_dual(best_lev0, best_lev1, nb_strengths - 1, mse, sb_count);
+    best_tot_mse = search_one_dual(best_lev0, best_lev1, nb_strengths - 1, mse,
+                                   sb_count, strengths, total_strengths);
   }
   return best_tot_mse;
 }
@@ -268,49 +277,200 @@ uint64_t compute_dering_dist(uint16_t *dst, int dstride, uint16_t *src,
   return sum >> 2 * coeff_shift;
 }
 
-void av1_cdef_search(YV12_BUFFER_CONFIG *frame, const YV12_BUFFER_CONFIG *ref,
-                     AV1_COMMON *cm, MACROBLOCKD *xd) {
-  int r, c;
-  int sbr, sbc;
+// The frame data shared by the workers measuring the distortion of the
+// superblocks with each strength.
+typedef struct {
+  const AV1_COMMON *cm;
   uint16_t *src[3];
   uint16_t *ref_coeff[3];
-  dering_list dlist[MAX_MIB_SIZE * MAX_MIB_SIZE];
-  int dir[OD_DERING_NBLOCKS][OD_DERING_NBLOCKS] = { { 0 } };
-  int var[OD_DERING_NBLOCKS][OD_DERING_NBLOCKS] = { { 0 } };
   int stride[3];
   int bsize[3];
   int mi_wide_l2[3];
   int mi_high_l2[3];
   int xdec[3];
   int ydec[3];
+  int nplanes;
+  int chroma_dering;
+  int clpf_damping;
+  int coeff_shift;
+  int nvsb;
+  int nhsb;
+  // Position of each superblock with blocks to filter, as sbr * nhsb + sbc.
+  const int *sb_pos;
+  const int *strengths;
+  int total_strengths;
+  uint64_t (**mse)[TOTAL_STRENGTHS];
+} CdefSearchCtx;
+
+// Superblocks measured by a worker of compute_mse_mt().
+typedef struct {
+  const CdefSearchCtx *ctx;
+  AVxJobQueue *jobs;
+  int worker;
+} CdefSearchJob;
+
+// Measures the distortion of superblock sb with each strength.
+static void compute_sb_mse(const CdefSearchCtx *ctx, int sb) {
+  const AV1_COMMON *const cm = ctx->cm;
+  const int sbr = ctx->sb_pos[sb] / ctx->nhsb;
+  const int sbc = ctx->sb_pos[sb] % ctx->nhsb;
+  const int nhb = AOMMIN(MAX_MIB_SIZE, cm->mi_cols - MAX_MIB_SIZE * sbc);
+  const int nvb = AOMMIN(MAX_MIB_SIZE, cm->mi_rows - MAX_MIB_SIZE * sbr);
+  dering_list dlist[MAX_MIB_SIZE * MAX_MIB_SIZE];
+  int dir[OD_DERING_NBLOCKS][OD_DERING_NBLOCKS] = { { 0 } };
+  int var[OD_DERING_NBLOCKS][OD_DERING_NBLOCKS] = { { 0 } };
+  DECLARE_ALIGNED(32, uint16_t, inbuf[OD_DERING_INBUF_SIZE]);
+  uint16_t *const in =
+      inbuf + OD_FILT_VBORDER * OD_FILT_BSTRIDE + OD_FILT_HBORDER;
+  DECLARE_ALIGNED(32, uint16_t, tmp_dst[MAX_SB_SQUARE]);
+  const int dering_count = sb_compute_dering_list(cm, sbr * MAX_MIB_SIZE,
+                                                  sbc * MAX_MIB_SIZE, dlist);
+  int dirinit = 0;
+  int pli, i;
+
+  for (pli = 0; pli < ctx->nplanes; pli++) {
+    for (i = 0; i < OD_DERING_INBUF_SIZE; i++) inbuf[i] = OD_DERING_VERY_LARGE;
+    for (i = 0; i < ctx->total_strengths; i++) {
+      const int gi = ctx->strengths[i];
+      int threshold;
+      uint64_t curr_mse;
+      int clpf_strength;
+      threshold = gi / CLPF_STRENGTHS;
+      if (pli > 0 && !ctx->chroma_dering) threshold = 0;
+      /* We avoid filtering the pixels for which some of the pixels to
+         average
+         are outside the frame. We could change the filter instead, but it
+         would add special cases for any future vectorization. */
+      int yoff = OD_FILT_VBORDER * (sbr != 0);
+      int xoff = OD_FILT_HBORDER * (sbc != 0);
+      int ysize = (nvb << ctx->mi_high_l2[pli]) +
+                  OD_FILT_VBORDER * (sbr != ctx->nvsb - 1) + yoff;
+      int xsize = (nhb << ctx->mi_wide_l2[pli]) +
+                  OD_FILT_HBORDER * (sbc != ctx->nhsb - 1) + xoff;
+      clpf_strength = gi % CLPF_STRENGTHS;
+      if (clpf_strength == 0)
+        copy_sb16_16(&in[(-yoff * OD_FILT_BSTRIDE - xoff)], OD_FILT_BSTRIDE,
+                     ctx->src[pli],
+                     (sbr * MAX_MIB_SIZE << ctx->mi_high_l2[pli]) - yoff,
+                     (sbc * MAX_MIB_SIZE << ctx->mi_wide_l2[pli]) - xoff,
+                     ctx->stride[pli], ysize, xsize);
+      od_dering(clpf_strength ? NULL : (uint8_t *)in, OD_FILT_BSTRIDE, tmp_dst,
+                in, ctx->xdec[pli], ctx->ydec[pli], dir, &dirinit, var, pli,
+                dlist, dering_count, threshold,
+                clpf_strength + (clpf_strength == 3), ctx->clpf_damping,
+                ctx->coeff_shift, clpf_strength != 0, 1);
+      curr_mse = compute_dering_dist(
+          ctx->ref_coeff[pli] +
+              (sbr * MAX_MIB_SIZE << ctx->mi_high_l2[pli]) * ctx->stride[pli] +
+              (sbc * MAX_MIB_SIZE << ctx->mi_wide_l2[pli]),
+          ctx->stride[pli], tmp_dst, dlist, dering_count,
+          (BLOCK_SIZE)ctx->bsize[pli], ctx->coeff_shift, pli);
+      if (pli < 2)
+        ctx->mse[pli][sb][gi] = curr_mse;
+      else
+        ctx->mse[1][sb][gi] += curr_mse;
+    }
+  }
+}
+
+static int cdef_search_worker_hook(const CdefSearchJob *const job,
+                                   void *unused) {
+  int sb;
+  (void)unused;
+  while ((sb = aom_job_queue_next(job->jobs, job->worker)) >= 0)
+    compute_sb_mse(job->ctx, sb);
+  return 1;
+}
+
+// Shares the superblocks between the workers, the last one running on the
+// main thread.
+static void compute_mse_mt(const CdefSearchCtx *ctx, int sb_count,
+                           AVxWorker *workers, int num_workers) {
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+  AVxJobQueue queue = { NULL, 0, 0 };
+  CdefSearchJob *jobs;
+  int i;
+
+  num_workers = AOMMIN(num_workers, sb_count);
+  jobs = num_workers > 1 ? aom_malloc(num_workers * sizeof(*jobs)) : NULL;
+  if (jobs == NULL || !aom_job_queue_alloc(&queue, num_workers)) {
+    // With a single worker, or if the jobs cannot be allocated, measure the
+    // distortion on this thread.
+    aom_free(jobs);
+    for (i = 0; i < sb_count; i++) compute_sb_mse(ctx, i);
+    return;
+  }
+  aom_job_queue_reset(&queue, sb_count, num_workers);
+
+  for (i = 0; i < num_workers; ++i) {
+    AVxWorker *const worker = &workers[i];
+    jobs[i].ctx = ctx;
+    jobs[i].jobs = &queue;
+    jobs[i].worker = i;
+    worker->hook = (AVxWorkerHook)cdef_search_worker_hook;
+    worker->data1 = &jobs[i];
+    worker->data2 = NULL;
+    if (i == num_workers - 1)
+      winterface->execute(worker);
+    else
+      winterface->launch(worker);
+  }
+
+  for (i = 0; i < num_workers; ++i) winterface->sync(&workers[i]);
+
+  aom_job_queue_free(&queue);
+  aom_free(jobs);
+}
+
+void av1_cdef_search(YV12_BUFFER_CONFIG *frame, const YV12_BUFFER_CONFIG *ref,
+                     AV1_COMMON *cm, MACROBLOCKD *xd, int fast,
+                     AVxWorker *workers, int num_workers) {
+  CdefSearchCtx ctx;
+  int r, c;
+  int sbr, sbc;
+  dering_list dlist[MAX_MIB_SIZE * MAX_MIB_SIZE];
   int pli;
-  int dering_count;
-  int coeff_shift = AOMMAX(cm->bit_depth - 8, 0);
   uint64_t best_tot_mse = (uint64_t)1 << 63;
   uint64_t tot_mse;
   int sb_count;
   int nvsb = (cm->mi_rows + MAX_MIB_SIZE - 1) / MAX_MIB_SIZE;
   int nhsb = (cm->mi_cols + MAX_MIB_SIZE - 1) / MAX_MIB_SIZE;
   int *sb_index = aom_malloc(nvsb * nhsb * sizeof(*sb_index));
+  int *sb_pos = aom_malloc(nvsb * nhsb * sizeof(*sb_pos));
   int *selected_strength = aom_malloc(nvsb * nhsb * sizeof(*sb_index));
   uint64_t(*mse[2])[TOTAL_STRENGTHS];
-  int clpf_damping = 3 + (cm->base_qindex >> 6);
+  int strengths[TOTAL_STRENGTHS];
+  int total_strengths = 0;
   int i;
   int nb_strengths;
   int nb_strength_bits;
   int quantizer;
   double lambda;
-  int nplanes = 3;
-  DECLARE_ALIGNED(32, uint16_t, inbuf[OD_DERING_INBUF_SIZE]);
-  uint16_t *in;
-  DECLARE_ALIGNED(32, uint16_t, tmp_dst[MAX_SB_SQUARE]);
-  int chroma_dering =
-      xd->plane[1].subsampling_x == xd->plane[1].subsampling_y &&
-      xd->plane[2].subsampling_x == xd->plane[2].subsampling_y;
+  const int nplanes = 3;
   quantizer =
       av1_ac_quant(cm->base_qindex, 0, cm->bit_depth) >> (cm->bit_depth - 8);
   lambda = .12 * quantizer * quantizer / 256.;
 
+  // The fast search only tries every other deringing strength.
+  for (i = 0; i < TOTAL_STRENGTHS; i++) {
+    if (!fast || (i / CLPF_STRENGTHS) % 2 == 0)
+      strengths[total_strengths++] = i;
+  }
+
+  ctx.cm = cm;
+  ctx.nplanes = nplanes;
+  ctx.chroma_dering =
+      xd->plane[1].subsampling_x == xd->plane[1].subsampling_y &&
+      xd->plane[2].subsampling_x == xd->plane[2].subsampling_y;
+  ctx.clpf_damping = 3 + (cm->base_qindex >> 6);
+  ctx.coeff_shift = AOMMAX(cm->bit_depth - 8, 0);
+  ctx.nvsb = nvsb;
+  ctx.nhsb = nhsb;
+  ctx.sb_pos = sb_pos;
+  ctx.strengths = strengths;
+  ctx.total_strengths = total_strengths;
+  ctx.mse = mse;
+
   av1_setup_dst_planes(xd->plane, frame, 0, 0);
   mse[0] = aom_malloc(sizeof(**mse) * nvsb * nhsb);
   mse[1] = aom_malloc(sizeof(**mse) * nvsb * nhsb);
@@ -331,102 +491,62 @@ void av1_cdef_search(YV12_BUFFER_CONFIG *frame, const YV12_BUFFER_CONFIG *ref,
         ref_stride = ref->uv_stride;
         break;
     }
-    src[pli] = aom_memalign(
-        32, sizeof(*src) * cm->mi_rows * cm->mi_cols * MI_SIZE * MI_SIZE);
-    ref_coeff[pli] = aom_memalign(
-        32, sizeof(*ref_coeff) * cm->mi_rows * cm->mi_cols * MI_SIZE * MI_SIZE);
-    xdec[pli] = xd->plane[pli].subsampling_x;
-    ydec[pli] = xd->plane[pli].subsampling_y;
-    bsize[pli] = ydec[pli] ? (xdec[pli] ? BLOCK_4X4 : BLOCK_8X4)
-                           : (xdec[pli] ? BLOCK_4X8 : BLOCK_8X8);
-    stride[pli] = cm->mi_cols << MI_SIZE_LOG2;
-    mi_wide_l2[pli] = MI_SIZE_LOG2 - xd->plane[pli].subsampling_x;
-    mi_high_l2[pli] = MI_SIZE_LOG2 - xd->plane[pli].subsampling_y;
+    ctx.src[pli] = aom_memalign(
+        32, sizeof(*ctx.src) * cm->mi_rows * cm->mi_cols * MI_SIZE * MI_SIZE);
+    ctx.ref_coeff[pli] =
+        aom_memalign(32, sizeof(*ctx.ref_coeff) * cm->mi_rows * cm->mi_cols *
+                             MI_SIZE * MI_SIZE);
+    ctx.xdec[pli] = xd->plane[pli].subsampling_x;
+    ctx.ydec[pli] = xd->plane[pli].subsampling_y;
+    ctx.bsize[pli] = ctx.ydec[pli] ? (ctx.xdec[pli] ? BLOCK_4X4 : BLOCK_8X4)
+                                   : (ctx.xdec[pli] ? BLOCK_4X8 : BLOCK_8X8);
+    ctx.stride[pli] = cm->mi_cols << MI_SIZE_LOG2;
+    ctx.mi_wide_l2[pli] = MI_SIZE_LOG2 - xd->plane[pli].subsampling_x;
+    ctx.mi_high_l2[pli] = MI_SIZE_LOG2 - xd->plane[pli].subsampling_y;
 
     const int frame_height =
         (cm->mi_rows * MI_SIZE) >> xd->plane[pli].subsampling_y;
     const int frame_width =
         (cm->mi_cols * MI_SIZE) >> xd->plane[pli].subsampling_x;
+    const int stride = ctx.stride[pli];
 
     for (r = 0; r < frame_height; ++r) {
       for (c = 0; c < frame_width; ++c) {
 #if CONFIG_AOM_HIGHBITDEPTH
         if (cm->use_highbitdepth) {
-          src[pli][r * stride[pli] + c] = CONVERT_TO_SHORTPTR(
+          ctx.src[pli][r * stride + c] = CONVERT_TO_SHORTPTR(
               xd->plane[pli].dst.buf)[r * xd->plane[pli].dst.stride + c];
-          ref_coeff[pli][r * stride[pli] + c] =
+          ctx.ref_coeff[pli][r * stride + c] =
               CONVERT_TO_SHORTPTR(ref_buffer)[r * ref_stride + c];
         } else {
 #endif
-          src[pli][r * stride[pli] + c] =
+          ctx.src[pli][r * stride + c] =
               xd->plane[pli].dst.buf[r * xd->plane[pli].dst.stride + c];
-          ref_coeff[pli][r * stride[pli] + c] = ref_buffer[r * ref_stride + c];
+          ctx.ref_coeff[pli][r * stride + c] = ref_buffer[r * ref_stride + c];
 #if CONFIG_AOM_HIGHBITDEPTH
         }
 #endif
       }
     }
   }
-  in = inbuf + OD_FILT_VBORDER * OD_FILT_BSTRIDE + OD_FILT_HBORDER;
+
+  // List the superblocks that have blocks to filter. Superblocks with all
+  // their blocks skipped are never filtered and are left out of the search.
   sb_count = 0;
   for (sbr = 0; sbr < nvsb; ++sbr) {
     for (sbc = 0; sbc < nhsb; ++sbc) {
-      int nvb, nhb;
-      int gi;
-      int dirinit = 0;
-      nhb = AOMMIN(MAX_MIB_SIZE, cm->mi_cols - MAX_MIB_SIZE * sbc);
-      nvb = AOMMIN(MAX_MIB_SIZE, cm->mi_rows - MAX_MIB_SIZE * sbr);
-      dering_count = sb_compute_dering_list(cm, sbr * MAX_MIB_SIZE,
-                                            sbc * MAX_MIB_SIZE, dlist);
-      if (dering_count == 0) continue;
-      for (pli = 0; pli < nplanes; pli++) {
-        for (i = 0; i < OD_DERING_INBUF_SIZE; i++)
-          inbuf[i] = OD_DERING_VERY_LARGE;
-        for (gi = 0; gi < TOTAL_STRENGTHS; gi++) {
-          int threshold;
-          uint64_t curr_mse;
-          int clpf_strength;
-          threshold = gi / CLPF_STRENGTHS;
-          if (pli > 0 && !chroma_dering) threshold = 0;
-          /* We avoid filtering the pixels for which some of the pixels to
-             average
-             are outside the frame. We could change the filter instead, but it
-             would add special cases for any future vectorization. */
-          int yoff = OD_FILT_VBORDER * (sbr != 0);
-          int xoff = OD_FILT_HBORDER * (sbc != 0);
-          int ysize = (nvb << mi_high_l2[pli]) +
-                      OD_FILT_VBORDER * (sbr != nvsb - 1) + yoff;
-          int xsize = (nhb << mi_wide_l2[pli]) +
-                      OD_FILT_HBORDER * (sbc != nhsb - 1) + xoff;
-          clpf_strength = gi % CLPF_STRENGTHS;
-          if (clpf_strength == 0)
-            copy_sb16_16(&in[(-yoff * OD_FILT_BSTRIDE - xoff)], OD_FILT_BSTRIDE,
-                         src[pli],
-                         (sbr * MAX_MIB_SIZE << mi_high_l2[pli]) - yoff,
-                         (sbc * MAX_MIB_SIZE << mi_wide_l2[pli]) - xoff,
-                         stride[pli], ysize, xsize);
-          od_dering(clpf_strength ? NULL : (uint8_t *)in, OD_FILT_BSTRIDE,
-                    tmp_dst, in, xdec[pli], ydec[pli], dir, &dirinit, var, pli,
-                    dlist, dering_count, threshold,
-                    clpf_strength + (clpf_strength == 3), clpf_damping,
-                    coeff_shift, clpf_strength != 0, 1);
-          curr_mse = compute_dering_dist(
-              ref_coeff[pli] +
-                  (sbr * MAX_MIB_SIZE << mi_high_l2[pli]) * stride[pli] +
-                  (sbc * MAX_MIB_SIZE << mi_wide_l2[pli]),
-              stride[pli], tmp_dst, dlist, dering_count, bsize[pli],
-              coeff_shift, pli);
-          if (pli < 2)
-            mse[pli][sb_count][gi] = curr_mse;
-          else
-            mse[1][sb_count][gi] += curr_mse;
-          sb_index[sb_count] =
-              MAX_MIB_SIZE * sbr * cm->mi_stride + MAX_MIB_SIZE * sbc;
-        }
-      }
+      if (sb_compute_dering_list(cm, sbr * MAX_MIB_SIZE, sbc * MAX_MIB_SIZE,
+                                 dlist) == 0)
+        continue;
+      sb_index[sb_count] =
+          MAX_MIB_SIZE * sbr * cm->mi_stride + MAX_MIB_SIZE * sbc;
+      sb_pos[sb_count] = sbr * nhsb + sbc;
       sb_count++;
     }
   }
+
+  compute_mse_mt(&ctx, sb_count, workers, num_workers);
+
   nb_strength_bits = 0;
   /* Search for different number of signalling bits. */
   for (i = 0; i <= 3; i++) {
@@ -436,10 +556,11 @@ void av1_cdef_search(YV12_BUFFER_CONFIG *frame, const YV12_BUFFER_CONFIG *ref,
     nb_strengths = 1 << i;
     if (nplanes >= 3)
       tot_mse = joint_strength_search_dual(best_lev0, best_lev1, nb_strengths,
-                                           mse, sb_count);
+                                           mse, sb_count, strengths,
+                                           total_strengths);
     else
-      tot_mse =
-          joint_strength_search(best_lev0, nb_strengths, mse[0], sb_count);
+      tot_mse = joint_strength_search(best_lev0, nb_strengths, mse[0],
+                                      sb_count, strengths, total_strengths);
     /* Count superblock signalling cost. */
     tot_mse += (uint64_t)(sb_count * lambda * i);
     /* Count header signalling cost. */
@@ -476,9 +597,10 @@ void av1_cdef_search(YV12_BUFFER_CONFIG *frame, const YV12_BUFFER_CONFIG *ref,
   aom_free(mse[0]);
   aom_free(mse[1]);
   for (pli = 0; pli < nplanes; pli++) {
-    aom_free(src[pli]);
-    aom_free(ref_coeff[pli]);
+    aom_free(ctx.src[pli]);
+    aom_free(ctx.ref_coeff[pli]);
   }
   aom_free(sb_index);
+  aom_free(sb_pos);
   aom_free(selected_strength);
 }
@@ -36,6 +36,16 @@ int av1_get_max_filter_level(const AV1_COMP *cpi) {
   }
 }
 
+static int64_t get_y_sse(const AV1_COMMON *cm, const YV12_BUFFER_CONFIG *a,
+                         const YV12_BUFFER_CONFIG *b) {
+#if CONFIG_AOM_HIGHBITDEPTH
+  if (cm->use_highbitdepth) return aom_highbd_get_y_sse(a, b);
+#else
+  (void)cm;
+#endif  // CONFIG_AOM_HIGHBITDEPTH
+  return aom_get_y_sse(a, b);
+}
+
 static int64_t try_filter_frame(const YV12_BUFFER_CONFIG *sd,
                                 AV1_COMP *const cpi, int filt_level,
                                 int partial_frame) {
@@ -46,24 +56,16 @@ static int64_t try_filter_frame(const YV12_BUFFER_CONFIG *sd,
   av1_loop_filter_frame(cm->frame_to_show, cm, &cpi->td.mb.e_mbd, filt_level, 1,
                         partial_frame);
 #else
-  if (cpi->num_workers > 1)
+  if (cpi->num_filter_workers > 1)
     av1_loop_filter_frame_mt(cm->frame_to_show, cm, cpi->td.mb.e_mbd.plane,
                              filt_level, 1, partial_frame, cpi->workers,
-                             cpi->num_workers, &cpi->lf_row_sync);
+                             cpi->num_filter_workers, &cpi->lf_row_sync);
   else
     av1_loop_filter_frame(cm->frame_to_show, cm, &cpi->td.mb.e_mbd, filt_level,
                           1, partial_frame);
 #endif
 
-#if CONFIG_AOM_HIGHBITDEPTH
-  if (cm->use_highbitdepth) {
-    filt_err = aom_highbd_get_y_sse(sd, cm->frame_to_show);
-  } else {
-    filt_err = aom_get_y_sse(sd, cm->frame_to_show);
-  }
-#else
-  filt_err = aom_get_y_sse(sd, cm->frame_to_show);
-#endif  // CONFIG_AOM_HIGHBITDEPTH
+  filt_err = get_y_sse(cm, sd, cm->frame_to_show);
 
   // Re-instate the unfiltered frame
   aom_yv12_copy_y(&cpi->last_frame_uf, cm->frame_to_show);
@@ -71,6 +73,88 @@ static int64_t try_filter_frame(const YV12_BUFFER_CONFIG *sd,
   return filt_err;
 }
 
+#if !CONFIG_VAR_TX
+// A loop filter level tried by a worker. The level is set up in a copy of the
+// common state and filters a copy of the unfiltered frame, so that the two
+// levels of a search step can be tried at the same time.
+typedef struct {
+  AV1_COMMON cm;
+  MACROBLOCKD xd;
+  const YV12_BUFFER_CONFIG *sd;
+  const YV12_BUFFER_CONFIG *unfiltered;
+  YV12_BUFFER_CONFIG *frame;
+  int filt_level;
+  int partial_frame;
+  int64_t filt_err;
+} LFSearchJob;
+
+static int lf_search_worker_hook(LFSearchJob *const job, void *unused) {
+  (void)unused;
+  aom_yv12_copy_y(job->unfiltered, job->frame);
+  av1_loop_filter_frame(job->frame, &job->cm, &job->xd, job->filt_level, 1,
+                        job->partial_frame);
+  job->filt_err = get_y_sse(&job->cm, job->sd, job->frame);
+  return 1;
+}
+
+static LFSearchJob *alloc_lf_search_jobs(const YV12_BUFFER_CONFIG *sd,
+                                         AV1_COMP *cpi, int partial_frame) {
+  AV1_COMMON *const cm = &cpi->common;
+  LFSearchJob *jobs;
+  int i;
+
+  CHECK_MEM_ERROR(cm, jobs, aom_malloc(2 * sizeof(*jobs)));
+  for (i = 0; i < 2; ++i) {
+    if (aom_realloc_frame_buffer(&cpi->lf_search_frame[i], cm->width,
+                                 cm->height, cm->subsampling_x,
+                                 cm->subsampling_y,
+#if CONFIG_AOM_HIGHBITDEPTH
+                                 cm->use_highbitdepth,
+#endif
+                                 AOM_BORDER_IN_PIXELS, cm->byte_alignment,
+                                 NULL, NULL, NULL)) {
+      aom_free(jobs);
+      aom_internal_error(&cm->error, AOM_CODEC_MEM_ERROR,
+                         "Failed to allocate loop filter search buffer");
+    }
+    jobs[i].cm = *cm;
+    jobs[i].xd = cpi->td.mb.e_mbd;
+    jobs[i].sd = sd;
+    jobs[i].unfiltered = &cpi->last_frame_uf;
+    jobs[i].frame = &cpi->lf_search_frame[i];
+    jobs[i].partial_frame = partial_frame;
+  }
+  return jobs;
+}
+
+// Tries two loop filter levels at the same time, one on the first worker and
+// the other one on the main thread.
+static void try_filter_levels_mt(AV1_COMP *const cpi, LFSearchJob *jobs,
+                                 int filt_level0, int filt_level1,
+                                 int64_t *ss_err) {
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+  AVxWorker *const workers[2] = {
+    &cpi->workers[0], &cpi->workers[cpi->num_filter_workers - 1]
+  };
+  int i;
+
+  jobs[0].filt_level = filt_level0;
+  jobs[1].filt_level = filt_level1;
+  for (i = 0; i < 2; ++i) {
+    workers[i]->hook = (AVxWorkerHook)lf_search_worker_hook;
+    workers[i]->data1 = &jobs[i];
+    workers[i]->data2 = NULL;
+  }
+
+  winterface->launch(workers[0]);
+  winterface->execute(workers[1]);
+  winterface->sync(workers[0]);
+
+  ss_err[filt_level0] = jobs[0].filt_err;
+  ss_err[filt_level1] = jobs[1].filt_err;
+}
+#endif  // !CONFIG_VAR_TX
+
 int av1_search_filter_level(const YV12_BUFFER_CONFIG *sd, AV1_COMP *cpi,
                             int partial_frame, double *best_cost_ret) {
   const AV1_COMMON *const cm = &cpi->common;
@@ -81,6 +165,9 @@ int av1_search_filter_level(const YV12_BUFFER_CONFIG *sd, AV1_COMP *cpi,
   int64_t best_err;
   int filt_best;
   MACROBLOCK *x = &cpi->td.mb;
+#if !CONFIG_VAR_TX
+  LFSearchJob *lf_search_jobs = NULL;
+#endif  // !CONFIG_VAR_TX
 
   // Start the search at the previous frame filter level unless it is now out of
   // range.
@@ -95,6 +182,11 @@ int av1_search_filter_level(const YV12_BUFFER_CONFIG *sd, AV1_COMP *cpi,
   //  Make a copy of the unfiltered / processed recon buffer
   aom_yv12_copy_y(cm->frame_to_show, &cpi->last_frame_uf);
 
+#if !CONFIG_VAR_TX
+  if (cpi->num_filter_workers > 1)
+    lf_search_jobs = alloc_lf_search_jobs(sd, cpi, partial_frame);
+#endif  // !CONFIG_VAR_TX
+
   best_err = try_filter_frame(sd, cpi, filt_mid, partial_frame);
   filt_best = filt_mid;
   ss_err[filt_mid] = best_err;
@@ -112,6 +204,14 @@ int av1_search_filter_level(const YV12_BUFFER_CONFIG *sd, AV1_COMP *cpi,
     // yx, bias less for large block size
     if (cm->tx_mode != ONLY_4X4) bias >>= 1;
 
+#if !CONFIG_VAR_TX
+    // Both levels are needed when the search has no direction yet.
+    if (lf_search_jobs != NULL && filt_direction == 0 &&
+        filt_low != filt_mid && filt_high != filt_mid &&
+        ss_err[filt_low] < 0 && ss_err[filt_high] < 0)
+      try_filter_levels_mt(cpi, lf_search_jobs, filt_low, filt_high, ss_err);
+#endif  // !CONFIG_VAR_TX
+
     if (filt_direction <= 0 && filt_low != filt_mid) {
       // Get Low filter error score
       if (ss_err[filt_low] < 0) {
@@ -151,6 +251,10 @@ int av1_search_filter_level(const YV12_BUFFER_CONFIG *sd, AV1_COMP *cpi,
     }
   }
 
+#if !CONFIG_VAR_TX
+  aom_free(lf_search_jobs);
+#endif  // !CONFIG_VAR_TX
+
   // Update best error
   best_err = ss_err[filt_best];
 
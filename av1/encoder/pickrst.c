@@ -118,21 +118,28 @@ static int64_t sse_restoration_frame(AV1_COMMON *const cm,
   return filt_err;
 }
 
+// Buffers a worker tries restoration tiles with.
+typedef struct {
+  YV12_BUFFER_CONFIG *dst;
+  int32_t *tmpbuf;
+} RstSearchBufs;
+
 static int64_t try_restoration_tile(const YV12_BUFFER_CONFIG *src,
                                     AV1_COMP *const cpi, RestorationInfo *rsi,
                                     int components_pattern, int partial_frame,
                                     int tile_idx, int subtile_idx,
                                     int subtile_bits,
-                                    YV12_BUFFER_CONFIG *dst_frame) {
+                                    const RstSearchBufs *bufs) {
   AV1_COMMON *const cm = &cpi->common;
+  YV12_BUFFER_CONFIG *const dst_frame = bufs->dst;
   int64_t filt_err;
   int tile_width, tile_height, nhtiles, nvtiles;
   int h_start, h_end, v_start, v_end;
   int ntiles, width, height;
 
-  // Y and UV components cannot be mixed
+  // Tiles are tried one plane at a time
   assert(components_pattern == 1 || components_pattern == 2 ||
-         components_pattern == 4 || components_pattern == 6);
+         components_pattern == 4);
 
   if (components_pattern == 1) {  // Y only
     width = src->y_crop_width;
@@ -146,8 +153,16 @@ static int64_t try_restoration_tile(const YV12_BUFFER_CONFIG *src,
       &tile_width, &tile_height, &nhtiles, &nvtiles);
   (void)ntiles;
 
-  av1_loop_restoration_frame(cm->frame_to_show, cm, rsi, components_pattern,
-                             partial_frame, dst_frame);
+  // Only the tile is filtered, unless a part of the frame is, as its
+  // restoration tiles are then laid out differently.
+  if (partial_frame)
+    av1_loop_restoration_frame(cm->frame_to_show, cm, rsi, components_pattern,
+                               partial_frame, dst_frame);
+  else
+    av1_loop_restoration_tile(cm->frame_to_show, cm,
+                              &rsi[get_msb(components_pattern)],
+                              get_msb(components_pattern), tile_idx,
+                              bufs->tmpbuf, dst_frame);
   av1_get_rest_tile_limits(tile_idx, subtile_idx, subtile_bits, nhtiles,
                            nvtiles, tile_width, tile_height, width, height, 0,
                            0, &h_start, &h_end, &v_start, &v_end);
@@ -163,12 +178,161 @@ static int64_t try_restoration_frame(const YV12_BUFFER_CONFIG *src,
                                      YV12_BUFFER_CONFIG *dst_frame) {
   AV1_COMMON *const cm = &cpi->common;
   int64_t filt_err;
-  av1_loop_restoration_frame(cm->frame_to_show, cm, rsi, components_pattern,
-                             partial_frame, dst_frame);
+  if (!partial_frame && cpi->num_filter_workers > 1)
+    av1_loop_restoration_frame_mt(cm->frame_to_show, cm, rsi,
+                                  components_pattern, dst_frame, cpi->workers,
+                                  cpi->num_filter_workers, &cpi->lr_sync);
+  else
+    av1_loop_restoration_frame(cm->frame_to_show, cm, rsi, components_pattern,
+                               partial_frame, dst_frame);
   filt_err = sse_restoration_frame(cm, src, dst_frame, components_pattern);
   return filt_err;
 }
 
+// Restoration search of the tiles of a plane. The tiles are searched
+// independently, possibly by different workers, before the frame level
+// decision is made.
+typedef struct RstSearchPlane {
+  const YV12_BUFFER_CONFIG *src;
+  AV1_COMP *cpi;
+  int partial_frame;
+  int plane;
+  RestorationInfo *info;
+  RestorationType *type;
+  double *best_tile_cost;
+  int ntiles;
+  int tile_width, tile_height;
+  int nhtiles, nvtiles;
+} RstSearchPlane;
+
+typedef void (*search_tile_func)(const RstSearchPlane *sp, int tile_idx,
+                                 const RstSearchBufs *bufs);
+
+// Tiles searched by a worker, taken from the job queue. The tiles of the
+// planes are numbered in order.
+typedef struct {
+  search_tile_func search_tile;
+  const RstSearchPlane *planes;
+  int num_planes;
+  AVxJobQueue *jobs;
+  int worker;
+  RstSearchBufs bufs;
+} RstSearchJob;
+
+// Searches tile n of the planes.
+static void search_tile_n(const RstSearchJob *job, int n) {
+  int p = 0;
+  while (n >= job->planes[p].ntiles) n -= job->planes[p++].ntiles;
+  job->search_tile(&job->planes[p], n, &job->bufs);
+}
+
+static int rst_search_worker_hook(RstSearchJob *const job, void *unused) {
+  int n;
+  (void)unused;
+  while ((n = aom_job_queue_next(job->jobs, job->worker)) >= 0)
+    search_tile_n(job, n);
+  return 1;
+}
+
+static void alloc_rst_search_bufs(AV1_COMP *cpi, int num) {
+  AV1_COMMON *const cm = &cpi->common;
+  int i;
+  if (cpi->num_rst_search_bufs < num) {
+    av1_free_rst_search_bufs(cpi);
+    CHECK_MEM_ERROR(cm, cpi->rst_search_frames,
+                    aom_calloc(num, sizeof(*cpi->rst_search_frames)));
+    CHECK_MEM_ERROR(cm, cpi->rst_search_tmpbufs,
+                    aom_calloc(num, sizeof(*cpi->rst_search_tmpbufs)));
+    cpi->num_rst_search_bufs = num;
+    for (i = 0; i < num; ++i) {
+      CHECK_MEM_ERROR(cm, cpi->rst_search_tmpbufs[i],
+                      (int32_t *)aom_memalign(16, RESTORATION_TMPBUF_SIZE));
+    }
+  }
+  for (i = 0; i < num; ++i) {
+    if (aom_realloc_frame_buffer(&cpi->rst_search_frames[i], cm->width,
+                                 cm->height, cm->subsampling_x,
+                                 cm->subsampling_y,
+#if CONFIG_AOM_HIGHBITDEPTH
+                                 cm->use_highbitdepth,
+#endif
+                                 AOM_BORDER_IN_PIXELS, cm->byte_alignment,
+                                 NULL, NULL, NULL))
+      aom_internal_error(&cm->error, AOM_CODEC_MEM_ERROR,
+                         "Failed to allocate restoration search buffer");
+  }
+}
+
+void av1_free_rst_search_bufs(AV1_COMP *cpi) {
+  int i;
+  for (i = 0; i < cpi->num_rst_search_bufs; ++i) {
+    aom_free_frame_buffer(&cpi->rst_search_frames[i]);
+    aom_free(cpi->rst_search_tmpbufs[i]);
+  }
+  aom_free(cpi->rst_search_frames);
+  aom_free(cpi->rst_search_tmpbufs);
+  cpi->rst_search_frames = NULL;
+  cpi->rst_search_tmpbufs = NULL;
+  cpi->num_rst_search_bufs = 0;
+}
+
+// Searches the tiles of the planes, sharing them between the workers. The main
+// thread tries the tiles in dst_frame.
+static void search_tiles(AV1_COMP *cpi, search_tile_func search_tile,
+                         const RstSearchPlane *planes, int num_planes,
+                         YV12_BUFFER_CONFIG *dst_frame) {
+  AV1_COMMON *const cm = &cpi->common;
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+  RstSearchJob *jobs;
+  int total_tiles = 0;
+  int num_jobs, i;
+
+  for (i = 0; i < num_planes; ++i) total_tiles += planes[i].ntiles;
+  // The whole frame is filtered for every tile when only a part of it is
+  // searched, which cannot be done concurrently.
+  num_jobs = planes[0].partial_frame
+                 ? 1
+                 : AOMMIN(cpi->num_filter_workers, total_tiles);
+  num_jobs = AOMMAX(num_jobs, 1);
+  if (num_jobs > 1) alloc_rst_search_bufs(cpi, num_jobs - 1);
+
+  CHECK_MEM_ERROR(cm, jobs, aom_malloc(num_jobs * sizeof(*jobs)));
+  for (i = 0; i < num_jobs; ++i) {
+    RstSearchJob *const job = &jobs[i];
+    job->search_tile = search_tile;
+    job->planes = planes;
+    job->num_planes = num_planes;
+    job->jobs = &cpi->job_queue;
+    job->worker = i;
+    if (i == num_jobs - 1) {
+      job->bufs.dst = dst_frame;
+      job->bufs.tmpbuf = cm->rst_internal.tmpbuf;
+    } else {
+      job->bufs.dst = &cpi->rst_search_frames[i];
+      job->bufs.tmpbuf = cpi->rst_search_tmpbufs[i];
+    }
+  }
+
+  if (num_jobs == 1) {
+    for (i = 0; i < total_tiles; ++i) search_tile_n(&jobs[0], i);
+  } else {
+    aom_job_queue_reset(&cpi->job_queue, total_tiles, num_jobs);
+    for (i = 0; i < num_jobs; ++i) {
+      AVxWorker *const worker = &cpi->workers[i];
+      worker->hook = (AVxWorkerHook)rst_search_worker_hook;
+      worker->data1 = &jobs[i];
+      worker->data2 = NULL;
+      if (i == num_jobs - 1)
+        winterface->execute(worker);
+      else
+        winterface->launch(worker);
+    }
+    for (i = 0; i < num_jobs; ++i) winterface->sync(&cpi->workers[i]);
+  }
+
+  aom_free(jobs);
+}
+
 static int64_t get_pixel_proj_error(uint8_t *src8, int width, int height,
                                     int src_stride, uint8_t *dat8,
                                     int dat_stride, int bit_depth,
@@ -343,73 +507,95 @@ static void search_selfguided_restoration(uint8_t *dat8, int width, int height,
   xqd[1] = bestxqd[1];
 }
 
+static void search_sgrproj_tile(const RstSearchPlane *sp, int tile_idx,
+                                const RstSearchBufs *bufs) {
+  const YV12_BUFFER_CONFIG *src = sp->src;
+  AV1_COMP *const cpi = sp->cpi;
+  SgrprojInfo *sgrproj_info = sp->info->sgrproj_info;
+  double err, cost_norestore, cost_sgrproj;
+  int bits;
+  MACROBLOCK *x = &cpi->td.mb;
+  AV1_COMMON *const cm = &cpi->common;
+  const YV12_BUFFER_CONFIG *dgd = cm->frame_to_show;
+  RestorationInfo *rsi = &cpi->rst_search[0];
+  int h_start, h_end, v_start, v_end;
+
+  av1_get_rest_tile_limits(tile_idx, 0, 0, sp->nhtiles, sp->nvtiles,
+                           sp->tile_width, sp->tile_height, cm->width,
+                           cm->height, 0, 0, &h_start, &h_end, &v_start,
+                           &v_end);
+  err = sse_restoration_tile(src, cm->frame_to_show, cm, h_start,
+                             h_end - h_start, v_start, v_end - v_start, 1);
+  // #bits when a tile is not restored
+  bits = av1_cost_bit(RESTORE_NONE_SGRPROJ_PROB, 0);
+  cost_norestore = RDCOST_DBL(x->rdmult, x->rddiv, (bits >> 4), err);
+  sp->best_tile_cost[tile_idx] = DBL_MAX;
+  search_selfguided_restoration(
+      dgd->y_buffer + v_start * dgd->y_stride + h_start, h_end - h_start,
+      v_end - v_start, dgd->y_stride,
+      src->y_buffer + v_start * src->y_stride + h_start, src->y_stride,
+#if CONFIG_AOM_HIGHBITDEPTH
+      cm->bit_depth,
+#else
+      8,
+#endif  // CONFIG_AOM_HIGHBITDEPTH
+      &rsi->sgrproj_info[tile_idx].ep, rsi->sgrproj_info[tile_idx].xqd,
+      bufs->tmpbuf);
+  rsi->restoration_type[tile_idx] = RESTORE_SGRPROJ;
+  err = try_restoration_tile(src, cpi, rsi, 1, sp->partial_frame, tile_idx, 0,
+                             0, bufs);
+  bits = SGRPROJ_BITS << AV1_PROB_COST_SHIFT;
+  bits += av1_cost_bit(RESTORE_NONE_SGRPROJ_PROB, 1);
+  cost_sgrproj = RDCOST_DBL(x->rdmult, x->rddiv, (bits >> 4), err);
+  if (cost_sgrproj >= cost_norestore) {
+    sp->type[tile_idx] = RESTORE_NONE;
+  } else {
+    sp->type[tile_idx] = RESTORE_SGRPROJ;
+    memcpy(&sgrproj_info[tile_idx], &rsi->sgrproj_info[tile_idx],
+           sizeof(sgrproj_info[tile_idx]));
+    bits = SGRPROJ_BITS << AV1_PROB_COST_SHIFT;
+    sp->best_tile_cost[tile_idx] = RDCOST_DBL(
+        x->rdmult, x->rddiv,
+        (bits + cpi->switchable_restore_cost[RESTORE_SGRPROJ]) >> 4, err);
+  }
+  rsi->restoration_type[tile_idx] = RESTORE_NONE;
+}
+
 static double search_sgrproj(const YV12_BUFFER_CONFIG *src, AV1_COMP *cpi,
                              int partial_frame, RestorationInfo *info,
                              RestorationType *type, double *best_tile_cost,
                              YV12_BUFFER_CONFIG *dst_frame) {
   SgrprojInfo *sgrproj_info = info->sgrproj_info;
-  double err, cost_norestore, cost_sgrproj;
+  double err, cost_sgrproj;
   int bits;
   MACROBLOCK *x = &cpi->td.mb;
   AV1_COMMON *const cm = &cpi->common;
-  const YV12_BUFFER_CONFIG *dgd = cm->frame_to_show;
   RestorationInfo *rsi = &cpi->rst_search[0];
-  int tile_idx, tile_width, tile_height, nhtiles, nvtiles;
-  int h_start, h_end, v_start, v_end;
+  RstSearchPlane sp;
+  int tile_idx;
+
+  sp.src = src;
+  sp.cpi = cpi;
+  sp.partial_frame = partial_frame;
+  sp.plane = AOM_PLANE_Y;
+  sp.info = info;
+  sp.type = type;
+  sp.best_tile_cost = best_tile_cost;
   // Allocate for the src buffer at high precision
-  const int ntiles = av1_get_rest_ntiles(
-      cm->width, cm->height, cm->rst_info[0].restoration_tilesize, &tile_width,
-      &tile_height, &nhtiles, &nvtiles);
+  sp.ntiles = av1_get_rest_ntiles(
+      cm->width, cm->height, cm->rst_info[0].restoration_tilesize,
+      &sp.tile_width, &sp.tile_height, &sp.nhtiles, &sp.nvtiles);
   rsi->frame_restoration_type = RESTORE_SGRPROJ;
 
-  for (tile_idx = 0; tile_idx < ntiles; ++tile_idx) {
+  for (tile_idx = 0; tile_idx < sp.ntiles; ++tile_idx) {
     rsi->restoration_type[tile_idx] = RESTORE_NONE;
   }
   // Compute best Sgrproj filters for each tile
-  for (tile_idx = 0; tile_idx < ntiles; ++tile_idx) {
-    av1_get_rest_tile_limits(tile_idx, 0, 0, nhtiles, nvtiles, tile_width,
-                             tile_height, cm->width, cm->height, 0, 0, &h_start,
-                             &h_end, &v_start, &v_end);
-    err = sse_restoration_tile(src, cm->frame_to_show, cm, h_start,
-                               h_end - h_start, v_start, v_end - v_start, 1);
-    // #bits when a tile is not restored
-    bits = av1_cost_bit(RESTORE_NONE_SGRPROJ_PROB, 0);
-    cost_norestore = RDCOST_DBL(x->rdmult, x->rddiv, (bits >> 4), err);
-    best_tile_cost[tile_idx] = DBL_MAX;
-    search_selfguided_restoration(
-        dgd->y_buffer + v_start * dgd->y_stride + h_start, h_end - h_start,
-        v_end - v_start, dgd->y_stride,
-        src->y_buffer + v_start * src->y_stride + h_start, src->y_stride,
-#if CONFIG_AOM_HIGHBITDEPTH
-        cm->bit_depth,
-#else
-        8,
-#endif  // CONFIG_AOM_HIGHBITDEPTH
-        &rsi->sgrproj_info[tile_idx].ep, rsi->sgrproj_info[tile_idx].xqd,
-        cm->rst_internal.tmpbuf);
-    rsi->restoration_type[tile_idx] = RESTORE_SGRPROJ;
-    err = try_restoration_tile(src, cpi, rsi, 1, partial_frame, tile_idx, 0, 0,
-                               dst_frame);
-    bits = SGRPROJ_BITS << AV1_PROB_COST_SHIFT;
-    bits += av1_cost_bit(RESTORE_NONE_SGRPROJ_PROB, 1);
-    cost_sgrproj = RDCOST_DBL(x->rdmult, x->rddiv, (bits >> 4), err);
-    if (cost_sgrproj >= cost_norestore) {
-      type[tile_idx] = RESTORE_NONE;
-    } else {
-      type[tile_idx] = RESTORE_SGRPROJ;
-      memcpy(&sgrproj_info[tile_idx], &rsi->sgrproj_info[tile_idx],
-             sizeof(sgrproj_info[tile_idx]));
-      bits = SGRPROJ_BITS << AV1_PROB_COST_SHIFT;
-      best_tile_cost[tile_idx] = RDCOST_DBL(
-          x->rdmult, x->rddiv,
-          (bits + cpi->switchable_restore_cost[RESTORE_SGRPROJ]) >> 4, err);
-    }
-    rsi->restoration_type[tile_idx] = RESTORE_NONE;
-  }
+  search_tiles(cpi, search_sgrproj_tile, &sp, 1, dst_frame);
   // Cost for Sgrproj filtering
   bits = frame_level_restore_bits[rsi->frame_restoration_type]
          << AV1_PROB_COST_SHIFT;
-  for (tile_idx = 0; tile_idx < ntiles; ++tile_idx) {
+  for (tile_idx = 0; tile_idx < sp.ntiles; ++tile_idx) {
     bits +=
         av1_cost_bit(RESTORE_NONE_SGRPROJ_PROB, type[tile_idx] != RESTORE_NONE);
     memcpy(&rsi->sgrproj_info[tile_idx], &sgrproj_info[tile_idx],
@@ -738,16 +924,18 @@ static void quantize_sym_filter(double *f, InterpKernel fi) {
   fi[3] = -2 * (fi[0] + fi[1] + fi[2]);
 }
 
-static double search_wiener_uv(const YV12_BUFFER_CONFIG *src, AV1_COMP *cpi,
-                               int partial_frame, int plane,
-                               RestorationInfo *info, RestorationType *type,
-                               YV12_BUFFER_CONFIG *dst_frame) {
-  WienerInfo *wiener_info = info->wiener_info;
+static void search_wiener_uv_tile(const RstSearchPlane *sp, int tile_idx,
+                                  const RstSearchBufs *bufs) {
+  const YV12_BUFFER_CONFIG *src = sp->src;
+  AV1_COMP *const cpi = sp->cpi;
+  const int plane = sp->plane;
+  WienerInfo *wiener_info = sp->info->wiener_info;
+  RestorationType *type = sp->type;
   AV1_COMMON *const cm = &cpi->common;
   RestorationInfo *rsi = cpi->rst_search;
   int64_t err;
   int bits;
-  double cost_wiener, cost_norestore, cost_wiener_frame, cost_norestore_frame;
+  double cost_wiener, cost_norestore;
   MACROBLOCK *x = &cpi->td.mb;
   double M[WIENER_WIN2];
   double H[WIENER_WIN2 * WIENER_WIN2];
@@ -758,122 +946,255 @@ static double search_wiener_uv(const YV12_BUFFER_CONFIG *src, AV1_COMP *cpi,
   const int src_stride = src->uv_stride;
   const int dgd_stride = dgd->uv_stride;
   double score;
-  int tile_idx, tile_width, tile_height, nhtiles, nvtiles;
   int h_start, h_end, v_start, v_end;
-  const int ntiles =
-      av1_get_rest_ntiles(width, height, cm->rst_info[1].restoration_tilesize,
-                          &tile_width, &tile_height, &nhtiles, &nvtiles);
-  assert(width == dgd->uv_crop_width);
-  assert(height == dgd->uv_crop_height);
 
-  rsi[plane].frame_restoration_type = RESTORE_NONE;
-  err = sse_restoration_frame(cm, src, cm->frame_to_show, (1 << plane));
-  bits = 0;
-  cost_norestore_frame = RDCOST_DBL(x->rdmult, x->rddiv, (bits >> 4), err);
+  av1_get_rest_tile_limits(tile_idx, 0, 0, sp->nhtiles, sp->nvtiles,
+                           sp->tile_width, sp->tile_height, width, height, 0, 0,
+                           &h_start, &h_end, &v_start, &v_end);
+  err = sse_restoration_tile(src, cm->frame_to_show, cm, h_start,
+                             h_end - h_start, v_start, v_end - v_start,
+                             1 << plane);
+  // #bits when a tile is not restored
+  bits = av1_cost_bit(RESTORE_NONE_WIENER_PROB, 0);
+  cost_norestore = RDCOST_DBL(x->rdmult, x->rddiv, (bits >> 4), err);
+  // best_tile_cost[tile_idx] = DBL_MAX;
+
+  av1_get_rest_tile_limits(tile_idx, 0, 0, sp->nhtiles, sp->nvtiles,
+                           sp->tile_width, sp->tile_height, width, height,
+                           WIENER_HALFWIN, WIENER_HALFWIN, &h_start, &h_end,
+                           &v_start, &v_end);
+  if (plane == AOM_PLANE_U) {
+#if CONFIG_AOM_HIGHBITDEPTH
+    if (cm->use_highbitdepth)
+      compute_stats_highbd(dgd->u_buffer, src->u_buffer, h_start, h_end,
+                           v_start, v_end, dgd_stride, src_stride, M, H);
+    else
+#endif  // CONFIG_AOM_HIGHBITDEPTH
+      compute_stats(dgd->u_buffer, src->u_buffer, h_start, h_end, v_start,
+                    v_end, dgd_stride, src_stride, M, H);
+  } else if (plane == AOM_PLANE_V) {
+#if CONFIG_AOM_HIGHBITDEPTH
+    if (cm->use_highbitdepth)
+      compute_stats_highbd(dgd->v_buffer, src->v_buffer, h_start, h_end,
+                           v_start, v_end, dgd_stride, src_stride, M, H);
+    else
+#endif  // CONFIG_AOM_HIGHBITDEPTH
+      compute_stats(dgd->v_buffer, src->v_buffer, h_start, h_end, v_start,
+                    v_end, dgd_stride, src_stride, M, H);
+  } else {
+    assert(0);
+  }
 
-  rsi[plane].frame_restoration_type = RESTORE_WIENER;
+  type[tile_idx] = RESTORE_WIENER;
 
-  for (tile_idx = 0; tile_idx < ntiles; ++tile_idx) {
-    rsi[plane].restoration_type[tile_idx] = RESTORE_NONE;
+  if (!wiener_decompose_sep_sym(M, H, vfilterd, hfilterd)) {
+    type[tile_idx] = RESTORE_NONE;
+    return;
+  }
+  quantize_sym_filter(vfilterd, rsi[plane].wiener_info[tile_idx].vfilter);
+  quantize_sym_filter(hfilterd, rsi[plane].wiener_info[tile_idx].hfilter);
+
+  // Filter score computes the value of the function x'*A*x - x'*b for the
+  // learned filter and compares it against identity filer. If there is no
+  // reduction in the function, the filter is reverted back to identity
+  score = compute_score(M, H, rsi[plane].wiener_info[tile_idx].vfilter,
+                        rsi[plane].wiener_info[tile_idx].hfilter);
+  if (score > 0.0) {
+    type[tile_idx] = RESTORE_NONE;
+    return;
   }
 
-  // Compute best Wiener filters for each tile
-  for (tile_idx = 0; tile_idx < ntiles; ++tile_idx) {
-    av1_get_rest_tile_limits(tile_idx, 0, 0, nhtiles, nvtiles, tile_width,
-                             tile_height, width, height, 0, 0, &h_start, &h_end,
-                             &v_start, &v_end);
-    err = sse_restoration_tile(src, cm->frame_to_show, cm, h_start,
-                               h_end - h_start, v_start, v_end - v_start,
-                               1 << plane);
-    // #bits when a tile is not restored
-    bits = av1_cost_bit(RESTORE_NONE_WIENER_PROB, 0);
-    cost_norestore = RDCOST_DBL(x->rdmult, x->rddiv, (bits >> 4), err);
-    // best_tile_cost[tile_idx] = DBL_MAX;
+  rsi[plane].restoration_type[tile_idx] = RESTORE_WIENER;
+  err = try_restoration_tile(src, cpi, rsi, 1 << plane, sp->partial_frame,
+                             tile_idx, 0, 0, bufs);
+  bits = WIENER_FILT_BITS << AV1_PROB_COST_SHIFT;
+  bits += av1_cost_bit(RESTORE_NONE_WIENER_PROB, 1);
+  cost_wiener = RDCOST_DBL(x->rdmult, x->rddiv, (bits >> 4), err);
+  if (cost_wiener >= cost_norestore) {
+    type[tile_idx] = RESTORE_NONE;
+  } else {
+    type[tile_idx] = RESTORE_WIENER;
+    memcpy(&wiener_info[tile_idx], &rsi[plane].wiener_info[tile_idx],
+           sizeof(wiener_info[tile_idx]));
+  }
+  rsi[plane].restoration_type[tile_idx] = RESTORE_NONE;
+}
 
-    av1_get_rest_tile_limits(tile_idx, 0, 0, nhtiles, nvtiles, tile_width,
-                             tile_height, width, height, WIENER_HALFWIN,
-                             WIENER_HALFWIN, &h_start, &h_end, &v_start,
-                             &v_end);
-    if (plane == AOM_PLANE_U) {
-#if CONFIG_AOM_HIGHBITDEPTH
-      if (cm->use_highbitdepth)
-        compute_stats_highbd(dgd->u_buffer, src->u_buffer, h_start, h_end,
-                             v_start, v_end, dgd_stride, src_stride, M, H);
-      else
-#endif  // CONFIG_AOM_HIGHBITDEPTH
-        compute_stats(dgd->u_buffer, src->u_buffer, h_start, h_end, v_start,
-                      v_end, dgd_stride, src_stride, M, H);
-    } else if (plane == AOM_PLANE_V) {
+// Searches the Wiener filters of both color components, whose tiles are
+// searched together.
+static void search_wiener_uv(const YV12_BUFFER_CONFIG *src, AV1_COMP *cpi,
+                             int partial_frame,
+                             YV12_BUFFER_CONFIG *dst_frame) {
+  AV1_COMMON *const cm = &cpi->common;
+  RestorationInfo *rsi = cpi->rst_search;
+  int64_t err;
+  int bits;
+  double cost_wiener_frame, cost_norestore_frame[MAX_MB_PLANE];
+  MACROBLOCK *x = &cpi->td.mb;
+  const YV12_BUFFER_CONFIG *dgd = cm->frame_to_show;
+  const int width = src->uv_crop_width;
+  const int height = src->uv_crop_height;
+  RstSearchPlane sp[2];
+  int plane, tile_idx;
+  assert(width == dgd->uv_crop_width);
+  assert(height == dgd->uv_crop_height);
+
+  for (plane = AOM_PLANE_U; plane <= AOM_PLANE_V; ++plane) {
+    RstSearchPlane *const p = &sp[plane - AOM_PLANE_U];
+    RestorationInfo *const info = &cm->rst_info[plane];
+    p->src = src;
+    p->cpi = cpi;
+    p->partial_frame = partial_frame;
+    p->plane = plane;
+    p->info = info;
+    p->type = info->restoration_type;
+    p->best_tile_cost = NULL;
+    p->ntiles = av1_get_rest_ntiles(
+        width, height, cm->rst_info[1].restoration_tilesize, &p->tile_width,
+        &p->tile_height, &p->nhtiles, &p->nvtiles);
+
+    rsi[plane].frame_restoration_type = RESTORE_NONE;
+    err = sse_restoration_frame(cm, src, cm->frame_to_show, (1 << plane));
+    bits = 0;
+    cost_norestore_frame[plane] =
+        RDCOST_DBL(x->rdmult, x->rddiv, (bits >> 4), err);
+
+    rsi[plane].frame_restoration_type = RESTORE_WIENER;
+
+    for (tile_idx = 0; tile_idx < p->ntiles; ++tile_idx) {
+      rsi[plane].restoration_type[tile_idx] = RESTORE_NONE;
+    }
+
+    // Construct a (WIENER_HALFWIN)-pixel border around the plane for the
+    // filter tried on each tile
+    if (!partial_frame) {
+      uint8_t *const data =
+          plane == AOM_PLANE_U ? dgd->u_buffer : dgd->v_buffer;
 #if CONFIG_AOM_HIGHBITDEPTH
       if (cm->use_highbitdepth)
-        compute_stats_highbd(dgd->v_buffer, src->v_buffer, h_start, h_end,
-                             v_start, v_end, dgd_stride, src_stride, M, H);
+        extend_frame_highbd(CONVERT_TO_SHORTPTR(data), width, height,
+                            dgd->uv_stride);
       else
 #endif  // CONFIG_AOM_HIGHBITDEPTH
-        compute_stats(dgd->v_buffer, src->v_buffer, h_start, h_end, v_start,
-                      v_end, dgd_stride, src_stride, M, H);
-    } else {
-      assert(0);
+        extend_frame(data, width, height, dgd->uv_stride);
     }
+  }
 
-    type[tile_idx] = RESTORE_WIENER;
-
-    if (!wiener_decompose_sep_sym(M, H, vfilterd, hfilterd)) {
-      type[tile_idx] = RESTORE_NONE;
-      continue;
-    }
-    quantize_sym_filter(vfilterd, rsi[plane].wiener_info[tile_idx].vfilter);
-    quantize_sym_filter(hfilterd, rsi[plane].wiener_info[tile_idx].hfilter);
-
-    // Filter score computes the value of the function x'*A*x - x'*b for the
-    // learned filter and compares it against identity filer. If there is no
-    // reduction in the function, the filter is reverted back to identity
-    score = compute_score(M, H, rsi[plane].wiener_info[tile_idx].vfilter,
-                          rsi[plane].wiener_info[tile_idx].hfilter);
-    if (score > 0.0) {
-      type[tile_idx] = RESTORE_NONE;
-      continue;
+  // Compute best Wiener filters for each tile
+  search_tiles(cpi, search_wiener_uv_tile, sp, 2, dst_frame);
+
+  for (plane = AOM_PLANE_U; plane <= AOM_PLANE_V; ++plane) {
+    const RstSearchPlane *const p = &sp[plane - AOM_PLANE_U];
+    RestorationInfo *const info = p->info;
+    RestorationType *const type = p->type;
+    WienerInfo *wiener_info = info->wiener_info;
+    // Cost for Wiener filtering
+    bits = 0;
+    for (tile_idx = 0; tile_idx < p->ntiles; ++tile_idx) {
+      bits += av1_cost_bit(RESTORE_NONE_WIENER_PROB,
+                           type[tile_idx] != RESTORE_NONE);
+      memcpy(&rsi[plane].wiener_info[tile_idx], &wiener_info[tile_idx],
+             sizeof(wiener_info[tile_idx]));
+      if (type[tile_idx] == RESTORE_WIENER) {
+        bits += (WIENER_FILT_BITS << AV1_PROB_COST_SHIFT);
+      }
+      rsi[plane].restoration_type[tile_idx] = type[tile_idx];
     }
+    err = try_restoration_frame(src, cpi, rsi, 1 << plane, partial_frame,
+                                dst_frame);
+    cost_wiener_frame = RDCOST_DBL(x->rdmult, x->rddiv, (bits >> 4), err);
 
-    rsi[plane].restoration_type[tile_idx] = RESTORE_WIENER;
-    err = try_restoration_tile(src, cpi, rsi, 1 << plane, partial_frame,
-                               tile_idx, 0, 0, dst_frame);
-    bits = WIENER_FILT_BITS << AV1_PROB_COST_SHIFT;
-    bits += av1_cost_bit(RESTORE_NONE_WIENER_PROB, 1);
-    cost_wiener = RDCOST_DBL(x->rdmult, x->rddiv, (bits >> 4), err);
-    if (cost_wiener >= cost_norestore) {
-      type[tile_idx] = RESTORE_NONE;
+    if (cost_wiener_frame < cost_norestore_frame[plane]) {
+      info->frame_restoration_type = RESTORE_WIENER;
     } else {
-      type[tile_idx] = RESTORE_WIENER;
-      memcpy(&wiener_info[tile_idx], &rsi[plane].wiener_info[tile_idx],
-             sizeof(wiener_info[tile_idx]));
+      info->frame_restoration_type = RESTORE_NONE;
     }
-    rsi[plane].restoration_type[tile_idx] = RESTORE_NONE;
   }
-  // Cost for Wiener filtering
-  bits = 0;
-  for (tile_idx = 0; tile_idx < ntiles; ++tile_idx) {
-    bits +=
-        av1_cost_bit(RESTORE_NONE_WIENER_PROB, type[tile_idx] != RESTORE_NONE);
-    memcpy(&rsi[plane].wiener_info[tile_idx], &wiener_info[tile_idx],
-           sizeof(wiener_info[tile_idx]));
-    if (type[tile_idx] == RESTORE_WIENER) {
-      bits += (WIENER_FILT_BITS << AV1_PROB_COST_SHIFT);
-    }
-    rsi[plane].restoration_type[tile_idx] = type[tile_idx];
+}
+
+static void search_wiener_tile(const RstSearchPlane *sp, int tile_idx,
+                               const RstSearchBufs *bufs) {
+  const YV12_BUFFER_CONFIG *src = sp->src;
+  AV1_COMP *const cpi = sp->cpi;
+  WienerInfo *wiener_info = sp->info->wiener_info;
+  RestorationType *type = sp->type;
+  double *best_tile_cost = sp->best_tile_cost;
+  AV1_COMMON *const cm = &cpi->common;
+  RestorationInfo *rsi = cpi->rst_search;
+  int64_t err;
+  int bits;
+  double cost_wiener, cost_norestore;
+  MACROBLOCK *x = &cpi->td.mb;
+  double M[WIENER_WIN2];
+  double H[WIENER_WIN2 * WIENER_WIN2];
+  double vfilterd[WIENER_WIN], hfilterd[WIENER_WIN];
+  const YV12_BUFFER_CONFIG *dgd = cm->frame_to_show;
+  const int width = cm->width;
+  const int height = cm->height;
+  const int src_stride = src->y_stride;
+  const int dgd_stride = dgd->y_stride;
+  double score;
+  int h_start, h_end, v_start, v_end;
+
+  av1_get_rest_tile_limits(tile_idx, 0, 0, sp->nhtiles, sp->nvtiles,
+                           sp->tile_width, sp->tile_height, width, height, 0, 0,
+                           &h_start, &h_end, &v_start, &v_end);
+  err = sse_restoration_tile(src, cm->frame_to_show, cm, h_start,
+                             h_end - h_start, v_start, v_end - v_start, 1);
+  // #bits when a tile is not restored
+  bits = av1_cost_bit(RESTORE_NONE_WIENER_PROB, 0);
+  cost_norestore = RDCOST_DBL(x->rdmult, x->rddiv, (bits >> 4), err);
+  best_tile_cost[tile_idx] = DBL_MAX;
+
+  av1_get_rest_tile_limits(tile_idx, 0, 0, sp->nhtiles, sp->nvtiles,
+                           sp->tile_width, sp->tile_height, width, height, 0, 0,
+                           &h_start, &h_end, &v_start, &v_end);
+#if CONFIG_AOM_HIGHBITDEPTH
+  if (cm->use_highbitdepth)
+    compute_stats_highbd(dgd->y_buffer, src->y_buffer, h_start, h_end, v_start,
+                         v_end, dgd_stride, src_stride, M, H);
+  else
+#endif  // CONFIG_AOM_HIGHBITDEPTH
+    compute_stats(dgd->y_buffer, src->y_buffer, h_start, h_end, v_start, v_end,
+                  dgd_stride, src_stride, M, H);
+
+  type[tile_idx] = RESTORE_WIENER;
+
+  if (!wiener_decompose_sep_sym(M, H, vfilterd, hfilterd)) {
+    type[tile_idx] = RESTORE_NONE;
+    return;
+  }
+  quantize_sym_filter(vfilterd, rsi->wiener_info[tile_idx].vfilter);
+  quantize_sym_filter(hfilterd, rsi->wiener_info[tile_idx].hfilter);
+
+  // Filter score computes the value of the function x'*A*x - x'*b for the
+  // learned filter and compares it against identity filer. If there is no
+  // reduction in the function, the filter is reverted back to identity
+  score = compute_score(M, H, rsi->wiener_info[tile_idx].vfilter,
+                        rsi->wiener_info[tile_idx].hfilter);
+  if (score > 0.0) {
+    type[tile_idx] = RESTORE_NONE;
+    return;
   }
-  err = try_restoration_frame(src, cpi, rsi, 1 << plane, partial_frame,
-                              dst_frame);
-  cost_wiener_frame = RDCOST_DBL(x->rdmult, x->rddiv, (bits >> 4), err);
 
-  if (cost_wiener_frame < cost_norestore_frame) {
-    info->frame_restoration_type = RESTORE_WIENER;
+  rsi->restoration_type[tile_idx] = RESTORE_WIENER;
+  err = try_restoration_tile(src, cpi, rsi, 1, sp->partial_frame, tile_idx, 0,
+                             0, bufs);
+  bits = WIENER_FILT_BITS << AV1_PROB_COST_SHIFT;
+  bits += av1_cost_bit(RESTORE_NONE_WIENER_PROB, 1);
+  cost_wiener = RDCOST_DBL(x->rdmult, x->rddiv, (bits >> 4), err);
+  if (cost_wiener >= cost_norestore) {
+    type[tile_idx] = RESTORE_NONE;
   } else {
-    info->frame_restoration_type = RESTORE_NONE;
+    type[tile_idx] = RESTORE_WIENER;
+    memcpy(&wiener_info[tile_idx], &rsi->wiener_info[tile_idx],
+           sizeof(wiener_info[tile_idx]));
+    bits = WIENER_FILT_BITS << AV1_PROB_COST_SHIFT;
+    best_tile_cost[tile_idx] = RDCOST_DBL(
+        x->rdmult, x->rddiv,
+        (bits + cpi->switchable_restore_cost[RESTORE_WIENER]) >> 4, err);
   }
-
-  return info->frame_restoration_type == RESTORE_WIENER ? cost_wiener_frame
-                                                        : cost_norestore_frame;
+  rsi->restoration_type[tile_idx] = RESTORE_NONE;
 }
 
 static double search_wiener(const YV12_BUFFER_CONFIG *src, AV1_COMP *cpi,
@@ -885,30 +1206,34 @@ static double search_wiener(const YV12_BUFFER_CONFIG *src, AV1_COMP *cpi,
   RestorationInfo *rsi = cpi->rst_search;
   int64_t err;
   int bits;
-  double cost_wiener, cost_norestore;
+  double cost_wiener;
   MACROBLOCK *x = &cpi->td.mb;
-  double M[WIENER_WIN2];
-  double H[WIENER_WIN2 * WIENER_WIN2];
-  double vfilterd[WIENER_WIN], hfilterd[WIENER_WIN];
   const YV12_BUFFER_CONFIG *dgd = cm->frame_to_show;
   const int width = cm->width;
   const int height = cm->height;
-  const int src_stride = src->y_stride;
   const int dgd_stride = dgd->y_stride;
-  double score;
-  int tile_idx, tile_width, tile_height, nhtiles, nvtiles;
-  int h_start, h_end, v_start, v_end;
-  const int ntiles =
-      av1_get_rest_ntiles(width, height, cm->rst_info[0].restoration_tilesize,
-                          &tile_width, &tile_height, &nhtiles, &nvtiles);
+  RstSearchPlane sp;
+  int tile_idx;
   assert(width == dgd->y_crop_width);
   assert(height == dgd->y_crop_height);
   assert(width == src->y_crop_width);
   assert(height == src->y_crop_height);
 
+  sp.src = src;
+  sp.cpi = cpi;
+  sp.partial_frame = partial_frame;
+  sp.plane = AOM_PLANE_Y;
+  sp.info = info;
+  sp.type = type;
+  sp.best_tile_cost = best_tile_cost;
+  sp.ntiles =
+      av1_get_rest_ntiles(width, height, cm->rst_info[0].restoration_tilesize,
+                          &sp.tile_width, &sp.tile_height, &sp.nhtiles,
+                          &sp.nvtiles);
+
   rsi->frame_restoration_type = RESTORE_WIENER;
 
-  for (tile_idx = 0; tile_idx < ntiles; ++tile_idx) {
+  for (tile_idx = 0; tile_idx < sp.ntiles; ++tile_idx) {
     rsi->restoration_type[tile_idx] = RESTORE_NONE;
   }
 
@@ -922,71 +1247,11 @@ static double search_wiener(const YV12_BUFFER_CONFIG *src, AV1_COMP *cpi,
     extend_frame(dgd->y_buffer, width, height, dgd_stride);
 
   // Compute best Wiener filters for each tile
-  for (tile_idx = 0; tile_idx < ntiles; ++tile_idx) {
-    av1_get_rest_tile_limits(tile_idx, 0, 0, nhtiles, nvtiles, tile_width,
-                             tile_height, width, height, 0, 0, &h_start, &h_end,
-                             &v_start, &v_end);
-    err = sse_restoration_tile(src, cm->frame_to_show, cm, h_start,
-                               h_end - h_start, v_start, v_end - v_start, 1);
-    // #bits when a tile is not restored
-    bits = av1_cost_bit(RESTORE_NONE_WIENER_PROB, 0);
-    cost_norestore = RDCOST_DBL(x->rdmult, x->rddiv, (bits >> 4), err);
-    best_tile_cost[tile_idx] = DBL_MAX;
-
-    av1_get_rest_tile_limits(tile_idx, 0, 0, nhtiles, nvtiles, tile_width,
-                             tile_height, width, height, 0, 0, &h_start, &h_end,
-                             &v_start, &v_end);
-#if CONFIG_AOM_HIGHBITDEPTH
-    if (cm->use_highbitdepth)
-      compute_stats_highbd(dgd->y_buffer, src->y_buffer, h_start, h_end,
-                           v_start, v_end, dgd_stride, src_stride, M, H);
-    else
-#endif  // CONFIG_AOM_HIGHBITDEPTH
-      compute_stats(dgd->y_buffer, src->y_buffer, h_start, h_end, v_start,
-                    v_end, dgd_stride, src_stride, M, H);
-
-    type[tile_idx] = RESTORE_WIENER;
-
-    if (!wiener_decompose_sep_sym(M, H, vfilterd, hfilterd)) {
-      type[tile_idx] = RESTORE_NONE;
-      continue;
-    }
-    quantize_sym_filter(vfilterd, rsi->wiener_info[tile_idx].vfilter);
-    quantize_sym_filter(hfilterd, rsi->wiener_info[tile_idx].hfilter);
-
-    // Filter score computes the value of the function x'*A*x - x'*b for the
-    // learned filter and compares it against identity filer. If there is no
-    // reduction in the function, the filter is reverted back to identity
-    score = compute_score(M, H, rsi->wiener_info[tile_idx].vfilter,
-                          rsi->wiener_info[tile_idx].hfilter);
-    if (score > 0.0) {
-      type[tile_idx] = RESTORE_NONE;
-      continue;
-    }
-
-    rsi->restoration_type[tile_idx] = RESTORE_WIENER;
-    err = try_restoration_tile(src, cpi, rsi, 1, partial_frame, tile_idx, 0, 0,
-                               dst_frame);
-    bits = WIENER_FILT_BITS << AV1_PROB_COST_SHIFT;
-    bits += av1_cost_bit(RESTORE_NONE_WIENER_PROB, 1);
-    cost_wiener = RDCOST_DBL(x->rdmult, x->rddiv, (bits >> 4), err);
-    if (cost_wiener >= cost_norestore) {
-      type[tile_idx] = RESTORE_NONE;
-    } else {
-      type[tile_idx] = RESTORE_WIENER;
-      memcpy(&wiener_info[tile_idx], &rsi->wiener_info[tile_idx],
-             sizeof(wiener_info[tile_idx]));
-      bits = WIENER_FILT_BITS << AV1_PROB_COST_SHIFT;
-      best_tile_cost[tile_idx] = RDCOST_DBL(
-          x->rdmult, x->rddiv,
-          (bits + cpi->switchable_restore_cost[RESTORE_WIENER]) >> 4, err);
-    }
-    rsi->restoration_type[tile_idx] = RESTORE_NONE;
-  }
+  search_tiles(cpi, search_wiener_tile, &sp, 1, dst_frame);
   // Cost for Wiener filtering
   bits = frame_level_restore_bits[rsi->frame_restoration_type]
          << AV1_PROB_COST_SHIFT;
-  for (tile_idx = 0; tile_idx < ntiles; ++tile_idx) {
+  for (tile_idx = 0; tile_idx < sp.ntiles; ++tile_idx) {
     bits +=
         av1_cost_bit(RESTORE_NONE_WIENER_PROB, type[tile_idx] != RESTORE_NONE);
     memcpy(&rsi->wiener_info[tile_idx], &wiener_info[tile_idx],
@@ -1124,13 +1389,7 @@ void av1_pick_filter_restoration(const YV12_BUFFER_CONFIG *src, AV1_COMP *cpi,
   }
 
   // Color components
-  search_wiener_uv(src, cpi, method == LPF_PICK_FROM_SUBIMAGE, AOM_PLANE_U,
-                   &cm->rst_info[AOM_PLANE_U],
-                   cm->rst_info[AOM_PLANE_U].restoration_type,
-                   &cpi->trial_frame_rst);
-  search_wiener_uv(src, cpi, method == LPF_PICK_FROM_SUBIMAGE, AOM_PLANE_V,
-                   &cm->rst_info[AOM_PLANE_V],
-                   cm->rst_info[AOM_PLANE_V].restoration_type,
+  search_wiener_uv(src, cpi, method == LPF_PICK_FROM_SUBIMAGE,
                    &cpi->trial_frame_rst);
   /*
   printf("Frame %d/%d restore types: %d %d %d\n",
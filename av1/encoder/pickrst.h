@@ -23,6 +23,9 @@ struct AV1_COMP;
 void av1_pick_filter_restoration(const YV12_BUFFER_CONFIG *sd, AV1_COMP *cpi,
                                  LPF_PICK_METHOD method);
 
+// Releases the buffers of the workers searching the restoration tiles.
+void av1_free_rst_search_bufs(AV1_COMP *cpi);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
@@ -226,6 +226,7 @@ static void set_good_speed_feature(AV1_COMP *cpi, AV1_COMMON *cm,
     sf->use_fast_coef_updates = ONE_LOOP_REDUCED;
     sf->use_fast_coef_costing = 1;
     sf->partition_search_breakout_rate_thr = 300;
+    sf->cdef_pick_method = CDEF_FAST_SEARCH;
   }
 
   if (speed >= 6) {
@@ -390,6 +391,7 @@ static void set_rt_speed_feature(AV1_COMP *cpi, SPEED_FEATURES *sf, int speed,
     sf->inter_mode_mask[BLOCK_32X64] = INTER_NEAREST_NEW_ZERO;
     sf->inter_mode_mask[BLOCK_64X32] = INTER_NEAREST_NEW_ZERO;
     sf->inter_mode_mask[BLOCK_64X64] = INTER_NEAREST_NEW_ZERO;
+    sf->cdef_pick_method = CDEF_FAST_SEARCH;
 #if CONFIG_EXT_PARTITION
     sf->inter_mode_mask[BLOCK_64X128] = INTER_NEAREST_NEW_ZERO;
     sf->inter_mode_mask[BLOCK_128X64] = INTER_NEAREST_NEW_ZERO;
@@ -537,6 +539,7 @@ void av1_set_speed_features_framesize_independent(AV1_COMP *cpi) {
   }
   sf->use_rd_breakout = 0;
   sf->lpf_pick = LPF_PICK_FROM_FULL_IMAGE;
+  sf->cdef_pick_method = CDEF_FULL_SEARCH;
   sf->use_fast_coef_updates = TWO_LOOP;
   sf->use_fast_coef_costing = 0;
   sf->mode_skip_start = MAX_MODES;  // Mode index at which mode skip mask set
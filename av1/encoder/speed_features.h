@@ -150,6 +150,13 @@ typedef enum {
   LPF_PICK_MINIMAL_LPF
 } LPF_PICK_METHOD;
 
+typedef enum {
+  // Try all the CDEF strengths
+  CDEF_FULL_SEARCH,
+  // Only try every other deringing strength
+  CDEF_FAST_SEARCH
+} CDEF_PICK_METHOD;
+
 typedef enum {
   // Terminate search early based on distortion so far compared to
   // qp step, distortion in the neighborhood of the frame, etc.
@@ -413,6 +420,9 @@ typedef struct SPEED_FEATURES {
   // This feature controls how the loop filter level is determined.
   LPF_PICK_METHOD lpf_pick;
 
+  // This feature controls how many CDEF strengths are searched.
+  CDEF_PICK_METHOD cdef_pick_method;
+
   // This feature limits the number of coefficients updates we actually do
   // by only looking at counts from 1/2 the bands.
   FAST_COEFF_UPDATE use_fast_coef_updates;
@@ -16,8 +16,22 @@
 extern "C" {
 #endif
 
+// The frames filtered into an alt-ref frame, shared by the threads filtering
+// its macroblock rows.
+typedef struct TemporalFilterParams {
+  YV12_BUFFER_CONFIG **frames;
+  int frame_count;
+  int alt_ref_index;
+  int strength;
+  struct scale_factors *scale;
+} TemporalFilterParams;
+
 void av1_temporal_filter(AV1_COMP *cpi, int distance);
 
+// Filters macroblock row mb_row of the alt-ref frame into cpi->alt_ref_buffer.
+void av1_temporal_filter_row(AV1_COMP *cpi, MACROBLOCK *x,
+                             const TemporalFilterParams *params, int mb_row);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
@@ -98,6 +98,49 @@ aomdec_av1_webm_frame_parallel() {
   fi
 }
 
+# Frame parallel decoding, alone and with tile and row workers, must produce
+# the frames of the serial decoder.
+aomdec_av1_frame_parallel_md5() {
+  if [ "$(aomdec_can_decode_av1)" = "yes" ] && \
+     [ "$(av1_encode_available)" = "yes" ]; then
+    local readonly decoder="$(aom_tool_path aomdec)"
+    local readonly file="${AOM_TEST_OUTPUT_DIR}/test_encode_fpm.ivf"
+    encode_yuv_raw_input_av1 "${file}" "--ivf --tile-columns=1 --tile-rows=1"
+    local readonly expected=$(${AOM_TEST_PREFIX} "${decoder}" "${file}" \
+      --md5 2>&1)
+    for threads in 2 3 8; do
+      for row_mt in "" "--row-mt"; do
+        local md5=$(${AOM_TEST_PREFIX} "${decoder}" "${file}" --md5 \
+          --threads=$threads --frame-parallel ${row_mt} 2>&1)
+        if [ "${md5}" != "${expected}" ]; then
+          elog "MD5 mismatch with ${threads} threads ${row_mt}:" \
+            "${md5} != ${expected}"
+          return 1
+        fi
+      done
+    done
+  fi
+}
+
+# --frame-timing reports every decoded frame, including the hidden ones.
+aomdec_av1_frame_timing() {
+  if [ "$(aomdec_can_decode_av1)" = "yes" ] && \
+     [ "$(av1_encode_available)" = "yes" ]; then
+    local readonly decoder="$(aom_tool_path aomdec)"
+    local readonly file="${AOM_TEST_OUTPUT_DIR}/test_encode_timing.ivf"
+    encode_yuv_raw_input_av1 "${file}" "--ivf --tile-columns=1"
+    local readonly output=$(${AOM_TEST_PREFIX} "${decoder}" "${file}" \
+      --threads=2 --frame-timing --summary --noblit 2>&1)
+    local readonly shown=$(echo "${output}" \
+      | awk '/ decoded frames/ { split($3, a, "/"); print a[2] }')
+    local readonly timed=$(echo "${output}" | awk '/^Total:/ { print $2 }')
+    if [ -z "${timed}" ] || [ "${timed}" -lt "${shown}" ]; then
+      elog "Timed frames (${timed}) < shown frames (${shown})"
+      return 1
+    fi
+  fi
+}
+
 # TODO(vigneshv): Enable or remove this test and associated code.
 DISABLED_aomdec_av1_webm_less_than_50_frames() {
   # ensure that reaching eof in webm_guess_framerate doesn't result in invalid
@@ -118,6 +161,8 @@ DISABLED_aomdec_av1_webm_less_than_50_frames() {
 
 aomdec_tests="aomdec_av1_webm
               aomdec_av1_webm_frame_parallel
+              aomdec_av1_frame_parallel_md5
+              aomdec_av1_frame_timing
               aomdec_aom_ivf_pipe_input
               DISABLED_aomdec_av1_webm_less_than_50_frames"
 
@@ -0,0 +1,212 @@
+/*
+ * Copyright (c) 2017, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+*/
+
+#include <cstring>
+
+#include "third_party/googletest/src/googletest/include/gtest/gtest.h"
+
+#include "./aom_config.h"
+#include "aom_mem/aom_mem.h"
+#include "aom_scale/yv12config.h"
+#include "aom_util/aom_thread.h"
+#include "av1/common/cdef.h"
+#include "av1/common/onyxc_int.h"
+#include "av1/common/reconinter.h"
+#include "test/acm_random.h"
+
+using libaom_test::ACMRandom;
+
+namespace {
+
+// Not a multiple of the superblock size, so that the last superblock row and
+// column are partial.
+const int kWidth = 208;
+const int kHeight = 536;
+const int kMaxWorkers = 8;
+
+// Filters the same frame with av1_cdef_frame() and with the multi-threaded
+// and row-based versions, which must give identical results.
+class CdefFrameTest : public ::testing::Test {
+ protected:
+  CdefFrameTest() : cm_(NULL), mi_(NULL) {}
+
+  virtual void SetUp() {
+    const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+    ACMRandom rnd(ACMRandom::DeterministicSeed());
+    int pli, i, r, c;
+
+    for (i = 0; i < kMaxWorkers; ++i) {
+      winterface->init(&workers_[i]);
+      ASSERT_NE(0, winterface->reset(&workers_[i]));
+    }
+
+    cm_ = reinterpret_cast<AV1_COMMON *>(aom_calloc(1, sizeof(*cm_)));
+    ASSERT_TRUE(cm_ != NULL);
+    memset(&xd_, 0, sizeof(xd_));
+    memset(&ref_, 0, sizeof(ref_));
+    memset(&test_, 0, sizeof(test_));
+    for (pli = 1; pli < MAX_MB_PLANE; ++pli) {
+      xd_.plane[pli].subsampling_x = 1;
+      xd_.plane[pli].subsampling_y = 1;
+    }
+
+    cm_->mi_rows = kHeight >> MI_SIZE_LOG2;
+    cm_->mi_cols = kWidth >> MI_SIZE_LOG2;
+    cm_->mi_stride = cm_->mi_cols;
+    cm_->bit_depth = AOM_BITS_8;
+    cm_->base_qindex = 120;
+    // Both planes off, chroma only, luma only and both planes on. The chroma
+    // planes of a superblock are deringed along the directions of its luma
+    // plane, whether the luma plane is filtered or not.
+    cm_->nb_cdef_strengths = 4;
+    cm_->cdef_strengths[0] = 0;
+    cm_->cdef_uv_strengths[0] = 0;
+    cm_->cdef_strengths[1] = 0;
+    cm_->cdef_uv_strengths[1] = 5 * CLPF_STRENGTHS + 1;
+    cm_->cdef_strengths[2] = 9 * CLPF_STRENGTHS + 2;
+    cm_->cdef_uv_strengths[2] = 0;
+    cm_->cdef_strengths[3] = 12 * CLPF_STRENGTHS + 3;
+    cm_->cdef_uv_strengths[3] = 3 * CLPF_STRENGTHS + 2;
+
+    const int mi_count = cm_->mi_rows * cm_->mi_stride;
+    mi_ = reinterpret_cast<MODE_INFO *>(aom_calloc(mi_count, sizeof(*mi_)));
+    cm_->mi_grid_visible = reinterpret_cast<MODE_INFO **>(
+        aom_calloc(mi_count, sizeof(*cm_->mi_grid_visible)));
+    ASSERT_TRUE(mi_ != NULL);
+    ASSERT_TRUE(cm_->mi_grid_visible != NULL);
+    for (r = 0; r < cm_->mi_rows; ++r) {
+      for (c = 0; c < cm_->mi_cols; ++c) {
+        MB_MODE_INFO *const mbmi = &mi_[r * cm_->mi_stride + c].mbmi;
+        mbmi->skip = rnd(8) == 0;
+        // Every superblock row starts with a superblock that has only its
+        // chroma planes filtered.
+        mbmi->cdef_strength =
+            c < MAX_MIB_SIZE ? 1 : (r / MAX_MIB_SIZE + c / MAX_MIB_SIZE) % 4;
+        int boundary = 0;
+        if (r == 0) boundary |= TILE_ABOVE_BOUNDARY;
+        if (c == 0 || c == MAX_MIB_SIZE * 2) boundary |= TILE_LEFT_BOUNDARY;
+        mbmi->boundary_info = static_cast<BOUNDARY_TYPE>(boundary);
+        cm_->mi_grid_visible[r * cm_->mi_stride + c] =
+            &mi_[r * cm_->mi_stride + c];
+      }
+    }
+
+    ASSERT_EQ(0, aom_alloc_frame_buffer(&ref_, kWidth, kHeight, 1, 1,
+#if CONFIG_AOM_HIGHBITDEPTH
+                                        0,
+#endif
+                                        AOM_BORDER_IN_PIXELS, 0));
+    ASSERT_EQ(0, aom_alloc_frame_buffer(&test_, kWidth, kHeight, 1, 1,
+#if CONFIG_AOM_HIGHBITDEPTH
+                                        0,
+#endif
+                                        AOM_BORDER_IN_PIXELS, 0));
+    // Gradients with noise and sharp edges, for the directions to vary.
+    for (pli = 0; pli < MAX_MB_PLANE; ++pli) {
+      const int w = pli ? ref_.uv_crop_width : ref_.y_crop_width;
+      const int h = pli ? ref_.uv_crop_height : ref_.y_crop_height;
+      const int stride = pli ? ref_.uv_stride : ref_.y_stride;
+      for (r = 0; r < h; ++r) {
+        for (c = 0; c < w; ++c) {
+          const int edge = ((r + 2 * c) / 11) & 1 ? 96 : 0;
+          Plane(&ref_, pli)[r * stride + c] =
+              (uint8_t)((r + c) / 8 + edge + rnd(24));
+        }
+      }
+    }
+  }
+
+  virtual void TearDown() {
+    const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+    for (int i = 0; i < kMaxWorkers; ++i) winterface->end(&workers_[i]);
+    aom_free_frame_buffer(&ref_);
+    aom_free_frame_buffer(&test_);
+    if (cm_ != NULL) aom_free(cm_->mi_grid_visible);
+    aom_free(mi_);
+    aom_free(cm_);
+  }
+
+  static uint8_t *Plane(const YV12_BUFFER_CONFIG *fb, int pli) {
+    return pli == 0 ? fb->y_buffer : pli == 1 ? fb->u_buffer : fb->v_buffer;
+  }
+
+  void CopyFrame(YV12_BUFFER_CONFIG *dst, const YV12_BUFFER_CONFIG *src) {
+    memcpy(dst->buffer_alloc, src->buffer_alloc, src->frame_size);
+  }
+
+  void CheckFrame() {
+    for (int pli = 0; pli < MAX_MB_PLANE; ++pli) {
+      const int w = pli ? ref_.uv_crop_width : ref_.y_crop_width;
+      const int h = pli ? ref_.uv_crop_height : ref_.y_crop_height;
+      const int stride = pli ? ref_.uv_stride : ref_.y_stride;
+      for (int r = 0; r < h; ++r) {
+        for (int c = 0; c < w; ++c) {
+          ASSERT_EQ(Plane(&ref_, pli)[r * stride + c],
+                    Plane(&test_, pli)[r * stride + c])
+              << "plane " << pli << " row " << r << " col " << c;
+        }
+      }
+    }
+  }
+
+  AV1_COMMON *cm_;
+  MODE_INFO *mi_;
+  MACROBLOCKD xd_;
+  YV12_BUFFER_CONFIG ref_;
+  YV12_BUFFER_CONFIG test_;
+  AVxWorker workers_[kMaxWorkers];
+};
+
+TEST_F(CdefFrameTest, MultiThreadedMatchesSerial) {
+  YV12_BUFFER_CONFIG unfiltered;
+  memset(&unfiltered, 0, sizeof(unfiltered));
+  ASSERT_EQ(0, aom_alloc_frame_buffer(&unfiltered, kWidth, kHeight, 1, 1,
+#if CONFIG_AOM_HIGHBITDEPTH
+                                      0,
+#endif
+                                      AOM_BORDER_IN_PIXELS, 0));
+  CopyFrame(&unfiltered, &ref_);
+  av1_cdef_frame(&ref_, cm_, &xd_);
+
+  for (int num_workers = 2; num_workers <= kMaxWorkers; ++num_workers) {
+    CopyFrame(&test_, &unfiltered);
+    av1_cdef_frame_mt(&test_, cm_, &xd_, workers_, num_workers);
+    SCOPED_TRACE(::testing::Message() << num_workers << " workers");
+    CheckFrame();
+    if (HasFatalFailure()) break;
+  }
+  aom_free_frame_buffer(&unfiltered);
+}
+
+// Filters the superblock rows one at a time in reverse order, as they may be
+// by the loop filter pipeline.
+TEST_F(CdefFrameTest, SuperblockRowsMatchSerial) {
+  const int nvsb = (cm_->mi_rows + MAX_MIB_SIZE - 1) / MAX_MIB_SIZE;
+  const int size = av1_cdef_sb_row_buf_size(cm_);
+  uint16_t *const buf =
+      reinterpret_cast<uint16_t *>(aom_malloc(sizeof(*buf) * nvsb * size));
+  ASSERT_TRUE(buf != NULL);
+  int sbr;
+
+  CopyFrame(&test_, &ref_);
+  av1_cdef_frame(&ref_, cm_, &xd_);
+
+  av1_setup_dst_planes(xd_.plane, &test_, 0, 0);
+  for (sbr = 0; sbr < nvsb - 1; ++sbr)
+    av1_cdef_save_sb_row_edge(cm_, &xd_, sbr, buf + sbr * size,
+                              buf + (sbr + 1) * size);
+  for (sbr = nvsb - 1; sbr >= 0; --sbr)
+    av1_cdef_filter_sb_row(cm_, &xd_, sbr, buf + sbr * size);
+  aom_free(buf);
+  CheckFrame();
+}
+
+}  // namespace
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2017, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+*/
+
+#include <string.h>
+
+#include "third_party/googletest/src/googletest/include/gtest/gtest.h"
+
+#include "./aom_config.h"
+#include "./aom_dsp_rtcd.h"
+#include "test/acm_random.h"
+#include "test/clear_system_state.h"
+#include "aom/aom_integer.h"
+#include "aom_dsp/prob.h"
+
+#if CONFIG_DAALA_EC || CONFIG_EC_ADAPT
+
+using libaom_test::ACMRandom;
+
+namespace {
+
+const int kMaxSymbols = 16;
+const int kNumTests = 100000;
+
+// Fills cdf with a random CDF of nsyms symbols, followed by its counter.
+void RandomCdf(ACMRandom *rnd, aom_cdf_prob *cdf, int nsyms) {
+  int prev = 0;
+  for (int i = 0; i < nsyms - 1; ++i) {
+    // Skew the values towards the end so that all the symbols are exercised.
+    const int v = prev + rnd->Rand16() % (CDF_PROB_TOP - prev + 1) / 2;
+    cdf[i] = v;
+    prev = v;
+  }
+  cdf[nsyms - 1] = CDF_PROB_TOP;
+  cdf[nsyms] = rnd->Rand8() % 33;
+}
+
+#if CONFIG_DAALA_EC
+typedef int (*FindSymbolFunc)(const uint16_t *cdf, int nsyms, unsigned q);
+
+// The first symbol s such that q < cdf[s].
+int ReferenceFindSymbol(const uint16_t *cdf, int nsyms, unsigned q) {
+  for (int s = 0; s < nsyms; ++s) {
+    if (q < cdf[s]) return s;
+  }
+  return nsyms;
+}
+
+class CdfFindSymbolTest : public ::testing::TestWithParam<FindSymbolFunc> {
+ public:
+  virtual ~CdfFindSymbolTest() {}
+  virtual void SetUp() { find_symbol_ = GetParam(); }
+  virtual void TearDown() { libaom_test::ClearSystemState(); }
+
+ protected:
+  FindSymbolFunc find_symbol_;
+};
+
+TEST_P(CdfFindSymbolTest, MatchesReference) {
+  ACMRandom rnd(ACMRandom::DeterministicSeed());
+  for (int n = 0; n < kNumTests; ++n) {
+    const int nsyms = 2 + rnd(kMaxSymbols - 1);
+    aom_cdf_prob cdf[kMaxSymbols + 1];
+    RandomCdf(&rnd, cdf, nsyms);
+    const unsigned q = rnd.Rand16() % CDF_PROB_TOP;
+    ASSERT_EQ(ReferenceFindSymbol(cdf, nsyms, q), find_symbol_(cdf, nsyms, q))
+        << "nsyms: " << nsyms << " q: " << q;
+  }
+}
+
+INSTANTIATE_TEST_CASE_P(C, CdfFindSymbolTest,
+                        ::testing::Values(&od_ec_find_symbol_c));
+
+#if HAVE_SSE2
+INSTANTIATE_TEST_CASE_P(SSE2, CdfFindSymbolTest,
+                        ::testing::Values(&od_ec_find_symbol_sse2));
+#endif
+
+#if HAVE_NEON
+INSTANTIATE_TEST_CASE_P(NEON, CdfFindSymbolTest,
+                        ::testing::Values(&od_ec_find_symbol_neon));
+#endif
+#endif  // CONFIG_DAALA_EC
+
+#if CONFIG_EC_ADAPT
+typedef void (*UpdateCdfFunc)(uint16_t *cdf, int val, int nsymbs);
+
+class CdfUpdateTest : public ::testing::TestWithParam<UpdateCdfFunc> {
+ public:
+  virtual ~CdfUpdateTest() {}
+  virtual void SetUp() { update_cdf_ = GetParam(); }
+  virtual void TearDown() { libaom_test::ClearSystemState(); }
+
+ protected:
+  UpdateCdfFunc update_cdf_;
+};
+
+TEST_P(CdfUpdateTest, MatchesReference) {
+  ACMRandom rnd(ACMRandom::DeterministicSeed());
+  for (int n = 0; n < kNumTests / 100; ++n) {
+    const int nsyms = 2 + rnd(kMaxSymbols - 1);
+    aom_cdf_prob ref[kMaxSymbols + 1];
+    aom_cdf_prob test[kMaxSymbols + 1];
+    RandomCdf(&rnd, ref, nsyms);
+    memcpy(test, ref, sizeof(ref));
+    // Adapt the CDF through its whole range of rates.
+    for (int i = 0; i < 100; ++i) {
+      const int val = rnd(nsyms);
+      update_cdf_c(ref, val, nsyms);
+      update_cdf_(test, val, nsyms);
+      for (int j = 0; j <= nsyms; ++j)
+        ASSERT_EQ(ref[j], test[j]) << "nsyms: " << nsyms << " entry: " << j;
+    }
+  }
+}
+
+INSTANTIATE_TEST_CASE_P(C, CdfUpdateTest, ::testing::Values(&aom_update_cdf_c));
+
+#if HAVE_SSE2
+INSTANTIATE_TEST_CASE_P(SSE2, CdfUpdateTest,
+                        ::testing::Values(&aom_update_cdf_sse2));
+#endif
+
+#if HAVE_NEON
+INSTANTIATE_TEST_CASE_P(NEON, CdfUpdateTest,
+                        ::testing::Values(&aom_update_cdf_neon));
+#endif
+#endif  // CONFIG_EC_ADAPT
+
+}  // namespace
+
+#endif  // CONFIG_DAALA_EC || CONFIG_EC_ADAPT
@@ -10,6 +10,7 @@
 */
 
 #include <string>
+#include <vector>
 #include "test/codec_factory.h"
 #include "test/decode_test_driver.h"
 #include "test/encode_test_driver.h"
@@ -240,4 +241,96 @@ TEST_P(AV1NewEncodeDecodePerfTest, PerfTest) {
 
 AV1_INSTANTIATE_TEST_CASE(AV1NewEncodeDecodePerfTest,
                           ::testing::Values(::libaom_test::kTwoPassGood));
+
+const unsigned kScalingThreads[] = { 1, 2, 4, 8, 16, 32 };
+
+// Encodes a clip with 16 tiles once and measures how the decoding speed
+// scales with the number of decoder threads.
+class AV1DecodeScalingPerfTest
+    : public ::libaom_test::EncoderTest,
+      public ::libaom_test::CodecTestWithParam<libaom_test::TestMode> {
+ protected:
+  AV1DecodeScalingPerfTest()
+      : EncoderTest(GET_PARAM(0)), encoding_mode_(GET_PARAM(1)) {}
+
+  virtual ~AV1DecodeScalingPerfTest() {}
+
+  virtual void SetUp() {
+    InitializeConfig();
+    SetMode(encoding_mode_);
+
+    cfg_.g_lag_in_frames = 25;
+    cfg_.rc_end_usage = AOM_VBR;
+  }
+
+  virtual void PreEncodeFrameHook(::libaom_test::VideoSource *video,
+                                  ::libaom_test::Encoder *encoder) {
+    if (video->frame() == 1) {
+      encoder->Control(AOME_SET_CPUUSED, 2);
+      encoder->Control(AV1E_SET_TILE_COLUMNS, 2);
+      encoder->Control(AV1E_SET_TILE_ROWS, 2);
+    }
+  }
+
+  virtual void FramePktHook(const aom_codec_cx_pkt_t *pkt) {
+    const uint8_t *const buf =
+        static_cast<const uint8_t *>(pkt->data.frame.buf);
+    frames_.push_back(std::vector<uint8_t>(buf, buf + pkt->data.frame.sz));
+  }
+
+  virtual bool DoDecode() { return false; }
+
+  double DecodeFrames(unsigned threads) {
+    aom_codec_dec_cfg_t cfg = aom_codec_dec_cfg_t();
+    cfg.threads = threads;
+    libaom_test::AV1Decoder decoder(cfg, 0);
+
+    aom_usec_timer t;
+    aom_usec_timer_start(&t);
+    for (size_t i = 0; i < frames_.size(); ++i)
+      decoder.DecodeFrame(&frames_[i][0], frames_[i].size());
+    aom_usec_timer_mark(&t);
+    return static_cast<double>(aom_usec_timer_elapsed(&t)) / kUsecsInSec;
+  }
+
+  std::vector<std::vector<uint8_t> > frames_;
+
+ private:
+  libaom_test::TestMode encoding_mode_;
+};
+
+TEST_P(AV1DecodeScalingPerfTest, PerfTest) {
+  const aom_rational timebase = { 33333333, 1000000000 };
+  cfg_.g_timebase = timebase;
+  cfg_.rc_target_bitrate = kAV1EncodePerfTestVectors[0].bitrate;
+
+  libaom_test::I420VideoSource video(
+      kAV1EncodePerfTestVectors[0].name, kAV1EncodePerfTestVectors[0].width,
+      kAV1EncodePerfTestVectors[0].height, timebase.den, timebase.num, 0, 30);
+  ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+
+  double single_thread_secs = 0;
+  for (size_t i = 0; i < sizeof(kScalingThreads) / sizeof(kScalingThreads[0]);
+       ++i) {
+    const unsigned threads = kScalingThreads[i];
+    const double elapsed_secs = DecodeFrames(threads);
+    const unsigned frames = static_cast<unsigned>(frames_.size());
+    if (threads == 1) single_thread_secs = elapsed_secs;
+
+    printf("{\n");
+    printf("\t\"type\" : \"decode_scaling_perf_test\",\n");
+    printf("\t\"version\" : \"%s\",\n", VERSION_STRING_NOSP);
+    printf("\t\"videoName\" : \"%s\",\n",
+           kAV1EncodePerfTestVectors[0].name);
+    printf("\t\"threadCount\" : %u,\n", threads);
+    printf("\t\"decodeTimeSecs\" : %f,\n", elapsed_secs);
+    printf("\t\"totalFrames\" : %u,\n", frames);
+    printf("\t\"framesPerSecond\" : %f,\n", frames / elapsed_secs);
+    printf("\t\"speedup\" : %f\n", single_thread_secs / elapsed_secs);
+    printf("}\n");
+  }
+}
+
+AV1_INSTANTIATE_TEST_CASE(AV1DecodeScalingPerfTest,
+                          ::testing::Values(::libaom_test::kTwoPassGood));
 }  // namespace
@@ -9,6 +9,9 @@
  * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
 */
 
+#include <string>
+#include <vector>
+
 #include "third_party/googletest/src/googletest/include/gtest/gtest.h"
 
 #include "./aom_config.h"
@@ -60,4 +63,97 @@ TEST(EncodeAPI, InvalidParams) {
   }
 }
 
+#if CONFIG_AV1_ENCODER && CONFIG_MULTITHREAD
+const int kAsyncWidth = 64;
+const int kAsyncHeight = 64;
+const int kAsyncFrames = 10;
+
+void AddFrame(std::vector<std::string> *frames, const aom_codec_cx_pkt_t *pkt) {
+  if (pkt->kind != AOM_CODEC_CX_FRAME_PKT) return;
+  frames->push_back(std::string(static_cast<const char *>(pkt->data.frame.buf),
+                                pkt->data.frame.sz));
+}
+
+void AsyncOutput(void *priv, const aom_codec_cx_pkt_t *pkt) {
+  AddFrame(static_cast<std::vector<std::string> *>(priv), pkt);
+}
+
+// Encodes the same frames synchronously (mode 0), asynchronously with packets
+// retrieved by aom_codec_get_cx_data() (mode 1), or asynchronously with an
+// output callback (mode 2).
+std::vector<std::string> EncodeFrames(int mode) {
+  std::vector<std::string> frames;
+  std::vector<uint8_t> buf(kAsyncWidth * kAsyncHeight * 3 / 2);
+  aom_codec_ctx_t enc;
+  aom_codec_enc_cfg_t cfg;
+  aom_image_t img;
+  aom_async_output_t output = { mode == 2 ? AsyncOutput : NULL, &frames };
+
+  EXPECT_EQ(AOM_CODEC_OK,
+            aom_codec_enc_config_default(&aom_codec_av1_cx_algo, &cfg, 0));
+  cfg.g_w = kAsyncWidth;
+  cfg.g_h = kAsyncHeight;
+  cfg.g_lag_in_frames = 3;
+  EXPECT_EQ(AOM_CODEC_OK,
+            aom_codec_enc_init(&enc, &aom_codec_av1_cx_algo, &cfg, 0));
+  if (mode != 0) {
+    EXPECT_EQ(AOM_CODEC_OK,
+              aom_codec_control(&enc, AV1E_SET_ASYNC_OUTPUT, &output));
+  }
+  aom_img_wrap(&img, AOM_IMG_FMT_I420, kAsyncWidth, kAsyncHeight, 1, &buf[0]);
+  for (int i = 0; i <= kAsyncFrames; ++i) {
+    if (i < kAsyncFrames) {
+      for (size_t j = 0; j < buf.size(); ++j)
+        buf[j] = static_cast<uint8_t>((j % kAsyncWidth) * 2 + i * 5);
+      EXPECT_EQ(AOM_CODEC_OK, aom_codec_encode(&enc, &img, i, 1, 0, 0));
+    } else {
+      EXPECT_EQ(AOM_CODEC_OK, aom_codec_encode(&enc, NULL, i, 1, 0, 0));
+    }
+    aom_codec_iter_t iter = NULL;
+    const aom_codec_cx_pkt_t *pkt;
+    while ((pkt = aom_codec_get_cx_data(&enc, &iter)) != NULL)
+      AddFrame(&frames, pkt);
+  }
+  EXPECT_EQ(AOM_CODEC_OK, aom_codec_destroy(&enc));
+  return frames;
+}
+
+TEST(EncodeAPI, AsyncOutput) {
+  const std::vector<std::string> frames = EncodeFrames(0);
+  EXPECT_EQ(kAsyncFrames, static_cast<int>(frames.size()));
+  EXPECT_TRUE(frames == EncodeFrames(1));
+  EXPECT_TRUE(frames == EncodeFrames(2));
+}
+
+// An error of the encoding thread and its detail are returned by the next
+// call to aom_codec_encode().
+TEST(EncodeAPI, AsyncError) {
+  std::vector<uint8_t> buf(kAsyncWidth * kAsyncHeight * 3 / 2, 128);
+  aom_codec_ctx_t enc;
+  aom_codec_enc_cfg_t cfg;
+  aom_image_t img;
+  aom_async_output_t output = { NULL, NULL };
+
+  ASSERT_EQ(AOM_CODEC_OK,
+            aom_codec_enc_config_default(&aom_codec_av1_cx_algo, &cfg, 0));
+  cfg.g_w = kAsyncWidth;
+  cfg.g_h = kAsyncHeight;
+  ASSERT_EQ(AOM_CODEC_OK,
+            aom_codec_enc_init(&enc, &aom_codec_av1_cx_algo, &cfg, 0));
+  ASSERT_EQ(AOM_CODEC_OK,
+            aom_codec_control(&enc, AV1E_SET_ASYNC_OUTPUT, &output));
+  aom_img_wrap(&img, AOM_IMG_FMT_I420, kAsyncWidth, kAsyncHeight, 1, &buf[0]);
+
+  // The flags are only checked by the encoding thread.
+  EXPECT_EQ(AOM_CODEC_OK,
+            aom_codec_encode(&enc, &img, 0, 1,
+                             AOM_EFLAG_NO_UPD_GF | AOM_EFLAG_FORCE_GF, 0));
+  EXPECT_EQ(AOM_CODEC_INVALID_PARAM, aom_codec_encode(&enc, NULL, 1, 1, 0, 0));
+  ASSERT_TRUE(aom_codec_error_detail(&enc) != NULL);
+  EXPECT_EQ(std::string("Conflicting flags."), aom_codec_error_detail(&enc));
+  EXPECT_EQ(AOM_CODEC_OK, aom_codec_encode(&enc, NULL, 1, 1, 0, 0));
+  EXPECT_EQ(AOM_CODEC_OK, aom_codec_destroy(&enc));
+}
+#endif  // CONFIG_AV1_ENCODER && CONFIG_MULTITHREAD
+
 }  // namespace
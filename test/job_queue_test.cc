@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2017, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+*/
+
+#include <string.h>
+
+#include "third_party/googletest/src/googletest/include/gtest/gtest.h"
+
+#include "./aom_config.h"
+#include "aom_util/aom_job_queue.h"
+#include "aom_util/aom_thread.h"
+
+namespace {
+
+const int kMaxWorkers = 8;
+const int kNumJobs = 1000;
+
+class JobQueueTest : public ::testing::Test {
+ protected:
+  virtual void SetUp() {
+    memset(&queue_, 0, sizeof(queue_));
+    ASSERT_NE(aom_job_queue_alloc(&queue_, kMaxWorkers), 0);
+  }
+
+  virtual void TearDown() { aom_job_queue_free(&queue_); }
+
+  AVxJobQueue queue_;
+};
+
+TEST_F(JobQueueTest, OwnJobsInOrder) {
+  aom_job_queue_reset(&queue_, 10, 3);
+  EXPECT_EQ(1, aom_job_queue_next(&queue_, 1));
+  EXPECT_EQ(4, aom_job_queue_next(&queue_, 1));
+  EXPECT_EQ(7, aom_job_queue_next(&queue_, 1));
+  // Worker 1 then steals the first job left of worker 2, then of worker 0.
+  EXPECT_EQ(2, aom_job_queue_next(&queue_, 1));
+  EXPECT_EQ(0, aom_job_queue_next(&queue_, 0));
+  EXPECT_EQ(3, aom_job_queue_next(&queue_, 0));
+}
+
+TEST_F(JobQueueTest, EachJobOnce) {
+  for (int num_workers = 1; num_workers <= kMaxWorkers; ++num_workers) {
+    for (int num_jobs = 0; num_jobs < 2 * kMaxWorkers; ++num_jobs) {
+      int taken[2 * kMaxWorkers] = { 0 };
+      int job;
+      int worker = 0;
+
+      aom_job_queue_reset(&queue_, num_jobs, num_workers);
+      while ((job = aom_job_queue_next(&queue_, worker)) >= 0) {
+        ASSERT_LT(job, num_jobs);
+        ++taken[job];
+        worker = (worker + 1) % num_workers;
+      }
+      for (int i = 0; i < num_jobs; ++i) EXPECT_EQ(1, taken[i]);
+    }
+  }
+}
+
+struct JobQueueWorkerData {
+  AVxJobQueue *queue;
+  int worker;
+  int *taken;
+};
+
+int TakeJobs(void *arg1, void *arg2) {
+  JobQueueWorkerData *const data = reinterpret_cast<JobQueueWorkerData *>(arg1);
+  int job;
+  (void)arg2;
+  while ((job = aom_job_queue_next(data->queue, data->worker)) >= 0)
+    ++data->taken[job];
+  return 1;
+}
+
+TEST_F(JobQueueTest, EachJobOnceThreaded) {
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+  AVxWorker workers[kMaxWorkers];
+  JobQueueWorkerData data[kMaxWorkers];
+  int taken[kMaxWorkers][kNumJobs];
+
+  memset(taken, 0, sizeof(taken));
+  aom_job_queue_reset(&queue_, kNumJobs, kMaxWorkers);
+  for (int i = 0; i < kMaxWorkers; ++i) {
+    winterface->init(&workers[i]);
+    ASSERT_NE(winterface->reset(&workers[i]), 0);
+    data[i].queue = &queue_;
+    data[i].worker = i;
+    data[i].taken = taken[i];
+    workers[i].hook = TakeJobs;
+    workers[i].data1 = &data[i];
+    workers[i].data2 = NULL;
+    winterface->launch(&workers[i]);
+  }
+  for (int i = 0; i < kMaxWorkers; ++i) {
+    EXPECT_NE(winterface->sync(&workers[i]), 0);
+    winterface->end(&workers[i]);
+  }
+
+  for (int j = 0; j < kNumJobs; ++j) {
+    int count = 0;
+    for (int i = 0; i < kMaxWorkers; ++i) count += taken[i][j];
+    EXPECT_EQ(1, count);
+  }
+}
+
+}  // namespace
@@ -20,8 +20,10 @@ set(AOM_UNIT_TEST_COMMON_SOURCES
     "${AOM_ROOT}/test/codec_factory.h"
     "${AOM_ROOT}/test/convolve_test.cc"
     "${AOM_ROOT}/test/function_equivalence_test.h"
+    "${AOM_ROOT}/test/job_queue_test.cc"
     "${AOM_ROOT}/test/md5_helper.h"
     "${AOM_ROOT}/test/register_state_check.h"
+    "${AOM_ROOT}/test/thread_pool_test.cc"
     "${AOM_ROOT}/test/transform_test_base.h"
     "${AOM_ROOT}/test/util.h"
     "${AOM_ROOT}/test/video_source.h")
@@ -96,6 +98,7 @@ if (CONFIG_AV1)
   if (CONFIG_CDEF)
     set(AOM_UNIT_TEST_COMMON_SOURCES
         ${AOM_UNIT_TEST_COMMON_SOURCES}
+        "${AOM_ROOT}/test/cdef_frame_test.cc"
         "${AOM_ROOT}/test/clpf_test.cc")
   endif ()
 
@@ -181,6 +184,7 @@ endif ()
 if (CONFIG_AV1_DECODER AND CONFIG_AV1_ENCODER)
   set(AOM_UNIT_TEST_COMMON_SOURCES
       ${AOM_UNIT_TEST_COMMON_SOURCES}
+      "${AOM_ROOT}/test/decode_multithreaded_test.cc"
       "${AOM_ROOT}/test/divu_small_test.cc"
       "${AOM_ROOT}/test/ethread_test.cc"
       "${AOM_ROOT}/test/idct8x8_test.cc"
@@ -197,7 +201,8 @@ if (CONFIG_AV1_DECODER AND CONFIG_AV1_ENCODER)
   else ()
     set(AOM_UNIT_TEST_COMMON_SOURCES
         ${AOM_UNIT_TEST_COMMON_SOURCES}
-        "${AOM_ROOT}/test/boolcoder_test.cc")
+        "${AOM_ROOT}/test/boolcoder_test.cc"
+        "${AOM_ROOT}/test/cdf_simd_test.cc")
   endif ()
 
   if (CONFIG_EXT_TILE)
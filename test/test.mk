@@ -113,6 +113,7 @@ LIBAOM_TEST_SRCS-yes                   += partial_idct_test.cc
 LIBAOM_TEST_SRCS-yes                   += superframe_test.cc
 LIBAOM_TEST_SRCS-yes                   += tile_independence_test.cc
 LIBAOM_TEST_SRCS-yes                   += ethread_test.cc
+LIBAOM_TEST_SRCS-yes                   += decode_multithreaded_test.cc
 ifneq ($(CONFIG_ANS),yes)
 LIBAOM_TEST_SRCS-yes                   += binary_codes_test.cc
 endif
@@ -124,6 +125,7 @@ LIBAOM_TEST_SRCS-yes                   += ans_test.cc
 LIBAOM_TEST_SRCS-yes                   += ans_codec_test.cc
 else
 LIBAOM_TEST_SRCS-yes                   += boolcoder_test.cc
+LIBAOM_TEST_SRCS-yes                   += cdf_simd_test.cc
 ifeq ($(CONFIG_ACCOUNTING),yes)
 LIBAOM_TEST_SRCS-yes                   += accounting_test.cc
 endif
@@ -137,6 +139,7 @@ LIBAOM_TEST_SRCS-yes                   += convolve_test.cc
 LIBAOM_TEST_SRCS-yes                   += lpf_8_test.cc
 LIBAOM_TEST_SRCS-$(CONFIG_CDEF)        += dering_test.cc
 LIBAOM_TEST_SRCS-$(CONFIG_CDEF)        += clpf_test.cc
+LIBAOM_TEST_SRCS-$(CONFIG_CDEF)        += cdef_frame_test.cc
 LIBAOM_TEST_SRCS-yes                   += simd_cmp_impl.h
 LIBAOM_TEST_SRCS-$(HAVE_SSE2)          += simd_cmp_sse2.cc
 LIBAOM_TEST_SRCS-$(HAVE_SSSE3)         += simd_cmp_ssse3.cc
@@ -148,6 +151,8 @@ LIBAOM_TEST_SRCS-$(HAVE_SSSE3)         += simd_ssse3_test.cc
 LIBAOM_TEST_SRCS-$(HAVE_SSE4_1)        += simd_sse4_test.cc
 LIBAOM_TEST_SRCS-$(HAVE_NEON)          += simd_neon_test.cc
 LIBAOM_TEST_SRCS-yes                   += intrapred_test.cc
+LIBAOM_TEST_SRCS-yes                   += job_queue_test.cc
+LIBAOM_TEST_SRCS-yes                   += thread_pool_test.cc
 #LIBAOM_TEST_SRCS-$(CONFIG_AV1_DECODER) += av1_thread_test.cc
 LIBAOM_TEST_SRCS-$(CONFIG_AV1_ENCODER) += dct16x16_test.cc
 LIBAOM_TEST_SRCS-$(CONFIG_AV1_ENCODER) += dct32x32_test.cc
@@ -0,0 +1,355 @@
+/*
+ * Copyright (c) 2017, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+*/
+
+#include "third_party/googletest/src/googletest/include/gtest/gtest.h"
+
+#include "./aom_config.h"
+#include "aom/aom_codec.h"
+#include "aom_ports/aom_timer.h"
+#include "aom_util/aom_thread.h"
+#include "aom_util/aom_thread_pool.h"
+
+#if CONFIG_MULTITHREAD
+
+namespace {
+
+const int kNumThreads = 4;
+const int kNumClients = 6;
+const int kNumRounds = 50;
+
+int Hook(void *arg1, void *arg2) {
+  int *const count = reinterpret_cast<int *>(arg1);
+  ++*count;
+  return arg2 == NULL;
+}
+
+TEST(ThreadPoolTest, LaunchAndSync) {
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+  AVxThreadPool *const pool = aom_thread_pool_alloc(kNumThreads);
+  ASSERT_TRUE(pool != NULL);
+  EXPECT_EQ(kNumThreads, aom_thread_pool_num_threads(pool));
+
+  AVxThreadPoolClient client;
+  ASSERT_NE(aom_thread_pool_client_init(&client, pool, kNumThreads), 0);
+  AVxWorker workers[kNumThreads];
+  int counts[kNumThreads] = { 0 };
+  for (int i = 0; i < kNumThreads; ++i) {
+    winterface->init(&workers[i]);
+    workers[i].pool = &client;
+    ASSERT_NE(winterface->reset(&workers[i]), 0);
+    workers[i].hook = Hook;
+    workers[i].data1 = &counts[i];
+  }
+
+  for (int n = 0; n < kNumRounds; ++n) {
+    for (int i = 0; i < kNumThreads; ++i) {
+      // The last worker reports an error every other round.
+      workers[i].data2 = (i == kNumThreads - 1 && (n & 1)) ? &counts[i] : NULL;
+      winterface->launch(&workers[i]);
+    }
+    for (int i = 0; i < kNumThreads; ++i) {
+      EXPECT_EQ(i < kNumThreads - 1 || !(n & 1),
+                winterface->sync(&workers[i]) != 0);
+      workers[i].had_error = 0;
+    }
+  }
+  for (int i = 0; i < kNumThreads; ++i) {
+    EXPECT_EQ(kNumRounds, counts[i]);
+    winterface->end(&workers[i]);
+  }
+  aom_thread_pool_client_free(&client);
+  aom_thread_pool_free(pool);
+}
+
+TEST(ThreadPoolTest, ClientLimits) {
+  AVxThreadPool *const pool = aom_thread_pool_alloc(kNumThreads);
+  ASSERT_TRUE(pool != NULL);
+  AVxThreadPoolClient client;
+  EXPECT_EQ(0, aom_thread_pool_client_init(&client, pool, 0));
+  EXPECT_EQ(0, aom_thread_pool_client_init(&client, pool, kNumThreads + 1));
+  aom_thread_pool_free(pool);
+  EXPECT_TRUE(aom_thread_pool_alloc(0) == NULL);
+}
+
+// The workers launched by a client wait for each other at a barrier, which
+// only works if the pool runs all of them at the same time.
+struct Barrier {
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  int size;
+  int waiting;
+  int generation;
+};
+
+int BarrierHook(void *arg1, void *arg2) {
+  Barrier *const barrier = reinterpret_cast<Barrier *>(arg1);
+  (void)arg2;
+  pthread_mutex_lock(&barrier->mutex);
+  const int generation = barrier->generation;
+  if (++barrier->waiting == barrier->size) {
+    barrier->waiting = 0;
+    ++barrier->generation;
+    pthread_cond_broadcast(&barrier->cond);
+  } else {
+    while (generation == barrier->generation)
+      pthread_cond_wait(&barrier->cond, &barrier->mutex);
+  }
+  pthread_mutex_unlock(&barrier->mutex);
+  return 1;
+}
+
+struct ClientData {
+  AVxThreadPool *pool;
+  int num_workers;
+  int ok;
+};
+
+// Runs kNumRounds stages of num_workers workers and one more worker on the
+// calling thread, like the encoder and the decoder do.
+int RunClient(void *arg1, void *arg2) {
+  ClientData *const data = reinterpret_cast<ClientData *>(arg1);
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+  AVxThreadPoolClient client;
+  AVxWorker workers[kNumThreads + 1];
+  Barrier barrier;
+  (void)arg2;
+
+  if (!aom_thread_pool_client_init(&client, data->pool, data->num_workers))
+    return 0;
+  pthread_mutex_init(&barrier.mutex, NULL);
+  pthread_cond_init(&barrier.cond, NULL);
+  barrier.size = data->num_workers + 1;
+  barrier.waiting = 0;
+  barrier.generation = 0;
+  for (int i = 0; i <= data->num_workers; ++i) {
+    winterface->init(&workers[i]);
+    workers[i].pool = &client;
+    if (i < data->num_workers) winterface->reset(&workers[i]);
+    workers[i].hook = BarrierHook;
+    workers[i].data1 = &barrier;
+    workers[i].data2 = NULL;
+  }
+  data->ok = 1;
+  for (int n = 0; n < kNumRounds; ++n) {
+    for (int i = 0; i < data->num_workers; ++i)
+      winterface->launch(&workers[i]);
+    winterface->execute(&workers[data->num_workers]);
+    for (int i = 0; i <= data->num_workers; ++i)
+      data->ok &= winterface->sync(&workers[i]);
+  }
+  for (int i = 0; i <= data->num_workers; ++i) winterface->end(&workers[i]);
+  aom_thread_pool_client_free(&client);
+  pthread_cond_destroy(&barrier.cond);
+  pthread_mutex_destroy(&barrier.mutex);
+  return 1;
+}
+
+TEST(ThreadPoolTest, WorkersOfAClientRunTogether) {
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+  AVxThreadPool *const pool = aom_thread_pool_alloc(kNumThreads);
+  ASSERT_TRUE(pool != NULL);
+
+  // Together, the clients launch many more workers than there are threads.
+  AVxWorker threads[kNumClients];
+  ClientData data[kNumClients];
+  for (int i = 0; i < kNumClients; ++i) {
+    data[i].pool = pool;
+    data[i].num_workers = 1 + i % kNumThreads;
+    data[i].ok = 0;
+    winterface->init(&threads[i]);
+    ASSERT_NE(winterface->reset(&threads[i]), 0);
+    threads[i].hook = RunClient;
+    threads[i].data1 = &data[i];
+    threads[i].data2 = NULL;
+    winterface->launch(&threads[i]);
+  }
+  for (int i = 0; i < kNumClients; ++i) {
+    EXPECT_NE(winterface->sync(&threads[i]), 0);
+    EXPECT_EQ(1, data[i].ok);
+    winterface->end(&threads[i]);
+  }
+  aom_thread_pool_free(pool);
+}
+
+// State shared by a client that keeps launching workers, like the frame
+// workers of the decoder, and a client that waits for threads.
+struct YieldData {
+  AVxThreadPool *pool;
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  // Number of workers launched by the first client.
+  int launched;
+  // Whether the first client is in aom_thread_pool_yield().
+  int yielding;
+  // Whether the first client stops launching workers.
+  int stopping;
+  int waiting_done;
+};
+
+struct ContinuousWorker {
+  YieldData *data;
+  int index;
+};
+
+// Time in microseconds a worker gives its client to leave
+// aom_thread_pool_yield() before it takes the client to be blocked in it,
+// waiting for the worker.
+const int64_t kYieldTimeout = 100000;
+// Time in microseconds a worker leaves the mutex to its client while polling.
+const int64_t kYieldPollInterval = 100;
+
+void Spin(int64_t usecs) {
+  aom_usec_timer timer;
+  aom_usec_timer_start(&timer);
+  do {
+    aom_usec_timer_mark(&timer);
+  } while (aom_usec_timer_elapsed(&timer) < usecs);
+}
+
+// Runs until the next worker is launched, so that the client always has a
+// worker running. A worker does not wait for the next one while its client
+// stays blocked in aom_thread_pool_yield(), since the next worker is only
+// launched after it.
+int ContinuousHook(void *arg1, void *arg2) {
+  ContinuousWorker *const worker = reinterpret_cast<ContinuousWorker *>(arg1);
+  YieldData *const data = worker->data;
+  aom_usec_timer timer;
+  int polling = 0;
+  (void)arg2;
+  pthread_mutex_lock(&data->mutex);
+  while (data->launched <= worker->index + 1 && !data->stopping) {
+    if (!data->yielding) {
+      polling = 0;
+      pthread_cond_wait(&data->cond, &data->mutex);
+      continue;
+    }
+    if (!polling) {
+      aom_usec_timer_start(&timer);
+      polling = 1;
+    }
+    aom_usec_timer_mark(&timer);
+    if (aom_usec_timer_elapsed(&timer) >= kYieldTimeout) break;
+    pthread_mutex_unlock(&data->mutex);
+    Spin(kYieldPollInterval);
+    pthread_mutex_lock(&data->mutex);
+  }
+  pthread_mutex_unlock(&data->mutex);
+  return 1;
+}
+
+// Launches workers until the waiting client got its threads. Without
+// aom_thread_pool_yield(), the client would keep its threads until it runs out
+// of launches.
+int RunContinuousClient(void *arg1, void *arg2) {
+  YieldData *const data = reinterpret_cast<YieldData *>(arg1);
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+  const int kMaxLaunches = 1000;
+  AVxThreadPoolClient client;
+  AVxWorker workers[2];
+  ContinuousWorker worker_data[2];
+  int done = 0;
+  (void)arg2;
+
+  if (!aom_thread_pool_client_init(&client, data->pool, 2)) return 0;
+  for (int i = 0; i < 2; ++i) {
+    winterface->init(&workers[i]);
+    workers[i].pool = &client;
+    winterface->reset(&workers[i]);
+    workers[i].hook = ContinuousHook;
+    workers[i].data1 = &worker_data[i];
+    worker_data[i].data = data;
+  }
+  for (int n = 0; n < kMaxLaunches && !done; ++n) {
+    winterface->sync(&workers[n & 1]);
+    pthread_mutex_lock(&data->mutex);
+    data->yielding = 1;
+    pthread_cond_broadcast(&data->cond);
+    pthread_mutex_unlock(&data->mutex);
+    aom_thread_pool_yield(&client);
+    pthread_mutex_lock(&data->mutex);
+    data->yielding = 0;
+    pthread_mutex_unlock(&data->mutex);
+    worker_data[n & 1].index = n;
+    winterface->launch(&workers[n & 1]);
+    pthread_mutex_lock(&data->mutex);
+    data->launched = n + 1;
+    pthread_cond_broadcast(&data->cond);
+    done = data->waiting_done;
+    pthread_mutex_unlock(&data->mutex);
+  }
+  pthread_mutex_lock(&data->mutex);
+  data->stopping = 1;
+  pthread_cond_broadcast(&data->cond);
+  pthread_mutex_unlock(&data->mutex);
+  for (int i = 0; i < 2; ++i) winterface->end(&workers[i]);
+  aom_thread_pool_client_free(&client);
+  return done;
+}
+
+TEST(ThreadPoolTest, ContinuousClientYields) {
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+  YieldData data;
+  data.pool = aom_thread_pool_alloc(2);
+  ASSERT_TRUE(data.pool != NULL);
+  pthread_mutex_init(&data.mutex, NULL);
+  pthread_cond_init(&data.cond, NULL);
+  data.launched = 0;
+  data.yielding = 0;
+  data.stopping = 0;
+  data.waiting_done = 0;
+
+  AVxWorker thread;
+  winterface->init(&thread);
+  ASSERT_NE(winterface->reset(&thread), 0);
+  thread.hook = RunContinuousClient;
+  thread.data1 = &data;
+  thread.data2 = NULL;
+  winterface->launch(&thread);
+
+  // All the threads of the pool are reserved by the other client.
+  pthread_mutex_lock(&data.mutex);
+  while (data.launched == 0) pthread_cond_wait(&data.cond, &data.mutex);
+  pthread_mutex_unlock(&data.mutex);
+
+  AVxThreadPoolClient client;
+  ASSERT_NE(aom_thread_pool_client_init(&client, data.pool, 1), 0);
+  AVxWorker worker;
+  winterface->init(&worker);
+  worker.pool = &client;
+  ASSERT_NE(winterface->reset(&worker), 0);
+  winterface->launch(&worker);
+  EXPECT_NE(winterface->sync(&worker), 0);
+  winterface->end(&worker);
+  aom_thread_pool_client_free(&client);
+  pthread_mutex_lock(&data.mutex);
+  data.waiting_done = 1;
+  pthread_mutex_unlock(&data.mutex);
+
+  // The other client saw the waiting one finish before running out of
+  // launches.
+  EXPECT_NE(winterface->sync(&thread), 0);
+  winterface->end(&thread);
+  pthread_cond_destroy(&data.cond);
+  pthread_mutex_destroy(&data.mutex);
+  aom_thread_pool_free(data.pool);
+}
+
+TEST(ThreadPoolTest, PublicApi) {
+  EXPECT_TRUE(aom_thread_pool_create(0) == NULL);
+  aom_thread_pool_t *const pool = aom_thread_pool_create(2);
+  ASSERT_TRUE(pool != NULL);
+  aom_thread_pool_destroy(pool);
+  aom_thread_pool_destroy(NULL);
+}
+
+}  // namespace
+
+#endif  // CONFIG_MULTITHREAD